@@ -1194,17 +1194,26 @@ void WBContextModel::export_svg(const std::string &path) {
       _("Cannot Export Diagram"), _("Current diagram cannot be exported as image, please select a diagram first."));
 }
 
-void WBContextModel::exportPng(const model_DiagramRef &diagram, const std::string &path) {
+bool WBContextModel::exportPng(const model_DiagramRef &diagram, const std::string &path) {
+  mdc::CanvasView *canvas = diagram->get_data()->get_realized_canvas_view();
+  if (canvas == NULL) {
+    logError("Cannot export diagram %s to %s, it could not be realized\n", diagram->name().c_str(), path.c_str());
+    wb::WBContextUI::get()->get_wb()->_frontendCallbacks->show_status_text(_("Could not export to PNG file."));
+    return false;
+  }
+
   wb::WBContextUI::get()->get_wb()->_frontendCallbacks->show_status_text(
         strfmt(_("Exporting full model diagram to %s..."), path.c_str()));
   try {
-    diagram->get_data()->get_canvas_view()->export_png(path, true);
+    canvas->export_png(path, true);
     wb::WBContextUI::get()->get_wb()->_frontendCallbacks->show_status_text(
           strfmt(_("Exported diagram image to %s"), path.c_str()));
   } catch (const std::exception &exc) {
     wb::WBContextUI::get()->get_wb()->_frontendCallbacks->show_status_text(_("Could not export to PNG file."));
     wb::WBContextUI::get()->get_wb()->show_exception(_("Export to PNG"), exc);
+    return false;
   }
+  return true;
 }
 
 void WBContextModel::export_ps(const std::string &path) {
@@ -1252,8 +1261,14 @@ void WBContextModel::add_new_diagram(const model_ModelRef &model) {
   wb::WBContextUI::get()->get_wb()->_frontendCallbacks->show_status_text(_("Diagram added."));
 }
 
-void WBContextModel::switch_diagram(const model_DiagramRef &view) {
-  wb::WBContextUI::get()->get_wb()->_frontendCallbacks->switched_view(view->get_data()->get_canvas_view());
+bool WBContextModel::switch_diagram(const model_DiagramRef &view) {
+  // Closed diagrams are not realized when a document is loaded, so this is where they get their canvas view.
+  mdc::CanvasView *canvas = view->get_data()->get_realized_canvas_view();
+  if (canvas == NULL)
+    return false;
+
+  wb::WBContextUI::get()->get_wb()->_frontendCallbacks->switched_view(canvas);
+  return true;
 }
 
 #endif // Diagrams_and_Canvas____
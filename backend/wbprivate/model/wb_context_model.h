@@ -111,14 +111,14 @@ namespace wb {
     void export_pdf(const std::string &path);
     void export_ps(const std::string &path);
     void export_svg(const std::string &path);
-    void exportPng(const model_DiagramRef &diagram, const std::string &path);
+    bool exportPng(const model_DiagramRef &diagram, const std::string &path);
 
     // Diagrams
     model_DiagramRef get_view_with_id(const std::string &id);
 
     void add_new_diagram(const model_ModelRef &model);
 
-    void switch_diagram(const model_DiagramRef &view);
+    bool switch_diagram(const model_DiagramRef &view);
 
     bool delete_diagram(const model_DiagramRef &view);
     bool delete_object(model_ObjectRef object);
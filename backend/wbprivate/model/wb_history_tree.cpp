@@ -34,6 +34,7 @@ HistoryTree::HistoryTree(UndoManager *undom)
     _undom(undom),
     _refresh_pending(false) {
   add_column(mforms::IconStringColumnType, "Action", 200);
+  add_column(mforms::StringColumnType, "Size", 70);
   end_columns();
 
   _icon = bec::IconManager::get_instance()->get_icon_path("history.png");
@@ -61,18 +62,34 @@ void HistoryTree::refresh() {
   // just update the captions of the existing nodes
 
   int row = 0;
+  size_t undo_size = 0, redo_size = 0;
   for (std::deque<UndoAction *>::const_iterator iter = undostack.begin(); iter != undostack.end(); ++iter) {
+    size_t size = (*iter)->memory_size();
+    undo_size += size;
+
     mforms::TreeNodeRef node = node_at_row(row++);
     node->set_icon_path(0, _icon);
     node->set_string(0, (*iter)->description());
+    node->set_string(1, base::sizefmt(size, false));
   }
 
   for (std::deque<UndoAction *>::const_reverse_iterator iter = redostack.rbegin(); iter != redostack.rend(); ++iter) {
+    size_t size = (*iter)->memory_size();
+    redo_size += size;
+
     mforms::TreeNodeRef node = node_at_row(row++);
     node->set_icon_path(0, _icon);
     node->set_string(0, "(" + (*iter)->description() + ")");
+    node->set_string(1, base::sizefmt(size, false));
   }
+
+  size_t limit = _undom->get_memory_limit();
   _undom->unlock();
+
+  set_tooltip(base::strfmt("Undo: %i entries, %s\nRedo: %i entries, %s\nMemory limit: %s", (int)undostack.size(),
+                           base::sizefmt(undo_size, false).c_str(), (int)redostack.size(),
+                           base::sizefmt(redo_size, false).c_str(),
+                           limit > 0 ? base::sizefmt(limit, false).c_str() : "none"));
 }
 
 void HistoryTree::activate_node(mforms::TreeNodeRef node, int column) {
@@ -209,6 +209,11 @@ void SpatialDrawBox::render(bool reproject) {
   if (reproject && !_background_layer->hidden())
     _background_layer->render(_spatial_reprojector);
 
+  // The part of the layers that ends up in the cache, in layer coordinates (i.e. before zoom and offset).
+  base::Point center(width / 2.0, height / 2.0);
+  base::Rect visible_rect((-center.x) / _zoom_level + center.x - _offset_x,
+                          (-center.y) / _zoom_level + center.y - _offset_y, width / _zoom_level, height / _zoom_level);
+
   int i = 0;
 
   base::MutexLock lock(_layer_mutex);
@@ -220,7 +225,7 @@ void SpatialDrawBox::render(bool reproject) {
     if (!(*it)->hidden()) {
       if (reproject)
         (*it)->render(_spatial_reprojector);
-      (*it)->repaint(*_ctx_cache, _zoom_level, base::Rect());
+      (*it)->repaint(*_ctx_cache, _zoom_level, visible_rect);
     }
   }
 
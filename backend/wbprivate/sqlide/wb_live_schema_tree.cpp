@@ -22,6 +22,7 @@
  */
 
 #include "wb_live_schema_tree.h"
+#include "wb_object_search_index.h"
 #include "grtdb/charset_utils.h"
 #include "grt/icon_manager.h"
 
@@ -32,6 +33,8 @@
 
 #include "mforms/app.h"
 #include <boost/make_shared.hpp>
+#include <algorithm>
+#include <unordered_set>
 
 using namespace wb;
 using namespace bec;
@@ -535,6 +538,16 @@ void LiveSchemaTree::set_case_sensitive_identifiers(bool flag) {
   _case_sensitive_identifiers = flag;
 }
 
+/*
+ * Sorts a list of object names the way the tree orders its nodes. Meant to be called by the fetch workers
+ * before the list is handed over to the main thread, so update_node_children only has to verify the order.
+ */
+void LiveSchemaTree::sort_object_names(base::StringListPtr names, bool case_sensitive) {
+  auto compare = std::bind(base::stl_string_compare, std::placeholders::_1, std::placeholders::_2, case_sensitive);
+  if (names && !std::is_sorted(names->begin(), names->end(), compare))
+    names->sort(compare);
+}
+
 bool LiveSchemaTree::identifiers_equal(const std::string& a, const std::string& b) {
   return base::string_compare(a, b, _case_sensitive_identifiers) == 0;
 }
@@ -733,25 +746,32 @@ void LiveSchemaTree::update_change_data(mforms::TreeNodeRef parent, base::String
   int total_nodes = parent->count();
   if (total_nodes == 1 && parent->get_child(0)->get_string(0) == FETCHING_CAPTION)
     to_remove.push_back(parent->get_child(0));
-  else {
+  else if (total_nodes > 0) {
+    // Hashing the incoming names keeps this linear, a lookup per node in the list made refreshing
+    // schemas with many thousand objects stall the UI.
+    std::unordered_set<std::string> incoming(children->begin(), children->end());
+    std::unordered_set<std::string> existing;
+
     for (int index = 0; index < total_nodes; index++) {
       node = parent->get_child(index);
       LSTData* pchild_data = dynamic_cast<LSTData*>(node->get_data());
 
       // Ensure only items of the same type are analyzed
       if (pchild_data && pchild_data->get_type() == type) {
-        std::list<std::string>::iterator found_child =
-          std::find(children->begin(), children->end(), node->get_string(0));
+        std::string name = node->get_string(0);
 
         // If not found, the item will be removed
-        if (found_child == children->end())
+        if (incoming.find(name) == incoming.end())
           to_remove.push_back(node);
-        // If found, the item is removed from the incoming list
-        // to let only nodes to be added
         else
-          children->erase(found_child);
+          existing.insert(name);
       }
     }
+
+    // Found items are removed from the incoming list to let only nodes to be added.
+    // Only the first occurrence of every name is dropped.
+    if (!existing.empty())
+      children->remove_if([&existing](const std::string& name) { return existing.erase(name) > 0; });
   }
 }
 
@@ -795,8 +815,6 @@ bool LiveSchemaTree::update_node_children(mforms::TreeNodeRef parent, base::Stri
     bool removed = false;
     std::vector<mforms::TreeNodeRef> childs_to_remove;
 
-    //_model_view->freeze_refresh(); cannot be called from a background thread.
-
     // Calculates the nodes to be removed and the new nodes to be created
     update_change_data(parent, children, type, childs_to_remove);
 
@@ -815,9 +833,9 @@ bool LiveSchemaTree::update_node_children(mforms::TreeNodeRef parent, base::Stri
     std::vector<mforms::TreeNodeRef> group_added_nodes;
     std::string icon_path = get_node_icon_path(type);
 
+    // Lists coming from the fetch workers are already sorted, so this is just an order check then.
     if (sorted)
-      children->sort(
-        std::bind(base::stl_string_compare, std::placeholders::_1, std::placeholders::_2, _case_sensitive_identifiers));
+      sort_object_names(children, _case_sensitive_identifiers);
 
     if (!children->empty()) {
       // it and it_end are used on the iteration process
@@ -883,10 +901,6 @@ bool LiveSchemaTree::update_node_children(mforms::TreeNodeRef parent, base::Stri
     }
 
     ret_val = (added || removed);
-
-    std::string icon = get_node_icon_path(type);
-
-    //_model_view->thaw_refresh(); Cannot be called from a background thread.
   }
 
   return ret_val;
@@ -1079,6 +1093,9 @@ void LiveSchemaTree::schema_contents_arrived(const std::string& schema_name, bas
       mforms::TreeNodeRef schema_node = get_child_node(_model_view->root_node(), schema_name);
 
       if (schema_node) {
+        // Avoids the view processing every single row change while thousands of nodes are added.
+        _model_view->freeze_refresh();
+
         mforms::TreeNodeRef tables_node = schema_node->get_child(TABLES_NODE_INDEX);
         mforms::TreeNodeRef views_node = schema_node->get_child(VIEWS_NODE_INDEX);
         mforms::TreeNodeRef procedures_node = schema_node->get_child(PROCEDURES_NODE_INDEX);
@@ -1135,6 +1152,8 @@ void LiveSchemaTree::schema_contents_arrived(const std::string& schema_name, bas
 
         pdata->fetching = false;
         update_node_icon(schema_node);
+
+        _model_view->thaw_refresh();
       }
     }
   }
@@ -1714,6 +1733,7 @@ std::string LiveSchemaTree::get_filter_wildcard(const std::string& filter, Filte
 //--------------------------------------------------------------------------------------------------
 void LiveSchemaTree::filter_data() {
   _enabled_events = false;
+  _model_view->freeze_refresh();
 
   // Removes all the objects on the target tree
   _model_view->clear();
@@ -1725,6 +1745,7 @@ void LiveSchemaTree::filter_data() {
   // To keep the active schema on the filtered tree
   set_active_schema(_base->_active_schema);
 
+  _model_view->thaw_refresh();
   _enabled_events = true;
 }
 
@@ -1799,24 +1820,40 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
   // Clears the collection...
   target->remove_children();
 
-  int count = source->count();
-  for (int index = 0; index < count; index++) {
-    mforms::TreeNodeRef source_node = source->get_child(index);
-    if (!validate || g_pattern_match_string(pattern, base::toupper(source_node->get_string(0)).c_str())) {
-      std::vector<mforms::TreeNodeRef> group_added_nodes;
-      _node_collections[type].captions.clear();
-      _node_collections[type].captions.push_back(source_node->get_string(0));
-      group_added_nodes = target->add_node_collection(_node_collections[type]);
-      setup_node(group_added_nodes[0], type, source_node->get_data(), true);
+  // Collects all the matching nodes first, so they are created with a single collection insert.
+  // With a name index only the matches are looked up, otherwise all the source nodes are checked.
+  std::vector<mforms::TreeNodeRef> source_nodes;
+  bool indexed = validate && pattern == (type == Schema ? _schema_pattern : _object_pattern) &&
+                 find_indexed_children(type, source, source_nodes);
+
+  if (!indexed) {
+    source_nodes.clear();
+    int count = source->count();
+    for (int index = 0; index < count; index++) {
+      mforms::TreeNodeRef source_node = source->get_child(index);
+      if (!validate || g_pattern_match_string(pattern, base::toupper(source_node->get_string(0)).c_str()))
+        source_nodes.push_back(source_node);
+    }
+  }
+
+  _node_collections[type].captions.clear();
+  for (auto& source_node : source_nodes)
+    _node_collections[type].captions.push_back(source_node->get_string(0));
+
+  if (!source_nodes.empty()) {
+    std::vector<mforms::TreeNodeRef> added_nodes = target->add_node_collection(_node_collections[type]);
+    for (std::size_t index = 0; index < added_nodes.size(); index++) {
+      mforms::TreeNodeRef source_node = source_nodes[index];
+      setup_node(added_nodes[index], type, source_node->get_data(), true);
 
       // For each found node, continues with their children...
       if (type == Schema || type == Table || type == View)
-        filter_children_collection(source_node, group_added_nodes[0]);
+        filter_children_collection(source_node, added_nodes[index]);
 
       if (source_node->is_expanded())
-        group_added_nodes[0]->expand();
+        added_nodes[index]->expand();
       else
-        group_added_nodes[0]->collapse();
+        added_nodes[index]->collapse();
     }
   }
 
@@ -1832,10 +1869,79 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
 
 //--------------------------------------------------------------------------------------------------
 
+/*
+*  find_indexed_children: looks up the children of source matching the current filter in the object index.
+*                         Source children are sorted, so each match is found with a binary search and nothing
+*                         else is visited. Returns false if the index can't answer, i.e. it is not set, the
+*                         schema has not been indexed yet or a name in the index has no node in the tree.
+*/
+bool LiveSchemaTree::find_indexed_children(ObjectType type, mforms::TreeNodeRef& source,
+                                           std::vector<mforms::TreeNodeRef>& nodes) {
+  if (_object_index == nullptr || !_base)
+    return false;
+
+  base::StringListPtr names;
+  if (type == Schema) {
+    // An index not matching the tree (e.g. not filled yet) would hide schemas.
+    if (_object_index->schema_count() != (std::size_t)source->count())
+      return false;
+
+    std::vector<std::string> schemas = _object_index->find_schemas(_schema_wildcard);
+    names = std::make_shared<base::StringList>(schemas.begin(), schemas.end());
+  } else {
+    ObjectSearchIndex::SchemaMatches matches;
+    if (!_object_index->find_objects(get_schema_name(source), _object_wildcard, matches))
+      return false;
+
+    switch (type) {
+      case Table:
+        names = matches.tables;
+        break;
+      case View:
+        names = matches.views;
+        break;
+      case Procedure:
+        names = matches.procedures;
+        break;
+      case Function:
+        names = matches.functions;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  // The index is ordered by upper cased names, the tree by its own collation.
+  std::vector<std::pair<int, mforms::TreeNodeRef>> found;
+  found.reserve(names->size());
+  int last = source->count() - 1;
+  for (auto& name : *names) {
+    int position = 0;
+    mforms::TreeNodeRef node = _base->binary_search_node(source, 0, last, name, type, position);
+    if (!node)
+      return false;
+    found.push_back(std::make_pair(position, node));
+  }
+  std::sort(found.begin(), found.end(),
+            [](const std::pair<int, mforms::TreeNodeRef>& a, const std::pair<int, mforms::TreeNodeRef>& b) {
+              return a.first < b.first;
+            });
+
+  nodes.clear();
+  nodes.reserve(found.size());
+  for (auto& entry : found)
+    nodes.push_back(entry.second);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void LiveSchemaTree::clean_filter() {
   if (_filter.length() > 0) {
     _filter_type = Any;
     _filter = "";
+    _schema_wildcard.clear();
+    _object_wildcard.clear();
 
     g_pattern_spec_free(_schema_pattern);
     _schema_pattern = NULL;
@@ -1861,9 +1967,12 @@ void LiveSchemaTree::set_filter(std::string filter) {
     std::string object_filter = base::toupper(get_filter_wildcard(filters.size() > 1 ? filters[1] : "", LocalLike));
 
     _schema_pattern = g_pattern_spec_new(schema_filter.c_str());
+    _schema_wildcard = schema_filter;
 
-    if (filters.size() > 1 && object_filter != "*")
+    if (filters.size() > 1 && object_filter != "*") {
       _object_pattern = g_pattern_spec_new(object_filter.c_str());
+      _object_wildcard = object_filter;
+    }
   }
 }
 
@@ -1986,10 +2095,9 @@ void LiveSchemaTree::update_schemata(base::StringListPtr schema_list) {
       root = _model_view->root_node();
     }
 
-    schema_list->sort(
-      std::bind(base::stl_string_compare, std::placeholders::_1, std::placeholders::_2, _case_sensitive_identifiers));
-
+    _model_view->freeze_refresh();
     update_node_children(root, schema_list, Schema, true);
+    _model_view->thaw_refresh();
 
     // Re-sets the active schema at view level
     if (_active_schema.length())
@@ -33,6 +33,8 @@
 #include "base/trackable.h"
 
 namespace wb {
+  class ObjectSearchIndex;
+
   class MYSQLWBBACKEND_PUBLIC_FUNC LiveSchemaTree : base::trackable {
   public:
     friend class LiveSchemaTreeTester;
@@ -397,6 +399,8 @@ namespace wb {
     void filter_children_collection(mforms::TreeNodeRef& source, mforms::TreeNodeRef& target);
     bool filter_children(ObjectType type, mforms::TreeNodeRef& source, mforms::TreeNodeRef& target,
                          GPatternSpec* pattern = NULL);
+    bool find_indexed_children(ObjectType type, mforms::TreeNodeRef& source,
+                               std::vector<mforms::TreeNodeRef>& nodes);
     bool is_object_type(ObjectTypeValidation validation, ObjectType type);
 
   public:
@@ -452,6 +456,12 @@ namespace wb {
 
     LiveSchemaTree* getBase() { return _base; }
 
+    // The name index kept by the fetch workers. When set, filtering looks up the matching schemas and objects
+    // there and only visits their nodes in the base tree.
+    void set_object_index(const ObjectSearchIndex* index) {
+      _object_index = index;
+    }
+
     bool update_node_children(mforms::TreeNodeRef parent, base::StringListPtr children, ObjectType type,
                               bool sorted = false, bool just_append = false);
     void update_change_data(mforms::TreeNodeRef parent, base::StringListPtr children, ObjectType type,
@@ -471,6 +481,10 @@ namespace wb {
     void expand_toggled(mforms::TreeNodeRef node, bool value);
     void node_activated(mforms::TreeNodeRef node, int column);
     void set_case_sensitive_identifiers(bool flag);
+    bool case_sensitive_identifiers() const {
+      return _case_sensitive_identifiers;
+    }
+    static void sort_object_names(base::StringListPtr names, bool case_sensitive);
     std::string get_schema_name(const mforms::TreeNodeRef& node);
     std::vector<std::string> get_node_path(const mforms::TreeNodeRef& node);
     mforms::TreeNodeRef get_node_from_path(std::vector<std::string> path);
@@ -487,7 +501,10 @@ namespace wb {
     base::MySQLVersion _version;
 
     LiveSchemaTree *_base = nullptr;
+    const ObjectSearchIndex *_object_index = nullptr;
     std::string _filter;
+    std::string _schema_wildcard; // The wildcards the patterns were created from.
+    std::string _object_wildcard;
     ObjectType _filter_type;
     LSTData *notify_on_reload_data = nullptr;
 
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "wb_object_search_index.h"
+#include "base/string_utilities.h"
+
+#include <glib.h>
+#include <algorithm>
+
+using namespace wb;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Matches upper cased names against a wildcard pattern. Plain, prefix and substring patterns (the ones typed
+ * into the sidebar filter) are handled with string compares, anything else goes through GPatternSpec.
+ */
+class ObjectSearchIndex::NameMatcher {
+public:
+  NameMatcher(const std::string &pattern) : _pattern(base::toupper(pattern.empty() ? "*" : pattern)) {
+    size_t wildcard = _pattern.find_first_of("*?");
+    _prefix = _pattern.substr(0, wildcard);
+
+    if (wildcard == std::string::npos)
+      _kind = Exact;
+    else if (wildcard == _pattern.size() - 1 && _pattern.back() == '*')
+      _kind = Prefix;
+    else if (wildcard == 0 && _pattern.size() > 1 && _pattern.find_first_of("*?", 1) == _pattern.size() - 1 &&
+             _pattern.back() == '*') {
+      _kind = Substring;
+      _literal = _pattern.substr(1, _pattern.size() - 2);
+    } else {
+      _kind = Wildcard;
+      _spec = g_pattern_spec_new(_pattern.c_str());
+    }
+  }
+
+  NameMatcher(const NameMatcher &) = delete;
+  NameMatcher &operator=(const NameMatcher &) = delete;
+
+  ~NameMatcher() {
+    if (_spec != nullptr)
+      g_pattern_spec_free(_spec);
+  }
+
+  // The literal part before the first wildcard, all matching names start with it.
+  const std::string &prefix() const {
+    return _prefix;
+  }
+
+  bool matches(const std::string &key) const {
+    switch (_kind) {
+      case Exact:
+        return key == _pattern;
+      case Prefix:
+        return key.compare(0, _prefix.size(), _prefix) == 0;
+      case Substring:
+        return key.find(_literal) != std::string::npos;
+      default:
+        return g_pattern_match_string(_spec, key.c_str()) != 0;
+    }
+  }
+
+private:
+  enum Kind { Exact, Prefix, Substring, Wildcard };
+
+  std::string _pattern;
+  std::string _prefix;
+  std::string _literal;
+  Kind _kind;
+  GPatternSpec *_spec = nullptr;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Converts a filter in server LIKE syntax (as passed to the remote search) back to the wildcard syntax
+ * used in the sidebar.
+ */
+std::string ObjectSearchIndex::like_to_wildcard(const std::string &filter) {
+  std::string result;
+  result.reserve(filter.size());
+
+  for (size_t i = 0; i < filter.size(); ++i) {
+    char c = filter[i];
+    if (c == '\\' && i + 1 < filter.size())
+      result += filter[++i];
+    else if (c == '%')
+      result += '*';
+    else if (c == '_')
+      result += '?';
+    else
+      result += c;
+  }
+
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Sets the list of schemas on the server. Contents of schemas no longer in the list are dropped, new schemas
+ * are known but not indexed until their contents arrive.
+ */
+void ObjectSearchIndex::set_schemas(const std::vector<std::string> &schemas) {
+  base::MutexLock lock(_mutex);
+
+  std::map<std::string, SchemaEntry> updated;
+  for (auto &schema : schemas) {
+    auto existing = _schemas.find(schema);
+    if (existing != _schemas.end())
+      updated[schema] = std::move(existing->second);
+    else
+      updated[schema];
+  }
+  _schemas.swap(updated);
+  update_schema_keys();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Called with the mutex held.
+void ObjectSearchIndex::update_schema_keys() {
+  _schema_keys.clear();
+  _schema_keys.reserve(_schemas.size());
+  for (auto &schema : _schemas)
+    _schema_keys.push_back({ base::toupper(schema.first), schema.first });
+  std::sort(_schema_keys.begin(), _schema_keys.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ObjectSearchIndex::add_objects(std::vector<Entry> &objects, base::StringListPtr names,
+                                    LiveSchemaTree::ObjectType type) {
+  if (!names)
+    return;
+
+  for (auto &name : *names)
+    objects.push_back({ base::toupper(name), name, type });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the indexed objects of the given schema. Called with the lists fetched for the schema tree,
+ * so it runs in the fetch worker and the sorting work stays off the main thread.
+ */
+void ObjectSearchIndex::set_schema_contents(const std::string &schema, base::StringListPtr tables,
+                                            base::StringListPtr views, base::StringListPtr procedures,
+                                            base::StringListPtr functions) {
+  std::vector<Entry> objects;
+  add_objects(objects, tables, LiveSchemaTree::Table);
+  add_objects(objects, views, LiveSchemaTree::View);
+  add_objects(objects, procedures, LiveSchemaTree::Procedure);
+  add_objects(objects, functions, LiveSchemaTree::Function);
+  std::sort(objects.begin(), objects.end());
+
+  base::MutexLock lock(_mutex);
+  SchemaEntry &entry = _schemas[schema];
+  entry.objects.swap(objects);
+  entry.indexed = true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Keeps the index in sync with objects created, renamed or dropped from within the editor.
+ * An empty old name means the object was created, an empty new name that it was dropped.
+ */
+void ObjectSearchIndex::update_object(LiveSchemaTree::ObjectType type, const std::string &schema,
+                                      const std::string &old_name, const std::string &new_name) {
+  base::MutexLock lock(_mutex);
+
+  if (type == LiveSchemaTree::Schema) {
+    if (!old_name.empty())
+      _schemas.erase(old_name);
+    if (!new_name.empty()) {
+      // A new schema is empty, so its (empty) contents are known already.
+      _schemas[new_name].indexed = old_name.empty();
+    }
+    update_schema_keys();
+    return;
+  }
+
+  auto schema_entry = _schemas.find(schema);
+  if (schema_entry == _schemas.end() || !schema_entry->second.indexed)
+    return;
+
+  std::vector<Entry> &objects = schema_entry->second.objects;
+  if (!old_name.empty()) {
+    Entry old_entry{ base::toupper(old_name), old_name, type };
+    auto range = std::equal_range(objects.begin(), objects.end(), old_entry);
+    for (auto iterator = range.first; iterator != range.second; ++iterator) {
+      if (iterator->name == old_name && iterator->type == type) {
+        objects.erase(iterator);
+        break;
+      }
+    }
+  }
+
+  if (!new_name.empty()) {
+    Entry new_entry{ base::toupper(new_name), new_name, type };
+    objects.insert(std::upper_bound(objects.begin(), objects.end(), new_entry), new_entry);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ObjectSearchIndex::clear() {
+  base::MutexLock lock(_mutex);
+  _schemas.clear();
+  _schema_keys.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool ObjectSearchIndex::is_indexed(const std::string &schema) const {
+  base::MutexLock lock(_mutex);
+
+  auto entry = _schemas.find(schema);
+  return entry != _schemas.end() && entry->second.indexed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t ObjectSearchIndex::schema_count() const {
+  base::MutexLock lock(_mutex);
+  return _schemas.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t ObjectSearchIndex::object_count() const {
+  base::MutexLock lock(_mutex);
+
+  size_t count = 0;
+  for (auto &entry : _schemas)
+    count += entry.second.objects.size();
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Searches the indexed objects using the sidebar wildcard syntax (* and ?), case insensitive.
+ * The matches are returned per schema, in the same shape as the schema contents fetched from the server.
+ *
+ * Schemas matching the schema filter whose contents have not arrived yet are returned in unindexed, only those
+ * have to be searched on the server. Returns false if no schemas are known yet, so nothing can be answered locally.
+ */
+bool ObjectSearchIndex::search(const std::string &schema_filter, const std::string &object_filter,
+                               std::vector<SchemaMatches> &matches, std::vector<std::string> &unindexed) const {
+  NameMatcher schema_matcher(schema_filter);
+  NameMatcher object_matcher(object_filter);
+
+  base::MutexLock lock(_mutex);
+
+  if (_schemas.empty())
+    return false;
+
+  std::vector<SchemaMatches> result;
+  std::vector<std::string> missing;
+  for (auto &schema_entry : _schemas) {
+    if (!schema_matcher.matches(base::toupper(schema_entry.first)))
+      continue;
+
+    if (!schema_entry.second.indexed) {
+      missing.push_back(schema_entry.first);
+      continue;
+    }
+
+    SchemaMatches schema_matches;
+    match_objects(schema_entry.second.objects, object_matcher, schema_matches);
+    if (!schema_matches.tables->empty() || !schema_matches.views->empty() || !schema_matches.procedures->empty() ||
+        !schema_matches.functions->empty()) {
+      schema_matches.schema = schema_entry.first;
+      result.push_back(schema_matches);
+    }
+  }
+
+  matches.swap(result);
+  unindexed.swap(missing);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the schemas matching the given filter (sidebar wildcard syntax, case insensitive). Only the range of
+ * schema names starting with the literal prefix of the filter is checked.
+ */
+std::vector<std::string> ObjectSearchIndex::find_schemas(const std::string &schema_filter) const {
+  NameMatcher matcher(schema_filter);
+  const std::string &prefix = matcher.prefix();
+
+  base::MutexLock lock(_mutex);
+
+  std::vector<std::string> result;
+  auto iterator = std::lower_bound(_schema_keys.begin(), _schema_keys.end(), std::make_pair(prefix, std::string()));
+  for (; iterator != _schema_keys.end() && iterator->first.compare(0, prefix.size(), prefix) == 0; ++iterator) {
+    if (matcher.matches(iterator->first))
+      result.push_back(iterator->second);
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Collects the objects of a single schema matching the given filter. Returns false if the schema has not been
+ * indexed yet.
+ */
+bool ObjectSearchIndex::find_objects(const std::string &schema, const std::string &object_filter,
+                                     SchemaMatches &matches) const {
+  NameMatcher matcher(object_filter);
+
+  base::MutexLock lock(_mutex);
+
+  auto schema_entry = _schemas.find(schema);
+  if (schema_entry == _schemas.end() || !schema_entry->second.indexed)
+    return false;
+
+  matches = SchemaMatches();
+  matches.schema = schema;
+  match_objects(schema_entry->second.objects, matcher, matches);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the matching objects to the per type lists of matches, which are always set afterwards.
+ * Entries are sorted by their upper cased name, so only the range starting with the literal prefix
+ * of the pattern needs to be checked.
+ */
+void ObjectSearchIndex::match_objects(const std::vector<Entry> &objects, const NameMatcher &matcher,
+                                      SchemaMatches &matches) {
+  for (auto list : { &matches.tables, &matches.views, &matches.procedures, &matches.functions }) {
+    if (!*list)
+      *list = std::make_shared<base::StringList>();
+  }
+
+  const std::string &prefix = matcher.prefix();
+  auto iterator = std::lower_bound(objects.begin(), objects.end(), Entry{ prefix, "", LiveSchemaTree::Any });
+  for (; iterator != objects.end() && iterator->key.compare(0, prefix.size(), prefix) == 0; ++iterator) {
+    if (!matcher.matches(iterator->key))
+      continue;
+
+    switch (iterator->type) {
+      case LiveSchemaTree::Table:
+        matches.tables->push_back(iterator->name);
+        break;
+      case LiveSchemaTree::View:
+        matches.views->push_back(iterator->name);
+        break;
+      case LiveSchemaTree::Procedure:
+        matches.procedures->push_back(iterator->name);
+        break;
+      default:
+        matches.functions->push_back(iterator->name);
+        break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "workbench/wb_backend_public_interface.h"
+#include "sqlide/wb_live_schema_tree.h"
+#include "base/threading.h"
+
+#include <map>
+
+namespace wb {
+
+  /**
+   * Client side index over the names of the schema objects loaded into the live schema tree. It lets the sidebar
+   * answer object searches locally instead of calling the SEARCH_OBJECTS procedure on the server.
+   * Filled from the fetch worker threads, so all access is synchronized.
+   */
+  class MYSQLWBBACKEND_PUBLIC_FUNC ObjectSearchIndex {
+  public:
+    struct SchemaMatches {
+      std::string schema;
+      base::StringListPtr tables;
+      base::StringListPtr views;
+      base::StringListPtr procedures;
+      base::StringListPtr functions;
+    };
+
+    void set_schemas(const std::vector<std::string> &schemas);
+    void set_schema_contents(const std::string &schema, base::StringListPtr tables, base::StringListPtr views,
+                             base::StringListPtr procedures, base::StringListPtr functions);
+    void update_object(LiveSchemaTree::ObjectType type, const std::string &schema, const std::string &old_name,
+                       const std::string &new_name);
+    void clear();
+
+    bool is_indexed(const std::string &schema) const;
+    size_t schema_count() const;
+    size_t object_count() const;
+
+    bool search(const std::string &schema_filter, const std::string &object_filter,
+                std::vector<SchemaMatches> &matches, std::vector<std::string> &unindexed) const;
+
+    // Lookups for the sidebar filter, so it only has to create the tree nodes of the matches.
+    std::vector<std::string> find_schemas(const std::string &schema_filter) const;
+    bool find_objects(const std::string &schema, const std::string &object_filter, SchemaMatches &matches) const;
+
+    static std::string like_to_wildcard(const std::string &filter);
+
+  private:
+    class NameMatcher;
+
+    struct Entry {
+      std::string key; // Upper cased name, the sort key.
+      std::string name;
+      LiveSchemaTree::ObjectType type;
+
+      bool operator<(const Entry &other) const {
+        return key < other.key;
+      }
+    };
+
+    struct SchemaEntry {
+      bool indexed = false;
+      std::vector<Entry> objects;
+    };
+
+    void add_objects(std::vector<Entry> &objects, base::StringListPtr names, LiveSchemaTree::ObjectType type);
+    void update_schema_keys();
+    static void match_objects(const std::vector<Entry> &objects, const NameMatcher &matcher, SchemaMatches &matches);
+
+    std::map<std::string, SchemaEntry> _schemas;
+    std::vector<std::pair<std::string, std::string>> _schema_keys; // Upper cased and real schema names, sorted.
+    mutable base::Mutex _mutex; // guards _schemas and _schema_keys
+  };
+
+}
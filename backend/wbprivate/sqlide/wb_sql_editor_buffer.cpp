@@ -641,13 +641,21 @@ void SqlEditorForm::open_file(const std::string &path, bool in_new_tab, bool ask
   }
 
   try {
-    if (askForFile && panel->load_from(file_path) == SqlEditorPanel::RunInstead) {
+    SqlEditorPanel::LoadResult result = askForFile ? panel->load_from(file_path) : SqlEditorPanel::Loaded;
+    if (result == SqlEditorPanel::RunInstead || result == SqlEditorPanel::RunWithEncodingInstead) {
       if (in_new_tab)
         remove_sql_editor(panel);
-      grt::BaseListRef args(true);
-      args.ginsert(grtobj());
-      args.ginsert(grt::StringRef(file_path));
-      grt::GRT::get()->call_module_function("SQLIDEUtils", "runSQLScriptFile", args);
+
+      if (result == SqlEditorPanel::RunInstead && connected()) {
+        // Large scripts are executed straight from the file, without loading them into an editor.
+        exec_sql_script_file(file_path);
+      } else {
+        // The script runner plugin lets the user pick the encoding and converts the file through the mysql client.
+        grt::BaseListRef args(true);
+        args.ginsert(grtobj());
+        args.ginsert(grt::StringRef(file_path));
+        grt::GRT::get()->call_module_function("SQLIDEUtils", "runSQLScriptFile", args);
+      }
       return;
     }
   } catch (std::exception &exc) {
@@ -39,6 +39,7 @@
 #include "sqlide/sql_script_run_wizard.h"
 
 #include "sqlide/column_width_cache.h"
+#include "sqlide/sql_script_file_reader.h"
 
 #include "objimpl/db.query/db_query_Resultset.h"
 #include "objimpl/wrapper/mforms_ObjectReference_impl.h"
@@ -49,6 +50,7 @@
 #include "base/file_functions.h"
 #include "base/file_utilities.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/boost_smart_ptr_helpers.h"
 #include "base/util_functions.h"
 #include "base/scope_exit_trigger.h"
@@ -187,6 +189,37 @@ private:
 
 struct SqlEditorForm::PrivateMutex {
   std::mutex _symbolsMutex;
+
+  // An additional aux connection, opened on demand while the main aux connection is busy.
+  struct PooledConnection {
+    sql::Dbc_connection_handler::Ref conn;
+    base::RecMutex mutex;
+    std::thread::id owner; // The thread which got this connection last, for nested use.
+    bool failed = false;   // Opening the connection failed, not retried until the next (re)connect.
+
+    PooledConnection() : conn(new sql::Dbc_connection_handler()) {
+    }
+  };
+
+  std::mutex _auxPoolMutex; // Guards the pool, the owners, the statistics and the state below. Not the connections.
+  std::vector<std::unique_ptr<PooledConnection>> _auxPool; // Entries are never removed.
+  std::thread::id _auxOwner;
+  AuxConnectionPoolStats _auxPoolStats;
+
+  // What the pool needs to know about the main aux connection. That one is only safe to look at with its own
+  // mutex held, which the pool can't wait for.
+  bool _auxConnected = false;
+  std::string _auxActiveSchema;
+
+  void setAuxConnected(bool connected) {
+    std::lock_guard<std::mutex> poolLock(_auxPoolMutex);
+    _auxConnected = connected;
+  }
+
+  void setAuxActiveSchema(const std::string &schema) {
+    std::lock_guard<std::mutex> poolLock(_auxPoolMutex);
+    _auxActiveSchema = schema;
+  }
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -575,7 +608,10 @@ grt::StringRef SqlEditorForm::do_disconnect() {
       RecMutexLock lock(_aux_dbc_conn_mutex);
       close_connection(_aux_dbc_conn);
       _aux_dbc_conn->ref.reset();
+      _pimplMutex->setAuxConnected(false);
     }
+
+    close_aux_connection_pool();
   }
 
   return grt::StringRef();
@@ -1139,6 +1175,11 @@ void SqlEditorForm::create_connection(sql::Dbc_connection_handler::Ref &dbc_conn
 
   dbc_conn->ref->setAutoCommit(autocommit_mode);
   dbc_conn->autocommit_mode = dbc_conn->ref->getAutoCommit();
+
+  if (dbc_conn == _aux_dbc_conn) {
+    _pimplMutex->setAuxActiveSchema(dbc_conn->active_schema);
+    _pimplMutex->setAuxConnected(true);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1318,12 +1359,16 @@ std::string createTableRow(const std::string &name, const std::string &value = "
 
 grt::StringRef SqlEditorForm::do_connect(std::shared_ptr<SSHTunnel> tunnel, sql::Authentication::Ref &auth,
                                          ConnectionErrorInfo *err_ptr) {
+  BASE_TRACE("sql", "connect");
   try {
+    close_aux_connection_pool();
+
     RecMutexLock aux_dbc_conn_mutex(_aux_dbc_conn_mutex);
     RecMutexLock usr_dbc_conn_mutex(_usr_dbc_conn_mutex);
 
     _aux_dbc_conn->ref.reset();
     _usr_dbc_conn->ref.reset();
+    _pimplMutex->setAuxConnected(false);
 
     _connection_details["name"] = _connection->name();
     _connection_details["hostName"] = _connection->parameterValues().get_string("hostName");
@@ -1590,14 +1635,185 @@ bool SqlEditorForm::ping() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Hands out an aux connection for a task. That is the main aux connection, if it is free or already held by the
+ * calling thread. While it is busy (e.g. with a long running schema fetch) up to DbSqlEditor:AuxConnectionPoolSize - 1
+ * additional connections are opened on demand, so that sidebar and code completion queries don't queue up behind it.
+ * Only if all of them are busy the caller waits for the main aux connection, as before.
+ *
+ * Pooled connections follow the active schema, but no other session state. Use the main aux connection
+ * (lockOnly or the other ensure_valid_aux_connection() variant) for anything depending on that.
+ */
 base::RecMutexLock SqlEditorForm::ensure_valid_aux_connection(sql::Dbc_connection_handler::Ref &conn, bool lockOnly) {
-  RecMutexLock lock(ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex, lockOnly));
+  long poolSize = bec::GRTManager::get()->get_app_option_int("DbSqlEditor:AuxConnectionPoolSize", 3);
+  if (lockOnly || poolSize < 2) {
+    RecMutexLock lock(ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex, lockOnly));
+    conn = _aux_dbc_conn;
+    return lock;
+  }
+
+  PrivateMutex &d = *_pimplMutex;
+  std::thread::id self = std::this_thread::get_id();
+  PrivateMutex::PooledConnection *pooled = nullptr;
+  bool useMain = false;
+  bool connected;
+  std::string schema;
+  size_t poolCount;
+  {
+    std::lock_guard<std::mutex> poolLock(d._auxPoolMutex);
+    connected = d._auxConnected;
+    schema = d._auxActiveSchema;
+    while (d._auxPool.size() < (size_t)poolSize - 1)
+      d._auxPool.emplace_back(new PrivateMutex::PooledConnection());
+    size_t count = (size_t)poolSize - 1;
+    poolCount = d._auxPool.size();
+
+    // Nested use on the same thread gets the connection it already holds. For all others any free one will do.
+    // tryLock() on a recursive mutex only succeeds for a stale owner if the connection is free anyway.
+    // Without a main aux connection nothing is handed out, so the caller gets db_not_connected below.
+    for (int pass = 0; connected && pass < 2 && !useMain && pooled == nullptr; ++pass) {
+      bool ownedOnly = pass == 0;
+      if ((!ownedOnly || d._auxOwner == self) && _aux_dbc_conn_mutex.tryLock())
+        useMain = true;
+      for (size_t i = 0; i < count && !useMain && pooled == nullptr; ++i) {
+        PrivateMutex::PooledConnection *candidate = d._auxPool[i].get();
+        if (!candidate->failed && (!ownedOnly || candidate->owner == self) && candidate->mutex.tryLock())
+          pooled = candidate;
+      }
+    }
+
+    if (connected)
+      ++d._auxPoolStats.acquisitions;
+    if (useMain || pooled != nullptr) {
+      size_t inUse = 1;
+      if (!useMain) {
+        if (!_aux_dbc_conn_mutex.tryLock())
+          ++inUse;
+        else
+          _aux_dbc_conn_mutex.unlock();
+      }
+      for (size_t i = 0; i < count; ++i) {
+        PrivateMutex::PooledConnection *other = d._auxPool[i].get();
+        if (other == pooled)
+          continue;
+        if (!other->mutex.tryLock())
+          ++inUse;
+        else
+          other->mutex.unlock();
+      }
+      d._auxPoolStats.peak_in_use = std::max(d._auxPoolStats.peak_in_use, inUse);
+
+      if (useMain)
+        d._auxOwner = self;
+      else
+        pooled->owner = self;
+    }
+  }
+
+  if (pooled != nullptr) {
+    // The tryLock() above keeps the connection reserved until the scoped lock is taken.
+    try {
+      if (!pooled->conn->ref.get_ptr()) {
+        pooled->conn->active_schema = schema;
+        create_connection(pooled->conn, _connection, sql::DriverManager::getDriverManager()->getTunnel(_connection),
+                          _dbc_auth, true, false);
+        logDebug("Opened additional aux connection (%zu in pool)\n", poolCount);
+      }
+
+      RecMutexLock lock(ensure_valid_dbc_connection(pooled->conn, pooled->mutex));
+      if (!schema.empty() && pooled->conn->active_schema != schema) {
+        pooled->conn->ref->setSchema(schema);
+        pooled->conn->active_schema = schema;
+      }
+      pooled->mutex.unlock();
+
+      conn = pooled->conn;
+      return lock;
+    } catch (std::exception &exc) {
+      logWarning("Cannot use additional aux connection, falling back to the main one: %s\n", exc.what());
+      pooled->failed = true;
+      pooled->mutex.unlock();
+    }
+  } else if (useMain) {
+    try {
+      RecMutexLock lock(ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex));
+      _aux_dbc_conn_mutex.unlock();
+      conn = _aux_dbc_conn;
+      return lock;
+    } catch (...) {
+      _aux_dbc_conn_mutex.unlock();
+      throw;
+    }
+  }
+
+  if (!connected) {
+    RecMutexLock lock(ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex));
+    conn = _aux_dbc_conn;
+    return lock;
+  }
+
+  // All connections are busy, wait for the main one.
+  double start = timestamp();
+  RecMutexLock lock(ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex));
+  double waited = timestamp() - start;
+  {
+    std::lock_guard<std::mutex> poolLock(d._auxPoolMutex);
+    d._auxOwner = self;
+    ++d._auxPoolStats.waits;
+    d._auxPoolStats.total_wait_time += waited;
+    d._auxPoolStats.max_wait_time = std::max(d._auxPoolStats.max_wait_time, waited);
+  }
+
   conn = _aux_dbc_conn;
   return lock;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
+SqlEditorForm::AuxConnectionPoolStats SqlEditorForm::aux_connection_pool_stats() {
+  PrivateMutex &d = *_pimplMutex;
+  std::lock_guard<std::mutex> poolLock(d._auxPoolMutex);
+
+  AuxConnectionPoolStats stats = d._auxPoolStats;
+  stats.size = (size_t)std::max(bec::GRTManager::get()->get_app_option_int("DbSqlEditor:AuxConnectionPoolSize", 3), 1L);
+  stats.open = d._auxConnected ? 1 : 0;
+  for (auto &pooled : d._auxPool) {
+    if (pooled->conn->ref.get_ptr())
+      ++stats.open;
+  }
+
+  return stats;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Closes the additional aux connections, waiting for tasks still using them. They are opened again on demand.
+ */
+void SqlEditorForm::close_aux_connection_pool() {
+  PrivateMutex &d = *_pimplMutex;
+  std::vector<PrivateMutex::PooledConnection *> pool;
+  {
+    std::lock_guard<std::mutex> poolLock(d._auxPoolMutex);
+    for (auto &pooled : d._auxPool)
+      pool.push_back(pooled.get());
+
+    const AuxConnectionPoolStats &stats = d._auxPoolStats;
+    if (stats.acquisitions > 0)
+      logDebug("Aux connection pool: %zu hand outs, %zu waits (%.3fs total, %.3fs max), at most %zu in use\n",
+               stats.acquisitions, stats.waits, stats.total_wait_time, stats.max_wait_time, stats.peak_in_use);
+  }
+
+  for (auto pooled : pool) {
+    RecMutexLock lock(pooled->mutex);
+    close_connection(pooled->conn);
+    pooled->conn->ref.reset();
+    pooled->failed = false;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 RecMutexLock SqlEditorForm::ensure_valid_aux_connection(bool throw_on_block, bool lockOnly) {
   return ensure_valid_dbc_connection(_aux_dbc_conn, _aux_dbc_conn_mutex, throw_on_block, lockOnly);
 }
@@ -1941,6 +2157,7 @@ void SqlEditorForm::update_live_schema_tree(const std::string &sql) {
 
 grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::string> sql, SqlEditorPanel *editor,
                                           ExecFlags flags, RecordsetsRef result_list) {
+  BASE_TRACE("sql", "exec");
 
   logDebug("Background task for sql execution started\n");
 
@@ -2014,6 +2231,107 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
     ssize_t max_resultset_count = bec::GRTManager::get()->get_app_option_int("DbSqlEditor::MaxResultsets", 50);
     ssize_t total_result_count = (editor != nullptr) ? editor->resultset_count() : 0; // Consider pinned result sets.
 
+    // Opt-in batching: runs of statements without result sets are sent in multi-statement packets (up to the
+    // server's max_allowed_packet) and get a single summary log entry instead of one entry per statement.
+    std::size_t batch_packet_size = 0;
+    if (statement_ranges.size() > 1 &&
+        bec::GRTManager::get()->get_app_option_int("DbSqlEditor:BatchStatementExecution", 0) != 0) {
+      std::string value;
+      if (get_session_variable(_usr_dbc_conn->ref.get(), "max_allowed_packet", value))
+        batch_packet_size = (std::size_t)std::max(0LL, base::atoi<long long>(value, 0LL) - 1024);
+    }
+    std::list<std::string> batch;
+    std::vector<Sql_syntax_check::Statement_type> batch_types;
+
+    // Runs the collected batch. Returns false if script execution must stop.
+    auto run_batch = [&]() -> bool {
+      if (logging_queries)
+        _history->add_entry(batch);
+
+      std::string action = base::truncate_text(batch.front(), 256);
+      if (batch.size() > 1)
+        action.append(strfmt(_(" ... (%li statements)"), (long)batch.size()));
+      RowId log_message_index = add_log_message(DbSqlEditorLog::BusyMsg, _("Running..."), action, "?");
+
+      std::unique_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
+      sql::SqlBatchExec batch_exec;
+      batch_exec.max_packet_size(batch_packet_size);
+      batch_exec.error_cb([this](long long code, const std::string &message, const std::string &statement) {
+        add_log_message(DbSqlEditorLog::ErrorMsg, strfmt(_("Error Code: %lli. %s"), code, message.c_str()), statement,
+                        "");
+        return 0;
+      });
+
+      // Stop at every error, so a stop request is noticed and the remaining statements can be resumed right after the
+      // failed one.
+      batch_exec.stop_on_error(true);
+
+      Timer batch_exec_timer(false);
+      batch_exec_timer.run();
+      long executed = 0;
+      long error_count = 0;
+      long packet_count = 0;
+      bool use_executed = false;
+      bool stopped = false;
+      std::size_t offset = 0;
+      while (!batch.empty()) {
+        if (_usr_dbc_conn->is_stop_query_requested) {
+          stopped = true;
+          break;
+        }
+
+        long batch_errors = batch_exec(dbc_statement.get(), batch);
+        packet_count += batch_exec.packet_count();
+
+        // The failed statement (if any) is the last one in the log.
+        std::size_t handled = batch_exec.sql_log().size();
+        std::size_t succeeded = handled - (std::size_t)batch_errors;
+        std::list<std::string>::const_iterator iterator = batch_exec.sql_log().begin();
+        for (std::size_t i = 0; i < succeeded; ++i, ++iterator) {
+          switch (batch_types[offset + i]) {
+            case Sql_syntax_check::sql_use:
+              use_executed = true;
+              break;
+            case Sql_syntax_check::sql_set:
+              if (iterator->find("@sql_mode") != std::string::npos)
+                ran_set_sql_mode = true;
+              break;
+            case Sql_syntax_check::sql_drop:
+              update_live_schema_tree(*iterator);
+              break;
+            default:
+              break;
+          }
+        }
+        executed += (long)succeeded;
+        offset += handled;
+
+        if (batch_errors == 0)
+          break;
+        error_count += batch_errors;
+        if (!_continueOnError) {
+          stopped = true;
+          break;
+        }
+        batch.erase(batch.begin(), std::next(batch.begin(), (std::ptrdiff_t)handled));
+      }
+      batch_exec_timer.stop();
+
+      if (use_executed)
+        cache_active_schema_name();
+
+      std::string message = strfmt(_("%li statement(s) executed in %li multi-statement packet(s)"), executed,
+                                   packet_count);
+      if (error_count > 0)
+        message.append(strfmt(_(", %li error(s)"), error_count));
+      set_log_message(log_message_index, error_count > 0 ? DbSqlEditorLog::WarningMsg : DbSqlEditorLog::OKMsg,
+                      message, action, batch_exec_timer.duration_formatted());
+
+      batch.clear();
+      batch_types.clear();
+      return !stopped;
+    };
+
     bool results_left = false;
     for (auto &statement_range : statement_ranges) {
       logDebug3("Executing statement range: %lu, %lu...\n", statement_range.first, statement_range.second);
@@ -2035,6 +2353,14 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
         if (Sql_syntax_check::sql_empty == statement_type)
           continue;
 
+        if (batch_packet_size > 0 && sql::SqlBatchExec::is_batchable(statement)) {
+          batch.push_back(statement);
+          batch_types.push_back(statement_type);
+          continue;
+        }
+        if (!batch.empty() && !run_batch())
+          goto stop_processing_sql_script;
+
         std::string schema_name;
         std::string table_name;
 
@@ -2349,6 +2675,9 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
       }
     } // statement range loop
 
+    if (!batch.empty() && !run_batch())
+      goto stop_processing_sql_script;
+
     if (results_left) {
       exec_sql_task->execute_in_main_thread(
         std::bind(&mforms::Utilities::show_warning, _("Result set limit reached"),
@@ -2547,6 +2876,230 @@ db_query_ResultsetRef SqlEditorForm::exec_main_query(const std::string &sql, boo
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Runs the query on the user connection and writes its result directly into a file (CSV, tab separated or JSON lines),
+ * without creating a result grid. Rows are streamed from the server, so the result size is not limited by memory.
+ */
+size_t SqlEditorForm::exec_main_query_to_file(const std::string &sql, const std::string &format,
+                                              const std::string &path,
+                                              const Recordset_stream_exporter::Progress_cb &progress_cb) {
+  Recordset_stream_exporter::Format export_format;
+  if (!Recordset_stream_exporter::format_for_name(format, export_format))
+    throw std::invalid_argument(strfmt("Unsupported export format %s", format.c_str()));
+
+  base::RecMutexLock lock(ensure_valid_usr_connection());
+  if (!_usr_dbc_conn)
+    return 0;
+
+  RowId rid = add_log_message(DbSqlEditorLog::BusyMsg, _("Exporting "), sql, "- / ?");
+  const std::unique_ptr<sql::Statement> stmt(_usr_dbc_conn->ref->createStatement());
+  stmt->setResultSetType(sql::ResultSet::TYPE_FORWARD_ONLY);
+  Timer statement_exec_timer(false);
+  try {
+    std::unique_ptr<sql::ResultSet> results(stmt->executeQuery(sql));
+
+    Recordset_stream_exporter exporter(export_format, path);
+    exporter.progress_callback([this, progress_cb](size_t rows, double rows_per_second) {
+      if (_usr_dbc_conn->is_stop_query_requested)
+        return false;
+      return !progress_cb || progress_cb(rows, rows_per_second);
+    });
+    size_t rows = exporter.export_result_set(results.get());
+
+    set_log_message(rid, DbSqlEditorLog::OKMsg,
+                    strfmt(_("%s rows exported to %s (%.0f rows/s)"), std::to_string(rows).c_str(), path.c_str(),
+                           exporter.rows_per_second()),
+                    sql, statement_exec_timer.duration_formatted());
+    return rows;
+  } catch (sql::SQLException &e) {
+    set_log_message(rid, DbSqlEditorLog::ErrorMsg, strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what()), sql,
+                    "");
+    throw;
+  } catch (std::exception &e) {
+    set_log_message(rid, DbSqlEditorLog::ErrorMsg, e.what(), sql, "");
+    throw;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Executes a SQL script file on the user connection without loading it into an editor. The file is read and split
+ * in the background while statements are executed, with a bounded read-ahead, so the size of the script doesn't
+ * matter. There are no result tabs and no per statement history or log entries: a single log row shows progress
+ * and throughput, only failing statements are logged individually.
+ */
+void SqlEditorForm::exec_sql_script_file(const std::string &path, bool sync) {
+  if (!connected())
+    throw grt::db_not_connected("Not connected");
+
+  exec_sql_task->exec(sync, std::bind(&SqlEditorForm::do_exec_sql_script_file, this, weak_ptr_from(this), path));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The upper cased first word of a statement (also within a version comment as written by mysqldump), to recognize
+// statements which change the schema tree.
+static std::string statement_keyword(const std::string &statement) {
+  size_t i = 0;
+  if (statement.compare(0, 3, "/*!") == 0) {
+    i = 3;
+    while (i < statement.size() && (isdigit((unsigned char)statement[i]) || isspace((unsigned char)statement[i])))
+      ++i;
+  }
+
+  std::string keyword;
+  for (; i < statement.size() && keyword.size() < 16 && isalpha((unsigned char)statement[i]); ++i)
+    keyword.push_back((char)toupper((unsigned char)statement[i]));
+  return keyword;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+grt::StringRef SqlEditorForm::do_exec_sql_script_file(Ptr self_ptr, const std::string &path) {
+  logDebug("Background task for sql script file %s started\n", path.c_str());
+
+  std::shared_ptr<SqlEditorForm> self_ref = (self_ptr).lock();
+  if (!self_ref) {
+    logError("Couldn't aquire lock for SQL editor form\n");
+    return grt::StringRef("");
+  }
+
+  // add_log_message() will increment this variable on errors or warnings
+  _exec_sql_error_count = 0;
+
+  std::string context = strfmt(_("Run SQL script %s"), path.c_str());
+  sql::Driver *dbc_driver = nullptr;
+  try {
+    RecMutexLock use_dbc_conn_mutex(ensure_valid_usr_connection());
+
+    dbc_driver = _usr_dbc_conn->ref->getDriver();
+    dbc_driver->threadInit();
+
+    bool is_running_query = true;
+    AutoSwap<bool> is_running_query_keeper(_is_running_query, is_running_query);
+    update_menu_and_toolbar();
+
+    _has_pending_log_messages = false;
+    base::ScopeExitTrigger schedule_log_messages_refresh(std::bind(&SqlEditorForm::refresh_log_messages, this, true));
+
+    {
+      std::list<std::string> history_entry;
+      history_entry.push_back(strfmt("-- Run SQL script file %s", path.c_str()));
+      _history->add_entry(history_entry);
+    }
+
+    bec::GRTManager::get()->replace_status_text(strfmt(_("Running script %s..."), path.c_str()));
+    RowId log_message_index = add_log_message(DbSqlEditorLog::BusyMsg, _("Running..."), context, "");
+
+    Sql_script_file_reader reader(path);
+    reader.start();
+
+    double update_interval =
+      bec::GRTManager::get()->get_app_option_int("DbSqlEditor:ProgressStatusUpdateInterval", 500) / 1000.;
+    double total_mb = reader.file_size() / (1024.0 * 1024.0);
+    Timer script_timer(true);
+    double last_update = 0;
+    std::uint64_t executed_bytes = 0;
+    size_t statement_count = 0;
+    size_t error_count = 0;
+    bool ran_ddl = false;
+    bool interrupted = false;
+
+    auto progress_message = [&]() {
+      double mb = executed_bytes / (1024.0 * 1024.0);
+      double seconds = script_timer.duration();
+      std::string message = strfmt(_("%s statement(s), %.1f of %.1f MB (%i%%), %.1f MB/s"),
+                                   std::to_string(statement_count).c_str(), mb, total_mb,
+                                   total_mb > 0 ? (int)(mb * 100 / total_mb) : 100, seconds > 0 ? mb / seconds : 0.0);
+      if (error_count > 0)
+        message.append(strfmt(_(", %s error(s)"), std::to_string(error_count).c_str()));
+      return message;
+    };
+
+    std::unique_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
+    Sql_script_file_reader::Statement statement;
+    while (reader.next(statement)) {
+      if (_usr_dbc_conn->is_stop_query_requested) {
+        interrupted = true;
+        break;
+      }
+
+      try {
+        bool more_results = dbc_statement->execute(statement.sql);
+        do {
+          if (more_results) {
+            std::unique_ptr<sql::ResultSet> discarded(dbc_statement->getResultSet());
+          }
+        } while ((more_results = dbc_statement->getMoreResults()));
+      } catch (sql::SQLException &e) {
+        ++error_count;
+        add_log_message(DbSqlEditorLog::ErrorMsg,
+                        strfmt(_("Error Code: %i. %s\nLine %s of the script"), e.getErrorCode(), e.what(),
+                               std::to_string(statement.line + 1).c_str()),
+                        base::truncate_text(statement.sql, 1024), "");
+        if (!_continueOnError) {
+          interrupted = true;
+          break;
+        }
+      }
+
+      ++statement_count;
+      executed_bytes = statement.end_offset;
+
+      if (!ran_ddl) {
+        std::string keyword = statement_keyword(statement.sql);
+        ran_ddl = keyword == "CREATE" || keyword == "DROP" || keyword == "ALTER" || keyword == "RENAME";
+      }
+
+      if (script_timer.duration() - last_update >= update_interval) {
+        last_update = script_timer.duration();
+        set_log_message(log_message_index, DbSqlEditorLog::BusyMsg, progress_message(), context,
+                        script_timer.duration_formatted());
+      }
+    }
+    reader.cancel();
+    if (!interrupted)
+      executed_bytes = reader.file_size();
+    script_timer.stop();
+
+    std::string message = progress_message();
+    if (interrupted) {
+      set_log_message(log_message_index, DbSqlEditorLog::ErrorMsg, _("Script execution stopped after ") + message,
+                      context, script_timer.duration_formatted());
+      bec::GRTManager::get()->replace_status_text(_("Query interrupted"));
+    } else {
+      set_log_message(log_message_index, error_count > 0 ? DbSqlEditorLog::WarningMsg : DbSqlEditorLog::OKMsg,
+                      message, context, script_timer.duration_formatted());
+      bec::GRTManager::get()->replace_status_text(_("Query Completed"));
+    }
+    logInfo("Script %s: %s\n", path.c_str(), message.c_str());
+
+    // Side effects of the script (USE, SET sql_mode, DDL) are applied once at the end instead of per statement.
+    cache_active_schema_name();
+    cache_sql_mode();
+    if (ran_ddl && _live_tree) {
+      wb::LiveSchemaTree::Delegate *tree_delegate = _live_tree.get();
+      bec::GRTManager::get()->run_once_when_idle(this, std::bind(&wb::LiveSchemaTree::Delegate::tree_refresh,
+                                                                 tree_delegate));
+    }
+  }
+  CATCH_ANY_EXCEPTION_AND_DISPATCH(context)
+
+  if (dbc_driver)
+    dbc_driver->threadEnd();
+
+  logDebug("SQL script file execution finished\n");
+
+  update_menu_and_toolbar();
+
+  _usr_dbc_conn->is_stop_query_requested = false;
+
+  return grt::StringRef("");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 bool SqlEditorForm::is_running_query() {
   return _is_running_query;
 }
@@ -2888,9 +3441,12 @@ void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, b
                                                base::StringListPtr functions) {
   std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
   std::unique_ptr<sql::Statement> statement;
-  RecMutexLock usr_dbc_conn_mutex(ensure_valid_usr_connection());
-  if (_usr_dbc_conn->ref.get() != nullptr)
-    statement.reset(_usr_dbc_conn->ref->createStatement());
+
+  // Uses an aux connection, so a long running user query doesn't hold up the symbol refresh.
+  sql::Dbc_connection_handler::Ref conn;
+  RecMutexLock aux_dbc_conn_mutex(ensure_valid_aux_connection(conn));
+  if (conn->ref.get() != nullptr)
+    statement.reset(conn->ref->createStatement());
 
   auto schemaSymbols = _databaseSymbols.getSymbolsOfType<SchemaSymbol>();
   bool hasPerformanceSchema = std::find_if(schemaSymbols.begin(), schemaSymbols.end(), [](auto symbol) -> bool {
@@ -2937,7 +3493,7 @@ void SqlEditorForm::schema_meta_data_refreshed(const std::string &schema_name, b
       }
 
       if (statement != nullptr) {
-        auto metaInfo = _usr_dbc_conn->ref->getMetaData();
+        auto metaInfo = conn->ref->getMetaData();
         if (hasPerformanceSchema && (metaInfo->getDatabaseMajorVersion() > 7
             || (metaInfo->getDatabaseMajorVersion() == 5 && metaInfo->getDatabaseMinorVersion() > 6))) {
           std::unique_ptr<sql::ResultSet> rs(
@@ -2961,6 +3517,7 @@ void SqlEditorForm::cache_active_schema_name() {
   std::string schema = _usr_dbc_conn->ref->getSchema();
   _usr_dbc_conn->active_schema = schema;
   _aux_dbc_conn->active_schema = schema;
+  _pimplMutex->setAuxActiveSchema(schema);
 
   exec_sql_task->execute_in_main_thread(std::bind(&SqlEditorForm::update_editor_title_schema, this, schema), false,
                                         true);
@@ -2978,6 +3535,7 @@ void SqlEditorForm::active_schema(const std::string &value) {
       if (!value.empty())
         _aux_dbc_conn->ref->setSchema(value);
       _aux_dbc_conn->active_schema = value;
+      _pimplMutex->setAuxActiveSchema(value);
     }
 
     {
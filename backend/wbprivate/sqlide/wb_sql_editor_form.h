@@ -34,6 +34,7 @@
 #include "grtpp_notifications.h"
 
 #include "sqlide/recordset_be.h"
+#include "sqlide/recordset_stream_export.h"
 #include "sqlide/sql_editor_be.h"
 #include "sqlide/db_sql_editor_log.h"
 #include "sqlide/db_sql_editor_history_be.h"
@@ -309,6 +310,7 @@ private:
   void init_connection(sql::Connection *dbc_conn_ref, const db_mgmt_ConnectionRef &connectionProperties,
                        sql::Dbc_connection_handler::Ref &dbc_conn, bool user_connection);
   void close_connection(sql::Dbc_connection_handler::Ref &dbc_conn);
+  void close_aux_connection_pool();
   base::RecMutexLock ensure_valid_dbc_connection(sql::Dbc_connection_handler::Ref &dbc_conn,
                                                  base::RecMutex &dbc_conn_mutex, bool throw_on_block = false,
                                                  bool lockOnly = false);
@@ -318,7 +320,19 @@ private:
   std::vector<std::pair<std::string, std::string>> runQueryForCache(const std::string &query);
 
 public:
+  // Usage figures of the aux connection pool, see ensure_valid_aux_connection().
+  struct AuxConnectionPoolStats {
+    size_t size = 0;            // Configured number of aux connections, including the main one.
+    size_t open = 0;            // Aux connections currently open.
+    size_t peak_in_use = 0;     // Most aux connections in use at the same time.
+    size_t acquisitions = 0;    // Number of times an aux connection was handed out.
+    size_t waits = 0;           // Hand outs which had to wait because all connections were busy.
+    double total_wait_time = 0; // In seconds.
+    double max_wait_time = 0;   // In seconds.
+  };
+
   base::RecMutexLock ensure_valid_aux_connection(sql::Dbc_connection_handler::Ref &conn, bool lockOnly = false);
+  AuxConnectionPoolStats aux_connection_pool_stats();
   parsers::MySQLParserContext::Ref work_parser_context() {
     return _work_parser_context;
   };
@@ -354,6 +368,9 @@ public:
 
   void exec_main_sql(const std::string &sql, bool log);
   db_query_ResultsetRef exec_main_query(const std::string &sql, bool log);
+  size_t exec_main_query_to_file(const std::string &sql, const std::string &format, const std::string &path,
+                                 const Recordset_stream_exporter::Progress_cb &progress_cb);
+  void exec_sql_script_file(const std::string &path, bool sync = false);
 
   void explain_current_statement();
   bool is_running_query();
@@ -368,6 +385,7 @@ private:
 
   grt::StringRef do_exec_sql(Ptr self_ptr, std::shared_ptr<std::string> sql, SqlEditorPanel *editor, ExecFlags flags,
                              RecordsetsRef result_list);
+  grt::StringRef do_exec_sql_script_file(Ptr self_ptr, const std::string &path);
 
   void handle_command_side_effects(const std::string &sql);
 
@@ -508,7 +508,7 @@ SqlEditorPanel::LoadResult SqlEditorPanel::load_from(const std::string &file, co
     return Cancelled;
   } else if (result == FileCharsetDialog::RunInstead) {
     g_free(data);
-    return RunInstead;
+    return RunWithEncodingInstead;
   }
 
   // if original data was in utf8, utf8_data comes back NULL
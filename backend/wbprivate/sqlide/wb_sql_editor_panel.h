@@ -165,7 +165,9 @@ public:
     static AutoSaveInfo old_autosave(const std::string &autosave_file);
   };
 
-  enum LoadResult { Cancelled, Loaded, RunInstead };
+  // RunInstead: the file is too large to edit and should be executed directly. RunWithEncodingInstead: the file is
+  // not UTF-8 and should be executed with a conversion from its encoding.
+  enum LoadResult { Cancelled, Loaded, RunInstead, RunWithEncodingInstead };
 
   LoadResult load_from(const std::string &file, const std::string &encoding = "", bool keep_dirty = false);
   bool load_autosave(const AutoSaveInfo &info, const std::string &text_file);
@@ -28,6 +28,7 @@
 #include "result_form_view.h"
 #include "objimpl/db.query/db_query_Resultset.h"
 #include "sqlide/recordset_cdbc_storage.h"
+#include "sqlide/recordset_sql_storage.h"
 #include "grtdb/db_helpers.h"
 #include "grtui/inserts_export_form.h"
 #include "objimpl/wrapper/mforms_ObjectReference_impl.h"
@@ -508,11 +509,59 @@ void SqlEditorResult::show_export_recordset() {
       exporter.set_title(_("Export Resultset"));
       if (!path.empty())
         exporter.set_path(path);
+
+      // A result cut off by the row limit can be exported in full by streaming the query result from the server.
+      bool streamed = false;
+      Recordset_sql_storage *storage = dynamic_cast<Recordset_sql_storage *>(rs->data_storage().get());
+      if (storage != nullptr && !storage->sql_query().empty() && rs->limit_rows_applicable()) {
+        std::string query = storage->sql_query();
+        exporter.stream_export_callback([this, query, &streamed](const std::string &format, const std::string &path) {
+          if (mforms::Utilities::show_message(_("Export Resultset"),
+                                              _("The result set only contains the rows fetched with the current row "
+                                                "limit. Do you want to run the query again and export all rows "
+                                                "directly from the server?"),
+                                              _("Export All Rows"), _("Export Fetched Rows")) != mforms::ResultOk)
+            return false;
+
+          streamed = true;
+          SqlEditorForm::Ref form = _owner->owner()->shared_from_this();
+          bec::GRTManager::get()->replace_status_text(strfmt(_("Exporting resultset to %s..."), path.c_str()));
+          // Streaming can take long, so it runs on the background workers. Exports on the same editor are
+          // serialized, as they share its user connection.
+          bec::GRTManager::get()->get_background_dispatcher()->execute_async_function(
+            "export resultset", [form, query, format, path]() -> grt::ValueRef {
+              try {
+                size_t rows = form->exec_main_query_to_file(query, format, path, [](size_t rows, double) {
+                  bec::GRTManager::get()->run_once_when_idle([rows]() {
+                    bec::GRTManager::get()->replace_status_text(
+                      strfmt(_("Exporting resultset, %s rows written..."), std::to_string(rows).c_str()));
+                  });
+                  return true;
+                });
+                bec::GRTManager::get()->run_once_when_idle([rows, path]() {
+                  bec::GRTManager::get()->replace_status_text(
+                    strfmt(_("Exported %s rows to %s"), std::to_string(rows).c_str(), path.c_str()));
+                });
+              } catch (const std::exception &exc) {
+                std::string error = exc.what();
+                bec::GRTManager::get()->run_once_when_idle([error]() {
+                  bec::GRTManager::get()->replace_status_text(_("Export resultset failed"));
+                  mforms::Utilities::show_error(_("Error exporting recordset"), error, _("OK"));
+                });
+              }
+              return grt::ValueRef();
+            },
+            bec::GRTTaskBase::PriorityNormal, strfmt("usr-connection:%p", form.get()));
+          return true;
+        });
+      }
+
       path = exporter.run();
       if (path.empty())
         bec::GRTManager::get()->replace_status_text(_("Export resultset canceled"));
       else {
-        bec::GRTManager::get()->replace_status_text(strfmt(_("Exported resultset to %s"), path.c_str()));
+        if (!streamed)
+          bec::GRTManager::get()->replace_status_text(strfmt(_("Exported resultset to %s"), path.c_str()));
         bec::GRTManager::get()->set_app_option("Recordset:LastExportPath", grt::StringRef(path));
         extension = base::extension(path);
         if (!extension.empty() && extension[0] == '.')
@@ -576,10 +625,15 @@ void SqlEditorResult::onRecordsetColumnsResized(const std::vector<int> cols) {
     }
   }
   if (!widths.empty()) {
-    bec::GRTManager::get()->get_dispatcher()->execute_async_function("store column widths", [this, widths]() {
-      _owner->owner()->column_width_cache()->save_columns_width(widths);
-      return grt::ValueRef();
-    });
+    // Writes to the same cache file are kept in order, writes for other connections can run alongside.
+    SqlEditorForm::Ref form = _owner->owner()->shared_from_this();
+    bec::GRTManager::get()->get_background_dispatcher()->execute_async_function(
+      "store column widths",
+      [form, widths]() {
+        form->column_width_cache()->save_columns_width(widths);
+        return grt::ValueRef();
+      },
+      bec::GRTTaskBase::PriorityLow, "column-widths:" + form->column_width_cache()->connection_id());
   }
 }
 
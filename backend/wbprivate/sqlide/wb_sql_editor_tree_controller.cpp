@@ -122,6 +122,7 @@ std::shared_ptr<SqlEditorTreeController> SqlEditorTreeController::create(SqlEdit
   instance->_filtered_schema_tree.set_delegate(instance);
   instance->_filtered_schema_tree.set_fetch_delegate(instance);
   instance->_filtered_schema_tree.set_base(&instance->_base_schema_tree);
+  instance->_filtered_schema_tree.set_object_index(&instance->_object_index);
 
   return instance;
 }
@@ -373,6 +374,40 @@ void SqlEditorTreeController::sidebar_splitter_changed() {
 bool SqlEditorTreeController::fetch_data_for_filter(
   const std::string &schema_filter, const std::string &object_filter,
   const wb::LiveSchemaTree::NewSchemaContentArrivedSlot &arrived_slot) {
+  // Answer the search from the object names loaded so far. The server is only asked for the schemas matching
+  // the filter whose contents have not been fetched yet.
+  std::vector<wb::ObjectSearchIndex::SchemaMatches> matches;
+  std::vector<std::string> unindexed;
+  std::vector<std::string> remote_schema_filters;
+  if (_object_index.search(ObjectSearchIndex::like_to_wildcard(schema_filter),
+                           ObjectSearchIndex::like_to_wildcard(object_filter), matches, unindexed)) {
+    logDebug3("Filter %s.%s: %d schemas answered from the local object index, %d left for the server\n",
+              schema_filter.c_str(), object_filter.c_str(), (int)matches.size(), (int)unindexed.size());
+
+    if (arrived_slot) {
+      for (auto &match : matches)
+        bec::GRTManager::get()->run_once_when_idle(
+          this, std::bind(arrived_slot, match.schema, match.tables, match.views, match.procedures, match.functions,
+                          true));
+    }
+
+    if (unindexed.empty())
+      return true;
+
+    if (!matches.empty()) {
+      for (auto schema : unindexed) {
+        base::replaceStringInplace(schema, "\\", "\\\\");
+        base::replaceStringInplace(schema, "%", "\\%");
+        base::replaceStringInplace(schema, "_", "\\_");
+        remote_schema_filters.push_back(schema);
+      }
+    }
+  }
+
+  // When nothing was delivered locally a single search with the original filter can't duplicate any result.
+  if (remote_schema_filters.empty())
+    remote_schema_filters.push_back(schema_filter);
+
   std::string wb_internal_schema = bec::GRTManager::get()->get_app_option_string("workbench:InternalSchema");
 
   sql::Dbc_connection_handler::Ref conn;
@@ -418,7 +453,8 @@ bool SqlEditorTreeController::fetch_data_for_filter(
     logDebug3("Fetch data for filter %s.%s\n", schema_filter.c_str(), object_filter.c_str());
 
     live_schema_fetch_task->exec(sync, std::bind(&SqlEditorTreeController::do_fetch_data_for_filter, this,
-                                                 weak_ptr_from(this), schema_filter, object_filter, arrived_slot));
+                                                 weak_ptr_from(this), remote_schema_filters, object_filter,
+                                                 arrived_slot));
   }
 
   return true;
@@ -476,6 +512,7 @@ void SqlEditorTreeController::refresh_live_object_in_overview(wb::LiveSchemaTree
     // update schema tree even if no object was added/dropped, to clear details attribute which contents might to be
     // changed
     _schema_tree->update_live_object_state(type, schema_name, old_obj_name, new_obj_name);
+    _object_index.update_object(type, schema_name, old_obj_name, new_obj_name);
   }
   CATCH_ANY_EXCEPTION_AND_DISPATCH_TO_DEFAULT_LOG(_("Refresh live schema object"))
 }
@@ -540,6 +577,14 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
         }
     }
 
+    // Sorting here keeps that work off the main thread, the tree then only verifies the order.
+    bool case_sensitive = _base_schema_tree.case_sensitive_identifiers();
+    LiveSchemaTree::sort_object_names(tables, case_sensitive);
+    LiveSchemaTree::sort_object_names(views, case_sensitive);
+    LiveSchemaTree::sort_object_names(procedures, case_sensitive);
+    LiveSchemaTree::sort_object_names(functions, case_sensitive);
+    _object_index.set_schema_contents(schema_name, tables, views, procedures, functions);
+
     if (arrived_slot) {
       std::function<void()> schema_contents_arrived =
         std::bind(arrived_slot, schema_name, tables, views, procedures, functions, false);
@@ -568,77 +613,80 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
 //----------------------------------------------------------------------------------------------------------------------
 
 grt::StringRef SqlEditorTreeController::do_fetch_data_for_filter(
-  std::weak_ptr<SqlEditorTreeController> self_ptr, const std::string &schema_filter, const std::string &object_filter,
-  wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot) {
+  std::weak_ptr<SqlEditorTreeController> self_ptr, const std::vector<std::string> &schema_filters,
+  const std::string &object_filter, wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot) {
   RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR(SqlEditorTreeController, self_ptr, self, grt::StringRef(""))
 
-  logDebug3("Searching data for %s.%s\n", schema_filter.c_str(), object_filter.c_str());
-
-  std::shared_ptr<sql::ResultSet> dbc_resultset;
-  std::map<std::string, int> schema_directory;
-  std::string last_schema;
-
   std::string wb_internal_schema = bec::GRTManager::get()->get_app_option_string("workbench:InternalSchema");
 
   try {
-    // Creates the template for the sqlstring
-    std::string procedure(base::sqlstring("CALL !.SEARCH_OBJECTS(?,?,0)", 0) << wb_internal_schema << schema_filter
-                                                                             << object_filter);
-
-    // Gets the data
-    std::string error = _owner->fetch_data_from_stored_procedure(procedure, dbc_resultset);
-
-    if (dbc_resultset && !error.length()) {
-      StringListPtr tables(new std::list<std::string>());
-      StringListPtr views(new std::list<std::string>());
-      StringListPtr procedures(new std::list<std::string>());
-      StringListPtr functions(new std::list<std::string>());
-
-      // Creates the needed schema/objects
-      while (dbc_resultset->next()) {
-        std::string schema = dbc_resultset->getString(1);
-        std::string object = dbc_resultset->getString(2);
-        std::string type = dbc_resultset->getString(3);
-
-        // A schema change occurred, need to create the structure for the data loaded so far
-        if (schema != last_schema && last_schema != "") {
-          if (arrived_slot)
-            bec::GRTManager::get()->run_once_when_idle(
-              this, std::bind(arrived_slot, last_schema, tables, views, procedures, functions, true));
-
-          tables->clear();
-          views->clear();
-          procedures->clear();
-          functions->clear();
-        }
+    for (auto &schema_filter : schema_filters) {
+      logDebug3("Searching data for %s.%s\n", schema_filter.c_str(), object_filter.c_str());
+
+      std::shared_ptr<sql::ResultSet> dbc_resultset;
+      std::string last_schema;
+
+      // Creates the template for the sqlstring
+      std::string procedure(base::sqlstring("CALL !.SEARCH_OBJECTS(?,?,0)", 0) << wb_internal_schema << schema_filter
+                                                                               << object_filter);
+
+      // Gets the data
+      std::string error = _owner->fetch_data_from_stored_procedure(procedure, dbc_resultset);
+
+      if (dbc_resultset && !error.length()) {
+        StringListPtr tables(new std::list<std::string>());
+        StringListPtr views(new std::list<std::string>());
+        StringListPtr procedures(new std::list<std::string>());
+        StringListPtr functions(new std::list<std::string>());
+
+        // Creates the needed schema/objects
+        while (dbc_resultset->next()) {
+          std::string schema = dbc_resultset->getString(1);
+          std::string object = dbc_resultset->getString(2);
+          std::string type = dbc_resultset->getString(3);
+
+          // A schema change occurred, need to create the structure for the data loaded so far.
+          // The lists are handed over to the idle callback, so new ones are needed for the next schema.
+          if (schema != last_schema && last_schema != "") {
+            if (arrived_slot)
+              bec::GRTManager::get()->run_once_when_idle(
+                this, std::bind(arrived_slot, last_schema, tables, views, procedures, functions, true));
+
+            tables.reset(new std::list<std::string>());
+            views.reset(new std::list<std::string>());
+            procedures.reset(new std::list<std::string>());
+            functions.reset(new std::list<std::string>());
+          }
 
-        last_schema = schema;
+          last_schema = schema;
 
-        if (type == "T")
-          tables->push_back(object);
-        else if (type == "V")
-          views->push_back(object);
-        else if (type == "P")
-          procedures->push_back(object);
-        else
-          functions->push_back(object);
-      }
+          if (type == "T")
+            tables->push_back(object);
+          else if (type == "V")
+            views->push_back(object);
+          else if (type == "P")
+            procedures->push_back(object);
+          else
+            functions->push_back(object);
+        }
 
-      if (last_schema != "" && arrived_slot)
-        bec::GRTManager::get()->run_once_when_idle(
-          this, std::bind(arrived_slot, last_schema, tables, views, procedures, functions, true));
-    } else {
-      std::string userName = _owner->connection_descriptor()->parameterValues().get_string("userName");
+        if (last_schema != "" && arrived_slot)
+          bec::GRTManager::get()->run_once_when_idle(
+            this, std::bind(arrived_slot, last_schema, tables, views, procedures, functions, true));
+      } else {
+        std::string userName = _owner->connection_descriptor()->parameterValues().get_string("userName");
 
-      std::string msgFmt =
-        _("The user %s has no privileges on %s to create temporal tables or execute required stored procedures "
-          "used in remote search in this server.\n"
-          "Ensure your database administrator grants you full access to the schema %s and retry.\n\n%s.");
+        std::string msgFmt =
+          _("The user %s has no privileges on %s to create temporal tables or execute required stored procedures "
+            "used in remote search in this server.\n"
+            "Ensure your database administrator grants you full access to the schema %s and retry.\n\n%s.");
 
-      std::string message = base::strfmt(msgFmt.c_str(), userName.c_str(), wb_internal_schema.c_str(),
-                                         wb_internal_schema.c_str(), error.c_str());
+        std::string message = base::strfmt(msgFmt.c_str(), userName.c_str(), wb_internal_schema.c_str(),
+                                           wb_internal_schema.c_str(), error.c_str());
 
-      mforms::Utilities::show_error(_("Search Objects in Server"), message, _("Ok"));
+        mforms::Utilities::show_error(_("Search Objects in Server"), message, _("Ok"));
+        break;
+      }
     }
   }
 
@@ -2418,8 +2466,10 @@ grt::StringRef SqlEditorTreeController::do_refresh_schema_tree_safe(SqlEditorFor
 
   std::vector<std::string> schemaList = fetch_schema_list();
   _owner->schemaListRefreshed(schemaList);
+  _object_index.set_schemas(schemaList);
 
   schema_list->assign(schemaList.begin(), schemaList.end());
+  LiveSchemaTree::sort_object_names(schema_list, _base_schema_tree.case_sensitive_identifiers());
   bec::GRTManager::get()->run_once_when_idle(this,
                                              std::bind(&LiveSchemaTree::update_schemata, _schema_tree, schema_list));
   bec::GRTManager::get()->run_once_when_idle(this, std::bind(&SqlEditorForm::schema_tree_did_populate, _owner));
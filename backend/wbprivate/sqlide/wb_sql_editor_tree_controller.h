@@ -23,6 +23,7 @@
 
 #include "workbench/wb_backend_public_interface.h"
 #include "sqlide/wb_live_schema_tree.h"
+#include "sqlide/wb_object_search_index.h"
 #include "sqlide/db_sql_editor_log.h" // for RowId
 #include "grt/grt_threaded_task.h"
 
@@ -85,6 +86,7 @@ private:
   wb::LiveSchemaTree *_schema_tree;
   wb::LiveSchemaTree _base_schema_tree;
   wb::LiveSchemaTree _filtered_schema_tree;
+  wb::ObjectSearchIndex _object_index;
   base::Mutex _schema_contents_mutex;
   GrtThreadedTask::Ref live_schema_fetch_task;
   GrtThreadedTask::Ref live_schemata_refresh_task;
@@ -146,7 +148,8 @@ private:
                               const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &updater_slot);
 
   grt::StringRef do_fetch_data_for_filter(std::weak_ptr<SqlEditorTreeController> self_ptr,
-                                          const std::string &schema_filter, const std::string &object_filter,
+                                          const std::vector<std::string> &schema_filters,
+                                          const std::string &object_filter,
                                           wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot);
 
   void schema_row_selected();
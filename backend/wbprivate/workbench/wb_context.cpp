@@ -66,6 +66,7 @@
 
 #include "base/threaded_timer.h"
 #include "base/log.h"
+#include "base/profiling.h"
 #include "base/drawing.h"
 
 #include "mforms/mforms.h"
@@ -100,6 +101,8 @@ DEFAULT_LOG_DOMAIN(DOMAIN_WB_CONTEXT)
 #define UI_REQUEST_THROTTLE 0.3
 
 #define DEFAULT_UNDO_STACK_SIZE 10
+// memory budget of the model undo history in MB, 0 for no limit
+#define DEFAULT_UNDO_MEMORY_LIMIT 256
 
 // auto-save every 1 minute (default)
 #define AUTO_SAVE_MODEL_INTERVAL (60)
@@ -599,6 +602,10 @@ void WBContext::finalize() {
   bec::GRTManager::get()->set_status_slot(std::function<void(std::string)>{});
   _plugin_manager->set_gui_plugin_callbacks(PluginManagerImpl::OpenGUIPluginSlot{},
     PluginManagerImpl::ShowGUIPluginSlot{}, PluginManagerImpl::CloseGUIPluginSlot{});
+
+  const char *trace_file = getenv("WB_TRACE");
+  if (trace_file != nullptr && *trace_file != '\0' && base::Tracer::enabled())
+    base::Tracer::write_chrome_trace(trace_file);
 }
 
 void WBContext::block_user_interaction(bool flag) {
@@ -735,6 +742,13 @@ bool WBContext::init_(WBFrontendCallbacks *callbacks, WBOptions *options) {
   logInfo("WbContext::init\n");
   grt::ValueRef res;
 
+  // WB_TRACE=<file> records trace spans from here on and writes them to <file> when the application closes.
+  const char *trace_file = getenv("WB_TRACE");
+  if (trace_file != nullptr && *trace_file != '\0') {
+    base::Tracer::set_thread_name("Main");
+    base::Tracer::enable(true);
+  }
+
   _force_opengl_rendering = options->force_opengl_rendering;
   _force_sw_rendering = options->force_sw_rendering;
 
@@ -1389,6 +1403,7 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "workbench:ForceSWRendering", 0);
   set_default(options, "workbench:OSSHideMissing", 0);
   set_default(options, "workbench:UndoEntries", DEFAULT_UNDO_STACK_SIZE);
+  set_default(options, "workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
   set_default(options, "workbench:AutoSaveModelInterval", AUTO_SAVE_MODEL_INTERVAL);
   set_default(options, "workbench:AutoSaveSQLEditorInterval", AUTO_SAVE_SQLEDITOR_INTERVAL);
   set_default(options, "workbench.AutoReopenLastModel", 0);
@@ -1426,8 +1441,10 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "DbSqlEditor:KeepAliveInterval", 600);            // in seconds
   set_default(options, "DbSqlEditor:ReadTimeOut", 30);                  // in seconds
   set_default(options, "DbSqlEditor:ConnectionTimeOut", 60);             // in seconds
+  set_default(options, "DbSqlEditor:AuxConnectionPoolSize", 3); // connections for sidebar/completion queries
   set_default(options, "DbSqlEditor:MaxQuerySizeToHistory", 65536);
   set_default(options, "DbSqlEditor:ContinueOnError", 0); // continue running sql script bypassing failed statements
+  set_default(options, "DbSqlEditor:BatchStatementExecution", 0); // group result-less statements into packets
   set_default(options, "DbSqlEditor:AutocommitMode", 1);  // when enabled, each statement will be committed immediately
   set_default(options, "DbSqlEditor:IsDataChangesCommitWizardEnabled", 1);
   set_default(options, "DbSqlEditor:ShowSchemaTreeSchemaContents", 1);
@@ -1450,6 +1467,9 @@ void WBContext::set_default_options(grt::DictRef options) {
   // Recordset
   set_default(options, "Recordset:FloatingPointVisibleScale", 3);
   set_default(options, "Recordset:FieldValueTruncationThreshold", 256);
+  set_default(options, "Recordset:SearchIndexMinRows", 50000);
+  set_default(options, "Recordset:SearchIndexMaxMemory", 256); // in MB, 0 disables the search index
+  set_default(options, "Recordset:SortMemoryBudget", 256);    // in MB, 0 always sorts in SQLite
   set_default(options, "SqlEditor:LimitRows", 1);
   set_default(options, "SqlEditor:LimitRowsCount", 1000);
   set_default(options, "SqlEditor:PreserveRowFilter", 1);
@@ -1947,6 +1967,9 @@ void WBContext::option_dict_changed(grt::internal::OwnedDict *options, bool, con
       undo_size = 1;
 
     grt::GRT::get()->get_undo_manager()->set_undo_limit(undo_size);
+
+    ssize_t undo_memory = get_wb_options().get_int("workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
+    grt::GRT::get()->get_undo_manager()->set_memory_limit(undo_memory > 0 ? (size_t)undo_memory * 1024 * 1024 : 0);
   }
 }
 
@@ -33,12 +33,15 @@
 #include <errno.h>
 
 #include "grt.h"
+#include "grtpp_undo_manager.h"
 
 #include "base/log.h"
 #include "base/string_utilities.h"
 #include "base/file_utilities.h"
 #include "base/file_functions.h"
 #include "base/util_functions.h"
+#include "base/profiling.h"
+#include "base/xml_functions.h"
 
 #include "mforms/utilities.h"
 #include "mdc_image.h"
@@ -78,6 +81,15 @@
  * automatically deleted when it is closed normally.
  * When a document is opened, it will check if there already is a document folder for that file
  * and if so, the recovery function will kick in, using the autosave XML file.
+ *
+ * Serializing the whole document on every auto-save causes noticeable pauses for large models,
+ * so only the first auto-save (and an occasional compaction) writes the full autosave XML. In between,
+ * the object members that changed since the previous auto-save are appended to
+ * document-autosave.journal, one <batch> per auto-save. Items inserted into or removed from a list are
+ * journaled on their own, instead of the whole list. Changes are collected from the actions reported
+ * by the undo manager. Changes made while undo tracking was off are not reported, so when the GRT
+ * counted any of them (or nothing could be journaled at all) the next auto-save writes a full snapshot.
+ * On recovery the batches are applied to the autosave XML before it is loaded.
  */
 
 DEFAULT_LOG_DOMAIN("model")
@@ -174,8 +186,17 @@ std::string ModelFile::create_document_dir(const std::string &dir, const std::st
   return path;
 }
 
-ModelFile::ModelFile(const std::string &tmpdir) : _temp_dir_lock(0), _dirty(false) {
+ModelFile::ModelFile(const std::string &tmpdir)
+  : _temp_dir_lock(0),
+    _dirty(false),
+    _journal_needs_snapshot(false),
+    _journal_untracked_changes(0),
+    _journal_size(0),
+    _snapshot_size(0) {
   _temp_dir = tmpdir;
+
+  scoped_connect(grt::GRT::get()->get_undo_manager()->signal_action_added(),
+                 std::bind(&ModelFile::record_journal_change, this, std::placeholders::_1));
 }
 
 ModelFile::~ModelFile() {
@@ -187,6 +208,7 @@ void ModelFile::copy_file_to(const std::string &file, const std::string &dest) {
 }
 
 void ModelFile::open(const std::string &path) {
+  BASE_TRACE("model", "open");
   bool file_is_zip;
   bool file_is_autosave = false;
 
@@ -306,6 +328,17 @@ void ModelFile::open(const std::string &path) {
             recover = false;
           }
         }
+
+        std::string journal_path = auto_save_dir + "/" + MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME;
+        if (recover && g_file_test(journal_path.c_str(), G_FILE_TEST_EXISTS)) {
+          try {
+            apply_autosave_journal(auto_save_dir + "/" + MAIN_DOCUMENT_NAME, journal_path);
+          } catch (const std::exception &exc) {
+            logError("Could not apply the autosave journal, recovering from the last full autosave: %s\n",
+                     exc.what());
+          }
+          g_remove(journal_path.c_str());
+        }
       }
     } else // Cancel recovery
     {
@@ -314,6 +347,8 @@ void ModelFile::open(const std::string &path) {
     }
   }
 
+  reset_autosave_journal();
+
   if (!recover) {
     _content_dir = create_document_dir(_temp_dir, basename);
 
@@ -377,6 +412,7 @@ void ModelFile::create() {
 
   _content_dir = create_document_dir(_temp_dir, "newmodel.mwb");
   add_db_file(_content_dir);
+  reset_autosave_journal();
 
   _dirty = false;
 }
@@ -671,6 +707,7 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
 }
 
 workbench_DocumentRef ModelFile::unserialize_document(xmlDocPtr xmldoc, const std::string &path) {
+  BASE_TRACE("model", "load");
   std::string doctype, version;
 
   grt::GRT::get()->get_xml_metainfo(xmldoc, doctype, version);
@@ -783,7 +820,9 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
 
   // saving the file for real can delete the autosave
   g_remove(get_path_for("document-autosave.mwb.xml").c_str());
+  g_remove(get_path_for(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME).c_str());
   g_remove(get_path_for("real_path").c_str());
+  reset_autosave_journal();
 
   if (g_path_is_absolute(path.c_str()))
     pack_zip(path, _content_dir, comment);
@@ -920,6 +959,132 @@ std::string ModelFile::get_file_contents(const std::string &path) {
   throw std::runtime_error("Error reading attached file contents.");
 }
 
+//--------------------------------------------------------------------------------------------------
+
+static xmlNodePtr first_journal_element(xmlNodePtr node) {
+  while (node != NULL && node->type != XML_ELEMENT_NODE)
+    node = node->next;
+  return node;
+}
+
+/**
+ * Adds (or removes) all object nodes in the given subtree to/from the id -> node map used to replay
+ * the autosave journal. Removed nodes are also dropped from the set of nodes that existed when the
+ * current batch started.
+ */
+static void index_journal_objects(xmlNodePtr node, std::map<std::string, xmlNodePtr> &objects, bool add,
+                                  std::set<xmlNodePtr> *original = NULL) {
+  if (node->type != XML_ELEMENT_NODE)
+    return;
+
+  if (xmlStrcmp(node->name, (xmlChar *)"value") == 0 && base::xml::getProp(node, "type") == "object") {
+    std::string id = base::xml::getProp(node, "id");
+    if (add)
+      objects[id] = node;
+    else {
+      auto iter = objects.find(id);
+      if (iter != objects.end() && iter->second == node)
+        objects.erase(iter);
+      if (original != NULL)
+        original->erase(node);
+    }
+  }
+
+  for (xmlNodePtr child = node->children; child != NULL; child = child->next)
+    index_journal_objects(child, objects, add, original);
+}
+
+// Returns the element child at the given position, or NULL if there are not that many.
+static xmlNodePtr journal_element_at(xmlNodePtr parent, size_t index) {
+  for (xmlNodePtr child = first_journal_element(parent->children); child != NULL;
+       child = first_journal_element(child->next)) {
+    if (index-- == 0)
+      return child;
+  }
+  return NULL;
+}
+
+static xmlNodePtr journal_member_node(xmlNodePtr object, const std::string &member) {
+  for (xmlNodePtr child = object->children; child != NULL; child = child->next) {
+    if (child->type == XML_ELEMENT_NODE && base::xml::getProp(child, "key") == member)
+      return child;
+  }
+  return NULL;
+}
+
+// List and dict pointers are only meaningful within a single serialization run and would clash with the
+// ones stored in the snapshot.
+static void strip_journal_pointers(xmlNodePtr node) {
+  if (node->type != XML_ELEMENT_NODE)
+    return;
+
+  xmlUnsetProp(node, (xmlChar *)"_ptr_");
+  for (xmlNodePtr child = node->children; child != NULL; child = child->next)
+    strip_journal_pointers(child);
+}
+
+// Serializes a value the way the document serializer writes it and adds the resulting node to entry.
+static xmlNodePtr serialize_journal_value(xmlNodePtr entry, const grt::ValueRef &value, bool objects_as_links,
+                                          const std::string &what) {
+  std::string data = grt::GRT::get()->serialize_xml_data(value, "", "", objects_as_links);
+  xmlDocPtr doc = xmlReadMemory(data.data(), (int)data.size(), NULL, NULL, XML_PARSE_NOENT);
+  if (doc == NULL)
+    throw std::runtime_error("Could not serialize " + what + " for the autosave journal");
+
+  xmlNodePtr node = first_journal_element(xmlDocGetRootElement(doc)->children);
+  if (node != NULL) {
+    node = xmlAddChild(entry, xmlDocCopyNode(node, entry->doc, 1));
+    strip_journal_pointers(node);
+  }
+  xmlFreeDoc(doc);
+  return node;
+}
+
+/**
+ * Writes the current value of an object member into a journal entry, in the same form the document
+ * serializer uses inside the object node. No value is written for null members.
+ */
+static void serialize_journal_member(xmlNodePtr entry, const grt::ObjectRef &object, const std::string &name) {
+  const grt::MetaClass::Member *member = object.get_metaclass()->get_member_info(name);
+  if (member == NULL || member->calculated)
+    return;
+
+  grt::ValueRef value(object->get_member(name));
+  if (!value.is_valid())
+    return;
+
+  xmlNodePtr node;
+  if (!member->owned_object && value.type() == grt::ObjectType) {
+    node = xmlNewTextChild(entry, NULL, (xmlChar *)"link", (xmlChar *)grt::ObjectRef::cast_from(value)->id().c_str());
+    xmlNewProp(node, (xmlChar *)"type", (xmlChar *)"object");
+    xmlNewProp(node, (xmlChar *)"struct-name", (xmlChar *)member->type.base.object_class.c_str());
+  } else {
+    node = serialize_journal_value(entry, value, !member->owned_object, object.class_name() + "::" + name);
+    if (node == NULL)
+      return;
+  }
+  xmlSetProp(node, (xmlChar *)"key", (xmlChar *)name.c_str());
+}
+
+/**
+ * Writes a single list item into a journal entry, in the same form the document serializer uses
+ * inside the list node of the owning member.
+ */
+static void serialize_journal_list_item(xmlNodePtr entry, const grt::ObjectRef &object, const std::string &name,
+                                        const grt::ValueRef &value) {
+  const grt::MetaClass::Member *member = object.get_metaclass()->get_member_info(name);
+  if (!value.is_valid())
+    xmlNewTextChild(entry, NULL, (xmlChar *)"null", NULL);
+  else if (member != NULL && !member->owned_object && value.type() == grt::ObjectType) {
+    xmlNodePtr node =
+      xmlNewTextChild(entry, NULL, (xmlChar *)"link", (xmlChar *)grt::ObjectRef::cast_from(value)->id().c_str());
+    xmlNewProp(node, (xmlChar *)"type", (xmlChar *)"object");
+  } else
+    serialize_journal_value(entry, value, false, object.class_name() + "::" + name + " item");
+}
+
+//--------------------------------------------------------------------------------------------------
+
 // writing
 void ModelFile::store_document(const workbench_DocumentRef &doc) {
   grt::GRT::get()->serialize(doc, get_path_for(MAIN_DOCUMENT_NAME), DOCUMENT_FORMAT, DOCUMENT_VERSION);
@@ -928,7 +1093,234 @@ void ModelFile::store_document(const workbench_DocumentRef &doc) {
 }
 
 void ModelFile::store_document_autosave(const workbench_DocumentRef &doc) {
-  grt::GRT::get()->serialize(doc, get_path_for("document-autosave.mwb.xml"), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  std::map<std::pair<std::string, std::string>, grt::ObjectRef> changes;
+  std::vector<JournalListChange> list_changes;
+  bool write_snapshot;
+  {
+    base::MutexLock lock(_journal_mutex);
+    changes.swap(_journal_changes);
+    list_changes.swap(_journal_list_changes);
+
+    // Changes made without undo tracking never reach the journal. An autosave with nothing journaled
+    // was triggered by such changes too.
+    size_t untracked_changes = grt::GRT::get()->untracked_change_count();
+    bool missed_changes =
+      untracked_changes != _journal_untracked_changes || (changes.empty() && list_changes.empty());
+    _journal_untracked_changes = untracked_changes;
+
+    // Compact once replaying the journal would cost more than loading a fresh snapshot.
+    write_snapshot =
+      _journal_needs_snapshot || missed_changes || _snapshot_size == 0 || _journal_size > _snapshot_size;
+    _journal_needs_snapshot = false;
+  }
+
+  std::string journal_path = get_path_for(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME);
+  if (write_snapshot) {
+    std::string path = get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME);
+    try {
+      grt::GRT::get()->serialize(doc, path, DOCUMENT_FORMAT, DOCUMENT_VERSION);
+    } catch (...) {
+      base::MutexLock lock(_journal_mutex);
+      _journal_needs_snapshot = true;
+      throw;
+    }
+    g_remove(journal_path.c_str());
+    _snapshot_size = std::max(base_get_file_size(path.c_str()), 1L);
+    _journal_size = 0;
+    return;
+  }
+
+  xmlDocPtr batch = xmlNewDoc((xmlChar *)"1.0");
+  batch->children = xmlNewDocRawNode(batch, NULL, (xmlChar *)"batch", NULL);
+  for (auto &change : changes) {
+    xmlNodePtr entry = xmlNewTextChild(batch->children, NULL, (xmlChar *)"entry", NULL);
+    xmlNewProp(entry, (xmlChar *)"object", (xmlChar *)change.first.first.c_str());
+    xmlNewProp(entry, (xmlChar *)"member", (xmlChar *)change.first.second.c_str());
+    serialize_journal_member(entry, change.second, change.first.second);
+  }
+
+  // Item changes must be replayed in the order they were made. Lists that are written in full anyway
+  // are skipped.
+  for (auto &change : list_changes) {
+    if (changes.find(std::make_pair(change.owner->id(), change.member)) != changes.end())
+      continue;
+
+    xmlNodePtr entry = xmlNewTextChild(batch->children, NULL, (xmlChar *)"entry", NULL);
+    xmlNewProp(entry, (xmlChar *)"object", (xmlChar *)change.owner->id().c_str());
+    xmlNewProp(entry, (xmlChar *)"member", (xmlChar *)change.member.c_str());
+    xmlNewProp(entry, (xmlChar *)(change.inserted ? "insert" : "remove"),
+               (xmlChar *)std::to_string(change.index).c_str());
+    if (change.inserted)
+      serialize_journal_list_item(entry, change.owner, change.member, change.value);
+  }
+
+  xmlChar *buffer = NULL;
+  int size = 0;
+  xmlDocDumpFormatMemory(batch, &buffer, &size, 1);
+  xmlFreeDoc(batch);
+
+  FILE *f = base_fopen(journal_path.c_str(), "ab");
+  bool written = f != NULL && fwrite(buffer, 1, size, f) == (size_t)size;
+  if (f != NULL)
+    written = fclose(f) == 0 && written;
+  xmlFree(buffer);
+
+  if (!written) {
+    // The journal is incomplete now, start over with a full snapshot on the next autosave.
+    base::MutexLock lock(_journal_mutex);
+    _journal_needs_snapshot = true;
+    throw grt::os_error("Could not write autosave journal " + journal_path, errno);
+  }
+  _journal_size += size;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called by the undo manager for every change made to the GRT tree. Only the object and member are
+ * remembered, the value is serialized when the next autosave runs. List inserts and removals keep
+ * the item, so that only the item is written.
+ */
+void ModelFile::record_journal_change(grt::UndoAction *action) {
+  // Custom undo actions restore state kept outside of the GRT tree (e.g. attached files).
+  if (dynamic_cast<grt::SimpleUndoAction *>(action) != NULL)
+    return;
+
+  grt::ObjectRef object;
+  std::string member;
+  bool found = action->get_changed_member(object, member);
+
+  JournalListChange list_change;
+  bool item_change = false;
+  if (found) {
+    if (grt::UndoListInsertAction *insert = dynamic_cast<grt::UndoListInsertAction *>(action)) {
+      // Actions added by scripts do not carry the value.
+      if (insert->get_value().is_valid()) {
+        // The action is added before the list changes, so an append goes to the current end.
+        size_t index = insert->get_index();
+        list_change = { object, member, true, index == grt::BaseListRef::npos ? insert->get_list().count() : index,
+                        insert->get_value() };
+        item_change = true;
+      }
+    } else if (grt::UndoListRemoveAction *remove = dynamic_cast<grt::UndoListRemoveAction *>(action)) {
+      list_change = { object, member, false, remove->get_index(), grt::ValueRef() };
+      item_change = true;
+    }
+  }
+
+  base::MutexLock lock(_journal_mutex);
+  if (!found)
+    _journal_needs_snapshot = true;
+  else if (item_change)
+    _journal_list_changes.push_back(list_change);
+  else
+    _journal_changes[std::make_pair(object->id(), member)] = object;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ModelFile::reset_autosave_journal() {
+  base::MutexLock lock(_journal_mutex);
+  _journal_changes.clear();
+  _journal_list_changes.clear();
+  _journal_needs_snapshot = false;
+  _journal_untracked_changes = grt::GRT::get()->untracked_change_count();
+  _journal_size = 0;
+  _snapshot_size = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replays an autosave journal on the autosave XML it was recorded against and writes the result back
+ * to document_path. Batches are applied in order. A batch cut short by a crash while it was written
+ * ends the replay.
+ */
+void ModelFile::apply_autosave_journal(const std::string &document_path, const std::string &journal_path) {
+  gchar *contents = NULL;
+  gsize length = 0;
+  if (!g_file_get_contents(journal_path.c_str(), &contents, &length, NULL))
+    throw std::runtime_error("Could not read autosave journal " + journal_path);
+  std::string journal(contents, length);
+  g_free(contents);
+
+  xmlDocPtr xmldoc = grt::GRT::get()->load_xml(document_path);
+  std::map<std::string, xmlNodePtr> objects;
+  index_journal_objects(xmlDocGetRootElement(xmldoc), objects, true);
+
+  static const std::string batch_end = "</batch>\n";
+  size_t start = 0, end, batches = 0;
+  while ((end = journal.find(batch_end, start)) != std::string::npos) {
+    end += batch_end.size();
+    xmlDocPtr batch = xmlReadMemory(journal.data() + start, (int)(end - start), NULL, NULL, XML_PARSE_NOENT);
+    start = end;
+    if (batch == NULL)
+      break;
+
+    // Objects written in this batch were serialized with all changes of the batch applied. Item changes
+    // are only replayed on objects that were already there when the batch started.
+    std::set<xmlNodePtr> original;
+    for (auto &object : objects)
+      original.insert(object.second);
+
+    for (xmlNodePtr entry = xmlDocGetRootElement(batch)->children; entry != NULL; entry = entry->next) {
+      if (entry->type != XML_ELEMENT_NODE)
+        continue;
+
+      // Objects created after the snapshot are contained in full in the entry of the member that owns them.
+      auto object = objects.find(base::xml::getProp(entry, "object"));
+      if (object == objects.end())
+        continue;
+
+      std::string member = base::xml::getProp(entry, "member");
+      xmlNodePtr member_node = journal_member_node(object->second, member);
+      std::string insert = base::xml::getProp(entry, "insert");
+      std::string remove = base::xml::getProp(entry, "remove");
+      if (!insert.empty() || !remove.empty()) {
+        if (member_node == NULL || original.find(object->second) == original.end())
+          continue;
+
+        if (!remove.empty()) {
+          xmlNodePtr item = journal_element_at(member_node, std::stoul(remove));
+          if (item != NULL) {
+            index_journal_objects(item, objects, false, &original);
+            xmlUnlinkNode(item);
+            xmlFreeNode(item);
+          }
+        } else {
+          xmlNodePtr value = first_journal_element(entry->children);
+          if (value == NULL)
+            continue;
+          value = xmlDocCopyNode(value, xmldoc, 1);
+          xmlNodePtr next = journal_element_at(member_node, std::stoul(insert));
+          value = next != NULL ? xmlAddPrevSibling(next, value) : xmlAddChild(member_node, value);
+          index_journal_objects(value, objects, true);
+        }
+        continue;
+      }
+
+      if (member_node != NULL) {
+        index_journal_objects(member_node, objects, false, &original);
+        xmlUnlinkNode(member_node);
+        xmlFreeNode(member_node);
+      }
+
+      xmlNodePtr value = first_journal_element(entry->children);
+      if (value != NULL) {
+        value = xmlAddChild(object->second, xmlDocCopyNode(value, xmldoc, 1));
+        index_journal_objects(value, objects, true);
+      }
+    }
+    xmlFreeDoc(batch);
+    ++batches;
+  }
+
+  int result = xmlSaveFormatFile(document_path.c_str(), xmldoc, 1);
+  xmlFreeDoc(xmldoc);
+  if (result < 0)
+    throw std::runtime_error("Could not write recovered document " + document_path);
+
+  logInfo("Applied %i autosave journal batches\n", (int)batches);
 }
 
 void ModelFile::delete_file(const std::string &path) {
@@ -37,11 +37,16 @@
 
 #define MAIN_DOCUMENT_NAME "document.mwb.xml"
 #define MAIN_DOCUMENT_AUTOSAVE_NAME "document-autosave.mwb.xml"
+#define MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME "document-autosave.journal"
 
 namespace bec {
   class GRTManager;
 }
 
+namespace grt {
+  class UndoAction;
+}
+
 namespace wb {
   class MYSQLWBBACKEND_PUBLIC_FUNC ModelFile : public base::trackable {
   public:
@@ -69,6 +74,7 @@ namespace wb {
 
     void store_document(const workbench_DocumentRef &doc);
     void store_document_autosave(const workbench_DocumentRef &doc);
+    static void apply_autosave_journal(const std::string &document_path, const std::string &journal_path);
 
     std::list<std::string> get_file_list(const std::string &prefixdir = "");
     bool has_file(const std::string &name);
@@ -122,6 +128,27 @@ namespace wb {
 
     bool _dirty;
 
+    // A single item inserted into or removed from a list member, journaled instead of the whole list.
+    struct JournalListChange {
+      grt::ObjectRef owner;
+      std::string member;
+      bool inserted;
+      size_t index;
+      grt::ValueRef value;
+    };
+
+    base::Mutex _journal_mutex;
+    std::map<std::pair<std::string, std::string>, grt::ObjectRef> _journal_changes; //< (object id, member) changed
+                                                                                     //  since the last autosave
+    std::vector<JournalListChange> _journal_list_changes; //< list items changed since the last autosave, in order
+    bool _journal_needs_snapshot;      //< a change was seen that cannot be written to the journal
+    size_t _journal_untracked_changes; //< GRT untracked change count at the last autosave
+    long _journal_size;                //< bytes written to the autosave journal since the last snapshot
+    long _snapshot_size;               //< size of the last autosave snapshot, 0 if none was written yet
+
+    void record_journal_change(grt::UndoAction *action);
+    void reset_autosave_journal();
+
     typedef std::map<std::string, std::string> TableInsertsSqlScripts; // table guid -> sql script (inserts)
     TableInsertsSqlScripts
       table_inserts_sql_scripts; // for model upgrade only: move insert sql scripts from xml to sqlite db
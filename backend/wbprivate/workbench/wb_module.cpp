@@ -25,6 +25,7 @@
 
 #include "base/config_file.h"
 #include "base/log.h"
+#include "base/profiling.h"
 
 #include "wb_module.h"
 #include "wb_overview.h"
@@ -565,13 +566,11 @@ int WorkbenchImpl::exportPS(const std::string &filename) {
 }
 
 int WorkbenchImpl::activateDiagram(const model_DiagramRef &diagram) {
-  _wb->get_model_context()->switch_diagram(diagram);
-  return 0;
+  return _wb->get_model_context()->switch_diagram(diagram) ? 0 : -1;
 }
 
 int WorkbenchImpl::exportDiagramToPng(const model_DiagramRef &diagram, const std::string &filename) {
-  _wb->get_model_context()->exportPng(diagram, filename);
-  return 0;
+  return _wb->get_model_context()->exportPng(diagram, filename) ? 0 : -1;
 }
 
 static void quit() {
@@ -1155,6 +1154,31 @@ int WorkbenchImpl::debugValidateGRT() {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Clears previously collected trace data and starts recording trace spans.
+ */
+int WorkbenchImpl::startTracing() {
+  base::Tracer::clear();
+  base::Tracer::enable(true);
+  return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Stops recording trace spans and writes what was collected as Chrome trace-event JSON to the given file
+ * (if not empty). Returns 1 if the file was written.
+ */
+int WorkbenchImpl::stopTracing(const std::string &path) {
+  base::Tracer::enable(false);
+  if (path.empty())
+    return 0;
+
+  return base::Tracer::write_chrome_trace(path) ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 int WorkbenchImpl::refreshHomeConnections() {
   wb::WBContextUI::get()->refresh_home_connections();
   return 0;
@@ -131,6 +131,8 @@ namespace wb {
       DECLARE_MODULE_FUNCTION(WorkbenchImpl::getTempDir),
 
       DECLARE_MODULE_FUNCTION(WorkbenchImpl::debugValidateGRT),
+      DECLARE_MODULE_FUNCTION(WorkbenchImpl::startTracing),
+      DECLARE_MODULE_FUNCTION(WorkbenchImpl::stopTracing),
       DECLARE_MODULE_FUNCTION(WorkbenchImpl::getVideoAdapter),
 
       DECLARE_MODULE_FUNCTION(WorkbenchImpl::runScriptFile),
@@ -282,6 +284,8 @@ namespace wb {
 
     // debugging
     int debugValidateGRT();
+    int startTracing();
+    int stopTracing(const std::string &path);
 
     int showUserTypeEditor(const workbench_physical_ModelRef &model);
     int showDocumentProperties();
@@ -21,8 +21,15 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+
 #include "base/threading.h"
 #include "base/log.h"
+#include "base/util_functions.h"
 
 #include "grt_dispatcher.h"
 #include "grt_manager.h"
@@ -43,12 +50,6 @@ struct CallbackHelper {
   }
 };
 
-struct GRTTaskHelper {
-  GRTTaskBase::Ref task;
-  GRTTaskHelper(const GRTTaskBase::Ref task_) : task(task_) {
-  }
-};
-
 struct GrtDispatcherHelper {
   GRTDispatcher::Ref dispatcher;
   GrtDispatcherHelper(const GRTDispatcher::Ref dispatcher_) : dispatcher(dispatcher_) {
@@ -158,17 +159,137 @@ bool GRTTaskBase::process_message(const grt::Message &msg) {
 void GRTTaskBase::process_message_m(const grt::Message &msg) {
 }
 
-//----------------- GrtNullTask --------------------------------------------------------------------
+//----------------- GRTTaskQueue -------------------------------------------------------------------
 
-class GrtNullTask : public GRTTaskBase {
+/**
+ * The task queue shared by the worker threads of a dispatcher. Tasks are handed out by priority and
+ * then in the order they were added, skipping tasks whose affinity key is currently held by another worker.
+ * Once closed, the queue is drained and then signals the workers to terminate.
+ */
+class bec::GRTTaskQueue {
 public:
-  GrtNullTask(const GRTDispatcher::Ref dispatcher) : GRTTaskBase("Terminate Worker Thread", dispatcher) {
+  struct Entry {
+    GRTTaskBase::Ref task;
+    double queued_at;
+    double wait_time;
+  };
+
+  GRTTaskQueue() : _stats(), _closed(false) {
   }
-  virtual void finished(const grt::ValueRef &result) {
+
+  void push(const GRTTaskBase::Ref task) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _queues[priority_index(task)].push_back({ task, base::timestamp(), 0 });
+      size_t depth = queue_depth();
+      if (depth > _stats.max_queue_depth)
+        _stats.max_queue_depth = depth;
+    }
+    _condition.notify_one();
   }
-  virtual grt::ValueRef execute() {
-    _result = grt::ValueRef();
-    return _result;
+
+  // Waits up to the given time for a runnable task. Returns false if the queue was closed and is empty,
+  // otherwise true, with entry.task being empty if no task became runnable in time.
+  bool pop(Entry &entry, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    entry.task.reset();
+    if (!take_runnable(entry) && !(_closed && queue_depth() == 0)) {
+      _condition.wait_for(lock, std::chrono::milliseconds(timeout_ms));
+      take_runnable(entry);
+    }
+
+    if (entry.task) {
+      entry.wait_time = base::timestamp() - entry.queued_at;
+      _stats.total_wait_time += entry.wait_time;
+      if (entry.wait_time > _stats.max_wait_time)
+        _stats.max_wait_time = entry.wait_time;
+      ++_stats.running;
+      return true;
+    }
+    return !(_closed && queue_depth() == 0);
+  }
+
+  // Must be called by a worker once it is done with a task it got from pop().
+  void done(const Entry &entry, bool executed) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!entry.task->affinity().empty())
+        _active_keys.erase(entry.task->affinity());
+      --_stats.running;
+      if (executed)
+        ++_stats.tasks_executed;
+    }
+
+    // Tasks waiting for the released affinity key (or the end of the queue on shutdown) can go now.
+    _condition.notify_all();
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _closed = true;
+    }
+    _condition.notify_all();
+  }
+
+  // True while tasks are waiting or a worker hasn't finished the one it took.
+  bool busy() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return queue_depth() > 0 || _stats.running > 0;
+  }
+
+  GRTDispatcher::Statistics statistics() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    GRTDispatcher::Statistics result = _stats;
+    result.queue_depth = queue_depth();
+    for (size_t i = 0; i < 3; ++i)
+      result.queued_by_priority[i] = _queues[i].size();
+    return result;
+  }
+
+  void reset_statistics() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t running = _stats.running;
+    _stats = GRTDispatcher::Statistics();
+    _stats.running = running;
+  }
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  std::deque<Entry> _queues[3]; // One per priority, indexed by GRTTaskBase::Priority.
+  std::set<std::string> _active_keys;
+  GRTDispatcher::Statistics _stats;
+  bool _closed;
+
+  static size_t priority_index(const GRTTaskBase::Ref &task) {
+    int priority = task->priority();
+    if (priority < GRTTaskBase::PriorityLow)
+      return GRTTaskBase::PriorityLow;
+    return std::min(priority, (int)GRTTaskBase::PriorityHigh);
+  }
+
+  size_t queue_depth() const {
+    return _queues[0].size() + _queues[1].size() + _queues[2].size();
+  }
+
+  // Called with the mutex held.
+  bool take_runnable(Entry &entry) {
+    for (int priority = GRTTaskBase::PriorityHigh; priority >= GRTTaskBase::PriorityLow; --priority) {
+      std::deque<Entry> &queue = _queues[priority];
+      for (auto iterator = queue.begin(); iterator != queue.end(); ++iterator) {
+        const std::string &key = iterator->task->affinity();
+        if (!key.empty()) {
+          if (_active_keys.count(key) > 0)
+            continue;
+          _active_keys.insert(key);
+        }
+        entry = *iterator;
+        queue.erase(iterator);
+        return true;
+      }
+    }
+    return false;
   }
 };
 
@@ -329,17 +450,23 @@ static void sleep_2ms() {
 
 static GThread *_main_thread = NULL;
 
-GRTDispatcher::GRTDispatcher(bool threaded, bool is_main_dispatcher)
+GRTDispatcher::GRTDispatcher(bool threaded, bool is_main_dispatcher, size_t worker_count)
   : _busy(0),
     _threading_disabled(!threaded),
     _w_runing(0),
     _is_main_dispatcher(is_main_dispatcher),
     _shut_down(false),
-    _started(false) {
+    _started(false),
+    _worker_count(worker_count == 0 ? 1 : worker_count) {
   _shutdown_callback = false;
 
+  if (_is_main_dispatcher && _worker_count > 1) {
+    logWarning("The main dispatcher cannot use more than one worker thread (%i requested)\n", (int)_worker_count);
+    _worker_count = 1;
+  }
+
   if (threaded) {
-    _task_queue = g_async_queue_new();
+    _task_queue = new GRTTaskQueue();
     _callback_queue = g_async_queue_new();
   } else {
     _task_queue = NULL;
@@ -358,20 +485,20 @@ GRTDispatcher::GRTDispatcher(bool threaded, bool is_main_dispatcher)
 GRTDispatcher::~GRTDispatcher() {
   shutdown();
 
-  if (_thread != nullptr && _thread != g_thread_self()) {
-    g_thread_join(_thread);
+  for (auto thread : _threads) {
+    if (thread != g_thread_self())
+      g_thread_join(thread);
   }
 
-  if (_task_queue)
-    g_async_queue_unref(_task_queue);
+  delete _task_queue;
   if (_callback_queue)
     g_async_queue_unref(_callback_queue);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-GRTDispatcher::Ref GRTDispatcher::create_dispatcher(bool threaded, bool is_main_dispatcher) {
-  return Ref(new GRTDispatcher(threaded, is_main_dispatcher));
+GRTDispatcher::Ref GRTDispatcher::create_dispatcher(bool threaded, bool is_main_dispatcher, size_t worker_count) {
+  return Ref(new GRTDispatcher(threaded, is_main_dispatcher, worker_count));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -381,13 +508,26 @@ void GRTDispatcher::start() {
 
   _shut_down = false;
   if (!_threading_disabled) {
-    logDebug("starting worker thread\n");
+    logDebug("starting %i worker thread(s)\n", (int)_worker_count);
 
-    GrtDispatcherHelper *helper = new GrtDispatcherHelper(shared_from_this());
-    _thread = base::create_thread(worker_thread, helper);
-    if (_thread == 0) {
+    for (size_t i = 0; i < _worker_count; ++i) {
+      GrtDispatcherHelper *helper = new GrtDispatcherHelper(shared_from_this());
+      GThread *thread = base::create_thread(worker_thread, helper);
+      if (thread == 0) {
+        delete helper;
+        break;
+      }
+      _threads.push_back(thread);
+    }
+
+    if (_threads.empty()) {
       logError("base::create_thread failed to create the GRT worker thread. Falling back into non-threaded mode.\n");
       _threading_disabled = true;
+    } else {
+      if (_threads.size() < _worker_count)
+        logWarning("Could only create %i of %i worker threads\n", (int)_threads.size(), (int)_worker_count);
+      _worker_count = _threads.size();
+      _thread = _threads.front();
     }
   }
 
@@ -414,12 +554,19 @@ void GRTDispatcher::shutdown() {
   _shutdown_callback = true;
 
   // _thread == 0, means that init was not called, but threading_disabled was set to false.
+  // Closing the queue lets the workers finish what is already queued and then terminate.
   if (!_threading_disabled && _thread != 0) {
-    std::shared_ptr<GrtNullTask> task(new GrtNullTask(shared_from_this()));
-    add_task(task);
-    logDebug2("Main thread waiting for background thread to finish\n");
-    _w_runing.wait();
-    logDebug2("Background thread finished\n");
+    _task_queue->close();
+    logDebug2("Main thread waiting for background threads to finish\n");
+    for (size_t i = 0; i < _threads.size(); ++i)
+      _w_runing.wait();
+    logDebug2("Background threads finished\n");
+
+    Statistics statistics = _task_queue->statistics();
+    if (statistics.tasks_executed > 0)
+      logDebug("Dispatcher ran %zu tasks, queue depth max %zu, wait time avg %.3fs, max %.3fs\n",
+               statistics.tasks_executed, statistics.max_queue_depth, statistics.average_wait_time(),
+               statistics.max_wait_time);
   }
 
   if (_started && !_grtm.expired())
@@ -435,55 +582,39 @@ gpointer GRTDispatcher::worker_thread(gpointer data) {
   GRTDispatcher::Ref self = helper->dispatcher;
   delete helper;
 
-  GAsyncQueue *task_queue = self->_task_queue;
+  GRTTaskQueue *task_queue = self->_task_queue;
   GAsyncQueue *callback_queue = self->_callback_queue;
 
   mforms::Utilities::set_thread_name("GRTDispatcher");
 
   logDebug("worker thread running\n");
 
-  g_async_queue_ref(task_queue);
   g_async_queue_ref(callback_queue);
 
   self->worker_thread_init();
 
   while (true) {
-    GRTTaskBase::Ref task;
-
     self->worker_thread_iteration();
 
-// pop next task pushed to queue by the main thread
-
-#if GLIB_CHECK_VERSION(2, 32, 0)
-    GRTTaskHelper *helper = static_cast<GRTTaskHelper *>(g_async_queue_timeout_pop(task_queue, 1000000));
-    if (helper == NULL)
-      continue;
-    task = helper->task;
-    delete helper;
-#else
-    GTimeVal timeout;
-    g_get_current_time(&timeout);
-    timeout.tv_sec += 1;
-
-    GRTTaskHelper *helper = static_cast<GRTTaskHelper *>(g_async_queue_timed_pop(task_queue, &timeout));
-    if (helper == NULL)
+    // Pop the next task pushed to the queue. An empty entry means we timed out waiting.
+    GRTTaskQueue::Entry entry;
+    if (!task_queue->pop(entry, 1000)) {
+      logDebug3("Task queue closed. Terminating worker thread...\n");
+      break;
+    }
+    if (!entry.task)
       continue;
-    task = helper->task;
-    delete helper;
-#endif
+
+    GRTTaskBase::Ref task = entry.task;
 
     g_atomic_int_inc(&self->_busy);
     logDebug3("Running task \"%s\"\n", task->name().c_str());
-
-    if (dynamic_cast<GrtNullTask *>(task.get()) != 0) { // a NULL task terminates the thread
-      logDebug3("Null task found. Terminating worker thread...\n");
-      task->finished(grt::ValueRef());
-      g_atomic_int_dec_and_test(&self->_busy);
-      break;
-    }
+    if (entry.wait_time > 1.0)
+      logDebug("Task \"%s\" waited %.2fs in the queue\n", task->name().c_str(), entry.wait_time);
 
     if (task->is_cancelled()) {
       logDebug3("Task \"%s\" cancelled\n", task->name().c_str());
+      task_queue->done(entry, false);
       g_atomic_int_dec_and_test(&self->_busy);
       continue;
     }
@@ -497,6 +628,7 @@ gpointer GRTDispatcher::worker_thread(gpointer data) {
     self->execute_task(task);
 
     logDebug3("Task \"%s\" finished\n", task->name().c_str());
+    task_queue->done(entry, true);
     if (task->get_error()) {
       logError("%s\n",
                std::string(("worker: task '" + task->name() + "' has failed with error:.") + task->get_error()->what())
@@ -515,7 +647,6 @@ gpointer GRTDispatcher::worker_thread(gpointer data) {
 
   self->worker_thread_release();
 
-  g_async_queue_unref(task_queue);
   g_async_queue_unref(callback_queue);
 
   self->_w_runing.post();
@@ -539,14 +670,23 @@ void GRTDispatcher::execute_now(const GRTTaskBase::Ref task) {
 //--------------------------------------------------------------------------------------------------
 
 void GRTDispatcher::add_task(const GRTTaskBase::Ref task) {
-  // If threading is disabled or the worker thread is calling another
+  // If threading is disabled or a worker thread is calling another
   // task, we have to execute it immediately otherwise we'd just deadlock.
-  if (_threading_disabled || _thread == g_thread_self())
+  if (_threading_disabled || is_worker_thread())
     execute_now(task);
-  else {
-    GRTTaskHelper *helper = new GRTTaskHelper(task);
-    g_async_queue_push(_task_queue, helper);
+  else
+    _task_queue->push(task);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool GRTDispatcher::is_worker_thread() const {
+  GThread *self = g_thread_self();
+  for (auto thread : _threads) {
+    if (thread == self)
+      return true;
   }
+  return false;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -558,7 +698,22 @@ void GRTDispatcher::cancel_task(const GRTTaskBase::Ref task) {
 //--------------------------------------------------------------------------------------------------
 
 bool GRTDispatcher::get_busy() {
-  return (_task_queue && g_async_queue_length(_task_queue) > 0) || g_atomic_int_get(&_busy);
+  return (_task_queue && _task_queue->busy()) || g_atomic_int_get(&_busy);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+GRTDispatcher::Statistics GRTDispatcher::get_statistics() {
+  if (_task_queue)
+    return _task_queue->statistics();
+  return Statistics();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void GRTDispatcher::reset_statistics() {
+  if (_task_queue)
+    _task_queue->reset_statistics();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -588,8 +743,8 @@ void GRTDispatcher::flush_pending_callbacks() {
       DispatcherCallbackBase::Ref callback = helper->callback;
       delete helper;
 
-      // Don't run any task, but clear the queue if we are shutting down.
-      // This way the NullTask can surface up in the worker thread.
+      // Don't run any callback, but clear the queue if we are shutting down.
+      // This way a worker blocked on a callback can drain the task queue and terminate.
       if (!_shutdown_callback)
         callback->execute();
       callback->signal();
@@ -662,20 +817,25 @@ static bool call_process_message(const grt::Message &msgs, void *sender, const G
 //--------------------------------------------------------------------------------------------------
 
 void GRTDispatcher::prepare_task(const GRTTaskBase::Ref gtask) {
+  // Only the (single worker) main dispatcher routes GRT messages to the current task.
+  if (!_is_main_dispatcher)
+    return;
+
   _current_task = gtask;
 
   // Directly set the task callbacks.
-  if (_is_main_dispatcher)
-    grt::GRT::get()->pushMessageHandler(
+  grt::GRT::get()->pushMessageHandler(
       new grt::SlotHolder(std::bind(call_process_message, std::placeholders::_1, std::placeholders::_2, gtask)));
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void GRTDispatcher::restore_callbacks(const GRTTaskBase::Ref task) {
+  if (!_is_main_dispatcher)
+    return;
+
   // Restore originally set msg callbacks.
-  if (_is_main_dispatcher)
-    grt::GRT::get()->popMessageHandler();
+  grt::GRT::get()->popMessageHandler();
 
   _current_task.reset();
 }
@@ -734,6 +894,8 @@ grt::ValueRef GRTDispatcher::add_task_and_wait(const GRTTaskBase::Ref task) {
   }
 #endif
 
+  // The calling thread is blocked until the task is done, so it goes ahead of queued background work.
+  task->set_priority(GRTTaskBase::PriorityHigh);
   add_task(task);
 
   // wait for the task to finish executing
@@ -761,8 +923,12 @@ grt::ValueRef GRTDispatcher::execute_sync_function(const std::string &name,
 
 //--------------------------------------------------------------------------------------------------
 
-void GRTDispatcher::execute_async_function(const std::string &name, const std::function<grt::ValueRef()> &function) {
-  add_task(GRTSimpleTask::create_task(name, shared_from_this(), function));
+void GRTDispatcher::execute_async_function(const std::string &name, const std::function<grt::ValueRef()> &function,
+                                           GRTTaskBase::Priority priority, const std::string &affinity) {
+  GRTSimpleTask::Ref task(GRTSimpleTask::create_task(name, shared_from_this(), function));
+  task->set_priority(priority);
+  task->set_affinity(affinity);
+  add_task(task);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -114,6 +114,9 @@ namespace bec {
   public:
     typedef std::shared_ptr<GRTTaskBase> Ref;
 
+    // Queued tasks are picked by priority first and then in the order they were added.
+    enum Priority { PriorityLow = 0, PriorityNormal = 1, PriorityHigh = 2 };
+
     virtual ~GRTTaskBase();
 
     inline bool is_finished() {
@@ -138,6 +141,22 @@ namespace bec {
       _messages_to_main_thread = false;
     }
 
+    Priority priority() const {
+      return _priority;
+    }
+    void set_priority(Priority priority) {
+      _priority = priority;
+    }
+
+    // Tasks sharing a non-empty affinity key are never run concurrently by a multi-worker dispatcher.
+    // They are executed one after the other (in queue order), while other tasks may use the remaining workers.
+    const std::string &affinity() const {
+      return _affinity;
+    }
+    void set_affinity(const std::string &key) {
+      _affinity = key;
+    }
+
     // _m suffix methods are called in the main thread
     // the other ones are called in the grt thread and
     // schedule the call of their _m counterparts
@@ -179,7 +198,8 @@ namespace bec {
         _name(name),
         _cancelled(false),
         _finished(false),
-        _messages_to_main_thread(true) {
+        _messages_to_main_thread(true),
+        _priority(PriorityNormal) {
     }
 
     void set_finished();
@@ -189,6 +209,8 @@ namespace bec {
     bool _cancelled;
     bool _finished;
     bool _messages_to_main_thread;
+    Priority _priority;
+    std::string _affinity;
 
     // Should never be defined and called.
     GRTTaskBase(GRTTaskBase &);
@@ -289,13 +311,31 @@ namespace bec {
 
   //------------------------------------------------------------------------------------------------
 
+  class GRTTaskQueue;
+
   class WBPUBLICBACKEND_PUBLIC_FUNC GRTDispatcher : public std::enable_shared_from_this<GRTDispatcher> {
   public:
     typedef void (*FlushAndWaitCallback)();
     typedef std::shared_ptr<GRTDispatcher> Ref;
 
+    // Counters collected by the dispatcher since it was created (or since the last reset_statistics() call).
+    // Wait times are in seconds and measure the time a task spent in the queue before a worker picked it up.
+    struct Statistics {
+      size_t queue_depth;              // Tasks currently waiting.
+      size_t max_queue_depth;          // Highest number of waiting tasks seen.
+      size_t queued_by_priority[3];    // Tasks currently waiting, indexed by GRTTaskBase::Priority.
+      size_t tasks_executed;           // Tasks run by the worker threads.
+      size_t running;                  // Tasks currently being run by worker threads.
+      double total_wait_time;
+      double max_wait_time;
+
+      double average_wait_time() const {
+        return tasks_executed > 0 ? total_wait_time / tasks_executed : 0;
+      }
+    };
+
   private:
-    GAsyncQueue *_task_queue;
+    GRTTaskQueue *_task_queue;
     FlushAndWaitCallback _flush_main_thread_and_wait;
     std::weak_ptr<bec::GRTManager> _grtm;
 
@@ -309,13 +349,17 @@ namespace bec {
     bool _started;
 
     GAsyncQueue *_callback_queue;
-    GThread *_thread;
+    GThread *_thread; // The first (or only) worker thread.
+    std::vector<GThread *> _threads;
+    size_t _worker_count;
 
     static gpointer worker_thread(gpointer data);
 
     GRTTaskBase::Ref _current_task;
 
-    GRTDispatcher(bool threaded, bool is_main_dispatcher);
+    GRTDispatcher(bool threaded, bool is_main_dispatcher, size_t worker_count);
+
+    bool is_worker_thread() const;
 
     void prepare_task(const GRTTaskBase::Ref task);
     void execute_task(const GRTTaskBase::Ref task);
@@ -329,7 +373,9 @@ namespace bec {
     bool message_callback(const grt::Message &msg, void *sender);
 
   public:
-    static Ref create_dispatcher(bool threaded, bool is_main_dispatcher);
+    // Non-main dispatchers can use more than one worker thread for tasks that don't touch shared GRT state.
+    // The main dispatcher always uses a single worker, as the GRT message handler stack is global.
+    static Ref create_dispatcher(bool threaded, bool is_main_dispatcher, size_t worker_count = 1);
 
     virtual ~GRTDispatcher();
 
@@ -340,7 +386,9 @@ namespace bec {
 
     grt::ValueRef execute_sync_function(const std::string &name, const std::function<grt::ValueRef()> &function);
 
-    void execute_async_function(const std::string &name, const std::function<grt::ValueRef()> &function);
+    void execute_async_function(const std::string &name, const std::function<grt::ValueRef()> &function,
+                                GRTTaskBase::Priority priority = GRTTaskBase::PriorityNormal,
+                                const std::string &affinity = "");
 
     void wait_task(const GRTTaskBase::Ref task);
 
@@ -363,6 +411,12 @@ namespace bec {
 
     bool get_busy();
 
+    size_t worker_count() const {
+      return _worker_count;
+    }
+    Statistics get_statistics();
+    void reset_statistics();
+
     void cancel_task(const GRTTaskBase::Ref task);
 
     void flush_pending_callbacks();
@@ -21,12 +21,15 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <thread>
+
 #include "base/threading.h"
 #include "base/log.h"
 #include "base/file_utilities.h"
 
 #include "grtpp_module_python.h"
 #include "grtpp_module_cpp.h"
+#include "grtpp_module_lazy.h"
 
 #include "python_context.h"
 
@@ -37,6 +40,7 @@
 #include "base/file_functions.h"
 #include "base/file_utilities.h"
 #include "base/string_utilities.h"
+#include "base/util_functions.h"
 #include "mforms/utilities.h"
 
 #include "grt/grt_manager.h"
@@ -55,7 +59,8 @@ static void init_all() {
   }
 }
 
-GRTManager::GRTManager(bool threaded) : _has_unsaved_changes(false), _threaded(threaded), _verbose(false) {
+GRTManager::GRTManager(bool threaded)
+  : _has_unsaved_changes(false), _use_startup_cache(true), _threaded(threaded), _verbose(false) {
   _grt = grt::GRT::get();
   _globals_tree_soft_lock_count = 0;
 
@@ -69,6 +74,12 @@ GRTManager::GRTManager(bool threaded) : _has_unsaved_changes(false), _threaded(t
   _idle_blocked = false;
   _clipboard = 0;
 
+  // Migration source modules are rarely used, no need to load them on every start.
+  _deferred_module_patterns = { "db_sybase_*", "db_sqlanywhere_*", "db_msaccess_*" };
+
+  if (getenv("WB_NO_STARTUP_CACHE"))
+    _use_startup_cache = false;
+
   _dispatcher = GRTDispatcher::create_dispatcher(_threaded, true);
   _shell = new ShellBE(_dispatcher);
   _plugin_manager = _grt->get_native_module<PluginManagerImpl>();
@@ -157,6 +168,7 @@ bool GRTManager::in_main_thread() {
 }
 
 GRTManager::~GRTManager() {
+  shutdown_background_dispatcher();
   _dispatcher->shutdown();
   _dispatcher.reset();
 
@@ -210,6 +222,28 @@ void GRTManager::execute_grt_task(const std::string &title, const std::function<
   _dispatcher->add_task(task);
 }
 
+GRTDispatcher::Ref GRTManager::get_background_dispatcher() {
+  MutexLock lock(_background_dispatcher_mutex);
+  if (!_background_dispatcher) {
+    // A few workers are enough to keep a long export from blocking short jobs, more only add contention.
+    size_t worker_count = std::min<size_t>(std::max(2U, std::thread::hardware_concurrency()), 4);
+    _background_dispatcher = GRTDispatcher::create_dispatcher(_threaded, false, worker_count);
+    _background_dispatcher->set_main_thread_flush_and_wait(_dispatcher->get_main_thread_flush_and_wait());
+    _background_dispatcher->start();
+  }
+  return _background_dispatcher;
+}
+
+void GRTManager::shutdown_background_dispatcher() {
+  GRTDispatcher::Ref dispatcher;
+  {
+    MutexLock lock(_background_dispatcher_mutex);
+    dispatcher.swap(_background_dispatcher);
+  }
+  if (dispatcher)
+    dispatcher->shutdown();
+}
+
 void GRTManager::add_dispatcher(const GRTDispatcher::Ref dispatcher) {
   if (_dispatcher != dispatcher) {
     MutexLock disp_map_mutex(_disp_map_mutex);
@@ -252,6 +286,7 @@ void GRTManager::show_message(const std::string &title, const std::string &messa
 }
 
 void GRTManager::cleanUpAndReinitialize() {
+  shutdown_background_dispatcher();
   _dispatcher->shutdown();
   _dispatcher.reset();
 
@@ -278,11 +313,22 @@ void GRTManager::cleanUpAndReinitialize() {
 }
 
 void GRTManager::initialize(bool init_python, const std::string &loader_module_path) {
+  double start = base::timestamp();
+  double phase_start = start;
+  auto end_phase = [&](const std::string &name) {
+    double now = base::timestamp();
+    _startup_timings.push_back({ name, now - phase_start });
+    phase_start = now;
+  };
+  _startup_timings.clear();
+
   _dispatcher->start();
 
   load_structs();
+  end_phase("structs");
 
   init_module_loaders(loader_module_path, init_python);
+  end_phase("module loaders");
 
 #ifdef _MSC_VER
   add_python_module_dir(_basedir + "\\python");
@@ -297,10 +343,30 @@ void GRTManager::initialize(bool init_python, const std::string &loader_module_p
 #endif
 
   pyobject_initialize();
+  end_phase("python setup");
 
   load_libraries();
+  end_phase("libraries");
 
   load_modules();
+  end_phase("modules");
+
+  std::string breakdown;
+  for (auto &phase : _startup_timings)
+    breakdown += base::strfmt("%s: %.3fs, ", phase.first.c_str(), phase.second);
+  logInfo("GRT initialized in %.3fs (%s)\n", base::timestamp() - start,
+          breakdown.substr(0, breakdown.size() - 2).c_str());
+}
+
+std::string GRTManager::startup_cache_file(const std::string &name) {
+  if (!_use_startup_cache || _user_datadir.empty())
+    return "";
+
+  std::string cache_dir = base::makePath(_user_datadir, "cache");
+  if (!g_file_test(cache_dir.c_str(), G_FILE_TEST_IS_DIR) && g_mkdir_with_parents(cache_dir.c_str(), 0700) != 0)
+    return "";
+
+  return base::makePath(cache_dir, name);
 }
 
 bool GRTManager::initialize_shell(const std::string &shell_type) {
@@ -580,26 +646,44 @@ bool GRTManager::load_structs() {
   int c, count = 0;
   gchar **paths = g_strsplit(_struct_pathlist.c_str(), G_SEARCHPATH_SEPARATOR_S, 0);
 
+  std::vector<std::string> directories;
   for (int i = 0; paths[i]; i++) {
-    if (g_file_test(paths[i], G_FILE_TEST_IS_DIR)) {
+    if (g_file_test(paths[i], G_FILE_TEST_IS_DIR))
+      directories.push_back(paths[i]);
+  }
+  g_strfreev(paths);
+
+  // Parsing the struct XML files is only needed if they changed since the cache was written.
+  std::string cache_file = startup_cache_file("grt_structs.cache");
+  if (!cache_file.empty())
+    count = _grt->load_metaclass_cache(cache_file, directories);
+
+  bool cached = count >= 0;
+  if (cached) {
+    if (_verbose)
+      _shell->writef(_("Loaded struct definitions from cache '%s'.\n"), cache_file.c_str());
+  } else {
+    count = 0;
+    for (auto &directory : directories) {
       if (_verbose)
-        _shell->writef(_("Looking for struct files in '%s'.\n"), paths[i]);
+        _shell->writef(_("Looking for struct files in '%s'.\n"), directory.c_str());
 
       try {
-        c = _grt->scan_metaclasses_in(paths[i]);
+        c = _grt->scan_metaclasses_in(directory);
 
         count += c;
       } catch (std::exception &exc) {
-        _shell->writef(_("Could not load structs from '%s': %s\n"), paths[i], exc.what());
+        _shell->writef(_("Could not load structs from '%s': %s\n"), directory.c_str(), exc.what());
       }
     }
   }
 
   _grt->end_loading_metaclasses();
 
-  _shell->writef(_("Registered %i GRT classes.\n"), count);
+  if (!cached && !cache_file.empty())
+    _grt->save_metaclass_cache(cache_file, directories);
 
-  g_strfreev(paths);
+  _shell->writef(_("Registered %i GRT classes.\n"), count);
 
   return false;
 }
@@ -646,8 +730,27 @@ bool GRTManager::load_libraries() {
 bool GRTManager::load_modules() {
   if (_verbose)
     _shell->write_line(_("Loading modules..."));
+
+  // Modules described in the manifest are registered without loading them and get loaded on first use.
+  std::string manifest_file = startup_cache_file("grt_modules.cache");
+  std::unique_ptr<grt::ModuleManifest> manifest;
+  if (!manifest_file.empty() && !_deferred_module_patterns.empty()) {
+    manifest.reset(new grt::ModuleManifest(_deferred_module_patterns));
+    manifest->load(manifest_file);
+    _grt->set_module_manifest(manifest.get());
+  }
+
   scan_modules_grt(_module_extensions, false);
 
+  if (manifest) {
+    _grt->set_module_manifest(nullptr);
+    if (manifest->update(_grt->get_modules()))
+      manifest->save(manifest_file);
+
+    if (manifest->deferred_count() > 0)
+      logInfo("Deferred loading of %i modules until first use\n", (int)manifest->deferred_count());
+  }
+
   return true;
 }
 
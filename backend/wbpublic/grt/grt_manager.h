@@ -89,6 +89,22 @@ namespace bec {
 
     void set_module_extensions(const std::list<std::string> &extensions);
 
+    // The startup caches (binary metaclass registry and module manifest) are kept in the "cache" folder
+    // of the user data dir. They are rebuilt automatically when any of the source files change.
+    void set_use_startup_cache(bool flag) {
+      _use_startup_cache = flag;
+    }
+
+    // File name patterns of modules whose loading is deferred until first use, if they are in the manifest.
+    void set_deferred_module_patterns(const std::list<std::string> &patterns) {
+      _deferred_module_patterns = patterns;
+    }
+
+    // Time (in seconds) spent in each phase of initialize(), in order.
+    const std::vector<std::pair<std::string, double> > &get_startup_timings() const {
+      return _startup_timings;
+    }
+
     void rescan_modules();
     int do_scan_modules(const std::string &path, const std::list<std::string> &exts, bool refresh);
     void scan_modules_grt(const std::list<std::string> &extensions, bool refresh);
@@ -125,6 +141,11 @@ namespace bec {
       return _dispatcher;
     };
 
+    // A multi-worker dispatcher for self-contained background jobs (file exports, cache writes) that must not
+    // wait behind the GRT tasks of the main dispatcher. Its tasks don't get GRT messages routed to them.
+    // Jobs that must not overlap (e.g. work on the same connection) share a task affinity key.
+    GRTDispatcher::Ref get_background_dispatcher();
+
     void cleanUpAndReinitialize();
 
     void initialize(bool init_python, const std::string &loader_module_path = "");
@@ -221,6 +242,8 @@ namespace bec {
   protected:
     bool _has_unsaved_changes;
     GRTDispatcher::Ref _dispatcher;
+    GRTDispatcher::Ref _background_dispatcher;
+    base::Mutex _background_dispatcher_mutex;
     base::Mutex _idle_mutex;
     base::Mutex _idle_task_blocker_mutex;
     base::Mutex _timer_mutex;
@@ -255,6 +278,9 @@ namespace bec {
     int _idle_blocked;
 
     std::list<std::string> _module_extensions;
+    std::list<std::string> _deferred_module_patterns;
+    std::vector<std::pair<std::string, double> > _startup_timings;
+    bool _use_startup_cache;
 
     std::string _basedir;
     std::string _datadir;
@@ -282,6 +308,7 @@ namespace bec {
     virtual bool init_module_loaders(const std::string &loader_module_path, bool init_python);
 
     bool init_loaders(const std::string &loader_module_path, bool init_python);
+    std::string startup_cache_file(const std::string &name);
 
     void flush_shell_output();
 
@@ -293,5 +320,6 @@ namespace bec {
     grt::ValueRef setup_grt();
     void shell_write(const std::string &text);
     void task_error_cb(const std::exception &error, const std::string &title);
+    void shutdown_background_dispatcher();
   };
 };
@@ -23,12 +23,19 @@
 
 #include "spatial_handler.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("spatial");
 
+// Layers with fewer features are projected on the calling thread, a worker needs at least this many features.
+static const size_t PARALLEL_RENDER_MIN_FEATURES = 1000;
+
 #ifdef _MSC_VER
 static void __stdcall ogr_error_handler(CPLErr eErrClass, int err_no, const char *msg) {
   logError("gdal error: %d, %s\n", err_no, msg);
@@ -220,6 +227,201 @@ double spatial::ShapeContainer::distance_point(const base::Point &p) const {
 spatial::ShapeContainer::ShapeContainer() : type(ShapeUnknown) {
 }
 
+const size_t spatial::EnvelopeTree::node_capacity;
+
+void spatial::EnvelopeTree::clear() {
+  _nodes.clear();
+  _items.clear();
+  _item_boxes.clear();
+}
+
+// Sorts entries by their center, x first, then cuts them into vertical slices which are sorted by y
+// and packed into groups of node_capacity entries.
+template <class GetBox>
+static void str_pack(std::vector<size_t> &entries, GetBox get_box) {
+  const size_t capacity = spatial::EnvelopeTree::node_capacity;
+  size_t node_count = (entries.size() + capacity - 1) / capacity;
+  size_t slice_count = (size_t)ceil(sqrt((double)node_count));
+  size_t slice_size = slice_count * capacity;
+
+  std::sort(entries.begin(), entries.end(), [&](size_t a, size_t b) {
+    return get_box(a).min_x + get_box(a).max_x < get_box(b).min_x + get_box(b).max_x;
+  });
+  for (size_t start = 0; start < entries.size(); start += slice_size) {
+    auto end = entries.begin() + std::min(entries.size(), start + slice_size);
+    std::sort(entries.begin() + start, end, [&](size_t a, size_t b) {
+      return get_box(a).min_y + get_box(a).max_y < get_box(b).min_y + get_box(b).max_y;
+    });
+  }
+}
+
+void spatial::EnvelopeTree::build(const std::vector<base::Rect> &bounds) {
+  clear();
+  if (bounds.empty())
+    return;
+
+  _item_boxes.reserve(bounds.size());
+  for (auto &rect : bounds)
+    _item_boxes.push_back({ rect.pos.x, rect.pos.y, rect.pos.x + rect.size.width, rect.pos.y + rect.size.height });
+
+  _items.resize(bounds.size());
+  for (size_t i = 0; i < _items.size(); ++i)
+    _items[i] = i;
+  str_pack(_items, [this](size_t i) -> const Box & { return _item_boxes[i]; });
+
+  auto make_node = [](const Box *boxes[], size_t count, size_t first, bool leaf) {
+    Node node = { *boxes[0], first, count, leaf };
+    for (size_t i = 1; i < count; ++i) {
+      node.box.min_x = std::min(node.box.min_x, boxes[i]->min_x);
+      node.box.min_y = std::min(node.box.min_y, boxes[i]->min_y);
+      node.box.max_x = std::max(node.box.max_x, boxes[i]->max_x);
+      node.box.max_y = std::max(node.box.max_y, boxes[i]->max_y);
+    }
+    return node;
+  };
+
+  // Leaves, each one covering a consecutive run of _items.
+  const Box *boxes[node_capacity];
+  std::vector<Node> level;
+  for (size_t first = 0; first < _items.size(); first += node_capacity) {
+    size_t count = std::min(node_capacity, _items.size() - first);
+    for (size_t i = 0; i < count; ++i)
+      boxes[i] = &_item_boxes[_items[first + i]];
+    level.push_back(make_node(boxes, count, first, true));
+  }
+
+  // Pack every level into the next one until a single root is left. Nodes are stored top down,
+  // the root first, so children of a node always form a consecutive run further back in _nodes.
+  std::vector<std::vector<Node> > levels;
+  while (level.size() > 1) {
+    std::vector<size_t> order(level.size());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    str_pack(order, [&level](size_t i) -> const Box & { return level[i].box; });
+
+    std::vector<Node> sorted;
+    sorted.reserve(level.size());
+    for (size_t i : order)
+      sorted.push_back(level[i]);
+
+    std::vector<Node> parents;
+    for (size_t first = 0; first < sorted.size(); first += node_capacity) {
+      size_t count = std::min(node_capacity, sorted.size() - first);
+      for (size_t i = 0; i < count; ++i)
+        boxes[i] = &sorted[first + i].box;
+      parents.push_back(make_node(boxes, count, first, false)); // first is relative to the child level for now
+    }
+    levels.push_back(std::move(sorted));
+    level = std::move(parents);
+  }
+  levels.push_back(std::move(level));
+
+  size_t total = 0;
+  for (auto &l : levels)
+    total += l.size();
+  _nodes.reserve(total);
+
+  size_t child_offset = 0;
+  for (auto it = levels.rbegin(); it != levels.rend(); ++it) {
+    child_offset += it->size();
+    for (auto &node : *it) {
+      if (!node.leaf)
+        node.first += child_offset;
+      _nodes.push_back(node);
+    }
+  }
+}
+
+void spatial::EnvelopeTree::query(const base::Rect &area, std::vector<size_t> &result) const {
+  result.clear();
+  if (_nodes.empty())
+    return;
+
+  Box box = { area.pos.x, area.pos.y, area.pos.x + area.size.width, area.pos.y + area.size.height };
+  auto intersects = [&box](const Box &other) {
+    return other.min_x <= box.max_x && other.max_x >= box.min_x && other.min_y <= box.max_y && other.max_y >= box.min_y;
+  };
+
+  std::vector<size_t> stack(1, 0);
+  while (!stack.empty()) {
+    const Node &node = _nodes[stack.back()];
+    stack.pop_back();
+    if (!intersects(node.box))
+      continue;
+
+    for (size_t i = node.first; i < node.first + node.count; ++i) {
+      if (!node.leaf)
+        stack.push_back(i);
+      else if (intersects(_item_boxes[_items[i]]))
+        result.push_back(_items[i]);
+    }
+  }
+  std::sort(result.begin(), result.end());
+}
+
+static void simplify_range(const std::vector<base::Point> &points, size_t first, size_t last, double tolerance,
+                           std::vector<bool> &keep) {
+  std::vector<std::pair<size_t, size_t> > ranges(1, std::make_pair(first, last));
+  while (!ranges.empty()) {
+    std::pair<size_t, size_t> range = ranges.back();
+    ranges.pop_back();
+
+    double max_distance = 0;
+    size_t farthest = range.first;
+    for (size_t i = range.first + 1; i < range.second; ++i) {
+      double distance = distance_to_segment(points[range.first], points[range.second], points[i]);
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+
+    if (max_distance > tolerance) {
+      keep[farthest] = true;
+      ranges.push_back(std::make_pair(range.first, farthest));
+      ranges.push_back(std::make_pair(farthest, range.second));
+    }
+  }
+}
+
+void spatial::simplify_points(const std::vector<base::Point> &points, double tolerance, bool ring,
+                              std::vector<base::Point> &result) {
+  result.clear();
+  if (points.size() < 3) {
+    result = points;
+    return;
+  }
+
+  std::vector<bool> keep(points.size(), false);
+  size_t last = points.size() - 1;
+  keep[0] = keep[last] = true;
+
+  if (ring) {
+    // Start and end of a ring are the same point, split it at the point farthest away from there, so even a ring
+    // smaller than the tolerance keeps some area.
+    size_t farthest = 0;
+    double max_distance = 0;
+    for (size_t i = 1; i < last; ++i) {
+      double distance = sqrt(pow(points[i].x - points[0].x, 2) + pow(points[i].y - points[0].y, 2));
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+    if (farthest > 0) {
+      keep[farthest] = true;
+      simplify_range(points, 0, farthest, tolerance, keep);
+      simplify_range(points, farthest, last, tolerance, keep);
+    }
+  } else
+    simplify_range(points, 0, last, tolerance, keep);
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    if (keep[i])
+      result.push_back(points[i]);
+  }
+}
+
 std::string spatial::shape_description(ShapeType shp) {
   switch (shp) {
     case ShapePolygon:
@@ -727,51 +929,86 @@ bool spatial::Converter::from_proj_to_latlon(double &lat, double &lon) {
   return _proj_to_geo->Transform(1, &lat, &lon) != 0;
 }
 
-void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container) {
+OGRCoordinateTransformation *spatial::Converter::create_transformation() {
+  base::RecMutexLock mtx(_projection_protector);
+  return OGRCreateCoordinateTransformation(_source_srs, _target_srs);
+}
+
+void spatial::Converter::release_transformation(OGRCoordinateTransformation *transformation) {
+  if (transformation != NULL)
+    OCTDestroyCoordinateTransformation(transformation);
+}
+
+void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container,
+                                          OGRCoordinateTransformation *transformation) {
+  if (transformation == NULL)
+    transformation = _geo_to_proj;
+
+  // Take a copy of the screen mapping once, instead of locking for every single point.
+  double inv_projection[6];
+  {
+    base::RecMutexLock mtx(_projection_protector);
+    std::copy(_inv_projection, _inv_projection + 6, inv_projection);
+  }
+  auto to_screen = [&inv_projection](double &x, double &y) {
+    x = (int)(inv_projection[0] + inv_projection[1] * x);
+    y = (int)(inv_projection[3] + inv_projection[5] * y);
+  };
+
+  // Points of a shape are transformed as one batch, which is much cheaper than one call per point.
+  std::vector<double> xs, ys;
+  std::vector<int> success;
   std::deque<ShapeContainer>::iterator it;
   for (it = shapes_container.begin(); it != shapes_container.end() && !_interrupt; it++) {
-    std::deque<size_t> for_removal;
-    for (size_t i = 0; i < (*it).points.size() && !_interrupt; i++) {
-      if (!_geo_to_proj->Transform(1, &(*it).points[i].x, &(*it).points[i].y))
-        for_removal.push_back(i);
+    std::vector<base::Point> &points = (*it).points;
+    size_t count = points.size();
+    xs.resize(count);
+    ys.resize(count);
+    success.assign(count, 0);
+    for (size_t i = 0; i < count; i++) {
+      xs[i] = points[i].x;
+      ys[i] = points[i].y;
     }
-
-    if (_geo_to_proj->Transform(1, &(*it).bounding_box.bottom_right.x, &(*it).bounding_box.bottom_right.y) &&
-        _geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y)) {
-      int x, y;
-      from_projected((*it).bounding_box.bottom_right.x, (*it).bounding_box.bottom_right.y, x, y);
-      (*it).bounding_box.bottom_right.x = x;
-      (*it).bounding_box.bottom_right.y = y;
-      from_projected((*it).bounding_box.top_left.x, (*it).bounding_box.top_left.y, x, y);
-      (*it).bounding_box.top_left.x = x;
-      (*it).bounding_box.top_left.y = y;
-      (*it).bounding_box.converted = true;
+    if (count > 0)
+      transformation->Transform((int)count, xs.data(), ys.data(), NULL, success.data());
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (!success[i])
+        continue;
+      to_screen(xs[i], ys[i]);
+      points[kept++] = base::Point(xs[i], ys[i]);
+    }
+    if (kept != count) {
+      logDebug("%i points that could not be converted were skipped\n", (int)(count - kept));
+      points.resize(kept);
     }
 
-    if (!for_removal.empty())
-      logDebug("%i points that could not be converted were skipped\n", (int)for_removal.size());
-
-    std::deque<size_t>::reverse_iterator rit;
-    for (rit = for_removal.rbegin(); rit != for_removal.rend() && !_interrupt; rit++)
-      (*it).points.erase((*it).points.begin() + *rit);
-
-    for (size_t i = 0; i < (*it).points.size() && !_interrupt; i++) {
-      int x, y;
-      from_projected((*it).points[i].x, (*it).points[i].y, x, y);
-      (*it).points[i].x = x;
-      (*it).points[i].y = y;
+    Envelope &box = (*it).bounding_box;
+    double box_xs[2] = { box.bottom_right.x, box.top_left.x };
+    double box_ys[2] = { box.bottom_right.y, box.top_left.y };
+    int box_success[2] = { 0, 0 };
+    transformation->Transform(2, box_xs, box_ys, NULL, box_success);
+    if (box_success[0] && box_success[1]) {
+      to_screen(box_xs[0], box_ys[0]);
+      to_screen(box_xs[1], box_ys[1]);
+      box.bottom_right = base::Point(box_xs[0], box_ys[0]);
+      box.top_left = base::Point(box_xs[1], box_ys[1]);
+      box.converted = true;
     }
   }
 }
 
-void spatial::Converter::transform_envelope(spatial::Envelope &env) {
+void spatial::Converter::transform_envelope(spatial::Envelope &env, OGRCoordinateTransformation *transformation) {
   if (!env.is_init()) {
     logError("Can't transform empty envelope.\n");
     return;
   }
 
-  if (_geo_to_proj->Transform(1, &env.top_left.x, &env.top_left.y) &&
-      _geo_to_proj->Transform(1, &env.bottom_right.x, &env.bottom_right.y)) {
+  if (transformation == NULL)
+    transformation = _geo_to_proj;
+  if (transformation->Transform(1, &env.top_left.x, &env.top_left.y) &&
+      transformation->Transform(1, &env.bottom_right.x, &env.bottom_right.y)) {
     int x, y;
     from_projected(env.bottom_right.x, env.bottom_right.y, x, y);
     env.bottom_right.x = x;
@@ -811,16 +1048,66 @@ void Feature::get_envelope(spatial::Envelope &env, const bool &screen_coords) {
   env = _env_screen;
 }
 
-void Feature::render(Converter *converter) {
+void Feature::render(Converter *converter, OGRCoordinateTransformation *transformation) {
   std::deque<ShapeContainer> tmp_shapes;
   _geometry.get_points(tmp_shapes);
-  converter->transform_points(tmp_shapes);
+  converter->transform_points(tmp_shapes, transformation);
   spatial::Envelope env;
   _geometry.get_envelope(env);
-  converter->transform_envelope(env);
+  converter->transform_envelope(env, transformation);
   _env_screen = env;
 
   _shapes = tmp_shapes;
+  _lod_shapes.clear();
+}
+
+bool Feature::screen_bounds(base::Rect &bounds) const {
+  bool found = false;
+  double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+  for (auto &shape : _shapes) {
+    for (auto &point : shape.points) {
+      if (!found) {
+        min_x = max_x = point.x;
+        min_y = max_y = point.y;
+        found = true;
+        continue;
+      }
+      min_x = std::min(min_x, point.x);
+      min_y = std::min(min_y, point.y);
+      max_x = std::max(max_x, point.x);
+      max_y = std::max(max_y, point.y);
+    }
+  }
+  if (found)
+    bounds = base::Rect(min_x, min_y, max_x - min_x, max_y - min_y);
+  return found;
+}
+
+// Screen points are in pixels at zoom 1. Each power of 2 of the zoom gets its own simplified copy of the shapes,
+// with a tolerance of half a device pixel for the lowest scale of that level.
+const std::deque<ShapeContainer> &Feature::shapes_for_scale(float scale) {
+  int level = scale > 1 ? std::min(16, (int)std::floor(std::log2(scale))) : 0;
+  auto cached = _lod_shapes.find(level);
+  if (cached == _lod_shapes.end()) {
+    double tolerance = 0.5 / (1 << level);
+    std::deque<ShapeContainer> simplified;
+    bool changed = false;
+    for (auto &shape : _shapes) {
+      simplified.push_back(ShapeContainer());
+      ShapeContainer &copy = simplified.back();
+      copy.type = shape.type;
+      copy.bounding_box = shape.bounding_box;
+      if (shape.type == ShapePolygon || shape.type == ShapeLineString)
+        simplify_points(shape.points, tolerance, shape.type == ShapePolygon, copy.points);
+      else
+        copy.points = shape.points;
+      changed = changed || copy.points.size() != shape.points.size();
+    }
+    if (!changed)
+      simplified.clear(); // Nothing to gain, don't keep a copy around.
+    cached = _lod_shapes.insert(std::make_pair(level, std::move(simplified))).first;
+  }
+  return cached->second.empty() ? _shapes : cached->second;
 }
 
 double Feature::distance(const base::Point &p, const double &allowed_distance) {
@@ -851,7 +1138,9 @@ void Feature::interrupt() {
 }
 
 void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area, base::Color fill_color) {
-  for (std::deque<ShapeContainer>::iterator it = _shapes.begin(); it != _shapes.end() && !_owner->_interrupt; it++) {
+  const std::deque<ShapeContainer> &shapes = shapes_for_scale(scale);
+  for (std::deque<ShapeContainer>::const_iterator it = shapes.begin(); it != shapes.end() && !_owner->_interrupt;
+       it++) {
     if ((*it).points.empty()) {
       logError("%s is empty", shape_description(it->type).c_str());
       continue;
@@ -953,6 +1242,7 @@ void Layer::add_feature(int row_id, const std::string &geom_data, bool wkt) {
   feature->get_envelope(env);
   extend_env(_spatial_envelope, env);
   _features.push_back(feature);
+  _feature_index.clear(); // Needs screen coordinates, rebuilt on the next render().
 }
 
 void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area) {
@@ -965,8 +1255,19 @@ void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area)
   color.green *= 0.6;
   color.blue *= 0.6;
   cr.set_color(color);
-  for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
-    (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::invalid());
+  base::Color fill_color = _fill_polygons ? _color : base::Color::invalid();
+  if (clip_area.empty() || _feature_index.empty()) {
+    for (std::deque<Feature *>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
+      (*it)->repaint(cr, scale, clip_area, fill_color);
+  } else {
+    // Point markers are drawn with a fixed size on screen, make sure those at the border are not cut off.
+    base::Rect area = clip_area;
+    area.inflate(-6 / scale, -6 / scale);
+    std::vector<size_t> visible;
+    _feature_index.query(area, visible);
+    for (std::vector<size_t>::const_iterator it = visible.begin(); it != visible.end() && !_interrupt; ++it)
+      _features[*it]->repaint(cr, scale, clip_area, fill_color);
+  }
 
   cr.restore();
 }
@@ -983,16 +1284,81 @@ void Layer::render(Converter *converter) {
   _render_progress = 0.0;
   float step = 1.0f / _features.size();
 
-  for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
-       ++iter) {
-    (*iter)->render(converter);
-    _render_progress += step;
+  // Each worker gets a contiguous range of features and its own transformation.
+  size_t worker_count = std::min<size_t>(std::thread::hardware_concurrency(),
+                                         _features.size() / PARALLEL_RENDER_MIN_FEATURES);
+  std::vector<OGRCoordinateTransformation *> transformations;
+  for (size_t i = 0; i < worker_count; ++i) {
+    OGRCoordinateTransformation *transformation = converter->create_transformation();
+    if (transformation == NULL)
+      break;
+    transformations.push_back(transformation);
+  }
+
+  if (transformations.size() < 2) {
+    for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
+         ++iter) {
+      (*iter)->render(converter);
+      _render_progress += step;
+    }
+  } else {
+    size_t count = _features.size();
+    size_t chunk = (count + transformations.size() - 1) / transformations.size();
+    std::atomic<size_t> done(0);
+    std::atomic<size_t> finished_workers(0);
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < transformations.size(); ++w) {
+      workers.push_back(std::thread([this, converter, &transformations, &done, &finished_workers, w, chunk, count]() {
+        for (size_t i = w * chunk; i < std::min(count, (w + 1) * chunk) && !_interrupt; ++i) {
+          _features[i]->render(converter, transformations[w]);
+          ++done;
+        }
+        ++finished_workers;
+      }));
+    }
+
+    // Progress is reported from here, so it is only ever written by one thread.
+    while (finished_workers < workers.size()) {
+      _render_progress = (float)done / count;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    for (auto &worker : workers)
+      worker.join();
+    _render_progress = (float)done / count;
+  }
+
+  for (auto transformation : transformations)
+    Converter::release_transformation(transformation);
+
+  _feature_index.clear();
+  if (!_interrupt) {
+    // Features without any point get an empty rect far outside, so positions in the index match _features.
+    std::vector<base::Rect> bounds(_features.size(), base::Rect(-1e12, -1e12, 0, 0));
+    for (size_t i = 0; i < _features.size(); ++i)
+      _features[i]->screen_bounds(bounds[i]);
+    _feature_index.build(bounds);
   }
 }
 
 spatial::Feature *Layer::feature_closest(const base::Point &p, const double &allowed_distance) {
   double rval = -1;
   spatial::Feature *f = NULL;
+  if (!_feature_index.empty()) {
+    std::vector<size_t> candidates;
+    _feature_index.query(base::Rect(p.x - allowed_distance, p.y - allowed_distance, 2 * allowed_distance,
+                                    2 * allowed_distance),
+                         candidates);
+    for (std::vector<size_t>::const_iterator iter = candidates.begin(); iter != candidates.end() && !_interrupt;
+         ++iter) {
+      double dist = _features[*iter]->distance(p, allowed_distance);
+      if (dist < allowed_distance && dist != -1 && (dist < rval || rval == -1)) {
+        rval = dist;
+        f = _features[*iter];
+      }
+    }
+    return f;
+  }
+
   for (std::deque<spatial::Feature *>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt;
        ++iter) {
     double dist = (*iter)->distance(p, allowed_distance);
@@ -30,7 +30,10 @@
 #include <gdal/memdataset.h>
 #include <gdal/gdal_alg.h>
 #include <gdal/gdal.h>
+#include <atomic>
 #include <deque>
+#include <map>
+#include <vector>
 #include "base/geometry.h"
 #include "wbpublic_public_interface.h"
 
@@ -108,6 +111,39 @@ namespace spatial {
     double distance(const base::Point &p) const;
   };
 
+  // Static R-tree over rectangles, bulk loaded with Sort-Tile-Recursive packing.
+  // Items are identified by their position in the vector passed to build().
+  class WBPUBLICBACKEND_PUBLIC_FUNC EnvelopeTree {
+    struct Box {
+      double min_x, min_y, max_x, max_y;
+    };
+    struct Node {
+      Box box;
+      size_t first; // first child node, or first slot in _items for leaves
+      size_t count;
+      bool leaf;
+    };
+    std::vector<Node> _nodes;
+    std::vector<size_t> _items;
+    std::vector<Box> _item_boxes;
+
+  public:
+    static const size_t node_capacity = 16;
+
+    void build(const std::vector<base::Rect> &bounds);
+    void clear();
+    bool empty() const {
+      return _nodes.empty();
+    }
+
+    // Collects all items whose rectangle intersects area, in ascending item order.
+    void query(const base::Rect &area, std::vector<size_t> &result) const;
+  };
+
+  // Douglas-Peucker simplification of a polyline, rings keep at least the point farthest from their start.
+  WBPUBLICBACKEND_PUBLIC_FUNC void simplify_points(const std::vector<base::Point> &points, double tolerance,
+                                                   bool ring, std::vector<base::Point> &result);
+
   class WBPUBLICBACKEND_PUBLIC_FUNC Projection {
   protected:
     OGRSpatialReference _mercator_srs;
@@ -129,7 +165,7 @@ namespace spatial {
 
   class WBPUBLICBACKEND_PUBLIC_FUNC Importer {
     OGRGeometry *_geometry;
-    bool _interrupt;
+    std::atomic<bool> _interrupt;
     void extract_points(OGRGeometry *shape, std::deque<ShapeContainer> &shapes_container);
     int _srid;
 
@@ -162,7 +198,7 @@ namespace spatial {
     OGRSpatialReference *_source_srs;
     OGRSpatialReference *_target_srs;
     ProjectionView _view;
-    bool _interrupt;
+    std::atomic<bool> _interrupt;
 
   public:
     Converter(ProjectionView view, OGRSpatialReference *src_srs, OGRSpatialReference *dst_srs);
@@ -179,8 +215,14 @@ namespace spatial {
     bool from_latlon_to_proj(double &lat, double &lon);
     bool from_proj_to_latlon(double &lat, double &lon);
     static std::string dec_to_dms(double angle, AxisType axis, int precision);
-    void transform_points(std::deque<ShapeContainer> &shapes_container);
-    void transform_envelope(spatial::Envelope &env);
+
+    // Transformations are not thread safe, every worker thread needs its own one.
+    OGRCoordinateTransformation *create_transformation();
+    static void release_transformation(OGRCoordinateTransformation *transformation);
+
+    void transform_points(std::deque<ShapeContainer> &shapes_container,
+                          OGRCoordinateTransformation *transformation = NULL);
+    void transform_envelope(spatial::Envelope &env, OGRCoordinateTransformation *transformation = NULL);
     void interrupt();
   };
 
@@ -191,15 +233,18 @@ namespace spatial {
     int _row_id;
     Importer _geometry;
     std::deque<ShapeContainer> _shapes;
+    std::map<int, std::deque<ShapeContainer> > _lod_shapes; // Simplified _shapes per zoom level, empty if no gain.
     spatial::Envelope _env_screen;
 
+    const std::deque<ShapeContainer> &shapes_for_scale(float scale);
+
   public:
     Feature(Layer *layer, int row_id, const std::string &data, bool wkt);
     ~Feature();
 
     void interrupt();
     void get_envelope(spatial::Envelope &env, const bool &screen_coords = false);
-    void render(spatial::Converter *converter);
+    void render(spatial::Converter *converter, OGRCoordinateTransformation *transformation = NULL);
     void repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area,
                  base::Color fill_color = base::Color::invalid());
 
@@ -207,6 +252,7 @@ namespace spatial {
       return _row_id;
     }
     double distance(const base::Point &p, const double &allowed_distance = 4.0);
+    bool screen_bounds(base::Rect &bounds) const;
   };
 
   typedef int LayerId;
@@ -217,12 +263,13 @@ namespace spatial {
 
   protected:
     std::deque<Feature *> _features;
+    EnvelopeTree _feature_index; // Screen bounds of _features, built by render().
 
     LayerId _layer_id;
     base::Color _color;
     float _render_progress;
     bool _show;
-    bool _interrupt;
+    std::atomic<bool> _interrupt;
     spatial::Envelope _spatial_envelope;
     bool _fill_polygons;
 
@@ -28,23 +28,6 @@
 using namespace grt;
 using namespace bec;
 
-NodeId::NodeId() {
-}
-
-//--------------------------------------------------------------------------------------------------
-
-NodeId::NodeId(const NodeId &copy) {
-  index = copy.index;
-}
-
-//--------------------------------------------------------------------------------------------------
-
-NodeId::NodeId(size_t i) {
-  index.push_back(i);
-}
-
-//--------------------------------------------------------------------------------------------------
-
 NodeId::NodeId(const std::string &str) {
   try {
     const char *chr = str.c_str();
@@ -72,11 +55,6 @@ NodeId::NodeId(const std::string &str) {
   }
 }
 
-//--------------------------------------------------------------------------------------------------
-
-NodeId::~NodeId() {
-  index.clear();
-}
 
 //--------------------------------------------------------------------------------------------------
 
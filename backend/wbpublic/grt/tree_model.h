@@ -59,6 +59,196 @@ namespace bec {
    * @ingroup begrt
    */
 
+  /**
+    \class NodePath
+    \brief Storage for the path of a NodeId
+
+    Behaves like the subset of std::vector<size_t> which NodeId needs. Paths of up to InlineDepth entries (list rows
+    and the usual tree nodes) are kept inline, so creating and copying such node ids never touches the heap. Deeper
+    paths move to a heap allocated array.
+  */
+  class NodePath {
+  public:
+    typedef size_t value_type;
+    typedef size_t *iterator;
+    typedef const size_t *const_iterator;
+
+    static const size_t InlineDepth = 4;
+
+    NodePath() : _size(0), _capacity(InlineDepth) {
+    }
+
+    NodePath(const NodePath &other) : _size(0), _capacity(InlineDepth) {
+      assign(other.data(), other._size);
+    }
+
+    NodePath(NodePath &&other) noexcept : _size(0), _capacity(InlineDepth) {
+      take(other);
+    }
+
+    ~NodePath() {
+      if (!is_inline())
+        delete[] _heap;
+    }
+
+    NodePath &operator=(const NodePath &other) {
+      if (this != &other)
+        assign(other.data(), other._size);
+      return *this;
+    }
+
+    NodePath &operator=(NodePath &&other) noexcept {
+      if (this != &other) {
+        if (!is_inline())
+          delete[] _heap;
+        _size = 0;
+        _capacity = InlineDepth;
+        take(other);
+      }
+      return *this;
+    }
+
+    inline bool is_inline() const {
+      return _capacity == InlineDepth;
+    }
+
+    inline size_t *data() {
+      return is_inline() ? _inline : _heap;
+    }
+
+    inline const size_t *data() const {
+      return is_inline() ? _inline : _heap;
+    }
+
+    inline size_t size() const {
+      return _size;
+    }
+
+    inline size_t capacity() const {
+      return _capacity;
+    }
+
+    inline bool empty() const {
+      return _size == 0;
+    }
+
+    inline iterator begin() {
+      return data();
+    }
+
+    inline iterator end() {
+      return data() + _size;
+    }
+
+    inline const_iterator begin() const {
+      return data();
+    }
+
+    inline const_iterator end() const {
+      return data() + _size;
+    }
+
+    inline size_t &operator[](size_t i) {
+      return data()[i];
+    }
+
+    inline const size_t &operator[](size_t i) const {
+      return data()[i];
+    }
+
+    size_t &at(size_t i) {
+      if (i >= _size)
+        throw std::out_of_range("NodePath index out of range");
+      return data()[i];
+    }
+
+    const size_t &at(size_t i) const {
+      if (i >= _size)
+        throw std::out_of_range("NodePath index out of range");
+      return data()[i];
+    }
+
+    inline size_t &back() {
+      return data()[_size - 1];
+    }
+
+    inline const size_t &back() const {
+      return data()[_size - 1];
+    }
+
+    inline void push_back(size_t value) {
+      if (_size == _capacity)
+        grow(_capacity * 2);
+      data()[_size++] = value;
+    }
+
+    inline void pop_back() {
+      --_size;
+    }
+
+    inline void clear() {
+      _size = 0;
+    }
+
+    iterator insert(iterator position, size_t value) {
+      size_t offset = position - data();
+      if (_size == _capacity)
+        grow(_capacity * 2);
+      size_t *items = data();
+      std::copy_backward(items + offset, items + _size, items + _size + 1);
+      items[offset] = value;
+      ++_size;
+      return items + offset;
+    }
+
+    bool operator==(const NodePath &other) const {
+      return _size == other._size && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const NodePath &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    size_t _size;
+    size_t _capacity;
+    union {
+      size_t _inline[InlineDepth];
+      size_t *_heap;
+    };
+
+    void assign(const size_t *items, size_t count) {
+      if (count > _capacity)
+        grow(count);
+      std::copy(items, items + count, data());
+      _size = count;
+    }
+
+    // Expects this path to be empty and inline.
+    void take(NodePath &other) {
+      if (other.is_inline())
+        assign(other._inline, other._size);
+      else {
+        _heap = other._heap;
+        _capacity = other._capacity;
+        _size = other._size;
+        other._capacity = InlineDepth;
+      }
+      other._size = 0;
+    }
+
+    void grow(size_t capacity) {
+      size_t *items = new size_t[capacity];
+      std::copy(data(), data() + _size, items);
+      if (!is_inline())
+        delete[] _heap;
+      _heap = items;
+      _capacity = capacity;
+    }
+  };
+
+  //----------------------------------------------------------------------------
+
   /**
     \class NodeId
     \brief descibes path to a node starting from root for a Tree or it will contain an index (single entry) for List
@@ -70,14 +260,23 @@ namespace bec {
   struct WBPUBLICBACKEND_PUBLIC_FUNC NodeId {
     typedef std::string *uid; //!< To map short-living NodeId path to a persistent value
                               //!< This is needed for Gtk::TreeModel iterators
-    typedef std::vector<size_t> Index;
+    typedef NodePath Index;
     Index index; //!< Path itself
 
-    NodeId();
-    NodeId(const NodeId &copy);
-    NodeId(size_t i);
+    NodeId() {
+    }
+
+    NodeId(const NodeId &copy) : index(copy.index) {
+    }
+
+    NodeId(NodeId &&other) noexcept : index(std::move(other.index)) {
+    }
+
+    NodeId(size_t i) {
+      index.push_back(i);
+    }
+
     NodeId(const std::string &str);
-    ~NodeId();
 
     inline NodeId &operator=(const NodeId &node) {
       index = node.index;
@@ -85,6 +284,12 @@ namespace bec {
       return *this;
     }
 
+    inline NodeId &operator=(NodeId &&node) noexcept {
+      index = std::move(node.index);
+
+      return *this;
+    }
+
     bool operator<(const NodeId &r) const;
 
     inline bool operator==(const NodeId &node) const {
@@ -171,14 +376,8 @@ namespace bec {
 
   //------------------------------------------------------------------------------
   inline NodeId::uid NodeIds::map_node_id(const std::string &path_from_nodeid) {
-    Map::const_iterator it = _map.find(path_from_nodeid);
-    if (_map.end() != it)
-      return (NodeId::uid) & (*it);
-    else {
-      // TODO: make a faster way. Probably we can use item from insert
-      _map.insert(path_from_nodeid);
-      return map_node_id(path_from_nodeid);
-    }
+    // insert() returns the existing entry if the path is already mapped.
+    return (NodeId::uid) & (*_map.insert(path_from_nodeid).first);
   }
 
   //------------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 #include "parsers-common.h"
 
 #include "grtdb/db_helpers.h"
+#include "grtsqlparser/statement_splitter.h"
 
 #include "grts/structs.db.mysql.h"
 
@@ -37,13 +38,6 @@ namespace parsers {
   class MySQLParser;
   class SymbolTable;
 
-  // Describes a single statement out of a list in a string.
-  struct WBPUBLICBACKEND_PUBLIC_FUNC StatementRange {
-    size_t line;   // The line number of the statement.
-    size_t start;  // The byte start offset of the statement.
-    size_t length; // The length of the statements in bytes.
-  };
-
   struct WBPUBLICBACKEND_PUBLIC_FUNC MySQLParserContext {
     typedef std::shared_ptr<MySQLParserContext> Ref;
 
@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPLITTER_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define SPLITTER_USE_NEON
+#include <arm_neon.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "base/string_utilities.h"
+
+#include "statement_splitter.h"
+
+using namespace parsers;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+  /**
+   * Finds the first occurrence of any byte out of a small set. Used to skip over runs of bytes which the splitter
+   * would otherwise look at one by one, only to step over them.
+   */
+  class ByteScanner {
+  public:
+    ByteScanner() : _count(0) {
+    }
+
+    void add(unsigned char c) {
+      for (size_t i = 0; i < _count; ++i)
+        if (_bytes[i] == c)
+          return;
+
+      _bytes[_count] = c;
+#if defined(SPLITTER_USE_SSE2)
+      _vectors[_count] = _mm_set1_epi8(static_cast<char>(c));
+#elif defined(SPLITTER_USE_NEON)
+      _vectors[_count] = vdupq_n_u8(c);
+#endif
+      ++_count;
+    }
+
+    void clear() {
+      _count = 0;
+    }
+
+    // Returns a pointer to the first byte in [p, end) which is in the set, or end if there is none
+    // (p itself if it is not less than end).
+    const unsigned char *find(const unsigned char *p, const unsigned char *end) const {
+#if defined(SPLITTER_USE_SSE2)
+      while (p + 16 <= end) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        __m128i hits = _mm_cmpeq_epi8(block, _vectors[0]);
+        for (size_t i = 1; i < _count; ++i)
+          hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _vectors[i]));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0)
+          return p + firstBit(mask);
+        p += 16;
+      }
+#elif defined(SPLITTER_USE_NEON)
+      while (p + 16 <= end) {
+        uint8x16_t block = vld1q_u8(p);
+        uint8x16_t hits = vceqq_u8(block, _vectors[0]);
+        for (size_t i = 1; i < _count; ++i)
+          hits = vorrq_u8(hits, vceqq_u8(block, _vectors[i]));
+
+        // Narrow each 0x00/0xFF lane to 4 bits, giving a 64 bit mask with one nibble per byte.
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        if (mask != 0)
+          return p + (__builtin_ctzll(mask) >> 2);
+        p += 16;
+      }
+#endif
+      for (; p < end; ++p) {
+        for (size_t i = 0; i < _count; ++i)
+          if (*p == _bytes[i])
+            return p;
+      }
+      return p;
+    }
+
+  private:
+    static const size_t MaxBytes = 12;
+
+    unsigned char _bytes[MaxBytes];
+#if defined(SPLITTER_USE_SSE2)
+    __m128i _vectors[MaxBytes];
+#elif defined(SPLITTER_USE_NEON)
+    uint8x16_t _vectors[MaxBytes];
+#endif
+    size_t _count;
+
+    static unsigned firstBit(unsigned mask) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return index;
+#else
+      return __builtin_ctz(mask);
+#endif
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  const unsigned char *skipLeadingWhitespace(const unsigned char *head, const unsigned char *tail) {
+    while (head < tail && *head <= ' ')
+      head++;
+    return head;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  bool isLineBreak(const unsigned char *head, const unsigned char *lineBreak) {
+    if (*lineBreak == '\0')
+      return false;
+
+    while (*head != '\0' && *lineBreak != '\0' && *head == *lineBreak) {
+      head++;
+      lineBreak++;
+    }
+    return *lineBreak == '\0';
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  // The bytes that start anything the main loop of the splitter handles specially.
+  void setupContentScanner(ByteScanner &scanner, const std::string &delimiter, const std::string &lineBreak) {
+    static const char specials[] = "/-#\"'`dD";
+
+    scanner.clear();
+    for (const char *c = specials; *c != '\0'; ++c)
+      scanner.add(static_cast<unsigned char>(*c));
+    scanner.add(static_cast<unsigned char>(delimiter.c_str()[0]));
+    if (!lineBreak.empty())
+      scanner.add(static_cast<unsigned char>(lineBreak[0]));
+  }
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+StatementSplitter::StatementSplitter(const std::string &initialDelimiter, const std::string &lineBreak)
+  : _initialDelimiter(initialDelimiter.empty() ? ";" : initialDelimiter),
+    _lineBreak(lineBreak),
+    _hiddenCommandsAreContent(true),
+    _stop(nullptr),
+    _partDelimiter(_initialDelimiter),
+    _partLine(0),
+    _partPrevious(0) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Scans the text once and adds a range for each statement found to the given list. The line of each range is
+ * the (zero based) line the statement starts on.
+ */
+void StatementSplitter::split(const char *sql, size_t length, std::vector<StatementRange> &ranges) const {
+  std::string delimiter = _initialDelimiter;
+  size_t line = 0;
+  splitText(sql, length, true, 0, delimiter, line, ranges);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t StatementSplitter::splitPart(const char *sql, size_t length, bool atEnd, std::vector<StatementRange> &ranges) {
+  size_t consumed = splitText(sql, length, atEnd, _partPrevious, _partDelimiter, _partLine, ranges);
+  if (consumed > 0)
+    _partPrevious = static_cast<unsigned char>(sql[consumed - 1]);
+  return consumed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * The actual splitter. Previous byte, delimiter and line describe the state at the start of the text. Delimiter and
+ * line are updated to the state at the end of the consumed part, which is the returned byte count. Unless atEnd is
+ * set, only text up to the end of the last statement terminated by a delimiter is consumed, as everything after it
+ * might still change with the text that follows.
+ */
+size_t StatementSplitter::splitText(const char *sql, size_t length, bool atEnd, unsigned char previousByte,
+                                    std::string &delimiter, size_t &line, std::vector<StatementRange> &ranges) const {
+  static const unsigned char keyword[] = "delimiter";
+
+  const unsigned char *delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+  const unsigned char *start = reinterpret_cast<const unsigned char *>(sql);
+  const unsigned char *head = start;
+  const unsigned char *tail = head;
+  const unsigned char *end = head + length;
+  const unsigned char *newLine = reinterpret_cast<const unsigned char *>(_lineBreak.c_str());
+
+  ByteScanner contentScanner;
+  setupContentScanner(contentScanner, delimiter, _lineBreak);
+
+  ByteScanner quoteScanners[3];
+  static const unsigned char quoteChars[] = { '"', '\'', '`' };
+  for (size_t i = 0; i < 3; ++i) {
+    quoteScanners[i].add(quoteChars[i]);
+    quoteScanners[i].add('\\');
+  }
+
+  size_t currentLine = line;
+  size_t statementStart = line;
+  bool haveContent = false; // Set when anything else but comments were found for the current statement.
+
+  // The splitter looks ahead a few bytes at a time (comment starts, the DELIMITER keyword, line breaks), which gives
+  // wrong results when the text is cut off there. Statements ending that close to the end are not consumed yet.
+  const size_t lookahead = 16 + _lineBreak.size();
+  const unsigned char *consumed = start;
+  size_t consumedRanges = ranges.size();
+  std::string consumedDelimiter; // Only set once the delimiter was changed after the last consumed statement.
+  bool delimiterChanged = false;
+  auto consume = [&](const unsigned char *position) {
+    if (!atEnd && position + lookahead > end)
+      return;
+    consumed = position;
+    consumedRanges = ranges.size();
+    line = currentLine;
+    delimiterChanged = false;
+  };
+
+  while ((_stop == nullptr || !*_stop) && tail < end) {
+    switch (*tail) {
+      case '/': { // Possible multi line comment or hidden (conditional) command.
+        if (*(tail + 1) == '*') {
+          tail += 2;
+          bool isHiddenCommand = (*tail == '!');
+          while (true) {
+            while (tail < end && *tail != '*') {
+              if (isLineBreak(tail, newLine))
+                ++currentLine;
+              tail++;
+            }
+
+            if (tail == end) // Unfinished comment.
+              break;
+            else {
+              if (*++tail == '/') {
+                tail++; // Skip the slash too.
+                break;
+              }
+            }
+          }
+
+          if (isHiddenCommand && _hiddenCommandsAreContent)
+            haveContent = true;
+          if (!haveContent && !isHiddenCommand) {
+            head = tail; // Skip over the comment.
+            statementStart = currentLine;
+          }
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '-': { // Possible single line comment.
+        const unsigned char *endChar = tail + 2;
+        if (*(tail + 1) == '-' && (*endChar == ' ' || *endChar == '\t' || isLineBreak(endChar, newLine))) {
+          // Skip everything until the end of the line.
+          tail += 2;
+          while (tail < end && !isLineBreak(tail, newLine))
+            tail++;
+
+          if (!haveContent) {
+            head = tail;
+            statementStart = currentLine;
+          }
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '#': { // MySQL single line comment.
+        while (tail < end && !isLineBreak(tail, newLine))
+          tail++;
+
+        if (!haveContent) {
+          head = tail;
+          statementStart = currentLine;
+        }
+
+        break;
+      }
+
+      case '"':
+      case '\'':
+      case '`': { // Quoted string/id. Skip this in a local loop.
+        haveContent = true;
+        unsigned char quote = *tail++;
+        const ByteScanner &scanner = quoteScanners[quote == '"' ? 0 : (quote == '\'' ? 1 : 2)];
+        while (true) {
+          tail = scanner.find(tail, end);
+          if (tail >= end || *tail == quote)
+            break;
+          tail += 2; // Skip any escaped character too.
+        }
+        if (*tail == quote)
+          tail++; // Skip trailing quote char if one was there.
+
+        break;
+      }
+
+      case 'd':
+      case 'D': {
+        haveContent = true;
+
+        // Possible start of the keyword DELIMITER. Must be at the start of the text or a character,
+        // which is not part of a regular MySQL identifier (0-9, A-Z, a-z, _, $, \u0080-\uffff).
+        unsigned char previous = tail > start ? *(tail - 1) : previousByte;
+        bool isIdentifierChar = previous >= 0x80 || (previous >= '0' && previous <= '9') ||
+                                ((previous | 0x20) >= 'a' && (previous | 0x20) <= 'z') || previous == '$' ||
+                                previous == '_';
+        if (!isIdentifierChar) {
+          const unsigned char *run = tail + 1;
+          const unsigned char *kw = keyword + 1;
+          int count = 9;
+          while (count-- > 1 && (*run++ | 0x20) == *kw++)
+            ;
+          if (count == 0 && *run == ' ') {
+            // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+            tail = run++;
+            while (run < end && !isLineBreak(run, newLine))
+              ++run;
+            if (!delimiterChanged) {
+              consumedDelimiter = delimiter;
+              delimiterChanged = true;
+            }
+            delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
+            delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+            setupContentScanner(contentScanner, delimiter, _lineBreak);
+
+            // Skip over the delimiter statement and any following line breaks.
+            while (isLineBreak(run, newLine)) {
+              ++currentLine;
+              ++run;
+            }
+            tail = run;
+            head = tail;
+            statementStart = currentLine;
+          } else
+            ++tail;
+        } else
+          ++tail;
+
+        break;
+      }
+
+      default:
+        if (isLineBreak(tail, newLine)) {
+          ++currentLine;
+          if (!haveContent)
+            ++statementStart;
+        }
+
+        if (*tail > ' ')
+          haveContent = true;
+        tail++;
+
+        // Once content was seen, everything up to the next byte in the scanner's set would come here too and only
+        // advance tail, so it can be skipped in one go.
+        if (haveContent)
+          tail = contentScanner.find(tail, end);
+        break;
+    }
+
+    if (*tail == *delimiterHead) {
+      // Found possible start of the delimiter. Check if it really is.
+      size_t count = delimiter.size();
+      if (count == 1) {
+        // Most common case. Trim the statement and check if it is not empty before adding the range.
+        head = skipLeadingWhitespace(head, tail);
+        if (head < tail)
+          ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+        head = ++tail;
+        statementStart = currentLine;
+        haveContent = false;
+        consume(tail);
+      } else {
+        const unsigned char *run = tail + 1;
+        const unsigned char *del = delimiterHead + 1;
+        while (count-- > 1 && (*run++ == *del++))
+          ;
+
+        if (count == 0) {
+          // Multi char delimiter is complete. Tail still points to the start of the delimiter.
+          // Run points to the first character after the delimiter.
+          head = skipLeadingWhitespace(head, tail);
+          if (head < tail)
+            ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+          tail = run;
+          head = run;
+          statementStart = currentLine;
+          haveContent = false;
+          consume(tail);
+        }
+      }
+    }
+  }
+
+  if (!atEnd) {
+    // Everything after the last consumed statement is split again together with the text that follows.
+    ranges.resize(consumedRanges);
+    if (delimiterChanged)
+      delimiter = consumedDelimiter;
+    return consumed - start;
+  }
+
+  // Add remaining text to the range list.
+  head = skipLeadingWhitespace(head, tail);
+  if (head < tail)
+    ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+
+  line = currentLine;
+  return length;
+}
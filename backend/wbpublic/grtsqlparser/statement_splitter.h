@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <string>
+#include <vector>
+
+namespace parsers {
+
+  // Describes a single statement out of a list in a string.
+  struct WBPUBLICBACKEND_PUBLIC_FUNC StatementRange {
+    size_t line;   // The line number of the statement.
+    size_t start;  // The byte start offset of the statement.
+    size_t length; // The length of the statements in bytes.
+  };
+
+  /**
+   * Splits a script into its statements, taking comments, quoted text and DELIMITER commands into account.
+   * Statements are returned as ranges in the original text, without the delimiter and leading whitespace.
+   *
+   * Text without anything of interest for the splitter (most of a script, especially long string literals in dumps)
+   * is skipped 16 bytes at a time, using SSE2 or NEON where available.
+   */
+  class WBPUBLICBACKEND_PUBLIC_FUNC StatementSplitter {
+  public:
+    StatementSplitter(const std::string &initialDelimiter = ";", const std::string &lineBreak = "\n");
+
+    // When set (the default), a hidden command (/*!50003 ... */) counts as statement content. Otherwise a comment
+    // following such a command at the start of a statement moves the statement start over both.
+    void setHiddenCommandsAreContent(bool flag) {
+      _hiddenCommandsAreContent = flag;
+    }
+
+    // Splitting stops early once the given flag becomes true.
+    void setStopFlag(const volatile bool *stop) {
+      _stop = stop;
+    }
+
+    void split(const char *sql, size_t length, std::vector<StatementRange> &ranges) const;
+
+    /**
+     * Splits a script which arrives in pieces (e.g. a file read block by block). The text passed in must start where
+     * the consumed part of the previous call ended and returns the number of bytes consumed, which is everything up
+     * to the end of the last statement terminated by its delimiter. The caller keeps the rest and passes it again,
+     * followed by the next piece. With atEnd set, all text is consumed and an unterminated statement is added too.
+     *
+     * The current delimiter and line are kept between calls, so ranges are relative to the text passed in,
+     * while their lines count from the start of the script. As with split(), the text must be followed by a few
+     * zero bytes.
+     */
+    size_t splitPart(const char *sql, size_t length, bool atEnd, std::vector<StatementRange> &ranges);
+
+  private:
+    std::string _initialDelimiter;
+    std::string _lineBreak;
+    bool _hiddenCommandsAreContent;
+    const volatile bool *_stop;
+
+    // State at the end of the text consumed by splitPart().
+    std::string _partDelimiter;
+    size_t _partLine;
+    unsigned char _partPrevious;
+
+    size_t splitText(const char *sql, size_t length, bool atEnd, unsigned char previousByte, std::string &delimiter,
+                     size_t &line, std::vector<StatementRange> &ranges) const;
+  };
+
+} // namespace parsers
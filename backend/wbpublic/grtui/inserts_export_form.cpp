@@ -29,6 +29,7 @@
 
 #include "sqlide/recordset_text_storage.h"
 #include "sqlide/recordset_sql_storage.h"
+#include "sqlide/recordset_stream_export.h"
 
 #include "mforms/simpleform.h"
 #include "mforms/utilities.h"
@@ -67,6 +68,11 @@ std::string InsertsExportForm::run() {
     int i = _storage_type_index[format];
     const Recordset_storage_info &info(_storage_types[i]);
 
+    Recordset_stream_exporter::Format streamFormat;
+    if (_stream_export_cb && Recordset_stream_exporter::format_for_name(info.name, streamFormat) &&
+        _stream_export_cb(info.name, path))
+      return path;
+
     Recordset_data_storage::Ref dataStorage = _record_set->data_storage_for_export(info.name);
 
     if (dynamic_cast<Recordset_text_storage *>(dataStorage.get())) {
@@ -29,15 +29,25 @@
 
 #include "mforms/filechooser.h"
 
+#include <functional>
+
 class WBPUBLICBACKEND_PUBLIC_FUNC InsertsExportForm : public mforms::FileChooser {
 public:
   InsertsExportForm(mforms::Form *owner, Recordset::Ref rset = Recordset::Ref(),
                     const std::string &default_extension = "");
 
+  // Called for the formats the streaming exporter supports, before the grid contents are exported.
+  // Returning true means the callback took over the export (e.g. re-running the query on the server).
+  typedef std::function<bool(const std::string &data_format, const std::string &path)> Stream_export_cb;
+  void stream_export_callback(const Stream_export_cb &cb) {
+    _stream_export_cb = cb;
+  }
+
   std::string run();
 
 private:
   Recordset::Ref _record_set;
+  Stream_export_cb _stream_export_cb;
   std::vector<Recordset_storage_info> _storage_types;
   std::map<std::string, int> _storage_type_index;
 };
@@ -21,6 +21,8 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include "base/threading.h"
+
 #include "grts/structs.db.h"
 
 #include "grtpp_util.h"
@@ -30,13 +32,16 @@
 // db_ForeignKey
 
 // don't hold reference to the fk!
+// Catalogs can be built on several threads at once (e.g. parallel reverse engineering), so access is guarded.
 static std::map<grt::internal::Value *, std::set<db_ForeignKey *> > referenced_table_to_fk;
+static base::Mutex referenced_table_to_fk_mutex;
 
 void db_ForeignKey::init() {
 }
 
 void delete_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk) {
   if (table.is_valid()) {
+    base::MutexLock lock(referenced_table_to_fk_mutex);
     grt::internal::Value *t = table.valueptr();
     std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::iterator iter = referenced_table_to_fk.find(t);
     if (iter != referenced_table_to_fk.end()) {
@@ -52,6 +57,7 @@ void delete_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk) {
 
 void add_foreign_key_mapping(const db_TableRef &table, db_ForeignKey *fk) {
   if (table.is_valid()) {
+    base::MutexLock lock(referenced_table_to_fk_mutex);
     std::set<db_ForeignKey *> list;
     std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::iterator iter;
     if ((iter = referenced_table_to_fk.find(table.valueptr())) != referenced_table_to_fk.end()) {
@@ -72,6 +78,7 @@ grt::ListRef<db_ForeignKey> get_foreign_keys_referencing_table(const db_TableRef
   std::map<grt::internal::Value *, std::set<db_ForeignKey *> >::const_iterator iter;
   grt::ListRef<db_ForeignKey> result(true);
 
+  base::MutexLock lock(referenced_table_to_fk_mutex);
   if ((iter = referenced_table_to_fk.find(value.valueptr())) != referenced_table_to_fk.end()) {
     for (std::set<db_ForeignKey *>::const_iterator fk = iter->second.begin(); fk != iter->second.end(); ++fk) {
       result.insert(db_ForeignKeyRef(*fk));
@@ -37,6 +37,10 @@ public:
   ColumnWidthCache(const std::string &connection_id, const std::string &cache_dir);
   virtual ~ColumnWidthCache();
 
+  const std::string &connection_id() const {
+    return _connection_id;
+  }
+
   void save_column_width(const std::string &column_id, int width);
   void save_columns_width(const std::map<std::string, int> &columns);
   int get_column_width(const std::string &column_id);
@@ -36,13 +36,16 @@
 
 #include "base/log.h"
 #include "base/string_utilities.h"
+#include "base/util_functions.h"
 #include "base/boost_smart_ptr_helpers.h"
 #include "sqlite/command.hpp"
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include "grt/spatial_handler.h"
 
 #include "recordset_text_storage.h"
+#include "recordset_sorter.h"
 
 DEFAULT_LOG_DOMAIN("Recordset")
 
@@ -110,6 +113,7 @@ Recordset::Recordset(GrtThreadedTask::Ref parent_task)
 }
 
 Recordset::~Recordset() {
+  cancel_search_index_build();
   // recordset can't be freed before all calls planned from this class in main thread are finished
   bec::GRTManager::get()->get_dispatcher()->flush_pending_callbacks();
   delete _client_data;
@@ -118,6 +122,7 @@ Recordset::~Recordset() {
 
 bool Recordset::reset(Recordset_data_storage::Ptr data_storage_ptr, bool rethrow) {
   base::RecMutexLock data_mutex WB_UNUSED(_data_mutex);
+  cancel_search_index_build();
   VarGridModel::reset();
 
   std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
@@ -163,6 +168,7 @@ bool Recordset::reset(Recordset_data_storage::Ptr data_storage_ptr, bool rethrow
       }
 
       recalc_row_count(data_swap_db.get());
+      start_search_index_build();
 
       _readonly = data_storage->readonly();
 
@@ -370,6 +376,9 @@ void Recordset::mark_dirty(RowId row, ColumnId column, const sqlite::variant_t &
   RowId rowid(row);
   NodeId node(row);
   if (get_field_(node, _rowid_column, (ssize_t &)rowid)) {
+    if (_search_index)
+      _search_index->touch((std::uint32_t)rowid);
+
     std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
     sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db.get());
 
@@ -866,6 +875,12 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
         std::string subclauses_mediator = (!where_subclause1.empty() && !where_subclause2.empty()) ? " and " : "";
         where_clause =
           strfmt("where %s%s%s", where_subclause1.c_str(), subclauses_mediator.c_str(), where_subclause2.c_str());
+
+        // Restrict the LIKE scan to the rows the search index found, if it could narrow the filters.
+        std::string index_subclause = search_index_clause(data_swap_db);
+        if (!index_subclause.empty())
+          where_clause = strfmt("where %s and %s%s%s", index_subclause.c_str(), where_subclause1.c_str(),
+                                subclauses_mediator.c_str(), where_subclause2.c_str());
       }
     }
 
@@ -917,6 +932,11 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
       }
     }
 
+    // Sort in memory if the sort keys fit the budget, otherwise leave the ordering to SQLite.
+    std::shared_ptr<Recordset_sorter> sorter;
+    if (!orderby_clause.empty())
+      sorter = sort_in_memory(data_swap_db, tables_join, where_clause);
+
     {
       sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
 
@@ -924,11 +944,22 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
 
       sqlite::execute(*data_swap_db, strfmt("create table if not exists %s (`id` integer)", temp_table_name.c_str()),
                       true);
-      sqlite::execute(*data_swap_db, strfmt("insert into %s select `data`.`id` from %s %s %s", temp_table_name.c_str(),
-                                            tables_join.c_str(), where_clause.c_str(), orderby_clause.c_str()),
-                      true);
+      if (sorter) {
+        sqlite::command insert_statement(*data_swap_db,
+                                         strfmt("insert into %s (`id`) values (?)", temp_table_name.c_str()));
+        for (std::int64_t rowid : sorter->sorted_rowids()) {
+          insert_statement % (int)rowid;
+          insert_statement.emit();
+          insert_statement.clear();
+        }
+      } else
+        sqlite::execute(*data_swap_db, strfmt("insert into %s select `data`.`id` from %s %s %s",
+                                              temp_table_name.c_str(), tables_join.c_str(), where_clause.c_str(),
+                                              orderby_clause.c_str()),
+                        true);
       sqlite::execute(*data_swap_db, "drop table if exists `data_index`", true);
       sqlite::execute(*data_swap_db, strfmt("alter table %s rename to `data_index`", temp_table_name.c_str()), true);
+      sqlite::execute(*data_swap_db, "drop table if exists `search_candidates`", true);
 
       transaction_guarder.commit();
     }
@@ -943,6 +974,129 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
     refresh_ui();
 }
 
+/**
+ * Extracts the sort keys of the rows matching the where clause and sorts them in memory. Returns nothing if the
+ * in-memory sort is disabled or the keys exceed Recordset:SortMemoryBudget, so the caller sorts in SQLite.
+ */
+std::shared_ptr<Recordset_sorter> Recordset::sort_in_memory(sqlite::connection *data_swap_db,
+                                                            const std::string &tables_join,
+                                                            const std::string &where_clause) {
+  grt::DictRef options = grt::DictRef::cast_from(grt::GRT::get()->get("/wb/options/options"));
+  size_t memory_budget = options.is_valid() ? (size_t)options.get_int("Recordset:SortMemoryBudget", 0) : 0;
+  if (memory_budget == 0)
+    return std::shared_ptr<Recordset_sorter>();
+
+  std::vector<Recordset_sorter::Sort_key> keys;
+  std::string select_list = "`data`.`id`";
+  for (auto &sort_column : _sort_columns) {
+    Recordset_sorter::Sort_key key = { false, sort_column.second < 0 ? -1 : 1 };
+    switch (get_real_column_type(sort_column.first)) {
+      case NumericType:
+      case FloatType:
+      case DatetimeType:
+        select_list += strfmt(", cast(_%u as numeric)", (unsigned int)sort_column.first);
+        break;
+      case StringType:
+        key.nocase = true;
+        // fall through
+      default:
+        select_list += strfmt(", _%u", (unsigned int)sort_column.first);
+        break;
+    }
+    keys.push_back(key);
+  }
+
+  double start = timestamp();
+  std::shared_ptr<Recordset_sorter> sorter(new Recordset_sorter(keys, memory_budget * 1024 * 1024));
+  if (!sorter->load(data_swap_db,
+                    strfmt("select %s from %s %s", select_list.c_str(), tables_join.c_str(), where_clause.c_str()))) {
+    logDebug("Sort keys exceed the memory budget of %lu MB, sorting in SQLite\n", (unsigned long)memory_budget);
+    return std::shared_ptr<Recordset_sorter>();
+  }
+  sorter->sort();
+  logDebug2("Sorted %lu rows in memory in %.3fs\n", (unsigned long)sorter->row_count(), timestamp() - start);
+
+  return sorter;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset::start_search_index_build() {
+  grt::DictRef options = grt::DictRef::cast_from(grt::GRT::get()->get("/wb/options/options"));
+  if (!options.is_valid())
+    return;
+
+  size_t max_memory = (size_t)options.get_int("Recordset:SearchIndexMaxMemory", 0) * 1024 * 1024;
+  ssize_t min_rows = options.get_int("Recordset:SearchIndexMinRows", 0);
+  if (max_memory == 0 || (ssize_t)_real_row_count < min_rows || _real_row_count == 0 ||
+      _min_new_rowid > std::numeric_limits<std::uint32_t>::max())
+    return;
+
+  _search_index.reset(new Recordset_search_index(get_column_count(), max_memory));
+  _search_index->start_build(data_swap_db_path(), data_swap_db_partition_count());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset::cancel_search_index_build() {
+  if (_search_index) {
+    _search_index->cancel();
+    _search_index.reset();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Fills the `search_candidates` table with the rows the search index reports for the current column filters and
+ * search string and returns a where subclause restricting the data scan to them. Returns an empty string if the
+ * index is not available yet or can't narrow the filters, which leaves the full scan as it was.
+ */
+std::string Recordset::search_index_clause(sqlite::connection *data_swap_db) {
+  if (!_search_index || !_search_index->is_ready())
+    return "";
+
+  Recordset_search_index::Row_ids candidates, rowids;
+  bool narrowed = false;
+  for (auto &column_filter_expr : _column_filter_expr_map) {
+    if (!_search_index->column_candidates(column_filter_expr.first, column_filter_expr.second, rowids))
+      continue;
+    if (narrowed)
+      Recordset_search_index::intersect(candidates, rowids);
+    else
+      candidates.swap(rowids);
+    narrowed = true;
+  }
+  if (!_data_search_string.empty() &&
+      _search_index->any_column_candidates("%" + _data_search_string + "%", rowids)) {
+    if (narrowed)
+      Recordset_search_index::intersect(candidates, rowids);
+    else
+      candidates.swap(rowids);
+    narrowed = true;
+  }
+
+  // Handing over most of the rows costs more than it saves.
+  if (!narrowed || candidates.size() > _real_row_count / 2)
+    return "";
+
+  sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
+  sqlite::execute(*data_swap_db, "drop table if exists `search_candidates`", true);
+  sqlite::execute(*data_swap_db, "create table `search_candidates` (`id` integer primary key)", true);
+  {
+    sqlite::command insert_statement(*data_swap_db, "insert into `search_candidates` (`id`) values (?)");
+    for (std::uint32_t rowid : candidates) {
+      insert_statement % (int)rowid;
+      insert_statement.emit();
+      insert_statement.clear();
+    }
+  }
+  transaction_guarder.commit();
+  return "`data`.`id` in (select `id` from `search_candidates`)";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void Recordset::paste_rows_from_clipboard(ssize_t dest_row) {
   std::string text = mforms::Utilities::get_clipboard_text();
   std::vector<std::string> rows;
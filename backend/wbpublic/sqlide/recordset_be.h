@@ -26,12 +26,14 @@
 #include "wbpublic_public_interface.h"
 #include "sqlide/sqlide_generics.h"
 #include "sqlide/var_grid_model_be.h"
+#include "sqlide/recordset_search_index.h"
 #include "grt/action_list.h"
 #include <map>
 #include <set>
 #include <list>
 
 class Recordset_data_storage;
+class Recordset_sorter;
 class BinaryDataEditor;
 
 namespace mforms {
@@ -237,6 +239,9 @@ public:
 private:
   SortColumns _sort_columns; // column:direction(asc/desc)
 
+  std::shared_ptr<Recordset_sorter> sort_in_memory(sqlite::connection *data_swap_db, const std::string &tables_join,
+                                                   const std::string &where_clause);
+
 public:
   bool has_column_filters() const;
   bool has_column_filter(ColumnId column) const;
@@ -264,6 +269,20 @@ private:
   std::string _data_search_string;
   bool _preserveRowFilters;
 
+public:
+  // Trigram index used to narrow the search and column filters, built in the background after a fetch.
+  // Empty for small results or when disabled by the Recordset:SearchIndex* options.
+  Recordset_search_index::Ref search_index() const {
+    return _search_index;
+  }
+
+private:
+  void start_search_index_build();
+  void cancel_search_index_build();
+  std::string search_index_clause(sqlite::connection *data_swap_db);
+
+  Recordset_search_index::Ref _search_index;
+
 private:
   void rebuild_data_index(sqlite::connection *data_swap_db, bool do_cache_data_frame, bool do_refresh_ui);
 
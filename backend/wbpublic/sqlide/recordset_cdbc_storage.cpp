@@ -29,6 +29,7 @@
 #include "grtsqlparser/sql_facade.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
+#include "base/profiling.h"
 #include <sqlite/query.hpp>
 #include <algorithm>
 #include <ctype.h>
@@ -240,6 +241,7 @@ size_t Recordset_cdbc_storage::determine_pkey_columns_alt(Recordset::Column_name
 }
 
 void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connection *data_swap_db) {
+  BASE_TRACE("sql", "fetch");
   sql::Dbc_connection_handler::Ref conn;
   base::RecMutexLock lock(
     _getUserConnection(conn, true)); // we can't perform full connection check, hence we use the simple one
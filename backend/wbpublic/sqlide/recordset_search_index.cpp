@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <sqlite/query.hpp>
+
+#include "recordset_search_index.h"
+#include "recordset_be.h"
+#include "sqlide_generics.h"
+
+#include "base/string_utilities.h"
+#include "base/util_functions.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "base/log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+DEFAULT_LOG_DOMAIN("Recordset")
+
+using namespace base;
+
+const size_t Recordset_search_index::MAX_INDEXED_CELL_LENGTH = 64 * 1024;
+
+// Number of rows read from the swap db per statement while building.
+static const size_t CHUNK_SIZE = 4096;
+
+// Rough cost of a new posting list in the hash map (node, key and vector header).
+static const size_t POSTING_OVERHEAD = 64;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static inline unsigned char fold_case(unsigned char c) {
+  return (c >= 'A' && c <= 'Z') ? (unsigned char)(c + ('a' - 'A')) : c;
+}
+
+static inline std::uint32_t make_trigram(const unsigned char *p) {
+  return ((std::uint32_t)fold_case(p[0]) << 16) | ((std::uint32_t)fold_case(p[1]) << 8) | fold_case(p[2]);
+}
+
+static void append_trigrams(const char *text, size_t length, std::vector<std::uint32_t> &trigrams) {
+  const unsigned char *p = (const unsigned char *)text;
+  for (size_t i = 0; i + 3 <= length; ++i)
+    trigrams.push_back(make_trigram(p + i));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Recordset_search_index::Builder {
+public:
+  Builder(Recordset_search_index *index) : _index(index), _cancelled(false) {
+  }
+
+  ~Builder() {
+    cancel();
+  }
+
+  void start(const std::string &data_swap_db_path, size_t partition_count) {
+    _thread = std::thread(&Builder::run, this, data_swap_db_path, partition_count);
+  }
+
+  void cancel() {
+    _cancelled = true;
+    wait();
+  }
+
+  void wait() {
+    if (_thread.joinable())
+      _thread.join();
+  }
+
+private:
+  void run(std::string data_swap_db_path, size_t partition_count) {
+    double start_time = timestamp();
+    try {
+      std::shared_ptr<sqlite::connection> data_swap_db(new sqlite::connection(data_swap_db_path));
+      sqlide::optimize_sqlite_connection_for_speed(data_swap_db.get());
+
+      size_t column_count = _index->_columns.size();
+      for (size_t partition = 0; partition < partition_count; ++partition) {
+        size_t col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT;
+        size_t col_end = std::min<size_t>(column_count, col_begin + Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+        if (col_begin >= col_end)
+          break;
+
+        // Let SQLite convert the values to text, so that the indexed text is exactly what LIKE compares against.
+        // Rows are read in short chunks, each its own statement, so the shared lock on the swap db is released
+        // regularly and the grid can keep writing to it while the index is built.
+        std::string sql = "select `id`";
+        for (size_t col = col_begin; col < col_end; ++col)
+          sql += strfmt(", cast(`_%u` as text)", (unsigned int)col);
+        sql += strfmt(" from `data%s` where `id` > ? order by `id` limit %u",
+                      Recordset::data_swap_db_partition_suffix(partition).c_str(), (unsigned int)CHUNK_SIZE);
+
+        sqlite::query q(*data_swap_db, sql);
+        int last_rowid = -1;
+        for (bool more = true; more;) {
+          if (_cancelled)
+            return;
+
+          q.clear();
+          q % last_rowid;
+          if (!q.emit())
+            break;
+          std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+          size_t rows = 0;
+          do {
+            ++rows;
+            last_rowid = rs->get_int(0);
+            for (size_t col = col_begin; col < col_end; ++col) {
+              sqlite::variant_t v = rs->get_variant((int)(col - col_begin + 1));
+              const std::string *text = boost::get<std::string>(&v);
+              if (text == nullptr)
+                continue; // NULL never matches LIKE
+              if (!_index->add_cell((std::uint32_t)last_rowid, col, text->data(), text->size())) {
+                logInfo("Search index exceeds the memory limit of %lu bytes, not using it\n",
+                        (unsigned long)_index->_max_memory);
+                return;
+              }
+            }
+          } while (rs->next_row());
+          more = rows == CHUNK_SIZE;
+        }
+      }
+    } catch (std::exception &e) {
+      logError("Could not build the recordset search index: %s\n", e.what());
+      return;
+    }
+
+    if (_cancelled)
+      return;
+
+    _index->_build_time = timestamp() - start_time;
+    _index->finish();
+    logDebug("Search index for %lu rows built in %.3fs, %lu bytes\n", (unsigned long)_index->_row_count,
+             _index->_build_time, (unsigned long)_index->_memory_usage);
+  }
+
+  Recordset_search_index *_index;
+  std::atomic<bool> _cancelled;
+  std::thread _thread;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_search_index::Recordset_search_index(size_t column_count, size_t max_memory)
+  : _columns(column_count),
+    _max_memory(max_memory),
+    _memory_usage(0),
+    _row_count(0),
+    _over_limit(false),
+    _build_time(0),
+    _ready(false),
+    _builder(nullptr) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_search_index::~Recordset_search_index() {
+  delete _builder;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::start_build(const std::string &data_swap_db_path, size_t partition_count) {
+  cancel();
+  _builder = new Builder(this);
+  _builder->start(data_swap_db_path, partition_count);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::cancel() {
+  if (_builder != nullptr) {
+    _builder->cancel();
+    delete _builder;
+    _builder = nullptr;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::wait() {
+  if (_builder != nullptr)
+    _builder->wait();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_search_index::add_cell(std::uint32_t rowid, size_t column, const char *text, size_t length) {
+  if (_over_limit || column >= _columns.size())
+    return !_over_limit;
+
+  Column_index &column_index = _columns[column];
+  if (column == 0)
+    ++_row_count;
+
+  if (length > MAX_INDEXED_CELL_LENGTH) {
+    column_index.unindexed.push_back(rowid);
+    _memory_usage += sizeof(std::uint32_t);
+  } else {
+    _cell_trigrams.clear();
+    append_trigrams(text, length, _cell_trigrams);
+    std::sort(_cell_trigrams.begin(), _cell_trigrams.end());
+    _cell_trigrams.erase(std::unique(_cell_trigrams.begin(), _cell_trigrams.end()), _cell_trigrams.end());
+
+    for (std::uint32_t trigram : _cell_trigrams) {
+      Row_ids &rowids = column_index.postings[trigram];
+      size_t capacity = rowids.capacity();
+      if (capacity == 0)
+        _memory_usage += POSTING_OVERHEAD;
+      rowids.push_back(rowid);
+      _memory_usage += (rowids.capacity() - capacity) * sizeof(std::uint32_t);
+    }
+  }
+
+  if (_memory_usage > _max_memory) {
+    _over_limit = true;
+    _columns.clear();
+    _memory_usage = 0;
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::finish() {
+  MutexLock lock(_mutex);
+  _ready = !_over_limit;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::touch(std::uint32_t rowid) {
+  MutexLock lock(_mutex);
+  Row_ids::iterator it = std::lower_bound(_touched.begin(), _touched.end(), rowid);
+  if (it == _touched.end() || *it != rowid)
+    _touched.insert(it, rowid);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_search_index::is_ready() const {
+  MutexLock lock(_mutex);
+  return _ready;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t Recordset_search_index::row_count() const {
+  return is_ready() ? _row_count : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+size_t Recordset_search_index::memory_usage() const {
+  return is_ready() ? _memory_usage : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+double Recordset_search_index::build_time() const {
+  return is_ready() ? _build_time : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<std::uint32_t> Recordset_search_index::pattern_trigrams(const std::string &like_pattern) {
+  std::vector<std::uint32_t> trigrams;
+  size_t run_start = 0;
+  for (size_t i = 0; i <= like_pattern.size(); ++i) {
+    if (i == like_pattern.size() || like_pattern[i] == '%' || like_pattern[i] == '_') {
+      append_trigrams(like_pattern.data() + run_start, i - run_start, trigrams);
+      run_start = i + 1;
+    }
+  }
+  std::sort(trigrams.begin(), trigrams.end());
+  trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+  return trigrams;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::intersect(Row_ids &rowids, const Row_ids &other) {
+  Row_ids::iterator end =
+    std::set_intersection(rowids.begin(), rowids.end(), other.begin(), other.end(), rowids.begin());
+  rowids.erase(end, rowids.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::column_candidates_(size_t column, const std::vector<std::uint32_t> &trigrams,
+                                                Row_ids &rowids) const {
+  const Column_index &column_index = _columns[column];
+
+  // Intersect the posting lists, shortest first, so the working set shrinks as fast as possible.
+  std::vector<const Row_ids *> lists;
+  lists.reserve(trigrams.size());
+  for (std::uint32_t trigram : trigrams) {
+    Postings::const_iterator it = column_index.postings.find(trigram);
+    if (it == column_index.postings.end()) {
+      lists.clear();
+      break;
+    }
+    lists.push_back(&it->second);
+  }
+
+  Row_ids matches;
+  if (!lists.empty()) {
+    std::sort(lists.begin(), lists.end(),
+              [](const Row_ids *a, const Row_ids *b) { return a->size() < b->size(); });
+    matches = *lists.front();
+    for (size_t i = 1; i < lists.size() && !matches.empty(); ++i)
+      intersect(matches, *lists[i]);
+  }
+
+  rowids.clear();
+  std::set_union(matches.begin(), matches.end(), column_index.unindexed.begin(), column_index.unindexed.end(),
+                 std::back_inserter(rowids));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_search_index::add_touched(Row_ids &rowids) const {
+  MutexLock lock(_mutex);
+  if (_touched.empty())
+    return;
+  Row_ids merged;
+  merged.reserve(rowids.size() + _touched.size());
+  std::set_union(rowids.begin(), rowids.end(), _touched.begin(), _touched.end(), std::back_inserter(merged));
+  rowids.swap(merged);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_search_index::column_candidates(size_t column, const std::string &like_pattern, Row_ids &rowids) const {
+  if (!is_ready() || column >= _columns.size())
+    return false;
+  std::vector<std::uint32_t> trigrams = pattern_trigrams(like_pattern);
+  if (trigrams.empty())
+    return false;
+
+  column_candidates_(column, trigrams, rowids);
+  add_touched(rowids);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_search_index::any_column_candidates(const std::string &like_pattern, Row_ids &rowids) const {
+  if (!is_ready())
+    return false;
+  std::vector<std::uint32_t> trigrams = pattern_trigrams(like_pattern);
+  if (trigrams.empty())
+    return false;
+
+  rowids.clear();
+  Row_ids column_rowids, merged;
+  for (size_t column = 0; column < _columns.size(); ++column) {
+    column_candidates_(column, trigrams, column_rowids);
+    if (column_rowids.empty())
+      continue;
+    merged.clear();
+    std::set_union(rowids.begin(), rowids.end(), column_rowids.begin(), column_rowids.end(),
+                   std::back_inserter(merged));
+    rowids.swap(merged);
+  }
+  add_touched(rowids);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+#include "base/threading.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * In-memory trigram index over the cell text of a recordset's data swap db.
+ *
+ * The grid search box and the column filters are evaluated with LIKE over every row of the swap tables. The index
+ * narrows that scan to the rows whose cells contain all trigrams of the literal parts of the pattern. Candidates are
+ * always a superset of the real matches (LIKE is still applied to them), so filtering results don't change.
+ *
+ * Text is folded to lower case for ASCII letters only, which is what SQLite's LIKE does. Cells too large to index,
+ * and rows edited after the index was built, are reported as candidates for every pattern.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_search_index {
+public:
+  typedef std::shared_ptr<Recordset_search_index> Ref;
+  typedef std::vector<std::uint32_t> Row_ids; // ascending swap db row ids
+
+  // Cells longer than this are not split into trigrams but are always candidates.
+  static const size_t MAX_INDEXED_CELL_LENGTH;
+
+  Recordset_search_index(size_t column_count, size_t max_memory);
+  ~Recordset_search_index();
+
+  // Reads all cells from the swap db at the given path on a background thread. The index becomes ready when done.
+  void start_build(const std::string &data_swap_db_path, size_t partition_count);
+  // Stops a running background build and waits for it. The index stays unusable.
+  void cancel();
+  // Waits for the background build to finish.
+  void wait();
+
+  // Building interface. The cells of a column must be added in ascending row id order.
+  // Returns false once the memory limit is exceeded, in which case the index can't be used anymore.
+  bool add_cell(std::uint32_t rowid, size_t column, const char *text, size_t length);
+  void finish();
+
+  // Marks a row as changed after the index was built. Such rows are candidates for every pattern.
+  void touch(std::uint32_t rowid);
+
+  bool is_ready() const;
+  size_t row_count() const;
+  size_t memory_usage() const;
+  double build_time() const;
+
+  // Candidate rows for `column like pattern`. Returns false if the pattern can't be narrowed by the index
+  // (not ready, or no literal run of at least 3 bytes), in which case all rows must be scanned.
+  bool column_candidates(size_t column, const std::string &like_pattern, Row_ids &rowids) const;
+  // Candidate rows for `_0 like pattern or _1 like pattern or ...` over all indexed columns.
+  bool any_column_candidates(const std::string &like_pattern, Row_ids &rowids) const;
+
+  // Trigram keys of the literal runs of a LIKE pattern (split at % and _), case folded the same way as the cells.
+  static std::vector<std::uint32_t> pattern_trigrams(const std::string &like_pattern);
+
+  // Sorted intersection of two ascending row id lists, stored in the first.
+  static void intersect(Row_ids &rowids, const Row_ids &other);
+
+private:
+  Recordset_search_index(const Recordset_search_index &) = delete;
+  Recordset_search_index &operator=(const Recordset_search_index &) = delete;
+
+  class Builder;
+  friend class Builder;
+
+  typedef std::unordered_map<std::uint32_t, Row_ids> Postings;
+  struct Column_index {
+    Postings postings;
+    Row_ids unindexed; // rows whose cell in this column was too long to index
+  };
+
+  void column_candidates_(size_t column, const std::vector<std::uint32_t> &trigrams, Row_ids &rowids) const;
+  void add_touched(Row_ids &rowids) const;
+
+  std::vector<Column_index> _columns;
+  std::vector<std::uint32_t> _cell_trigrams; // scratch buffer for add_cell
+  size_t _max_memory;
+  size_t _memory_usage;
+  size_t _row_count;
+  bool _over_limit;
+  double _build_time;
+
+  mutable base::Mutex _mutex; // guards the members below
+  bool _ready;
+  Row_ids _touched;
+  Builder *_builder;
+};
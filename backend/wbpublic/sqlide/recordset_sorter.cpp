@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <sqlite/query.hpp>
+
+#include "recordset_sorter.h"
+
+#include "base/boost_smart_ptr_helpers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+const size_t Recordset_sorter::PARALLEL_SORT_THRESHOLD = 64 * 1024;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static int compare_int_real(std::int64_t i, double r) {
+  // Same approach as SQLite: compare against the integral part first, then look at the fraction.
+  if (r < -9223372036854775808.0)
+    return 1;
+  if (r >= 9223372036854775808.0)
+    return -1;
+  std::int64_t y = (std::int64_t)r;
+  if (i != y)
+    return i < y ? -1 : 1;
+  double yd = (double)y;
+  if (r > yd)
+    return -1;
+  if (r < yd)
+    return 1;
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static int compare_bytes(const char *a, size_t a_length, const char *b, size_t b_length) {
+  int res = memcmp(a, b, std::min(a_length, b_length));
+  if (res != 0)
+    return res < 0 ? -1 : 1;
+  if (a_length != b_length)
+    return a_length < b_length ? -1 : 1;
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_sorter::Recordset_sorter(const std::vector<Sort_key> &keys, size_t memory_budget)
+  : _memory_budget(memory_budget), _memory_usage(0) {
+  _columns.resize(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    _columns[i].key = keys[i];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_sorter::load(sqlite::connection *data_swap_db, const std::string &query) {
+  sqlite::query q(*data_swap_db, query);
+  if (!q.emit())
+    return true;
+
+  std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+  std::vector<sqlite::variant_t> values(_columns.size());
+  do {
+    for (size_t i = 0; i < values.size(); ++i)
+      values[i] = rs->get_variant((int)i + 1);
+    if (!add_row(rs->get_int(0), values))
+      return false;
+  } while (rs->next_row());
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_sorter::add_value(Column &column, const sqlite::variant_t &value) {
+  Cell cell = { 0, 0, NullValue };
+
+  if (const int *v = boost::get<int>(&value)) {
+    std::int64_t i = *v;
+    memcpy(&cell.data, &i, sizeof(i));
+    cell.type = IntValue;
+  } else if (const long long *v = boost::get<long long>(&value)) {
+    std::int64_t i = *v;
+    memcpy(&cell.data, &i, sizeof(i));
+    cell.type = IntValue;
+  } else if (const long double *v = boost::get<long double>(&value)) {
+    double d = (double)*v;
+    memcpy(&cell.data, &d, sizeof(d));
+    cell.type = RealValue;
+  } else if (const std::string *v = boost::get<std::string>(&value)) {
+    cell.data = column.buffer.size();
+    cell.length = (std::uint32_t)v->size();
+    cell.type = TextValue;
+    if (column.key.nocase) {
+      for (char c : *v)
+        column.buffer.push_back((c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c);
+    } else
+      column.buffer.append(*v);
+  } else if (const sqlite::blob_ref_t *v = boost::get<sqlite::blob_ref_t>(&value)) {
+    cell.data = column.buffer.size();
+    cell.type = BlobValue;
+    if (*v) {
+      cell.length = (std::uint32_t)(*v)->size();
+      if (!(*v)->empty())
+        column.buffer.append((const char *)&(*v)->front(), (*v)->size());
+    }
+  }
+
+  column.cells.push_back(cell);
+  _memory_usage += sizeof(Cell) + cell.length;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_sorter::add_row(std::int64_t rowid, const std::vector<sqlite::variant_t> &values) {
+  for (size_t i = 0; i < _columns.size(); ++i)
+    add_value(_columns[i], values[i]);
+  _rowids.push_back(rowid);
+  _memory_usage += sizeof(std::int64_t) + sizeof(std::uint32_t); // row id and its slot in the permutation
+
+  return _memory_usage <= _memory_budget;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int Recordset_sorter::compare(const Column &column, const Cell &a, const Cell &b) const {
+  // Storage classes order as in SQLite: NULL, numbers, text, blobs.
+  static const int rank[] = { 0, 1, 1, 2, 3 };
+  if (rank[a.type] != rank[b.type])
+    return rank[a.type] < rank[b.type] ? -1 : 1;
+
+  switch (a.type) {
+    case NullValue:
+      return 0;
+
+    case IntValue:
+    case RealValue: {
+      std::int64_t ai, bi;
+      double ad, bd;
+      memcpy(&ai, &a.data, sizeof(ai));
+      memcpy(&bi, &b.data, sizeof(bi));
+      memcpy(&ad, &a.data, sizeof(ad));
+      memcpy(&bd, &b.data, sizeof(bd));
+      if (a.type == IntValue && b.type == IntValue)
+        return ai < bi ? -1 : (ai > bi ? 1 : 0);
+      if (a.type == RealValue && b.type == RealValue)
+        return ad < bd ? -1 : (ad > bd ? 1 : 0);
+      if (a.type == IntValue)
+        return compare_int_real(ai, bd);
+      return -compare_int_real(bi, ad);
+    }
+
+    default:
+      return compare_bytes(column.buffer.data() + a.data, a.length, column.buffer.data() + b.data, b.length);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_sorter::less(std::uint32_t a, std::uint32_t b) const {
+  for (const Column &column : _columns) {
+    int res = compare(column, column.cells[a], column.cells[b]);
+    if (res != 0)
+      return column.key.direction < 0 ? res > 0 : res < 0;
+  }
+  return _rowids[a] < _rowids[b];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_sorter::sort(size_t thread_count) {
+  size_t count = _rowids.size();
+  std::vector<std::uint32_t> order(count);
+  for (size_t i = 0; i < count; ++i)
+    order[i] = (std::uint32_t)i;
+
+  auto cmp = [this](std::uint32_t a, std::uint32_t b) { return less(a, b); };
+
+  if (thread_count == 0)
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  thread_count = std::min(thread_count, std::max<size_t>(1, count / (PARALLEL_SORT_THRESHOLD / 2)));
+
+  if (thread_count <= 1 || count < PARALLEL_SORT_THRESHOLD)
+    std::sort(order.begin(), order.end(), cmp);
+  else {
+    // Sort one run per thread, then merge neighbouring runs pairwise, each merge pass again in parallel.
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= thread_count; ++i)
+      bounds.push_back(count * i / thread_count);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i)
+      threads.emplace_back(
+        [&, i]() { std::sort(order.begin() + bounds[i], order.begin() + bounds[i + 1], cmp); });
+    for (auto &thread : threads)
+      thread.join();
+
+    std::vector<std::uint32_t> merged(count);
+    while (bounds.size() > 2) {
+      std::vector<size_t> next_bounds;
+      threads.clear();
+      for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+        size_t begin = bounds[i], middle = bounds[i + 1];
+        size_t end = (i + 2 < bounds.size()) ? bounds[i + 2] : middle;
+        next_bounds.push_back(begin);
+        threads.emplace_back([&, begin, middle, end]() {
+          std::merge(order.begin() + begin, order.begin() + middle, order.begin() + middle, order.begin() + end,
+                     merged.begin() + begin, cmp);
+        });
+      }
+      if (next_bounds.back() != count)
+        next_bounds.push_back(count);
+      for (auto &thread : threads)
+        thread.join();
+      order.swap(merged);
+      bounds.swap(next_bounds);
+    }
+  }
+
+  _sorted_rowids.resize(count);
+  for (size_t i = 0; i < count; ++i)
+    _sorted_rowids[i] = _rowids[order[i]];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+#include "sqlide/sqlide_generics.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * In-memory sort of recordset rows, used by Recordset::sort_by instead of an ORDER BY over the data swap db.
+ *
+ * The sort keys of all rows are extracted once into compact per-column arrays (text goes into one buffer per
+ * column), then a permutation of the rows is sorted, in parallel for large results. The order is the same as
+ * SQLite would produce: NULL < numbers < text < blobs, numbers compared by value, text compared bytewise with
+ * optional ASCII case folding (NOCASE). Ties are broken by row id, so the result is deterministic.
+ *
+ * Loading stops as soon as the extracted keys exceed the memory budget, in which case the caller falls back to
+ * sorting in SQLite.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_sorter {
+public:
+  struct Sort_key {
+    bool nocase;   // fold ASCII letters to lower case before comparing text
+    int direction; // 1 ascending, -1 descending
+  };
+
+  Recordset_sorter(const std::vector<Sort_key> &keys, size_t memory_budget);
+
+  // Runs the query (row id in the first column, then one column per sort key) and extracts all keys.
+  // Returns false if the memory budget was exceeded.
+  bool load(sqlite::connection *data_swap_db, const std::string &query);
+
+  // Adds a row. values must hold one value per sort key. Returns false if the memory budget was exceeded.
+  bool add_row(std::int64_t rowid, const std::vector<sqlite::variant_t> &values);
+
+  // Sorts the rows added so far, using up to thread_count threads (0 means one per hardware thread).
+  void sort(size_t thread_count = 0);
+
+  // Row ids in sorted order, valid after sort().
+  const std::vector<std::int64_t> &sorted_rowids() const {
+    return _sorted_rowids;
+  }
+
+  size_t row_count() const {
+    return _rowids.size();
+  }
+  size_t memory_usage() const {
+    return _memory_usage;
+  }
+
+  // Results smaller than this are sorted on the calling thread only.
+  static const size_t PARALLEL_SORT_THRESHOLD;
+
+private:
+  enum Value_type { NullValue, IntValue, RealValue, TextValue, BlobValue };
+
+  struct Cell {
+    std::uint64_t data;   // integer or double bits for numbers, offset into the column's buffer for text/blobs
+    std::uint32_t length; // byte length of text/blobs
+    std::uint8_t type;    // Value_type
+  };
+
+  struct Column {
+    Sort_key key;
+    std::vector<Cell> cells;
+    std::string buffer;
+  };
+
+  void add_value(Column &column, const sqlite::variant_t &value);
+  int compare(const Column &column, const Cell &a, const Cell &b) const;
+  bool less(std::uint32_t a, std::uint32_t b) const;
+
+  std::vector<Column> _columns;
+  std::vector<std::int64_t> _rowids;
+  std::vector<std::int64_t> _sorted_rowids;
+  size_t _memory_budget;
+  size_t _memory_usage;
+};
@@ -211,7 +211,8 @@ void Recordset_sql_storage::load_insert_statement(const std::string &sql,
   }
 
   // check fields names & determine fields order
-  std::map<int, int> col_index_map; // index of field in var_list : index of field in passed fields_names
+  // index of field in var_list : index of field in passed fields_names (-1 if not passed)
+  std::vector<int> col_index_map(_fields_order.size(), -1);
   for (ColumnId n = 0, count = fields_names.size(); n < count; ++n) {
     Fields_order::const_iterator i = _fields_order.find(fields_names[n]);
     if (_fields_order.end() != i)
@@ -220,9 +221,9 @@ void Recordset_sql_storage::load_insert_statement(const std::string &sql,
 
   // insert row
   for (ColumnId n = 0, count = _fields_order.size(); n < count; ++n) {
-    std::map<int, int>::const_iterator i = col_index_map.find((int)n);
-    if ((col_index_map.end() != i) && !null_fields[i->second])
-      var_list->push_back(fields_values[i->second]);
+    int i = col_index_map[n];
+    if ((i >= 0) && !null_fields[i])
+      var_list->push_back(fields_values[i]);
     else
       var_list->push_back(sqlite::null_t());
   }
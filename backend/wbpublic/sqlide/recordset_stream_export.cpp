@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <sqlite/query.hpp>
+
+#include "recordset_stream_export.h"
+#include "sqlide_generics.h"
+#include "cppdbc.h"
+
+#include "base/string_utilities.h"
+#include "base/util_functions.h"
+#include "base/log.h"
+
+#include <errno.h>
+
+DEFAULT_LOG_DOMAIN(DOMAIN_WQE_BE)
+
+using namespace base;
+
+// Characters that force a CSV token to be enclosed in quotes. These mirror the csv_quote template modifier
+// so that the native export produces byte-identical files to the CSV/tab templates.
+static const char *CSV_COMMA_TRIGGERS = " \"\t\r\n,";
+static const char *CSV_SEMICOLON_TRIGGERS = " \"\t\r\n;";
+static const char *TAB_TRIGGERS = "\t";
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_stream_exporter::format_for_name(const std::string &data_format, Format &format) {
+  if (data_format == "CSV")
+    format = CSVComma;
+  else if (data_format == "CSV_semicolon")
+    format = CSVSemicolon;
+  else if (data_format == "tab")
+    format = TabSeparated;
+  else if (data_format == "JSON_lines")
+    format = JSONLines;
+  else
+    return false;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_stream_exporter::Recordset_stream_exporter(Format format, const std::string &file_path)
+  : _format(format),
+    _file_path(file_path),
+    _buffer_size(1024 * 1024),
+    _null_syntax("NULL"),
+    _include_header(format != JSONLines),
+    _separator(','),
+    _quote_triggers(CSV_COMMA_TRIGGERS),
+    _progress_interval(10000),
+    _rows_written(0),
+    _start_time(0),
+    _end_time(0) {
+  switch (_format) {
+    case CSVComma:
+      break;
+    case CSVSemicolon:
+      _separator = ';';
+      _quote_triggers = CSV_SEMICOLON_TRIGGERS;
+      break;
+    case TabSeparated:
+      _separator = '\t';
+      _quote_triggers = TAB_TRIGGERS;
+      break;
+    case JSONLines:
+      _null_syntax = "null";
+      _separator = ',';
+      _quote_triggers = NULL;
+      break;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_stream_exporter::~Recordset_stream_exporter() {
+  try {
+    flush();
+  } catch (std::exception &exc) {
+    logError("Error flushing export file %s: %s\n", _file_path.c_str(), exc.what());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+double Recordset_stream_exporter::rows_per_second() const {
+  double elapsed = (_end_time > 0 ? _end_time : base::timestamp()) - _start_time;
+  if (_start_time == 0 || elapsed <= 0)
+    return 0;
+  return _rows_written / elapsed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_stream_exporter::flush() {
+  if (_buffer.empty() || !_file.file())
+    return;
+
+  if (fwrite(_buffer.data(), 1, _buffer.size(), _file.file()) != _buffer.size())
+    throw std::runtime_error(strfmt("Error writing to export file `%s`: %s", _file_path.c_str(), g_strerror(errno)));
+  _buffer.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_stream_exporter::begin(const Recordset::Column_names &column_names) {
+  _file = base::FileHandle(_file_path, "wb");
+  _buffer.reserve(_buffer_size + 4096);
+  _rows_written = 0;
+  _start_time = base::timestamp();
+  _end_time = 0;
+
+  if (_format == JSONLines) {
+    _json_keys.clear();
+    _json_keys.reserve(column_names.size());
+    for (size_t i = 0; i < column_names.size(); ++i)
+      _json_keys.push_back(std::string(i == 0 ? "{\"" : ", \"") + base::escape_json_string(column_names[i]) + "\": ");
+  } else if (_include_header) {
+    for (size_t i = 0; i < column_names.size(); ++i)
+      write_field(i, column_names[i].data(), column_names[i].size(), false, true, false);
+    end_row();
+    _rows_written = 0; // the header does not count as a data row
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_stream_exporter::write_field(ColumnId column, const char *data, size_t length, bool is_null,
+                                           bool needs_quote, bool is_binary) {
+  if (_format == JSONLines) {
+    const std::string &key = _json_keys[column];
+    append(key.data(), key.size());
+    if (is_null)
+      append(_null_syntax.data(), _null_syntax.size());
+    else if (is_binary) {
+      std::string hex = sqlide::QuoteVar::blob_to_hex_string((const unsigned char *)data, length);
+      append('"');
+      append(hex.data(), hex.size());
+      append('"');
+    } else if (needs_quote) {
+      std::string escaped = base::escape_json_string(std::string(data, length));
+      append('"');
+      append(escaped.data(), escaped.size());
+      append('"');
+    } else
+      append(data, length);
+    return;
+  }
+
+  if (column > 0)
+    append(_separator);
+
+  if (is_null) {
+    data = _null_syntax.data();
+    length = _null_syntax.size();
+  }
+
+  bool quote = false;
+  for (const char *p = data, *end = data + length; p < end && !quote; ++p)
+    quote = strchr(_quote_triggers, *p) != NULL && *p != 0;
+
+  if (!quote) {
+    append(data, length);
+    return;
+  }
+
+  append('"');
+  const char *start = data;
+  for (const char *p = data, *end = data + length; p < end; ++p) {
+    if (*p == '"') {
+      append(start, p - start + 1);
+      append('"');
+      start = p + 1;
+    }
+  }
+  append(start, data + length - start);
+  append('"');
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_stream_exporter::end_row() {
+  if (_format == JSONLines)
+    append("}\n", 2);
+  else
+    append('\n');
+  ++_rows_written;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_stream_exporter::report_progress(bool final) {
+  if (final) {
+    flush();
+    _end_time = base::timestamp();
+  }
+  if (_progress_cb && (final || (_rows_written % _progress_interval) == 0))
+    return _progress_cb(_rows_written, rows_per_second());
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Exports the contents of the data swap tables, in storage order, the same way the export templates do.
+ */
+size_t Recordset_stream_exporter::export_swap_db(sqlite::connection *data_swap_db, size_t partition_count,
+                                                 ColumnId column_count, const Recordset::Column_names &column_names,
+                                                 const Recordset::Column_flags &column_flags) {
+  Recordset::Column_names visible_names(column_names.begin(), column_names.begin() + column_count);
+  begin(visible_names);
+
+  std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
+  Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
+  std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
+
+  if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
+    sqlide::VarToStr var_to_str;
+    sqlite::variant_t v;
+    std::string text;
+    bool next_row_exists = true;
+    do {
+      for (size_t partition = 0; partition < partition_count; ++partition) {
+        std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
+        for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
+                      col_end = std::min<ColumnId>(column_count,
+                                                   (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+             col < col_end; ++col) {
+          v = data_rs->get_variant((int)(col - col_begin));
+          bool needs_quote = (column_flags[col] & Recordset::NeedsQuoteFlag) != 0;
+          if (sqlide::is_var_null(v))
+            write_field(col, NULL, 0, true, needs_quote, false);
+          else if (_format == JSONLines && sqlide::is_var_blob(v)) {
+            const sqlite::blob_ref_t &blob = boost::get<sqlite::blob_ref_t>(v);
+            write_field(col, blob->empty() ? NULL : (const char *)&(*blob)[0], blob->size(), false, true, true);
+          } else {
+            text = boost::apply_visitor(var_to_str, v);
+            write_field(col, text.data(), text.size(), false, needs_quote, false);
+          }
+        }
+      }
+      end_row();
+
+      for (std::shared_ptr<sqlite::result> &data_rs : data_results)
+        next_row_exists = data_rs->next_row();
+
+      if (!report_progress(false))
+        throw std::runtime_error(_("Export was cancelled"));
+    } while (next_row_exists);
+  }
+
+  report_progress(true);
+  return _rows_written;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Exports a server result set directly, without populating the data swap db. The result set is consumed,
+ * so it's best used with an unbuffered (streaming) result from the connector.
+ */
+size_t Recordset_stream_exporter::export_result_set(sql::ResultSet *rs) {
+  sql::ResultSetMetaData *rs_meta(rs->getMetaData());
+  unsigned int column_count = rs_meta->getColumnCount();
+
+  Recordset::Column_names column_names;
+  std::vector<bool> needs_quote(column_count);
+  std::vector<bool> is_binary(column_count);
+  column_names.reserve(column_count);
+  for (unsigned int n = 0; n < column_count; ++n) {
+    column_names.push_back(rs_meta->getColumnLabel(n + 1));
+    int type = rs_meta->getColumnType(n + 1);
+    needs_quote[n] = !rs_meta->isNumeric(n + 1) && type != sql::DataType::DECIMAL;
+    is_binary[n] = type == sql::DataType::BINARY || type == sql::DataType::VARBINARY ||
+                   type == sql::DataType::LONGVARBINARY;
+  }
+
+  begin(column_names);
+
+  while (rs->next()) {
+    for (unsigned int n = 0; n < column_count; ++n) {
+      if (rs->isNull(n + 1))
+        write_field(n, NULL, 0, true, needs_quote[n], false);
+      else {
+        std::string value = rs->getString(n + 1);
+        write_field(n, value.data(), value.size(), false, needs_quote[n], is_binary[n] && _format == JSONLines);
+      }
+    }
+    end_row();
+
+    if (!report_progress(false))
+      throw std::runtime_error(_("Export was cancelled"));
+  }
+
+  report_progress(true);
+  return _rows_written;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
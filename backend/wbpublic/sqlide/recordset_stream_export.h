@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+#include "sqlide/recordset_be.h"
+#include "base/file_utilities.h"
+
+#include <functional>
+
+namespace sql {
+  class ResultSet;
+}
+
+/**
+ * Template-less exporter for the simple tabular formats (CSV, tab separated and JSON lines).
+ * Rows are written straight from the data swap db or from a server result set into a buffered file,
+ * without building any mtemplate dictionaries or keeping the exported text in memory.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_stream_exporter {
+public:
+  enum Format { CSVComma, CSVSemicolon, TabSeparated, JSONLines };
+
+  // Called every progress_interval() rows and once at the end. Returning false cancels the export.
+  typedef std::function<bool(size_t rows_written, double rows_per_second)> Progress_cb;
+
+  static bool format_for_name(const std::string &data_format, Format &format);
+
+  Recordset_stream_exporter(Format format, const std::string &file_path);
+  ~Recordset_stream_exporter();
+
+  void null_syntax(const std::string &val) {
+    _null_syntax = val;
+  }
+  void include_header(bool val) {
+    _include_header = val;
+  }
+  void buffer_size(size_t val) {
+    _buffer_size = std::max<size_t>(val, 4096);
+  }
+  void progress_callback(const Progress_cb &cb, size_t interval = 10000) {
+    _progress_cb = cb;
+    _progress_interval = std::max<size_t>(interval, 1);
+  }
+
+  size_t export_swap_db(sqlite::connection *data_swap_db, size_t partition_count, ColumnId column_count,
+                        const Recordset::Column_names &column_names, const Recordset::Column_flags &column_flags);
+  size_t export_result_set(sql::ResultSet *rs);
+
+  size_t rows_written() const {
+    return _rows_written;
+  }
+  double rows_per_second() const;
+
+private:
+  void begin(const Recordset::Column_names &column_names);
+  void write_field(ColumnId column, const char *data, size_t length, bool is_null, bool needs_quote, bool is_binary);
+  void end_row();
+  bool report_progress(bool final);
+  void flush();
+
+  inline void append(const char *data, size_t length) {
+    _buffer.append(data, length);
+    if (_buffer.size() >= _buffer_size)
+      flush();
+  }
+  inline void append(char c) {
+    _buffer.push_back(c);
+    if (_buffer.size() >= _buffer_size)
+      flush();
+  }
+
+  Format _format;
+  std::string _file_path;
+  base::FileHandle _file;
+  std::string _buffer;
+  size_t _buffer_size;
+  std::string _null_syntax;
+  bool _include_header;
+
+  std::vector<std::string> _json_keys; // pre-escaped "name": prefixes, one per column
+  char _separator;
+  const char *_quote_triggers;
+
+  Progress_cb _progress_cb;
+  size_t _progress_interval;
+  size_t _rows_written;
+  double _start_time;
+  double _end_time;
+};
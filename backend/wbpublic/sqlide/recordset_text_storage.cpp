@@ -53,7 +53,7 @@ static const Recordset_text_storage::TemplateInfo &template_info(const std::stri
   return _templates[template_name];
 }
 
-static void process_templates(const std::list<std::string> &files) {
+static void process_templates(const std::list<std::string> &files, bool builtin) {
   for (std::list<std::string>::const_iterator f = files.begin(); f != files.end(); ++f) {
     ConfigurationFile cf(AutoCreateNothing);
     if (cf.load(*f)) {
@@ -67,6 +67,7 @@ static void process_templates(const std::list<std::string> &files) {
       info.include_column_types = cf.get_value("include_column_types");
       info.null_syntax = cf.get_value("null_syntax");
       info.row_separator = cf.get_value("row_separator");
+      info.builtin = builtin;
       if (info.include_column_types != "xls")
         info.include_column_types = "";
       std::string args = cf.get_value("arguments");
@@ -85,11 +86,21 @@ static void scan_templates() {
   if (_templates.empty()) {
     std::string template_dir = base::makePath(bec::GRTManager::get()->get_basedir(), "modules/data/sqlide");
     std::list<std::string> files = base::scan_for_files_matching(template_dir + "/*.tpli");
-    process_templates(files);
+    process_templates(files, true);
+
+    // JSON lines has no template, it's only written by the native exporter
+    Recordset_text_storage::TemplateInfo json_lines;
+    json_lines.name = "JSON_lines";
+    json_lines.extension = "jsonl";
+    json_lines.description = "JSON lines";
+    json_lines.pre_quote_strings = true;
+    json_lines.null_syntax = "null";
+    json_lines.builtin = true;
+    _templates[json_lines.name] = json_lines;
 
     template_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), "recordset_export_templates");
     files = base::scan_for_files_matching(template_dir + "/*.tpli");
-    process_templates(files);
+    process_templates(files, false);
   }
 }
 
@@ -119,7 +130,7 @@ struct CSVTokenQuoteModifier : public mtemplate::Modifier {
   }
 };
 
-Recordset_text_storage::Recordset_text_storage() : Recordset_data_storage() {
+Recordset_text_storage::Recordset_text_storage() : Recordset_data_storage(), _use_native_export(true) {
   static bool registered_csvquote = false;
   if (!registered_csvquote) {
     registered_csvquote = true;
@@ -149,6 +160,20 @@ static std::string escape_json_string_(const std::string &s) {
 
 void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
   const TemplateInfo &info(template_info(_data_format));
+
+  Recordset_stream_exporter::Format native_format;
+  if (info.builtin && Recordset_stream_exporter::format_for_name(_data_format, native_format) &&
+      (_use_native_export || info.path.empty())) {
+    Recordset_stream_exporter exporter(native_format, _file_path);
+    exporter.null_syntax(info.null_syntax);
+    exporter.progress_callback(_progress_cb);
+    exporter.export_swap_db(data_swap_db, recordset->data_swap_db_partition_count(), recordset->get_column_count(),
+                            *recordset->column_names(), get_column_flags(recordset));
+    logDebug("Exported %s rows to %s (%.0f rows/s)\n", std::to_string(exporter.rows_written()).c_str(),
+             _file_path.c_str(), exporter.rows_per_second());
+    return;
+  }
+
   std::string template_name(info.name);
   bool strings_are_pre_quoted(info.pre_quote_strings);
   std::string include_column_types(info.include_column_types);
@@ -26,6 +26,7 @@
 
 #include "wbpublic_public_interface.h"
 #include "recordset_data_storage.h"
+#include "recordset_stream_export.h"
 #include <map>
 
 class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_text_storage : public Recordset_data_storage {
@@ -38,6 +39,7 @@ public:
     std::string row_separator;
     bool pre_quote_strings;
     std::string quote;
+    bool builtin; // shipped with WB, i.e. not overridden from the user's data dir
   };
   static std::vector<Recordset_storage_info> storage_types();
 
@@ -90,9 +92,20 @@ public:
     return _file_path;
   }
 
+  // Formats that have a native exporter (CSV, tab, JSON lines) skip the template engine unless disabled here
+  // or the template was customized by the user.
+  void use_native_export(bool val) {
+    _use_native_export = val;
+  }
+  void progress_callback(const Recordset_stream_exporter::Progress_cb &cb) {
+    _progress_cb = cb;
+  }
+
 protected:
   std::string _data_format;
   std::string _file_path;
+  bool _use_native_export;
+  Recordset_stream_exporter::Progress_cb _progress_cb;
 };
 
 #endif /* _RECORDSET_TEXT_STORAGE_BE_H_ */
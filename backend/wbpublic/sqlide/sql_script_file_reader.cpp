@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "sql_script_file_reader.h"
+#include "grtsqlparser/statement_splitter.h"
+
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+#include "base/log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+DEFAULT_LOG_DOMAIN("SqlScriptReader")
+
+using namespace base;
+
+const size_t Sql_script_file_reader::DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+const size_t Sql_script_file_reader::DEFAULT_MAX_READ_AHEAD = 16 * 1024 * 1024;
+
+// The splitter may look a few bytes past the end of the text it gets.
+static const size_t SPLITTER_PADDING = 16;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Sql_script_file_reader::Worker {
+public:
+  Worker(const std::string &path, std::ifstream &&stream, const std::string &delimiter, size_t block_size,
+         size_t max_read_ahead)
+    : _path(path),
+      _stream(std::move(stream)),
+      _splitter(delimiter),
+      _block_size(block_size),
+      _max_read_ahead(max_read_ahead),
+      _queued_bytes(0),
+      _bytes_read(0),
+      _done(false),
+      _stop(false) {
+    _splitter.setStopFlag(&_stop);
+    _thread = std::thread(&Worker::run, this);
+  }
+
+  ~Worker() {
+    cancel();
+    _thread.join();
+  }
+
+  void cancel() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    _queue.clear();
+    _queued_bytes = 0;
+    _can_read.notify_all();
+    _can_take.notify_all();
+  }
+
+  bool next(Statement &statement) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _can_take.wait(lock, [this]() { return !_queue.empty() || _done || _stop; });
+    if (_stop)
+      return false;
+
+    if (_queue.empty()) {
+      if (_error)
+        std::rethrow_exception(_error);
+      return false;
+    }
+
+    statement = std::move(_queue.front());
+    _queue.pop_front();
+    _queued_bytes -= statement.sql.size();
+    _can_read.notify_one();
+    return true;
+  }
+
+  std::uint64_t bytes_read() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes_read;
+  }
+
+private:
+  // Waits until there is room in the queue. Returns false if reading was cancelled meanwhile.
+  bool push(Statement &&statement) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _can_read.wait(lock, [this]() { return _queued_bytes < _max_read_ahead || _stop; });
+    if (_stop)
+      return false;
+
+    _queued_bytes += statement.sql.size();
+    _queue.push_back(std::move(statement));
+    _can_take.notify_one();
+    return true;
+  }
+
+  void run() {
+    try {
+      read();
+    } catch (std::exception &exc) {
+      logError("%s\n", exc.what());
+      std::lock_guard<std::mutex> lock(_mutex);
+      _error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done = true;
+    _can_take.notify_all();
+  }
+
+  void read() {
+    std::vector<char> buffer;
+    std::vector<parsers::StatementRange> ranges;
+    size_t pending = 0;       // bytes at the start of the buffer not consumed by the splitter yet
+    std::uint64_t offset = 0; // file offset of the buffer start
+    bool at_end = false;
+    bool first_block = true;
+
+    while (!at_end && !_stop) {
+      // Read at least as much as is pending. A statement spanning many blocks is split again with each block,
+      // doubling the text each time keeps that linear in the statement size.
+      size_t count = std::max(_block_size, pending);
+      buffer.resize(pending + count + SPLITTER_PADDING);
+      _stream.read(buffer.data() + pending, count);
+      size_t read_count = (size_t)_stream.gcount();
+      if (_stream.bad())
+        throw std::runtime_error(strfmt("Error reading file %s", _path.c_str()));
+      at_end = read_count < count;
+      pending += read_count;
+      std::fill(buffer.begin() + pending, buffer.begin() + pending + SPLITTER_PADDING, '\0');
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bytes_read += read_count;
+      }
+
+      size_t start = 0;
+      if (first_block) {
+        first_block = false;
+        if (pending >= 3 && memcmp(buffer.data(), "\xEF\xBB\xBF", 3) == 0)
+          start = 3; // Skip the UTF-8 byte order mark.
+      }
+
+      ranges.clear();
+      size_t consumed = _splitter.splitPart(buffer.data() + start, pending - start, at_end, ranges);
+      for (auto &range : ranges) {
+        Statement statement;
+        statement.sql.assign(buffer.data() + start + range.start, range.length);
+        statement.line = range.line;
+        statement.end_offset = offset + start + range.start + range.length;
+        if (!push(std::move(statement)))
+          return;
+      }
+
+      consumed += start;
+      memmove(buffer.data(), buffer.data() + consumed, pending - consumed);
+      pending -= consumed;
+      offset += consumed;
+    }
+  }
+
+  std::string _path;
+  std::ifstream _stream;
+  parsers::StatementSplitter _splitter;
+  size_t _block_size;
+  size_t _max_read_ahead;
+
+  std::mutex _mutex; // guards the members below
+  std::condition_variable _can_read;
+  std::condition_variable _can_take;
+  std::deque<Statement> _queue;
+  size_t _queued_bytes;
+  std::uint64_t _bytes_read;
+  std::exception_ptr _error;
+  bool _done;
+  volatile bool _stop; // also checked by the splitter
+
+  std::thread _thread;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Sql_script_file_reader::Sql_script_file_reader(const std::string &path, const std::string &delimiter,
+                                               size_t block_size, size_t max_read_ahead)
+  : _path(path),
+    _delimiter(delimiter),
+    _block_size(std::max<size_t>(block_size, 4096)),
+    _max_read_ahead(std::max<size_t>(max_read_ahead, 1)),
+    _file_size(0),
+    _worker(nullptr) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Sql_script_file_reader::~Sql_script_file_reader() {
+  delete _worker;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Sql_script_file_reader::start() {
+  if (_worker != nullptr)
+    return;
+
+  std::ifstream stream = base::openBinaryInputStream(_path);
+  if (!stream.is_open())
+    throw std::runtime_error(strfmt("Could not open file %s", _path.c_str()));
+
+  stream.seekg(0, std::ios::end);
+  _file_size = (std::uint64_t)stream.tellg();
+  stream.seekg(0, std::ios::beg);
+
+  _worker = new Worker(_path, std::move(stream), _delimiter, _block_size, _max_read_ahead);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Sql_script_file_reader::next(Statement &statement) {
+  return _worker != nullptr && _worker->next(statement);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Sql_script_file_reader::cancel() {
+  if (_worker != nullptr)
+    _worker->cancel();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::uint64_t Sql_script_file_reader::bytes_read() const {
+  return _worker != nullptr ? _worker->bytes_read() : 0;
+}
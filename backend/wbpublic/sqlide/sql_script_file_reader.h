@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Reads a SQL script file block by block on a background thread and hands out its statements in file order,
+ * so that scripts of any size can be executed without keeping their text in memory (or loading it into an editor).
+ *
+ * Statements are split with the shared statement splitter (including DELIMITER handling) while the file is read.
+ * Reading stays at most max_read_ahead bytes of statement text ahead of the consumer.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Sql_script_file_reader {
+public:
+  struct Statement {
+    std::string sql;
+    size_t line;              // zero based line the statement starts on
+    std::uint64_t end_offset; // file offset just past the statement text, for progress reporting
+  };
+
+  static const size_t DEFAULT_BLOCK_SIZE;
+  static const size_t DEFAULT_MAX_READ_AHEAD;
+
+  Sql_script_file_reader(const std::string &path, const std::string &delimiter = ";",
+                         size_t block_size = DEFAULT_BLOCK_SIZE, size_t max_read_ahead = DEFAULT_MAX_READ_AHEAD);
+  ~Sql_script_file_reader();
+
+  // Opens the file and starts reading. Throws std::runtime_error if the file cannot be opened.
+  void start();
+
+  // Waits for the next statement. Returns false at the end of the script or after cancel().
+  // A read error in the background thread is rethrown here.
+  bool next(Statement &statement);
+
+  // Stops reading. Statements already read are dropped.
+  void cancel();
+
+  std::uint64_t file_size() const {
+    return _file_size;
+  }
+  // Bytes of the file read so far (including the read-ahead).
+  std::uint64_t bytes_read() const;
+
+private:
+  Sql_script_file_reader(const Sql_script_file_reader &) = delete;
+  Sql_script_file_reader &operator=(const Sql_script_file_reader &) = delete;
+
+  class Worker;
+
+  std::string _path;
+  std::string _delimiter;
+  size_t _block_size;
+  size_t _max_read_ahead;
+  std::uint64_t _file_size;
+  Worker *_worker;
+};
@@ -25,6 +25,7 @@
 
 #include "var_grid_model_be.h"
 #include "base/string_utilities.h"
+#include "base/profiling.h"
 #include <sqlite/execute.hpp>
 #include <sqlite/query.hpp>
 #include "glib/gstdio.h"
@@ -481,6 +482,7 @@ void VarGridModel::add_column(const std::string &name, const sqlite::variant_t &
 //--------------------------------------------------------------------------------------------------
 
 void VarGridModel::cache_data_frame(RowId center_row, bool force_reload) {
+  BASE_TRACE("grid", "fill");
   static const RowId half_row_count = 500; //! load from options
   RowId row_count = half_row_count * 2;
 
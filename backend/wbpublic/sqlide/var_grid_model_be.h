@@ -163,6 +163,9 @@ protected:
 
 protected:
   std::shared_ptr<sqlite::connection> data_swap_db() const;
+  const std::string &data_swap_db_path() const {
+    return _data_swap_db_path;
+  }
 
 private:
   std::shared_ptr<sqlite::connection> create_data_swap_db_connection() const;
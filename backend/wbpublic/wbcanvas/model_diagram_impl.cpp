@@ -140,6 +140,17 @@ mdc::CanvasView *model_Diagram::ImplData::get_canvas_view() {
 
 //--------------------------------------------------------------------------------------------------
 
+mdc::CanvasView *model_Diagram::ImplData::get_realized_canvas_view() {
+  if (is_main_thread())
+    return get_canvas_view();
+
+  // Off the main thread realize() only schedules the realization.
+  return bec::GRTManager::get()->get_dispatcher()->call_from_main_thread<mdc::CanvasView *>(
+    std::bind(&model_Diagram::ImplData::get_canvas_view, this), true, false);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 Size model_Diagram::ImplData::get_size_for_page(const app_PageSettingsRef &page) {
   Size size;
 
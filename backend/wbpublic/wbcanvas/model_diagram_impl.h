@@ -120,6 +120,9 @@ public:
 
 public:
   mdc::CanvasView *get_canvas_view();
+  // Same as get_canvas_view(), but callers on another thread wait until the diagram was realized on the main
+  // thread. Returns NULL if the diagram cannot be realized.
+  mdc::CanvasView *get_realized_canvas_view();
   bool is_canvas_view_valid() {
     return _canvas_view != NULL;
   };
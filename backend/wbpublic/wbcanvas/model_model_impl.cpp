@@ -105,7 +105,14 @@ bool model_Model::ImplData::realize() {
   // do not use __diagrams because it will get the wrong instance
   grt::ListRef<model_Diagram> views(_owner->_diagrams);
 
+  // Only diagrams that have an open editor (or are current) get realized here. Closed diagrams keep just their
+  // model objects and are realized on first activation through get_canvas_view(), which keeps opening documents
+  // with many diagrams cheap.
+  model_DiagramRef current(_owner->currentDiagram());
   for (size_t c = views.count(), i = 0; i < c; i++) {
+    if (*views[i]->closed() != 0 && views[i] != current)
+      continue;
+
     view = views[i]->get_data();
     if (view)
       view->get_canvas_view(); // Will realize the canvas view if not yet done.
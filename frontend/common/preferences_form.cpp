@@ -827,6 +827,12 @@ mforms::View *PreferencesForm::create_sqlide_page() {
     entry = otable->add_entry_option("DbSqlEditor:ConnectionTimeOut",
                                      _("DBMS connection timeout interval (in seconds):"), "Timout Interval",
                                      _("Maximum time to wait before a connection attempt is aborted."));
+
+    entry = otable->add_entry_option("DbSqlEditor:AuxConnectionPoolSize",
+                                     _("Auxiliary connections per SQL editor:"), "Auxiliary Connections",
+                                     _("Number of background connections used for schema tree, object info and "
+                                       "auto completion queries. Extra connections are opened on demand only. "
+                                       "Set to 1 to use a single shared connection."));
     box->add(otable, false, true);
   }
 
@@ -1167,6 +1173,16 @@ mforms::View *PreferencesForm::create_query_page() {
       vbox->add(check, false);
     }
 
+    {
+      mforms::CheckBox *check = new_checkbox_option("DbSqlEditor:BatchStatementExecution");
+      check->set_text(_("Batch statements without result sets when running a script"));
+      check->set_name("Batch Statement Execution");
+      check->set_tooltip(_("Send consecutive statements which return no result set (DDL, INSERT, UPDATE...)\n"
+                           "in multi-statement packets of up to max_allowed_packet bytes, to save round trips.\n"
+                           "The output shows one summary entry per batch and one for each failed statement."));
+      vbox->add(check, false);
+    }
+
     {
       mforms::CheckBox *check= new_checkbox_option("DbSqlEditor:AutocommitMode");
       check->set_text(_("New connections use auto commit mode"));
@@ -1321,6 +1337,16 @@ mforms::View *PreferencesForm::create_model_page() {
                           "and slow down operation."));
     }
 
+    {
+      mforms::TextEntry *entry = new_numeric_entry_option("workbench:UndoMemoryLimit", 0, 65536);
+      entry->set_max_length(5);
+      entry->set_size(100, -1);
+
+      table->add_option(entry, _("Model undo history memory limit (MB):"), "Undo History Memory Limit",
+                        _("Older undo entries are discarded once the undo history holds more memory than this. "
+                          "The most recent entry is always kept. Use 0 for no limit."));
+    }
+
     {
       static const char *auto_save_intervals =
         "disable:0,10 seconds:10,15 seconds:15,30 seconds:30,1 minute:60,5 minutes:300,10 minutes:600,20 minutes:1200";
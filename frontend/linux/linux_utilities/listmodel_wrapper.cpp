@@ -600,9 +600,11 @@ Gtk::TreeModelFlags ListModelWrapper::get_flags_vfunc() const {
 
 //------------------------------------------------------------------------------
 bec::NodeId ListModelWrapper::get_node_for_path(const Gtk::TreeModel::Path& path) const {
-  if (path.empty())
-    return bec::NodeId();
-  return bec::NodeId(path.to_string());
+  // Take the indices straight from the path instead of going through its string form.
+  bec::NodeId node;
+  for (Gtk::TreeModel::Path::const_iterator i = path.begin(); i != path.end(); ++i)
+    node.append((size_t)*i);
+  return node;
 }
 
 //------------------------------------------------------------------------------
@@ -674,6 +676,21 @@ GType ListModelWrapper::get_column_type_vfunc(int index) const {
 //------------------------------------------------------------------------------
 bool ListModelWrapper::iter_next_vfunc(const iterator& iter, iterator& iter_next) const {
   bool ret = false;
+
+  // Rows of flat lists (and top level tree nodes) carry their index in the iterator, so the next one is just
+  // the following row. This is the path taken for every row when scrolling a result grid.
+  const GtkTreeIter* it = iter.gobj();
+  if (it && *_tm) {
+    const Index id(it);
+    if (id.cmp_stamp(_stamp) && id.mode() == Index::ListNode) {
+      const size_t next_row = id.row() + 1;
+      reset_iter(iter_next);
+      if (next_row < (*_tm)->count())
+        ret = init_gtktreeiter(iter_next.gobj(), bec::NodeId(next_row));
+      return ret;
+    }
+  }
+
   bec::NodeId current_node = node_for_iter(iter);
 
   // g_message("LMW::iter_next_vfunc: %s", _name.c_str());
@@ -706,7 +723,7 @@ bool ListModelWrapper::get_iter_vfunc(const Path& path, iterator& iter) const {
   reset_iter(iter);
 
   if (*_tm) {
-    bec::NodeId node(path.to_string());
+    bec::NodeId node(ListModelWrapper::get_node_for_path(path));
 
     if (node.is_valid() && node.back() < (*_tm)->count())
       ret = init_gtktreeiter(it, node);
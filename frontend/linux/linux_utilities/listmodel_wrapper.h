@@ -97,6 +97,11 @@ public:
   bec::NodeId to_node() const;
   static void reset_iter(GtkTreeIter* it);
 
+  //! Row index of a ListNode iterator, which keeps it directly in user_data.
+  size_t row() const {
+    return (size_t)(intptr_t)(((GtkTreeIter*)_raw_data)->user_data);
+  }
+
 private:
   int word(const int w) const;
   void word(const int w, const int v);
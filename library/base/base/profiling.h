@@ -28,6 +28,7 @@
 
 #include <string>
 #include <map>
+#include <cstdint>
 #include <time.h>
 
 namespace base {
@@ -117,6 +118,55 @@ namespace base {
       _sw.stop(message);
     };
   };
+
+  // Low overhead tracing of code sections ("spans") that can stay in production code.
+  // Tracing is off by default and can be switched on and off at any time. While it is off a span
+  // costs a single flag check. Every thread records into its own buffer, so recording an event never
+  // takes a lock. The collected events can be written in the Chrome trace-event format, which can be
+  // loaded into chrome://tracing or Perfetto.
+  // Usage: BASE_TRACE("category", "name") at the start of the scope to measure.
+  //        Tracer::enable(true) to start recording, Tracer::write_chrome_trace(path) to save the result.
+  //        Category and name are not copied and must be string literals.
+  class BASELIBRARY_PUBLIC_FUNC Tracer {
+  public:
+    static void enable(bool flag);
+    static bool enabled();
+
+    // Monotonic time in nanoseconds, only meaningful relative to other values of now().
+    static std::int64_t now();
+
+    static void record(const char *category, const char *name, std::int64_t start, std::int64_t end);
+    static void set_thread_name(const std::string &name);
+
+    static size_t event_count();
+    static size_t dropped_count();
+    static void clear();
+
+    static std::string to_chrome_json();
+    static bool write_chrome_trace(const std::string &path);
+  };
+
+  class BASELIBRARY_PUBLIC_FUNC TraceSpan {
+  private:
+    const char *_category;
+    const char *_name;
+    std::int64_t _start;
+
+  public:
+    TraceSpan(const char *category, const char *name)
+      : _category(category), _name(name), _start(Tracer::enabled() ? Tracer::now() : -1) {
+    }
+    ~TraceSpan() {
+      if (_start >= 0)
+        Tracer::record(_category, _name, _start, Tracer::now());
+    }
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+  };
 } // namespace base ends here
 
+#define BASE_TRACE_CONCAT_(a, b) a##b
+#define BASE_TRACE_CONCAT(a, b) BASE_TRACE_CONCAT_(a, b)
+#define BASE_TRACE(category, name) base::TraceSpan BASE_TRACE_CONCAT(_trace_span_, __LINE__)(category, name)
+
 #endif //_PROFILING_H_
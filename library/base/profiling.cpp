@@ -24,7 +24,14 @@
 #include "base/profiling.h"
 #include "base/log.h"
 #include "base/string_utilities.h"
+#include "base/file_functions.h"
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 DEFAULT_LOG_DOMAIN("Profiling")
 
@@ -119,4 +126,248 @@ namespace base {
     _starts.clear();
   }
   //-------------------------------------------------------------------------------------
+  //----------------- Tracer ------------------------------------------------------------
+
+  namespace {
+    struct TraceEvent {
+      const char *category;
+      const char *name;
+      std::int64_t start;
+      std::int64_t end;
+    };
+
+    // Events are kept in fixed size chunks which never move once allocated. Only the owning thread
+    // appends to a chunk and publishes each new event through the chunk counter, so readers can walk
+    // the chunks without synchronizing with the writer.
+    struct TraceChunk {
+      static const size_t capacity = 4096;
+
+      TraceEvent events[capacity];
+      std::atomic<size_t> count;
+      std::atomic<TraceChunk *> next;
+
+      TraceChunk() : count(0), next(nullptr) {
+      }
+    };
+
+    // Limits the memory a single thread can use for tracing (about 32MB). Later events are dropped.
+    const size_t MaxChunksPerThread = 256;
+
+    struct ThreadBuffer {
+      unsigned id = 0;
+      std::string name; // Guarded by the registry mutex.
+
+      std::atomic<TraceChunk *> head;
+      std::atomic<unsigned> generation;
+      TraceChunk *tail = nullptr; // Only used by the owning thread.
+      size_t chunk_count = 0;
+
+      ThreadBuffer() : head(nullptr), generation(0) {
+      }
+
+      ~ThreadBuffer() {
+        release();
+      }
+
+      void release() {
+        TraceChunk *chunk = head.exchange(nullptr);
+        while (chunk != nullptr) {
+          TraceChunk *next = chunk->next.load();
+          delete chunk;
+          chunk = next;
+        }
+        tail = nullptr;
+        chunk_count = 0;
+      }
+    };
+
+    struct TraceRegistry {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+      unsigned next_id = 1;
+
+      std::atomic<bool> enabled;
+      std::atomic<unsigned> generation; // Incremented by clear(), invalidates all recorded events.
+      std::atomic<size_t> dropped;
+
+      TraceRegistry() : enabled(false), generation(0), dropped(0) {
+      }
+    };
+
+    // Never destroyed, threads may still record while static objects are torn down.
+    TraceRegistry &trace_registry() {
+      static TraceRegistry *registry = new TraceRegistry();
+      return *registry;
+    }
+
+    ThreadBuffer &thread_buffer() {
+      thread_local std::shared_ptr<ThreadBuffer> buffer;
+      if (!buffer) {
+        TraceRegistry &registry = trace_registry();
+        buffer = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        buffer->id = registry.next_id++;
+        buffer->generation = registry.generation.load();
+        registry.buffers.push_back(buffer);
+      }
+      return *buffer;
+    }
+
+    // Calls the given function for every valid event, must be called with the registry mutex held.
+    template <typename Function>
+    void for_each_event(TraceRegistry &registry, Function f) {
+      unsigned generation = registry.generation.load(std::memory_order_acquire);
+      for (auto &buffer : registry.buffers) {
+        if (buffer->generation.load(std::memory_order_acquire) != generation)
+          continue;
+
+        for (TraceChunk *chunk = buffer->head.load(std::memory_order_acquire); chunk != nullptr;
+             chunk = chunk->next.load(std::memory_order_acquire)) {
+          size_t count = chunk->count.load(std::memory_order_acquire);
+          for (size_t i = 0; i < count; ++i)
+            f(*buffer, chunk->events[i]);
+        }
+      }
+    }
+  }
+
+  //-------------------------------------------------------------------------------------
+  void Tracer::enable(bool flag) {
+    trace_registry().enabled.store(flag, std::memory_order_relaxed);
+    logDebug("Tracing %s\n", flag ? "enabled" : "disabled");
+  }
+  //-------------------------------------------------------------------------------------
+  bool Tracer::enabled() {
+    return trace_registry().enabled.load(std::memory_order_relaxed);
+  }
+  //-------------------------------------------------------------------------------------
+  std::int64_t Tracer::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+  }
+  //-------------------------------------------------------------------------------------
+  void Tracer::record(const char *category, const char *name, std::int64_t start, std::int64_t end) {
+    TraceRegistry &registry = trace_registry();
+    ThreadBuffer &buffer = thread_buffer();
+
+    // Events recorded before the last clear() are discarded here, by the owning thread, so no other
+    // thread ever frees chunks that are still written to.
+    unsigned generation = registry.generation.load(std::memory_order_acquire);
+    if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      buffer.release();
+      buffer.generation.store(generation, std::memory_order_release);
+    }
+
+    TraceChunk *chunk = buffer.tail;
+    if (chunk == nullptr || chunk->count.load(std::memory_order_relaxed) == TraceChunk::capacity) {
+      if (buffer.chunk_count == MaxChunksPerThread) {
+        registry.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+
+      TraceChunk *fresh = new TraceChunk();
+      if (chunk == nullptr)
+        buffer.head.store(fresh, std::memory_order_release);
+      else
+        chunk->next.store(fresh, std::memory_order_release);
+      buffer.tail = fresh;
+      ++buffer.chunk_count;
+      chunk = fresh;
+    }
+
+    size_t index = chunk->count.load(std::memory_order_relaxed);
+    TraceEvent &event = chunk->events[index];
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    chunk->count.store(index + 1, std::memory_order_release);
+  }
+  //-------------------------------------------------------------------------------------
+  void Tracer::set_thread_name(const std::string &name) {
+    ThreadBuffer &buffer = thread_buffer();
+
+    std::lock_guard<std::mutex> lock(trace_registry().mutex);
+    buffer.name = name;
+  }
+  //-------------------------------------------------------------------------------------
+  size_t Tracer::event_count() {
+    TraceRegistry &registry = trace_registry();
+    size_t count = 0;
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for_each_event(registry, [&count](const ThreadBuffer &, const TraceEvent &) { ++count; });
+    return count;
+  }
+  //-------------------------------------------------------------------------------------
+  size_t Tracer::dropped_count() {
+    return trace_registry().dropped.load(std::memory_order_relaxed);
+  }
+  //-------------------------------------------------------------------------------------
+  void Tracer::clear() {
+    TraceRegistry &registry = trace_registry();
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.generation.fetch_add(1, std::memory_order_acq_rel);
+    registry.dropped.store(0, std::memory_order_relaxed);
+
+    // Buffers only referenced here belong to threads which are gone and can be freed right away.
+    auto end = std::remove_if(registry.buffers.begin(), registry.buffers.end(),
+                              [](const std::shared_ptr<ThreadBuffer> &buffer) { return buffer.use_count() == 1; });
+    registry.buffers.erase(end, registry.buffers.end());
+  }
+  //-------------------------------------------------------------------------------------
+  std::string Tracer::to_chrome_json() {
+    TraceRegistry &registry = trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // Timestamps are written relative to the first event, in microseconds.
+    std::int64_t origin = INT64_MAX;
+    for_each_event(registry, [&origin](const ThreadBuffer &, const TraceEvent &event) {
+      if (event.start < origin)
+        origin = event.start;
+    });
+
+    std::string result = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto &buffer : registry.buffers) {
+      std::string name = buffer->name.empty() ? base::strfmt("Thread %u", buffer->id) : buffer->name;
+      result += base::strfmt("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                             "\"args\":{\"name\":\"%s\"}}",
+                             first ? "" : ",", buffer->id, base::escape_json_string(name).c_str());
+      first = false;
+    }
+
+    for_each_event(registry, [&](const ThreadBuffer &buffer, const TraceEvent &event) {
+      result += base::strfmt(
+        "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+        first ? "" : ",", base::escape_json_string(event.name).c_str(), base::escape_json_string(event.category).c_str(),
+        (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0, buffer.id);
+      first = false;
+    });
+    result += "\n]}\n";
+
+    return result;
+  }
+  //-------------------------------------------------------------------------------------
+  bool Tracer::write_chrome_trace(const std::string &path) {
+    std::string json = to_chrome_json();
+
+    FILE *file = base_fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+      logError("Could not open trace file %s\n", path.c_str());
+      return false;
+    }
+    bool success = fwrite(json.data(), 1, json.size(), file) == json.size();
+    success = fclose(file) == 0 && success;
+
+    if (success)
+      logInfo("Trace written to %s\n", path.c_str());
+    else
+      logError("Error while writing trace file %s\n", path.c_str());
+    return success;
+  }
+  //-------------------------------------------------------------------------------------
 } // namespace base
\ No newline at end of file
@@ -24,7 +24,11 @@
 #include "sql_batch_exec.h"
 #include <cppconn/exception.h>
 #include <cppconn/resultset.h>
+#include <cctype>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <set>
 
 namespace sql {
 
@@ -33,13 +37,17 @@ namespace sql {
       _batch_exec_err_count(0),
       _batch_exec_progress_state(0),
       _batch_exec_progress_inc(0),
-      _stop_on_error(true) {
+      _stop_on_error(true),
+      _max_packet_size(0),
+      _packet_count(0) {
   }
 
   long SqlBatchExec::operator()(sql::Statement *stmt, std::list<std::string> &statements) {
     _batch_exec_success_count = 0;
     _batch_exec_err_count = 0;
+    _packet_count = 0;
     _sql_log.clear();
+    _failed_statements.clear();
 
     exec_sql_script(stmt, statements, _batch_exec_err_count);
     if (_batch_exec_err_count && !_failback_statements.empty()) {
@@ -54,28 +62,77 @@ namespace sql {
     return _batch_exec_err_count;
   }
 
+  bool SqlBatchExec::is_batchable(const std::string &statement) {
+    // Compound statements (routine/trigger bodies) contain semicolons. The server could handle them in a
+    // multi-statement packet, but the splitter might not have been given the right delimiter, so play safe.
+    if (statement.find(';') != std::string::npos)
+      return false;
+
+    // Skip white space and comments before the first keyword. For version comments (/*!50003 ...) the keyword in
+    // the comment counts.
+    const char *run = statement.c_str();
+    const char *end = run + statement.size();
+    while (run < end) {
+      if (std::isspace((unsigned char)*run))
+        ++run;
+      else if (*run == '#' || (run[0] == '-' && run[1] == '-' && (run[2] == ' ' || run[2] == '\t' || run[2] == '\n' ||
+                                                                   run[2] == '\r'))) {
+        while (run < end && *run != '\n')
+          ++run;
+      } else if (run[0] == '/' && run[1] == '*') {
+        if (run[2] == '!') {
+          run += 3;
+          while (run < end && std::isdigit((unsigned char)*run))
+            ++run;
+        } else {
+          const char *comment_end = std::strstr(run + 2, "*/");
+          run = (comment_end != nullptr) ? comment_end + 2 : end;
+        }
+      } else
+        break;
+    }
+
+    std::string keyword;
+    while (run < end && std::isalpha((unsigned char)*run))
+      keyword.push_back((char)std::toupper((unsigned char)*run++));
+
+    // Statements which return exactly one OK packet and never a result set. LOAD DATA is left out on purpose
+    // (LOCAL needs a file transfer round trip), as are CALL, SELECT, SHOW and friends.
+    static const std::set<std::string> batchable_keywords = {
+      "ALTER",  "COMMIT", "CREATE",   "DELETE",    "DROP", "FLUSH",    "GRANT",  "INSERT", "LOCK", "RENAME",
+      "REPLACE", "REVOKE", "ROLLBACK", "SAVEPOINT", "SET",  "TRUNCATE", "UNLOCK", "UPDATE", "USE"};
+    return batchable_keywords.count(keyword) > 0;
+  }
+
   void SqlBatchExec::exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements,
                                      long &batch_exec_err_count) {
     _batch_exec_progress_state = 0;
     _batch_exec_progress_inc = 1.f / statements.size();
 
-    for (std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end(); i != i_end; ++i) {
-      try {
-        _sql_log.push_back(*i);
-        if (stmt->execute(*i))
-          std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
-        ++_batch_exec_success_count;
-      } catch (SQLException &e) {
-        ++batch_exec_err_count;
-        if (!_error_cb)
-          throw;
-        else {
-          if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
-            _error_cb(-1, "Error when running failback script. Details follow.", "");
-          _error_cb(e.getErrorCode(), e.what(), *i);
+    std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end();
+    size_t index = 0;
+    while (i != i_end) {
+      // In batched mode collect the run of batchable statements which fits into one packet.
+      size_t count = 0;
+      if (_max_packet_size > 0) {
+        size_t packet_size = 0;
+        for (std::list<std::string>::const_iterator run = i; run != i_end && is_batchable(*run); ++run) {
+          packet_size += run->size() + 2; // Including the separator.
+          if (packet_size > _max_packet_size)
+            break;
+          ++count;
         }
       }
-      _batch_exec_progress_state += _batch_exec_progress_inc;
+
+      size_t handled = 1;
+      if (count > 1)
+        handled = exec_packet(stmt, i, count, index, batch_exec_err_count);
+      else
+        exec_statement(stmt, *i, index, batch_exec_err_count);
+      std::advance(i, handled);
+      index += handled;
+
+      _batch_exec_progress_state += handled * _batch_exec_progress_inc;
       if (_batch_exec_progress_cb)
         _batch_exec_progress_cb(_batch_exec_progress_state);
 
@@ -84,4 +141,74 @@ namespace sql {
     }
   }
 
+  void SqlBatchExec::exec_statement(sql::Statement *stmt, const std::string &statement, size_t index,
+                                    long &batch_exec_err_count) {
+    try {
+      _sql_log.push_back(statement);
+      if (stmt->execute(statement))
+        std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+      ++_batch_exec_success_count;
+    } catch (SQLException &e) {
+      ++batch_exec_err_count;
+      if (!_error_cb)
+        throw;
+      report_error(e, statement, index, batch_exec_err_count);
+    }
+  }
+
+  /**
+   * Sends count statements as one multi-statement packet. The server stops processing such a packet at the first
+   * failing statement and every statement in it yields exactly one result, so the number of results read before the
+   * error tells which statement failed. Returns the number of statements handled, which is count on success or
+   * the number up to and including the failed one.
+   */
+  size_t SqlBatchExec::exec_packet(sql::Statement *stmt, std::list<std::string>::const_iterator first, size_t count,
+                                   size_t index, long &batch_exec_err_count) {
+    std::string packet;
+    std::list<std::string>::const_iterator i = first;
+    for (size_t n = 0; n < count; ++n, ++i) {
+      if (n > 0)
+        packet.append(";\n");
+      packet.append(*i);
+    }
+    ++_packet_count;
+
+    size_t executed = 0;
+    i = first;
+    try {
+      bool is_result_set = stmt->execute(packet);
+      while (true) {
+        if (is_result_set)
+          std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+        _sql_log.push_back(*i++);
+        ++_batch_exec_success_count;
+        if (++executed == count)
+          break;
+        is_result_set = stmt->getMoreResults();
+      }
+    } catch (SQLException &e) {
+      _sql_log.push_back(*i);
+      ++batch_exec_err_count;
+      if (!_error_cb)
+        throw;
+      report_error(e, *i, index + executed, batch_exec_err_count);
+      return executed + 1;
+    }
+
+    // Nothing should be left, but don't leave the connection out of sync if a statement did return more.
+    while (stmt->getMoreResults())
+      std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+
+    return count;
+  }
+
+  void SqlBatchExec::report_error(const SQLException &e, const std::string &statement, size_t index,
+                                  long &batch_exec_err_count) {
+    if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
+      _error_cb(-1, "Error when running failback script. Details follow.", "");
+    else
+      _failed_statements.push_back(index);
+    _error_cb(e.getErrorCode(), e.what(), statement);
+  }
+
 } // namespace sql
@@ -29,10 +29,13 @@
 #include <cppconn/connection.h>
 #include <list>
 #include <string>
+#include <vector>
 #include <functional>
 
 namespace sql {
 
+  class SQLException;
+
   class CPPDBC_PUBLIC_FUNC SqlBatchExec {
   public:
     SqlBatchExec();
@@ -40,8 +43,16 @@ namespace sql {
   public:
     long operator()(sql::Statement *stmt, std::list<std::string> &statements);
 
+    // Tells whether a statement can share a multi-statement packet with its neighbours: it must not return a result
+    // set, must not need any client side interaction (like LOAD DATA LOCAL) and must not contain a semicolon itself.
+    static bool is_batchable(const std::string &statement);
+
   private:
     void exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements, long &batch_exec_err_count);
+    void exec_statement(sql::Statement *stmt, const std::string &statement, size_t index, long &batch_exec_err_count);
+    size_t exec_packet(sql::Statement *stmt, std::list<std::string>::const_iterator first, size_t count, size_t index,
+                       long &batch_exec_err_count);
+    void report_error(const SQLException &e, const std::string &statement, size_t index, long &batch_exec_err_count);
 
   public:
     typedef std::function<int(long long, const std::string &, const std::string &)> Error_cb;
@@ -79,6 +90,29 @@ namespace sql {
   private:
     bool _stop_on_error;
 
+  public:
+    // Opt-in batching: when non-zero, consecutive batchable statements are sent together in multi-statement packets
+    // of at most this many bytes (usually the server's max_allowed_packet), which needs CLIENT_MULTI_STATEMENTS.
+    void max_packet_size(size_t value) {
+      _max_packet_size = value;
+    }
+    size_t max_packet_size() const {
+      return _max_packet_size;
+    }
+    long packet_count() const {
+      return _packet_count;
+    }
+
+    // 0-based indexes of the failed statements in the list passed to operator() (not including failback statements).
+    const std::vector<size_t> &failed_statements() const {
+      return _failed_statements;
+    }
+
+  private:
+    size_t _max_packet_size;
+    long _packet_count;
+    std::vector<size_t> _failed_statements;
+
   public:
     void failback_statements(const std::list<std::string> &value) {
       _failback_statements = value;
@@ -67,6 +67,21 @@ namespace bt = boost::posix_time;
 
 // JSON Control Implementation
 
+/**
+ * Returns the text shown for a number value in the tree view.
+ */
+static std::string numberText(const rapidjson::Value &value) {
+  if (value.IsDouble())
+    return std::to_string(value.GetDouble());
+  if (value.IsInt64())
+    return std::to_string(value.GetInt64());
+  if (value.IsUint64())
+    return std::to_string(value.GetUint64());
+  return "";
+}
+
+//--------------------------------------------------------------------------------------------------
+
 static void findNode(TreeNodeRef parent, const std::string &text, JsonTreeBaseView::TreeNodeVectorMap &found) {
   if (parent.is_valid()) {
     auto node = parent;
@@ -351,7 +366,8 @@ void JsonBaseView::clear() {
 
 //--------------------------------------------------------------------------------------------------
 
-JsonTreeBaseView::JsonTreeBaseView(rapidjson::Document &doc) : JsonBaseView(doc), _useFilter(false), _searchIdx(0) {
+JsonTreeBaseView::JsonTreeBaseView(rapidjson::Document &doc)
+  : JsonBaseView(doc), _indexedRoot(nullptr), _useFilter(false), _searchIdx(0) {
   _contextMenu = mforms::manage(new mforms::ContextMenu());
   _contextMenu->signal_will_show()->connect(std::bind(&JsonTreeBaseView::prepareMenu, this));
 }
@@ -431,6 +447,7 @@ void JsonTreeBaseView::handleMenuCommand(const std::string &command) {
       node->set_data(nullptr); // This will explicitly delete the data.
     }
     node->remove_from_parent();
+    buildValueIndex(_indexedRoot); // Erasing moved the following values in memory.
     _dataChanged(false);
     return;
   }
@@ -467,6 +484,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
           generateTree(objectName.empty() ? jv : jv[objectName], 0, newNode);
           newNode->set_string(0, objectName + "{" + std::to_string(jv.MemberCount()) + "}");
           newNode->set_tag(objectName);
+          buildValueIndex(_indexedRoot);
           _dataChanged(false);
           break;
         }
@@ -481,6 +499,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
           auto newNode = (updateMode) ? node : node->add_child();
           generateTree((updateMode) ? jv : *(jv.End()-1), 0, newNode);
           newNode->set_string(0, objectName + "[" + std::to_string(jv.Size()) + "]");
+          buildValueIndex(_indexedRoot);
           _dataChanged(false);
           break;
         }
@@ -512,6 +531,10 @@ void JsonTreeBaseView::highlightMatchNode(const std::string &text, bool backward
     _textToFind = text;
     _searchIdx = 0;
   }
+  if (!_valueIndex.empty() && !_useFilter) {
+    highlightIndexedMatch(text, backward);
+    return;
+  }
   bool needSearch = false;
   auto it = _viewFindResult.find(text);
   if (it != _viewFindResult.end()) {
@@ -560,17 +583,21 @@ void JsonTreeBaseView::collectParents(TreeNodeRef node, std::list<TreeNodeRef> &
 void JsonTreeBaseView::reCreateTree(Value &value) {
   _useFilter = false;
   _treeView->clear();
+  buildValueIndex(&value);
   auto node = _treeView->root_node()->add_child();
   _treeView->BeginUpdate();
-  Value o(kObjectType);
-  o.CopyFrom(value, _document.GetAllocator());
   generateTree(value, 0, node);
+  loadChildren(node);
   _treeView->EndUpdate();
+  node->expand();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 bool JsonTreeBaseView::filterView(const std::string &text, rapidjson::Value &value) {
+  if (!_valueIndex.empty() && !_useFilter)
+    return filterIndexedView(text, value);
+
   auto selectedNode = _treeView->get_selected_node();
   if (!selectedNode.is_valid())
     selectedNode = _treeView->root_node();
@@ -605,6 +632,169 @@ bool JsonTreeBaseView::filterView(const std::string &text, rapidjson::Value &val
 
 //--------------------------------------------------------------------------------------------------
 
+bool JsonTreeBaseView::loadChildren(TreeNodeRef /*node*/) {
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool JsonTreeBaseView::hasPlaceholder(TreeNodeRef node) {
+  // Every generated node carries a JsonValueNodeData, only the placeholder has no data.
+  return node->count() == 1 && node->get_child(0)->get_data() == nullptr;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeBaseView::buildValueIndex(rapidjson::Value *root) {
+  _valueIndex.clear();
+  _indexedRoot = root;
+  _searchIdx = 0;
+  if (root != nullptr)
+    indexValue(*root, std::string::npos, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeBaseView::indexValue(rapidjson::Value &value, size_t parent, size_t position) {
+  size_t entry = _valueIndex.size();
+  _valueIndex.push_back({ &value, parent, position, 0 });
+  size_t index = 0;
+  if (value.IsObject()) {
+    for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it)
+      indexValue(it->value, entry, index++);
+  } else if (value.IsArray()) {
+    for (auto &item : value.GetArray())
+      indexValue(item, entry, index++);
+  }
+  _valueIndex[entry].end = _valueIndex.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Checks the same text a search over the tree nodes would look at, i.e. what is shown in the value column.
+ */
+bool JsonTreeBaseView::valueMatches(const rapidjson::Value &value, const std::string &text) {
+  switch (value.GetType()) {
+    case kStringType:
+      return base::contains_string(std::string(value.GetString(), value.GetStringLength()), text, false);
+    case kNumberType:
+      return base::contains_string(numberText(value), text, false);
+    case kTrueType:
+    case kFalseType:
+      return base::contains_string(value.GetBool() ? "true" : "false", text, false);
+    default:
+      return false;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the tree node for the given index entry, loading the children of all its ancestors on the way.
+ */
+TreeNodeRef JsonTreeBaseView::materializeNode(size_t entry) {
+  std::vector<size_t> chain;
+  for (size_t current = entry; current != std::string::npos; current = _valueIndex[current].parent)
+    chain.push_back(current);
+
+  TreeNodeRef node;
+  if (_treeView->root_node()->count() > 0)
+    node = _treeView->root_node()->get_child(0);
+  if (!node.is_valid())
+    return TreeNodeRef();
+
+  for (auto it = chain.rbegin() + 1; it != chain.rend(); ++it) {
+    loadChildren(node);
+    node->expand();
+
+    const ValueIndexEntry &child = _valueIndex[*it];
+    TreeNodeRef next;
+    if ((int)child.position < node->count()) {
+      next = node->get_child((int)child.position);
+      auto data = dynamic_cast<JsonValueNodeData *>(next->get_data());
+      if (data == nullptr || &data->getData() != child.value)
+        next = TreeNodeRef();
+    }
+    if (!next.is_valid()) {
+      // Children don't line up with the document, look for the value itself.
+      for (int i = 0; i < node->count(); ++i) {
+        auto data = dynamic_cast<JsonValueNodeData *>(node->get_child(i)->get_data());
+        if (data != nullptr && &data->getData() == child.value) {
+          next = node->get_child(i);
+          break;
+        }
+      }
+    }
+    if (!next.is_valid())
+      return TreeNodeRef();
+    node = next;
+  }
+  return node;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool JsonTreeBaseView::highlightIndexedMatch(const std::string &text, bool backward) {
+  // _searchIdx is the index entry following the current match, 0 when starting a new search.
+  size_t count = _valueIndex.size();
+  bool newSearch = _searchIdx == 0;
+  size_t current = newSearch ? 0 : _searchIdx - 1;
+  for (size_t i = 0; i < count; ++i) {
+    size_t offset = newSearch ? i : i + 1;
+    size_t entry = backward ? (current + count - offset % count) % count : (current + offset) % count;
+    if (!valueMatches(*_valueIndex[entry].value, text))
+      continue;
+
+    TreeNodeRef node = materializeNode(entry);
+    if (!node.is_valid())
+      continue;
+    _treeView->select_node(node);
+    _treeView->scrollToNode(node);
+    _treeView->focus();
+    _searchIdx = entry + 1;
+    return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool JsonTreeBaseView::filterIndexedView(const std::string &text, rapidjson::Value &value) {
+  // Restrict the search to the selected value and its descendants, like the node based filter does.
+  size_t begin = 0, end = _valueIndex.size();
+  auto selectedNode = _treeView->get_selected_node();
+  if (selectedNode.is_valid()) {
+    auto data = dynamic_cast<JsonValueNodeData *>(selectedNode->get_data());
+    for (size_t i = 0; data != nullptr && i < _valueIndex.size(); ++i) {
+      if (_valueIndex[i].value == &data->getData()) {
+        begin = i;
+        end = _valueIndex[i].end;
+        break;
+      }
+    }
+  }
+
+  _filterGuard.clear();
+  for (size_t entry = begin; entry < end; ++entry) {
+    if (!valueMatches(*_valueIndex[entry].value, text))
+      continue;
+    for (size_t current = entry; current != std::string::npos; current = _valueIndex[current].parent) {
+      if (!_filterGuard.insert(_valueIndex[current].value).second)
+        break; // The rest of the chain is already in.
+    }
+  }
+
+  if (!_filterGuard.empty()) {
+    _useFilter = true;
+    _treeView->clear();
+    generateTree(value, 0, _treeView->root_node());
+  }
+  return _useFilter;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void JsonTreeBaseView::generateTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew) {
   switch (value.GetType()) {
     case kNumberType:
@@ -820,6 +1010,7 @@ JsonTreeView::JsonTreeView(Document &doc) : JsonTreeBaseView(doc) {
   _treeView->set_cell_edit_handler(std::bind(&JsonTreeBaseView::setCellValue, this, ph::_1, ph::_2, ph::_3));
   _treeView->set_selection_mode(TreeSelectSingle);
   _treeView->set_context_menu(_contextMenu);
+  scoped_connect(_treeView->signal_expand_toggle(), std::bind(&JsonTreeView::nodeExpandToggled, this, ph::_1, ph::_2));
   init();
 }
 
@@ -840,6 +1031,8 @@ JsonTreeView::~JsonTreeView() {
 
 void JsonTreeView::clear() {
   _treeView->clear();
+  _valueIndex.clear();
+  _indexedRoot = nullptr;
   _viewFindResult.clear();
   _textToFind = "";
   _searchIdx = 0;
@@ -850,8 +1043,11 @@ void JsonTreeView::clear() {
 
 void JsonTreeView::setJson(rapidjson::Value &value) {
   clear();
+  buildValueIndex(&value);
   auto node = _treeView->root_node()->add_child();
   generateTree(value, 0, node);
+  loadChildren(node);
+  node->expand();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -860,18 +1056,68 @@ void JsonTreeView::appendJson(rapidjson::Value &value) {
   TreeNodeRef node = _treeView->root_node();
   _viewFindResult.clear();
   _textToFind = "";
-  _searchIdx = 0;
+  buildValueIndex(nullptr); // Several top level values, searching falls back to the tree nodes.
   generateTree(value, 0, node);
 }
 
 //--------------------------------------------------------------------------------------------------
 
+void JsonTreeView::nodeExpandToggled(TreeNodeRef node, bool expanded) {
+  if (expanded && !_useFilter)
+    loadChildren(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the placeholder of a collapsed object or array node with the real children.
+ * Returns true if the children had to be created.
+ */
+bool JsonTreeView::loadChildren(TreeNodeRef node) {
+  if (!node.is_valid() || !hasPlaceholder(node))
+    return false;
+  auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
+  if (data == nullptr)
+    return false;
+
+  _treeView->BeginUpdate();
+  node->remove_children();
+  rapidjson::Value &value = data->getData();
+  if (value.IsObject())
+    generateObjectChildren(value, node, true);
+  else if (value.IsArray())
+    generateArrayChildren(value, node);
+  _treeView->EndUpdate();
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node, bool addNew) {
   if (_useFilter && _filterGuard.count(&value) == 0)
     return;
-  size_t size = 0;
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
 
+  if (addNew && value.MemberCount() > 0) {
+    node->set_icon_path(0, "JS_Datatype_Object.png");
+    std::string name = node->get_string(0);
+    if (name.empty())
+      node->set_string(0, "<unnamed>");
+    node->set_string(1, "");
+    node->set_string(2, "Object");
+  }
+
+  // Members are created when the node is expanded. A filtered tree is small and shown fully expanded.
+  if (_useFilter || !addNew)
+    generateObjectChildren(value, node, addNew);
+  else if (value.MemberCount() > 0)
+    node->add_child();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::generateObjectChildren(rapidjson::Value &value, TreeNodeRef node, bool addNew) {
+  size_t size = 0;
   for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
     std::string text = it->name.GetString();
     std::stringstream textSize;
@@ -899,18 +1145,11 @@ void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*
         break;
     }
     auto node2 = (addNew) ? node->add_child() : node;
-    if (addNew) {
-      node->set_icon_path(0, "JS_Datatype_Object.png");
-      std::string name = node->get_string(0);
-      if (name.empty())
-        node->set_string(0, "<unnamed>");
-      node->set_string(1, "");
-      node->set_string(2, "Object");
-    }
     node2->set_string(0, text);
     node2->set_tag(text);
     generateTree(it->value, 1, node2);
-    node2->expand();
+    if (_useFilter)
+      node2->expand();
   }
 }
 
@@ -926,9 +1165,19 @@ void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
     node->set_string(0, "<unnamed>");
   node->set_string(1, "");
   node->set_string(2, "Array");
-  std::string tagName = node->get_tag();
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
 
+  if (_useFilter) {
+    generateArrayChildren(value, node);
+    node->expand();
+  } else if (!value.Empty())
+    node->add_child();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::generateArrayChildren(rapidjson::Value &value, TreeNodeRef node) {
+  std::string tagName = node->get_tag();
   int index = 0;
   for (auto &v : value.GetArray()) {
     if (_useFilter && _filterGuard.count(&v) == 0)
@@ -943,7 +1192,6 @@ void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
     generateTree(v, 1, arrrayNode, addNew);
     index++;
   }
-  node->expand();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -962,16 +1210,13 @@ void JsonTreeView::generateBoolInTree(rapidjson::Value &value, int /*columnId*/,
 void JsonTreeView::generateNumberInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node) {
   node->set_icon_path(0, "JS_Datatype_Number.png");
   node->set_attributes(1, mforms::TextAttributes("#4b4a4c", false, false));
-  if (value.IsDouble()) {
-    node->set_string(1, std::to_string(value.GetDouble()));
+  node->set_string(1, numberText(value));
+  if (value.IsDouble())
     node->set_string(2, "Double");
-  } else if (value.IsInt64()) {
-    node->set_string(1, std::to_string(value.GetInt64()));
+  else if (value.IsInt64())
     node->set_string(2, "Long Integer");
-  } else if (value.IsUint64()) {
-    node->set_string(1, std::to_string(value.GetUint64()));
+  else if (value.IsUint64())
     node->set_string(2, "Unsigned Long Integer");
-  }
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
   node->expand();
 }
@@ -1508,6 +1753,7 @@ JsonTabView::JsonTabView(bool tabLess, JsonTabViewType defaultView)
     _treeView(manage(new JsonTreeView(_document))),
     _gridView(manage(new JsonGridView(_document))),
     _tabView(manage(new TabView(tabLess ? TabViewTabless : TabViewPalette))),
+    _jsonTextStale(false),
     _updating(false),
     _defaultView(defaultView) {
   Setup();
@@ -1520,20 +1766,18 @@ JsonTabView::~JsonTabView() {
 
 //--------------------------------------------------------------------------------------------------
 void JsonTabView::setJson(const rapidjson::Value &value) {
-  Document d;
-  _json.CopyFrom(value, d.GetAllocator());
+  _json.CopyFrom(value, _document.GetAllocator());
   _ident = 0;
   _updating = true;
-  d.CopyFrom(_json, d.GetAllocator());
-  StringBuffer buffer;
-  PrettyWriter<StringBuffer> writer(buffer);
-  d.Accept(writer);
-  _jsonText = buffer.GetString();
+
+  // Serializing a large document takes a while and is only needed once the text is shown or requested.
+  _jsonText.clear();
+  _jsonTextStale = true;
 
   _updateView = { true, true, true };
   switch (_defaultView) {
     case JsonTabView::TabText:
-      _textView->setText(_jsonText, false);
+      _textView->setText(text(), false);
       _updateView.textViewUpdate = false;
       break;
     case JsonTabView::TabTree:
@@ -1553,6 +1797,7 @@ void JsonTabView::setJson(const rapidjson::Value &value) {
 
 void JsonTabView::setText(const std::string &text, bool validate) {
   _jsonText = text;
+  _jsonTextStale = false;
   _textView->setText(text, validate);
   _updateView.textViewUpdate = false;
 }
@@ -1563,18 +1808,18 @@ void JsonTabView::tabChanged() {
   int tabId = _tabView->get_active_tab();
   if (tabId == _tabId.textTabId && _updateView.textViewUpdate) {
     _updating = true;
-    _textView->setText(_jsonText);
+    _textView->setText(text());
     _updateView.textViewUpdate = false;
     _updating = false;
-    _dataChanged(_jsonText);
+    _dataChanged(text());
   } else if (tabId == _tabId.treeViewTabId && _updateView.treeViewUpdate) {
     _treeView->reCreateTree(_json);
     _updateView.treeViewUpdate = false;
-    _dataChanged(_jsonText);
+    _dataChanged(text());
   } else if (tabId == _tabId.gridViewTabId && _updateView.gridViewUpdate) {
     _gridView->reCreateTree(_json);
     _updateView.gridViewUpdate = false;
-    _dataChanged(_jsonText);
+    _dataChanged(text());
   }
 }
 
@@ -1590,9 +1835,11 @@ void JsonTabView::dataChanged(bool forceUpdate) {
     Writer<StringBuffer> writer(buffer);
     _document.Accept(writer);
     _jsonText = buffer.GetString();
+    _jsonTextStale = false;
   } else {
     if (_textView->validate()) {
       _jsonText = _textView->getText();
+      _jsonTextStale = false;
       _json.CopyFrom(_textView->getJson(), _document.GetAllocator());
     } else
       return;
@@ -1614,6 +1861,7 @@ boost::signals2::signal<void(const std::string &text)> *JsonTabView::editorDataC
 
 void JsonTabView::clear() {
   _jsonText.clear();
+  _jsonTextStale = false;
   _textView->clear();
   _treeView->clear();
   _gridView->clear();
@@ -1720,6 +1968,13 @@ JsonTabView::JsonTabViewType JsonTabView::getActiveTab() const {
 //--------------------------------------------------------------------------------------------------
 
 const std::string &JsonTabView::text() const {
+  if (_jsonTextStale) {
+    StringBuffer buffer;
+    PrettyWriter<StringBuffer> writer(buffer);
+    _json.Accept(writer);
+    _jsonText = buffer.GetString();
+    _jsonTextStale = false;
+  }
   return _jsonText;
 }
 
@@ -31,6 +31,7 @@
 #include "Scintilla.h"
 
 #include <set>
+#include <vector>
 #include <functional>
 
 
@@ -162,6 +163,26 @@ namespace mforms {
     void collectParents(TreeNodeRef node, TreeNodeList &parents);
     static std::string getNodeIconPath(JsonNodeIcons icon);
 
+    // Lazy loading: containers get a single placeholder child, which is replaced by the real children on expand.
+    virtual bool loadChildren(TreeNodeRef node);
+    static bool hasPlaceholder(TreeNodeRef node);
+
+    // Flat index of all values of the document in document order, used to search without materializing the tree.
+    struct ValueIndexEntry {
+      rapidjson::Value *value;
+      size_t parent;   // entry index of the containing value, npos for the root
+      size_t position; // index of the value within its parent (member or element index)
+      size_t end;      // entry index following the last descendant
+    };
+    void buildValueIndex(rapidjson::Value *root);
+    void indexValue(rapidjson::Value &value, size_t parent, size_t position);
+    static bool valueMatches(const rapidjson::Value &value, const std::string &text);
+    TreeNodeRef materializeNode(size_t entry);
+    bool highlightIndexedMatch(const std::string &text, bool backward);
+    bool filterIndexedView(const std::string &text, rapidjson::Value &value);
+
+    std::vector<ValueIndexEntry> _valueIndex;
+    rapidjson::Value *_indexedRoot;
     TreeNodeVectorMap _viewFindResult;
     std::set<rapidjson::Value *> _filterGuard;
     bool _useFilter;
@@ -190,6 +211,10 @@ namespace mforms {
 
   private:
     void init();
+    void nodeExpandToggled(TreeNodeRef node, bool expanded);
+    virtual bool loadChildren(TreeNodeRef node);
+    void generateObjectChildren(rapidjson::Value &value, TreeNodeRef node, bool addNew);
+    void generateArrayChildren(rapidjson::Value &value, TreeNodeRef node);
     virtual void generateArrayInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void generateObjectInTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew);
     virtual void generateNumberInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
@@ -275,7 +300,8 @@ namespace mforms {
     JsonTreeView *_treeView;
     JsonGridView *_gridView;
     TabView *_tabView;
-    std::string _jsonText;
+    mutable std::string _jsonText;
+    mutable bool _jsonTextStale; // _jsonText is generated from _json on first use
     rapidjson::Value _json;
     rapidjson::Document _document;
     int _ident;
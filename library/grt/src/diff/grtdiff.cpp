@@ -26,6 +26,7 @@
 
 #include "base/util_functions.h"
 #include "base/log.h"
+#include "base/profiling.h"
 
 #include "grtdiff.h"
 #include "diffchange.h"
@@ -94,6 +95,7 @@ namespace grt {
   }
 
   std::shared_ptr<DiffChange> GrtDiff::diff(const ValueRef &source, const ValueRef &target, const Omf *omf) {
+    BASE_TRACE("grt", "diff");
     return on_value(std::shared_ptr<DiffChange>(), source, target);
   }
 
@@ -32,6 +32,7 @@
 #include "grtpp_util.h"
 #include "grtpp_shell.h"
 #include "grtpp_module_cpp.h"
+#include "grtpp_module_lazy.h"
 #include "grtpp_undo_manager.h"
 #include "grtpp_notifications.h"
 
@@ -251,10 +252,11 @@ StringRef StringRef::format(const char *format, ...) {
 
 //--------------------------------------------------------------------------------------------------
 
-GRT::GRT() : _check_serialized_crc(false), _verbose(false), _testing(false) {
+GRT::GRT() : _module_manifest(nullptr), _check_serialized_crc(false), _verbose(false), _testing(false) {
   _scanning_modules = false;
 
   _tracking_changes = 0;
+  _untracked_changes = 0;
   _shell = 0;
 
   if (getenv("GRT_VERBOSE"))
@@ -837,6 +839,21 @@ int GRT::scan_modules_in(const std::string &path, const std::string &basePath, c
     }
 
     try {
+      // Modules known from the manifest can be registered without loading them yet.
+      if (_module_manifest != nullptr && !reload) {
+        Module *module = _module_manifest->create_deferred_module(module_path);
+        if (module != nullptr) {
+          try {
+            register_new_module(module);
+          } catch (...) {
+            delete module;
+            throw;
+          }
+          count++;
+          continue;
+        }
+      }
+
       if (load_module(module_path, basePath, reload)) {
         count++;
       }
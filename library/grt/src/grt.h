@@ -27,6 +27,7 @@
 #include <cxxabi.h>
 #endif
 #include <typeinfo>
+#include <atomic>
 #include <list>
 #include <map>
 #include <unordered_map>
@@ -2148,6 +2149,7 @@ namespace grt {
   protected:
     friend class Serializer;
     friend class Unserializer;
+    friend class MetaClassCache;
 
     MetaClass();
     void load_xml(xmlNodePtr node);
@@ -2435,6 +2437,7 @@ namespace grt {
   class Shell;
   class ModuleWrapper;
   class CPPModuleLoader;
+  class ModuleManifest;
   class Interface;
 
   class UndoGroup;
@@ -2509,6 +2512,20 @@ namespace grt {
      */
     void end_loading_metaclasses(bool check_class_binding = true);
 
+    /** Loads the metaclasses from a binary cache written by @ref save_metaclass_cache().
+     * The cache is only used if the struct files found in the given directories are exactly the
+     * ones it was created from (same paths, modification times and sizes).
+     *
+     * @ref end_loading_metaclasses() must be called afterwards, just like after scanning the XML files.
+     *
+     * @return the number of metaclasses loaded or -1 if the cache is missing, outdated or invalid, in which
+     * case nothing was loaded.
+     */
+    int load_metaclass_cache(const std::string &cache_file, const std::vector<std::string> &directories);
+
+    /** Writes all metaclasses loaded from struct files into a binary cache file. */
+    bool save_metaclass_cache(const std::string &cache_file, const std::vector<std::string> &directories);
+
     const std::list<MetaClass *> &get_metaclasses() const {
       return _metaclasses_list;
     }
@@ -2589,6 +2606,17 @@ namespace grt {
     int scan_modules_in(const std::string &path, const std::string &basePath, const std::list<std::string> &exts,
                         bool reload);
 
+    /** Sets a manifest of previously loaded modules. While scanning, modules listed in it as deferrable are
+     * registered from their manifest entry and only loaded when first called. Pass nullptr to load all modules
+     * immediately (the default). The manifest is not owned by the GRT.
+     */
+    void set_module_manifest(ModuleManifest *manifest) {
+      _module_manifest = manifest;
+    }
+    ModuleManifest *get_module_manifest() const {
+      return _module_manifest;
+    }
+
     const std::vector<Module *> &get_modules() const {
       return _modules;
     }
@@ -2703,6 +2731,15 @@ namespace grt {
       return _tracking_changes > 0;
     }
 
+    // Counts changes to global values made while change tracking was off. Code that follows changes through the
+    // undo manager can compare this to find out that it missed some.
+    void note_untracked_change() {
+      ++_untracked_changes;
+    }
+    size_t untracked_change_count() const {
+      return _untracked_changes;
+    }
+
     /** Starts tracking undo changes and opens an undo group.
      * Use the AutoUndo class for auto-trackign.
      */
@@ -2762,6 +2799,7 @@ namespace grt {
     std::vector<Module *> _modules;
     std::map<std::string, Interface *> _interfaces;
     std::map<std::string, ModuleWrapper *> _cached_module_wrapper;
+    ModuleManifest *_module_manifest;
 
     std::map<std::string, std::pair<void *, void (*)(void *)> > _context_data;
 
@@ -2781,6 +2819,7 @@ namespace grt {
     std::string _global_module_options_path;
     std::string _document_module_options_path;
     int _tracking_changes;
+    std::atomic<size_t> _untracked_changes;
     bool _check_serialized_crc;
     bool _verbose;
     bool _scanning_modules;
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+// Internal helpers for the binary startup caches (metaclass registry, module manifest). Not exported.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "grt.h"
+
+namespace grt {
+  namespace internal {
+
+    // Identifies the exact version of a file a cache entry was created from.
+    struct FileStamp {
+      int64_t mtime = 0;
+      int64_t size = 0;
+
+      static bool get(const std::string &path, FileStamp &stamp) {
+        GStatBuf info;
+        if (g_stat(path.c_str(), &info) != 0)
+          return false;
+        stamp.mtime = (int64_t)info.st_mtime;
+        stamp.size = (int64_t)info.st_size;
+        return true;
+      }
+
+      bool operator==(const FileStamp &other) const {
+        return mtime == other.mtime && size == other.size;
+      }
+      bool operator!=(const FileStamp &other) const {
+        return !(*this == other);
+      }
+    };
+
+    //----------------------------------------------------------------------------------------------
+
+    class CacheWriter {
+    public:
+      CacheWriter(const char *magic, uint32_t version) {
+        _data.append(magic, 4);
+        write(version);
+      }
+
+      void write(uint32_t value) {
+        _data.append((const char *)&value, sizeof(value));
+      }
+
+      void write(int64_t value) {
+        _data.append((const char *)&value, sizeof(value));
+      }
+
+      void write(bool value) {
+        _data.push_back(value ? 1 : 0);
+      }
+
+      void write(const std::string &value) {
+        write((uint32_t)value.size());
+        _data.append(value);
+      }
+
+      void write(const FileStamp &stamp) {
+        write(stamp.mtime);
+        write(stamp.size);
+      }
+
+      void write(const TypeSpec &type) {
+        write((uint32_t)type.base.type);
+        write(type.base.object_class);
+        write((uint32_t)type.content.type);
+        write(type.content.object_class);
+      }
+
+      // Writes to a temporary file first and renames it, so a concurrently starting instance never reads
+      // a partially written cache.
+      bool save(const std::string &path) {
+        return g_file_set_contents(path.c_str(), _data.data(), (gssize)_data.size(), NULL) != FALSE;
+      }
+
+    private:
+      std::string _data;
+    };
+
+    //----------------------------------------------------------------------------------------------
+
+    // Reads values written by CacheWriter. Reading past the end (a truncated or foreign file) does not
+    // throw but marks the reader as failed, which callers check with ok() before using what they read.
+    class CacheReader {
+    public:
+      CacheReader() : _contents(nullptr), _position(nullptr), _end(nullptr), _ok(false) {
+      }
+
+      ~CacheReader() {
+        g_free(_contents);
+      }
+
+      bool open(const std::string &path, const char *magic, uint32_t version) {
+        gsize length = 0;
+        if (!g_file_get_contents(path.c_str(), &_contents, &length, NULL))
+          return false;
+        _position = _contents;
+        _end = _contents + length;
+        _ok = length >= 4 && memcmp(_contents, magic, 4) == 0;
+        if (_ok) {
+          _position += 4;
+          _ok = read_uint() == version;
+        }
+        return _ok;
+      }
+
+      bool ok() const {
+        return _ok;
+      }
+
+      bool at_end() const {
+        return _position == _end;
+      }
+
+      uint32_t read_uint() {
+        uint32_t value = 0;
+        read_raw(&value, sizeof(value));
+        return value;
+      }
+
+      int64_t read_int64() {
+        int64_t value = 0;
+        read_raw(&value, sizeof(value));
+        return value;
+      }
+
+      bool read_bool() {
+        char value = 0;
+        read_raw(&value, 1);
+        return value != 0;
+      }
+
+      std::string read_string() {
+        uint32_t length = read_uint();
+        if (!_ok || length > (size_t)(_end - _position)) {
+          _ok = false;
+          return "";
+        }
+        std::string result(_position, length);
+        _position += length;
+        return result;
+      }
+
+      FileStamp read_stamp() {
+        FileStamp stamp;
+        stamp.mtime = read_int64();
+        stamp.size = read_int64();
+        return stamp;
+      }
+
+      TypeSpec read_type() {
+        TypeSpec type;
+        type.base.type = (Type)read_uint();
+        type.base.object_class = read_string();
+        type.content.type = (Type)read_uint();
+        type.content.object_class = read_string();
+        return type;
+      }
+
+    private:
+      gchar *_contents;
+      const char *_position;
+      const char *_end;
+      bool _ok;
+
+      void read_raw(void *target, size_t size) {
+        if (!_ok || size > (size_t)(_end - _position)) {
+          _ok = false;
+          return;
+        }
+        memcpy(target, _position, size);
+        _position += size;
+      }
+    };
+
+  } // namespace internal
+} // namespace grt
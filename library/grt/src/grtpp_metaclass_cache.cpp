@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include "base/log.h"
+
+#include "grt.h"
+#include "grtpp_cache_io.h"
+
+DEFAULT_LOG_DOMAIN(DOMAIN_GRT)
+
+using namespace grt;
+
+static const char *METACLASS_CACHE_MAGIC = "GRTM";
+
+// Must be increased whenever the layout written by MetaClassCache::write_class() changes.
+static const uint32_t METACLASS_CACHE_VERSION = 1;
+
+//--------------------------------------------------------------------------------------------------
+
+namespace grt {
+
+  // Has access to the MetaClass internals, to store and restore them without going through the XML parser.
+  class MetaClassCache {
+  public:
+    static void write_class(internal::CacheWriter &writer, MetaClass *metaclass) {
+      writer.write(metaclass->_name);
+      writer.write(metaclass->_parent ? metaclass->_parent->_name : std::string());
+      writer.write(metaclass->_source);
+      writer.write((uint32_t)metaclass->_crc32);
+      writer.write(metaclass->_force_impl);
+      writer.write(metaclass->_watch_lists);
+      writer.write(metaclass->_watch_dicts);
+      writer.write(metaclass->_impl_data);
+
+      writer.write((uint32_t)metaclass->_attributes.size());
+      for (auto &attribute : metaclass->_attributes) {
+        writer.write(attribute.first);
+        writer.write(attribute.second);
+      }
+
+      writer.write((uint32_t)metaclass->_members.size());
+      for (auto &entry : metaclass->_members) {
+        const MetaClass::Member &member = entry.second;
+        writer.write(member.name);
+        writer.write(member.type);
+        writer.write(member.default_value);
+        writer.write(member.read_only);
+        writer.write(member.delegate_get);
+        writer.write(member.delegate_set);
+        writer.write(member.private_);
+        writer.write(member.calculated);
+        writer.write(member.owned_object);
+        writer.write(member.overrides);
+        writer.write(member.null_content_allowed);
+      }
+
+      writer.write((uint32_t)metaclass->_methods.size());
+      for (auto &entry : metaclass->_methods) {
+        const MetaClass::Method &method = entry.second;
+        writer.write(method.name);
+        writer.write(method.module_name);
+        writer.write(method.module_function);
+        writer.write(method.ret_type);
+        writer.write((uint32_t)method.arg_types.size());
+        for (auto &arg : method.arg_types) {
+          writer.write(arg.name);
+          writer.write(arg.doc);
+          writer.write(arg.type);
+        }
+        writer.write(method.constructor);
+        writer.write(method.abstract);
+      }
+
+      writer.write((uint32_t)metaclass->_signals.size());
+      for (auto &signal : metaclass->_signals) {
+        writer.write(signal.name);
+        writer.write((uint32_t)signal.arg_types.size());
+        for (auto &arg : signal.arg_types) {
+          writer.write(arg.name);
+          writer.write((uint32_t)arg.type);
+          writer.write(arg.object_class);
+        }
+      }
+    }
+
+    //----------------------------------------------------------------------------------------------
+
+    // Returns a new metaclass, with its parent name in parent_name (the parent itself is resolved once all
+    // classes are read). Returns nullptr if the reader failed.
+    static MetaClass *read_class(internal::CacheReader &reader, std::string &parent_name) {
+      std::unique_ptr<MetaClass> metaclass(new MetaClass());
+
+      metaclass->_name = reader.read_string();
+      parent_name = reader.read_string();
+      metaclass->_source = reader.read_string();
+      metaclass->_crc32 = reader.read_uint();
+      metaclass->_force_impl = reader.read_bool();
+      metaclass->_watch_lists = reader.read_bool();
+      metaclass->_watch_dicts = reader.read_bool();
+      metaclass->_impl_data = reader.read_bool();
+
+      uint32_t count = reader.read_uint();
+      for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        std::string key = reader.read_string();
+        metaclass->_attributes[key] = reader.read_string();
+      }
+
+      count = reader.read_uint();
+      for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        MetaClass::Member member;
+        member.name = reader.read_string();
+        member.type = reader.read_type();
+        member.default_value = reader.read_string();
+        member.read_only = reader.read_bool();
+        member.delegate_get = reader.read_bool();
+        member.delegate_set = reader.read_bool();
+        member.private_ = reader.read_bool();
+        member.calculated = reader.read_bool();
+        member.owned_object = reader.read_bool();
+        member.overrides = reader.read_bool();
+        member.null_content_allowed = reader.read_bool();
+        member.property = 0;
+        metaclass->_members[member.name] = member;
+      }
+
+      count = reader.read_uint();
+      for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        MetaClass::Method method;
+        method.name = reader.read_string();
+        method.module_name = reader.read_string();
+        method.module_function = reader.read_string();
+        method.ret_type = reader.read_type();
+        uint32_t arg_count = reader.read_uint();
+        for (uint32_t j = 0; j < arg_count && reader.ok(); ++j) {
+          ArgSpec arg;
+          arg.name = reader.read_string();
+          arg.doc = reader.read_string();
+          arg.type = reader.read_type();
+          method.arg_types.push_back(arg);
+        }
+        method.constructor = reader.read_bool();
+        method.abstract = reader.read_bool();
+        method.function = 0;
+        metaclass->_methods[method.name] = method;
+      }
+
+      count = reader.read_uint();
+      for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+        MetaClass::Signal signal;
+        signal.name = reader.read_string();
+        uint32_t arg_count = reader.read_uint();
+        for (uint32_t j = 0; j < arg_count && reader.ok(); ++j) {
+          MetaClass::SignalArg arg;
+          arg.name = reader.read_string();
+          arg.type = (MetaClass::SignalArgType)reader.read_uint();
+          arg.object_class = reader.read_string();
+          signal.arg_types.push_back(arg);
+        }
+        metaclass->_signals.push_back(signal);
+      }
+
+      if (!reader.ok() || metaclass->_name.empty())
+        return nullptr;
+      return metaclass.release();
+    }
+
+    //----------------------------------------------------------------------------------------------
+
+    static void set_parent(MetaClass *metaclass, MetaClass *parent) {
+      metaclass->_parent = parent;
+    }
+  };
+
+} // namespace grt
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Collects the struct files (structs.*.xml) in the given directories, in the same way scan_metaclasses_in()
+ * finds them, together with their current file stamps.
+ */
+static std::vector<std::pair<std::string, internal::FileStamp>> struct_files_in(
+  const std::vector<std::string> &directories) {
+  std::vector<std::pair<std::string, internal::FileStamp>> result;
+
+  for (auto &directory : directories) {
+    GDir *dir = g_dir_open(directory.c_str(), 0, NULL);
+    if (!dir)
+      continue;
+
+    const char *entry;
+    while ((entry = g_dir_read_name(dir)) != NULL) {
+      if (g_str_has_prefix(entry, "structs.") && g_str_has_suffix(entry, ".xml")) {
+        char *path = g_build_filename(directory.c_str(), entry, NULL);
+        internal::FileStamp stamp;
+        if (internal::FileStamp::get(path, stamp))
+          result.push_back({ path, stamp });
+        g_free(path);
+      }
+    }
+    g_dir_close(dir);
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const std::pair<std::string, internal::FileStamp> &a,
+               const std::pair<std::string, internal::FileStamp> &b) { return a.first < b.first; });
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool GRT::save_metaclass_cache(const std::string &cache_file, const std::vector<std::string> &directories) {
+  auto files = struct_files_in(directories);
+
+  internal::CacheWriter writer(METACLASS_CACHE_MAGIC, METACLASS_CACHE_VERSION);
+  writer.write((uint32_t)files.size());
+  for (auto &file : files) {
+    writer.write(file.first);
+    writer.write(file.second);
+  }
+
+  writer.write((uint32_t)_metaclasses_list.size());
+  for (auto metaclass : _metaclasses_list)
+    MetaClassCache::write_class(writer, metaclass);
+
+  if (!writer.save(cache_file)) {
+    logWarning("Could not write metaclass cache %s\n", cache_file.c_str());
+    return false;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int GRT::load_metaclass_cache(const std::string &cache_file, const std::vector<std::string> &directories) {
+  internal::CacheReader reader;
+  if (!reader.open(cache_file, METACLASS_CACHE_MAGIC, METACLASS_CACHE_VERSION))
+    return -1;
+
+  // The cache is only valid for exactly the set of struct files it was created from.
+  auto files = struct_files_in(directories);
+  if (reader.read_uint() != files.size())
+    return -1;
+  for (auto &file : files) {
+    std::string path = reader.read_string();
+    internal::FileStamp stamp = reader.read_stamp();
+    if (!reader.ok() || path != file.first || stamp != file.second) {
+      logDebug("Metaclass cache is outdated (%s changed)\n", file.first.c_str());
+      return -1;
+    }
+  }
+
+  std::vector<std::unique_ptr<MetaClass>> classes;
+  std::vector<std::string> parents;
+  std::map<std::string, MetaClass *> by_name;
+
+  uint32_t count = reader.read_uint();
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    std::string parent;
+    MetaClass *metaclass = MetaClassCache::read_class(reader, parent);
+    if (metaclass == nullptr)
+      break;
+    classes.emplace_back(metaclass);
+    parents.push_back(parent);
+    by_name[metaclass->name()] = metaclass;
+  }
+
+  if (!reader.ok() || !reader.at_end() || classes.size() != count) {
+    logWarning("Metaclass cache %s is damaged, ignoring it\n", cache_file.c_str());
+    return -1;
+  }
+
+  // Resolve parents and check for conflicts before registering anything, so a failure leaves no traces.
+  for (size_t i = 0; i < classes.size(); ++i) {
+    if (get_metaclass(classes[i]->name()) != nullptr)
+      return -1;
+
+    MetaClass *parent = nullptr;
+    if (!parents[i].empty()) {
+      auto iter = by_name.find(parents[i]);
+      parent = iter != by_name.end() ? iter->second : get_metaclass(parents[i]);
+      if (parent == nullptr)
+        return -1;
+    }
+    MetaClassCache::set_parent(classes[i].get(), parent);
+  }
+
+  for (auto &metaclass : classes) {
+    add_metaclass(metaclass.get());
+    _metaclasses_list.push_back(metaclass.release());
+  }
+
+  return (int)count;
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+
+#include "base/log.h"
+#include "base/file_utilities.h"
+#include "base/util_functions.h"
+
+#include "grtpp_module_lazy.h"
+#include "grtpp_cache_io.h"
+
+DEFAULT_LOG_DOMAIN(DOMAIN_GRT)
+
+using namespace grt;
+
+static const char *MODULE_MANIFEST_MAGIC = "GRTL";
+static const uint32_t MODULE_MANIFEST_VERSION = 1;
+
+//----------------- LazyModule ---------------------------------------------------------------------
+
+LazyModule::LazyModule(ModuleLoader *loader) : Module(loader), _module(nullptr) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+LazyModule::~LazyModule() {
+  delete _module;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Module *LazyModule::load() {
+  base::MutexLock lock(_load_mutex);
+
+  if (_module == nullptr) {
+    double start = base::timestamp();
+
+    Module *module = _loader->init_module(_path);
+    if (module == nullptr)
+      throw grt::module_error("Could not load module " + _name + " from " + _path);
+
+    if (module->name() != _name) {
+      std::string name = module->name();
+      delete module;
+      throw grt::module_error("Module file " + _path + " now contains module " + name + " instead of " + _name);
+    }
+
+    _module = module;
+    logInfo("Loaded deferred module %s (%.3fs)\n", _name.c_str(), base::timestamp() - start);
+  }
+  return _module;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ValueRef LazyModule::call_function(const std::string &name, const grt::BaseListRef &args) {
+  if (!has_function(name))
+    throw grt::module_error(std::string("Module ").append(_name).append(" doesn't have function ").append(name));
+
+  return load()->call_function(name, args);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void LazyModule::closeModule() noexcept {
+  if (_module != nullptr)
+    _module->closeModule();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+GModule *LazyModule::getModule() const {
+  return _module != nullptr ? _module->getModule() : nullptr;
+}
+
+//----------------- ModuleManifest -----------------------------------------------------------------
+
+ModuleManifest::ModuleManifest(const std::list<std::string> &deferrable_patterns)
+  : _patterns(deferrable_patterns), _deferred_count(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ModuleManifest::is_deferrable(const std::string &path) const {
+  std::string name = base::basename(path);
+  for (auto &pattern : _patterns) {
+    if (g_pattern_match_simple(pattern.c_str(), name.c_str()))
+      return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Module *ModuleManifest::create_deferred_module(const std::string &path) {
+  auto iter = _entries.find(path);
+  if (iter == _entries.end() || !is_deferrable(path))
+    return nullptr;
+
+  const Entry &entry = iter->second;
+
+  // Plugins are registered from the plugin info of their modules at startup, so we'd load them anyway.
+  if (std::find(entry.interfaces.begin(), entry.interfaces.end(), "PluginInterface") != entry.interfaces.end())
+    return nullptr;
+
+  internal::FileStamp stamp;
+  if (!internal::FileStamp::get(path, stamp) || stamp.mtime != entry.mtime || stamp.size != entry.size)
+    return nullptr;
+
+  ModuleLoader *loader = GRT::get()->get_module_loader(entry.loader);
+  if (loader == nullptr)
+    return nullptr;
+
+  LazyModule *module = new LazyModule(loader);
+  module->_name = entry.name;
+  module->_path = entry.path;
+  module->_meta_version = entry.version;
+  module->_meta_author = entry.author;
+  module->_meta_description = entry.description;
+  module->_extends = entry.extends;
+  module->_is_bundle = entry.is_bundle;
+  module->_interfaces = entry.interfaces;
+
+  for (auto function : entry.functions) {
+    std::string name = function.name;
+    function.call = [module, name](const grt::BaseListRef &args) { return module->load()->call_function(name, args); };
+    module->add_function(function);
+  }
+
+  ++_deferred_count;
+  logDebug2("Deferring load of module %s (%s)\n", entry.name.c_str(), path.c_str());
+
+  return module;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ModuleManifest::update(const std::vector<Module *> &modules) {
+  std::map<std::string, Entry> entries;
+
+  for (auto module : modules) {
+    std::string path = module->path();
+    if (path.empty() || !is_deferrable(path))
+      continue;
+
+    // A module registered from the manifest keeps its entry, which is still up to date.
+    LazyModule *lazy = dynamic_cast<LazyModule *>(module);
+    if (lazy != nullptr && _entries.find(path) != _entries.end()) {
+      entries[path] = _entries[path];
+      continue;
+    }
+
+    internal::FileStamp stamp;
+    if (module->get_loader() == nullptr || !internal::FileStamp::get(path, stamp))
+      continue;
+
+    Entry entry;
+    entry.loader = module->get_loader()->get_loader_name();
+    entry.path = path;
+    entry.mtime = stamp.mtime;
+    entry.size = stamp.size;
+    entry.name = module->name();
+    entry.version = module->version();
+    entry.author = module->author();
+    entry.description = module->description();
+    entry.extends = module->extends();
+    entry.is_bundle = module->is_bundle();
+    entry.interfaces = module->get_interfaces();
+    for (auto function : module->get_functions()) {
+      function.call = nullptr;
+      entry.functions.push_back(function);
+    }
+    entries[path] = entry;
+  }
+
+  bool changed = entries.size() != _entries.size();
+  for (auto iter = entries.begin(); !changed && iter != entries.end(); ++iter) {
+    auto old = _entries.find(iter->first);
+    changed = old == _entries.end() || old->second.mtime != iter->second.mtime ||
+              old->second.size != iter->second.size || old->second.name != iter->second.name;
+  }
+
+  _entries.swap(entries);
+  return changed;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ModuleManifest::save(const std::string &file) {
+  internal::CacheWriter writer(MODULE_MANIFEST_MAGIC, MODULE_MANIFEST_VERSION);
+
+  writer.write((uint32_t)_entries.size());
+  for (auto &iter : _entries) {
+    const Entry &entry = iter.second;
+    writer.write(entry.loader);
+    writer.write(entry.path);
+    writer.write(entry.mtime);
+    writer.write(entry.size);
+    writer.write(entry.name);
+    writer.write(entry.version);
+    writer.write(entry.author);
+    writer.write(entry.description);
+    writer.write(entry.extends);
+    writer.write(entry.is_bundle);
+
+    writer.write((uint32_t)entry.interfaces.size());
+    for (auto &interface_name : entry.interfaces)
+      writer.write(interface_name);
+
+    writer.write((uint32_t)entry.functions.size());
+    for (auto &function : entry.functions) {
+      writer.write(function.name);
+      writer.write(function.description);
+      writer.write(function.ret_type);
+      writer.write((uint32_t)function.arg_types.size());
+      for (auto &arg : function.arg_types) {
+        writer.write(arg.name);
+        writer.write(arg.doc);
+        writer.write(arg.type);
+      }
+    }
+  }
+
+  if (!writer.save(file)) {
+    logWarning("Could not write module manifest %s\n", file.c_str());
+    return false;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ModuleManifest::load(const std::string &file) {
+  internal::CacheReader reader;
+  if (!reader.open(file, MODULE_MANIFEST_MAGIC, MODULE_MANIFEST_VERSION))
+    return false;
+
+  std::map<std::string, Entry> entries;
+  uint32_t count = reader.read_uint();
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    Entry entry;
+    entry.loader = reader.read_string();
+    entry.path = reader.read_string();
+    entry.mtime = reader.read_int64();
+    entry.size = reader.read_int64();
+    entry.name = reader.read_string();
+    entry.version = reader.read_string();
+    entry.author = reader.read_string();
+    entry.description = reader.read_string();
+    entry.extends = reader.read_string();
+    entry.is_bundle = reader.read_bool();
+
+    uint32_t interface_count = reader.read_uint();
+    for (uint32_t j = 0; j < interface_count && reader.ok(); ++j)
+      entry.interfaces.push_back(reader.read_string());
+
+    uint32_t function_count = reader.read_uint();
+    for (uint32_t j = 0; j < function_count && reader.ok(); ++j) {
+      Module::Function function;
+      function.name = reader.read_string();
+      function.description = reader.read_string();
+      function.ret_type = reader.read_type();
+      uint32_t arg_count = reader.read_uint();
+      for (uint32_t k = 0; k < arg_count && reader.ok(); ++k) {
+        ArgSpec arg;
+        arg.name = reader.read_string();
+        arg.doc = reader.read_string();
+        arg.type = reader.read_type();
+        function.arg_types.push_back(arg);
+      }
+      entry.functions.push_back(function);
+    }
+
+    entries[entry.path] = entry;
+  }
+
+  if (!reader.ok() || !reader.at_end()) {
+    logWarning("Module manifest %s is damaged, ignoring it\n", file.c_str());
+    return false;
+  }
+
+  _entries.swap(entries);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "grt.h"
+
+namespace grt {
+
+  /** A module registered from its manifest entry, without loading the module file.
+   *
+   * The lazy module carries the name, interfaces and function signatures of the real module, so it can be
+   * listed, validated and looked up like any other module. The real module is loaded through its loader
+   * when one of its functions is called the first time. All calls are then forwarded to it.
+   */
+  class MYSQLGRT_PUBLIC LazyModule : public Module {
+  public:
+    virtual ~LazyModule();
+
+    virtual ValueRef call_function(const std::string &name, const grt::BaseListRef &args) override;
+    virtual void closeModule() noexcept override;
+    virtual GModule *getModule() const override;
+
+    bool is_loaded() const {
+      return _module != nullptr;
+    }
+
+    // Loads the real module if that did not happen yet. Throws a grt::module_error if that fails.
+    Module *load();
+
+  protected:
+    friend class ModuleManifest;
+
+    LazyModule(ModuleLoader *loader);
+
+  private:
+    Module *_module;
+    base::Mutex _load_mutex;
+  };
+
+  //------------------------------------------------------------------------------------------------
+
+  /** Keeps the description of modules whose loading can be deferred until they are used.
+   *
+   * Which modules may be deferred is determined by file name patterns (e.g. "db_sybase_*"). Modules
+   * implementing the PluginInterface are always loaded, as plugins are collected at startup.
+   * The manifest is rebuilt from the loaded modules whenever one of the files changed and stored
+   * in a binary file, next to the other startup caches.
+   */
+  class MYSQLGRT_PUBLIC ModuleManifest {
+  public:
+    struct Entry {
+      std::string loader;
+      std::string path;
+      int64_t mtime;
+      int64_t size;
+
+      std::string name;
+      std::string version;
+      std::string author;
+      std::string description;
+      std::string extends;
+      bool is_bundle;
+      Module::Interfaces interfaces;
+      std::vector<Module::Function> functions; // Without the call slot.
+    };
+
+    ModuleManifest(const std::list<std::string> &deferrable_patterns);
+
+    bool load(const std::string &file);
+    bool save(const std::string &file);
+
+    // Replaces the entries by those from the given list of modules. Returns true if anything changed.
+    bool update(const std::vector<Module *> &modules);
+
+    bool is_deferrable(const std::string &path) const;
+
+    // Returns a new LazyModule for the module file, if it is deferrable and the entry for it is up to date.
+    Module *create_deferred_module(const std::string &path);
+
+    size_t deferred_count() const {
+      return _deferred_count;
+    }
+
+  private:
+    std::list<std::string> _patterns;
+    std::map<std::string, Entry> _entries;
+    size_t _deferred_count;
+  };
+
+} // namespace grt
@@ -28,6 +28,7 @@
 
 #include <iostream>
 #include <time.h>
+#include <typeinfo>
 
 #ifdef _MSC_VER
 #undef max
@@ -104,18 +105,94 @@ static std::string member_for_object_dict(const ObjectRef &object, const DictRef
   return name;
 }
 
+static bool changed_list_member(const BaseListRef &list, ObjectRef &object, std::string &member) {
+  object = owner_of_list(list);
+  if (!object.is_valid())
+    return false;
+  member = member_for_object_list(object, list);
+  return !member.empty();
+}
+
+static bool changed_dict_member(const DictRef &dict, ObjectRef &object, std::string &member) {
+  object = owner_of_dict(dict);
+  if (!object.is_valid())
+    return false;
+  member = member_for_object_dict(object, dict);
+  return !member.empty();
+}
+
+
+static size_t retained_memory_size(const ValueRef &value);
+
+static size_t retained_object_size(const ObjectRef &object) {
+  size_t size = sizeof(internal::Object);
+  object.get_metaclass()->foreach_member([&](const MetaClass::Member *member) {
+    size += sizeof(ValueRef);
+    if (member->owned_object && !member->calculated)
+      size += retained_memory_size(object->get_member(member->name));
+    return true;
+  });
+  return size;
+}
+
+/** Estimates the memory kept alive by a value stored in an undo action. Objects still attached to the
+ *  global tree are not counted, detached ones (e.g. deleted objects kept for undo) are followed through
+ *  their owned members.
+ */
+static size_t retained_memory_size(const ValueRef &value) {
+  if (!value.is_valid())
+    return 0;
+
+  switch (value.type()) {
+    case IntegerType:
+      return sizeof(internal::Integer);
+    case DoubleType:
+      return sizeof(internal::Double);
+    case StringType:
+      return sizeof(internal::String) + (*StringRef::cast_from(value)).size();
+    case ListType: {
+      BaseListRef list(BaseListRef::cast_from(value));
+      size_t size = sizeof(internal::List);
+      for (size_t c = list.count(), i = 0; i < c; i++)
+        size += sizeof(ValueRef) + retained_memory_size(list.get(i));
+      return size;
+    }
+    case DictType: {
+      DictRef dict(DictRef::cast_from(value));
+      size_t size = sizeof(internal::Dict);
+      for (internal::Dict::const_iterator iter = dict.begin(); iter != dict.end(); ++iter)
+        size += iter->first.size() + sizeof(ValueRef) + retained_memory_size(iter->second);
+      return size;
+    }
+    case ObjectType: {
+      ObjectRef object(ObjectRef::cast_from(value));
+      return object->is_global() ? 0 : retained_object_size(object);
+    }
+    default:
+      return 0;
+  }
+}
+
 //---------------------------------------------------------------------------------------------------
 
 void UndoAction::set_description(const std::string &description) {
   _description = description;
 }
 
+size_t UndoAction::memory_size() const {
+  return sizeof(UndoAction) + _description.size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 void SimpleUndoAction::dump(std::ostream &out, int indent) const {
   out << strfmt("%*s custom_action ", indent, "") << ": " << _description << std::endl;
 }
 
+size_t SimpleUndoAction::memory_size() const {
+  return sizeof(SimpleUndoAction) + UndoAction::description().size() + _description.size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoObjectChangeAction::UndoObjectChangeAction(const ObjectRef &object, const std::string &member)
@@ -151,11 +228,26 @@ void UndoObjectChangeAction::dump(std::ostream &out, int indent) const {
       << "> ->" << new_value << ": " << description() << std::endl;
 }
 
+bool UndoObjectChangeAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  object = _object;
+  member = _member;
+  return true;
+}
+
+size_t UndoObjectChangeAction::memory_size() const {
+  return sizeof(UndoObjectChangeAction) + UndoAction::description().size() + _member.size() +
+         retained_memory_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListInsertAction::UndoListInsertAction(const BaseListRef &list, size_t index) : _list(list), _index(index) {
 }
 
+UndoListInsertAction::UndoListInsertAction(const BaseListRef &list, size_t index, const ValueRef &value)
+  : _list(list), _index(index), _value(value) {
+}
+
 void UndoListInsertAction::undo(UndoManager *owner) {
   if (_index == BaseListRef::npos) {
     // Remove last entry in the list, if there is one.
@@ -192,6 +284,15 @@ void UndoListInsertAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoListInsertAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_list_member(_list, object, member);
+}
+
+size_t UndoListInsertAction::memory_size() const {
+  // The inserted value belongs to the list, it is not retained by this action.
+  return sizeof(UndoListInsertAction) + UndoAction::description().size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListReorderAction::UndoListReorderAction(const BaseListRef &list, size_t oindex, size_t nindex)
@@ -225,6 +326,14 @@ void UndoListReorderAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoListReorderAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_list_member(_list, object, member);
+}
+
+size_t UndoListReorderAction::memory_size() const {
+  return sizeof(UndoListReorderAction) + UndoAction::description().size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListSetAction::UndoListSetAction(const BaseListRef &list, size_t index) : _list(list), _index(index) {
@@ -258,6 +367,14 @@ void UndoListSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoListSetAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_list_member(_list, object, member);
+}
+
+size_t UndoListSetAction::memory_size() const {
+  return sizeof(UndoListSetAction) + UndoAction::description().size() + retained_memory_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListRemoveAction::UndoListRemoveAction(const BaseListRef &list, const ValueRef &value)
@@ -301,6 +418,14 @@ void UndoListRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoListRemoveAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_list_member(_list, object, member);
+}
+
+size_t UndoListRemoveAction::memory_size() const {
+  return sizeof(UndoListRemoveAction) + UndoAction::description().size() + retained_memory_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictSetAction::UndoDictSetAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -339,6 +464,14 @@ void UndoDictSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoDictSetAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_dict_member(_dict, object, member);
+}
+
+size_t UndoDictSetAction::memory_size() const {
+  return sizeof(UndoDictSetAction) + UndoAction::description().size() + _key.size() + retained_memory_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictRemoveAction::UndoDictRemoveAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -376,10 +509,20 @@ void UndoDictRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+bool UndoDictRemoveAction::get_changed_member(ObjectRef &object, std::string &member) const {
+  return changed_dict_member(_dict, object, member);
+}
+
+size_t UndoDictRemoveAction::memory_size() const {
+  return sizeof(UndoDictRemoveAction) + UndoAction::description().size() + _key.size() +
+         retained_memory_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoGroup::UndoGroup() {
   _is_open = true;
+  _memory_size = 0;
 }
 
 UndoGroup::~UndoGroup() {
@@ -399,6 +542,7 @@ void UndoGroup::undo(UndoManager *owner) {
 
 void UndoGroup::trim() {
   std::list<UndoAction *>::iterator next, iter;
+  _memory_size = 0;
   next = _actions.begin();
   // delete closed groups that are empty or have a single action
   while (next != _actions.end()) {
@@ -439,9 +583,10 @@ UndoGroup *UndoGroup::get_deepest_open_subgroup(UndoGroup **parent) {
 void UndoGroup::close() {
   // close the topmost open undo group
   UndoGroup *group = get_deepest_open_subgroup();
-  if (group)
+  if (group) {
     group->_is_open = false;
-  else
+    group->_changed_members.clear();
+  } else
     logWarning("trying to close already closed undo group\n");
 }
 
@@ -449,10 +594,21 @@ void UndoGroup::add(UndoAction *op) {
   // add the action to the topmost open undo group
   UndoGroup *subgroup = get_deepest_open_subgroup();
 
-  if (subgroup)
-    subgroup->_actions.push_back(op);
-  else
+  if (!subgroup)
     throw std::logic_error("trying to add an action to a closed undo group");
+
+  // Undoing the group restores a member from the first change recorded for it, so later changes
+  // of the same member in the same group don't need to be kept (e.g. a figure dragged around).
+  if (typeid(*op) == typeid(UndoObjectChangeAction)) {
+    UndoObjectChangeAction *change = static_cast<UndoObjectChangeAction *>(op);
+    if (!subgroup->_changed_members.insert(std::make_pair(change->get_object().valueptr(), change->get_member()))
+           .second) {
+      delete op;
+      return;
+    }
+  }
+  subgroup->_actions.push_back(op);
+  _memory_size = 0;
 }
 
 bool UndoGroup::empty() const {
@@ -476,6 +632,20 @@ void UndoGroup::set_description(const std::string &description) {
     UndoAction::set_description(description);
 }
 
+size_t UndoGroup::memory_size() const {
+  if (_memory_size > 0)
+    return _memory_size;
+
+  size_t size = sizeof(UndoGroup) + UndoAction::description().size();
+  for (std::list<UndoAction *>::const_iterator iter = _actions.begin(); iter != _actions.end(); ++iter)
+    size += sizeof(UndoAction *) + (*iter)->memory_size();
+
+  // Closed groups don't change anymore.
+  if (!_is_open)
+    _memory_size = size;
+  return size;
+}
+
 std::string UndoGroup::description() const {
   if (!_actions.empty() && _is_open) {
     UndoGroup *subgroup = dynamic_cast<UndoGroup *>(_actions.back());
@@ -501,6 +671,7 @@ UndoManager::UndoManager() {
   _is_undoing = false;
   _is_redoing = false;
   _undo_limit = 0;
+  _memory_limit = 0;
   _blocks = 0;
 }
 
@@ -548,10 +719,51 @@ void UndoManager::set_undo_limit(size_t limit) {
   trim_undo_stack();
 }
 
+void UndoManager::set_memory_limit(size_t bytes) {
+  _memory_limit = bytes;
+
+  trim_undo_stack();
+}
+
+size_t UndoManager::get_undo_memory_size() const {
+  size_t size = 0;
+  lock();
+  for (std::deque<UndoAction *>::const_iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter)
+    size += (*iter)->memory_size();
+  unlock();
+  return size;
+}
+
+size_t UndoManager::get_redo_memory_size() const {
+  size_t size = 0;
+  lock();
+  for (std::deque<UndoAction *>::const_iterator iter = _redo_stack.begin(); iter != _redo_stack.end(); ++iter)
+    size += (*iter)->memory_size();
+  unlock();
+  return size;
+}
+
 void UndoManager::trim_undo_stack() {
   lock();
-  if (_undo_limit > 0)
-    _undo_stack.erase(_undo_stack.begin(), _undo_stack.begin() + std::max(0, (int)(_undo_stack.size() - _undo_limit)));
+  size_t count = 0;
+  if (_undo_limit > 0 && _undo_stack.size() > _undo_limit)
+    count = _undo_stack.size() - _undo_limit;
+
+  // Drop the oldest entries that exceed the memory budget, but always keep the latest one.
+  if (_memory_limit > 0 && _undo_stack.size() > count + 1) {
+    size_t size = _undo_stack.back()->memory_size();
+    for (size_t i = _undo_stack.size() - 1; i > count; --i) {
+      size += _undo_stack[i - 1]->memory_size();
+      if (size > _memory_limit) {
+        count = i;
+        break;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i)
+    delete _undo_stack[i];
+  _undo_stack.erase(_undo_stack.begin(), _undo_stack.begin() + count);
   unlock();
 }
 
@@ -698,6 +910,10 @@ bool UndoManager::end_undo_group(const std::string &description, bool trim) {
     if (!description.empty())
       group->set_description(description);
 
+    // A closed top-level group can now be accounted for in the memory budget.
+    if (!group->is_open() && !_is_undoing)
+      trim_undo_stack();
+
     if (!group->is_open() && _undo_log && _undo_log->good())
       group->dump(*_undo_log);
 
@@ -858,6 +1074,9 @@ void UndoManager::redo() {
 }
 
 void UndoManager::add_undo(UndoAction *cmd) {
+  if (!_action_added_signal.empty() && dynamic_cast<UndoGroup *>(cmd) == NULL)
+    _action_added_signal(cmd);
+
   if (_blocks > 0) {
     delete cmd;
     return;
@@ -26,6 +26,7 @@
 #include "grt.h"
 
 #include <deque>
+#include <set>
 #include <boost/signals2.hpp>
 #include <ostream>
 
@@ -47,6 +48,15 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const = 0;
+
+    // Estimated number of bytes kept alive by this action, including old values only it refers to.
+    virtual size_t memory_size() const;
+
+    // Returns the object and member name that was modified by the change this action reverts.
+    // Returns false if the action is not a plain value change or the owner cannot be determined.
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const {
+      return false;
+    }
   };
 
   class MYSQLGRT_PUBLIC SimpleUndoAction : public UndoAction {
@@ -58,6 +68,7 @@ namespace grt {
     SimpleUndoAction(const std::function<void()> &undoslot) : _undo_slot(undoslot){};
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
 
     virtual void undo(UndoManager *owner) {
       _undo_slot();
@@ -84,18 +95,35 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoListInsertAction : public UndoAction {
     BaseListRef _list;
     size_t _index;
+    ValueRef _value;
 
   public:
     UndoListInsertAction(const BaseListRef &list, size_t index = BaseListRef::npos);
+    // The value is only kept for observers of the undo manager, undoing does not need it.
+    UndoListInsertAction(const BaseListRef &list, size_t index, const ValueRef &value);
+
+    const BaseListRef &get_list() const {
+      return _list;
+    }
+    size_t get_index() const {
+      return _index;
+    }
+    const ValueRef &get_value() const {
+      return _value;
+    }
 
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoListSetAction : public UndoAction {
@@ -109,6 +137,8 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoListReorderAction : public UndoAction {
@@ -121,6 +151,8 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoListRemoveAction : public UndoAction {
@@ -132,8 +164,20 @@ namespace grt {
     UndoListRemoveAction(const BaseListRef &list, const ValueRef &value);
     UndoListRemoveAction(const BaseListRef &list, size_t index);
 
+    const BaseListRef &get_list() const {
+      return _list;
+    }
+    size_t get_index() const {
+      return _index;
+    }
+    const ValueRef &get_value() const {
+      return _value;
+    }
+
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictSetAction : public UndoAction {
@@ -147,6 +191,8 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictRemoveAction : public UndoAction {
@@ -160,11 +206,17 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
+    virtual bool get_changed_member(ObjectRef &object, std::string &member) const;
   };
 
   class MYSQLGRT_PUBLIC UndoGroup : public UndoAction {
     std::list<UndoAction *> _actions;
     bool _is_open;
+    mutable size_t _memory_size; //< cached once the group is closed, 0 if not computed yet
+
+    // Object members changed by actions of this (open) group, used to drop repeated changes of the same member.
+    std::set<std::pair<internal::Value *, std::string> > _changed_members;
 
   public:
     UndoGroup();
@@ -182,6 +234,7 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
 
     void add(UndoAction *op);
     bool empty() const;
@@ -203,6 +256,7 @@ namespace grt {
   public:
     typedef boost::signals2::signal<void(UndoAction *)> UndoSignal;
     typedef boost::signals2::signal<void(UndoAction *)> RedoSignal;
+    typedef boost::signals2::signal<void(UndoAction *)> ActionSignal;
 
     UndoManager();
     virtual ~UndoManager();
@@ -219,6 +273,14 @@ namespace grt {
       return _undo_limit;
     }
 
+    // Maximum number of bytes the undo stack may keep alive (0 for no limit). The most recent entry is always kept.
+    void set_memory_limit(size_t bytes);
+    size_t get_memory_limit() const {
+      return _memory_limit;
+    }
+    size_t get_undo_memory_size() const;
+    size_t get_redo_memory_size() const;
+
     void disable();
     void enable();
     bool is_enabled() const {
@@ -264,6 +326,12 @@ namespace grt {
       return &_changed_signal;
     }
 
+    // Emitted for every single change action passed to add_undo(), including the ones recorded while
+    // undoing/redoing and while the undo manager is disabled. Groups are not reported.
+    ActionSignal *signal_action_added() {
+      return &_action_added_signal;
+    }
+
     void dump_undo_stack();
     void dump_redo_stack();
 
@@ -285,6 +353,7 @@ namespace grt {
     std::deque<UndoAction *> _redo_stack;
 
     size_t _undo_limit;
+    size_t _memory_limit;
 
     int _blocks;
     bool _is_undoing;
@@ -293,6 +362,7 @@ namespace grt {
     UndoSignal _undo_signal;
     RedoSignal _redo_signal;
     boost::signals2::signal<void()> _changed_signal;
+    ActionSignal _action_added_signal;
 
     void trim_undo_stack();
   };
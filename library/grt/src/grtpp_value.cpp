@@ -230,6 +230,8 @@ void List::set_unchecked(size_t index, const ValueRef& value) {
   {
     if (_is_global > 0 && grt::GRT::get()->tracking_changes())
       grt::GRT::get()->get_undo_manager()->add_undo(new UndoListSetAction(this, index));
+    else if (_is_global > 0)
+      grt::GRT::get()->note_untracked_change();
 
     if (_is_global > 0 && _content[index].is_valid()) {
       _content[index].unmark_global();
@@ -249,14 +251,18 @@ void List::insert_unchecked(const ValueRef& value, size_t index) {
 
   if (index == npos) {
     if (_is_global > 0 && grt::GRT::get()->tracking_changes())
-      grt::GRT::get()->get_undo_manager()->add_undo(new UndoListInsertAction(this, index));
+      grt::GRT::get()->get_undo_manager()->add_undo(new UndoListInsertAction(this, index, value));
+    else if (_is_global > 0)
+      grt::GRT::get()->note_untracked_change();
 
     _content.push_back(value);
   } else if (index > _content.size())
     throw grt::bad_item(index, _content.size());
   else {
     if (_is_global > 0 && grt::GRT::get()->tracking_changes())
-      grt::GRT::get()->get_undo_manager()->add_undo(new UndoListInsertAction(this, index));
+      grt::GRT::get()->get_undo_manager()->add_undo(new UndoListInsertAction(this, index, value));
+    else if (_is_global > 0)
+      grt::GRT::get()->note_untracked_change();
 
     _content.insert(_content.begin() + index, value);
   }
@@ -271,6 +277,8 @@ void List::remove(const ValueRef& value) {
 
       if (_is_global > 0 && grt::GRT::get()->tracking_changes())
         grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, i));
+      else if (_is_global > 0)
+        grt::GRT::get()->note_untracked_change();
 
       _content.erase(_content.begin() + i);
     }
@@ -286,6 +294,8 @@ void List::remove(size_t index) {
 
   if (_is_global > 0 && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, index));
+  else if (_is_global > 0)
+    grt::GRT::get()->note_untracked_change();
 
   _content.erase(_content.begin() + index);
 }
@@ -296,6 +306,8 @@ void List::reorder(size_t oi, size_t ni) {
 
   if (_is_global > 0 && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoListReorderAction(this, oi, ni));
+  else if (_is_global > 0)
+    grt::GRT::get()->note_untracked_change();
 
   ValueRef tmp(_content[oi]);
   _content.erase(_content.begin() + oi);
@@ -541,6 +553,8 @@ void Dict::set(const std::string& key, const ValueRef& value) {
   if (_is_global > 0) {
     if (grt::GRT::get()->tracking_changes())
       grt::GRT::get()->get_undo_manager()->add_undo(new UndoDictSetAction(this, key));
+    else
+      grt::GRT::get()->note_untracked_change();
 
     if (iter != _content.end() && iter->second.is_valid())
       iter->second.unmark_global();
@@ -558,6 +572,8 @@ void Dict::remove(const std::string& key) {
     if (_is_global > 0) {
       if (grt::GRT::get()->tracking_changes())
         grt::GRT::get()->get_undo_manager()->add_undo(new UndoDictRemoveAction(this, key));
+      else
+        grt::GRT::get()->note_untracked_change();
 
       if (iter->second.is_valid())
         iter->second.unmark_global();
@@ -893,6 +909,8 @@ void Object::owned_member_changed(const std::string& name, const grt::ValueRef&
     }
     if (grt::GRT::get()->tracking_changes())
       grt::GRT::get()->get_undo_manager()->add_undo(new UndoObjectChangeAction(this, name, ovalue));
+    else
+      grt::GRT::get()->note_untracked_change();
   }
   _changed_signal(name, ovalue);
 }
@@ -900,6 +918,8 @@ void Object::owned_member_changed(const std::string& name, const grt::ValueRef&
 void Object::member_changed(const std::string& name, const grt::ValueRef& ovalue, const grt::ValueRef& nvalue) {
   if (_is_global && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoObjectChangeAction(this, name, ovalue));
+  else if (_is_global)
+    grt::GRT::get()->note_untracked_change();
   _changed_signal(name, ovalue);
 }
 
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "compiled_template.h"
+#include "modifier.h"
+
+#include <iostream>
+
+namespace mtemplate {
+
+  //-----------------------------------------------------------------------------------
+  //  SlotDictionary stuff
+  //-----------------------------------------------------------------------------------
+  SlotDictionary::SlotDictionary(const CompiledTemplate *owner, const base::utf8string &name, SlotDictionary *parent)
+    : DictionaryInterface(name),
+      _template(owner),
+      _parent(parent),
+      _values(owner->variableCount()),
+      _is_set(owner->variableCount(), false),
+      _sections(owner->sectionCount()) {
+  }
+
+  SlotDictionary::~SlotDictionary() {
+    for (auto &section : _sections)
+      for (DictionaryInterface *dict : section)
+        delete dict;
+    for (auto &section : _other_sections)
+      for (DictionaryInterface *dict : section.second)
+        delete dict;
+  }
+
+  void SlotDictionary::setSlotValue(std::size_t slot, const base::utf8string &value) {
+    _values[slot] = value;
+    _is_set[slot] = true;
+  }
+
+  void SlotDictionary::setValue(const base::utf8string &key, const base::utf8string &value) {
+    int slot = _template->variableSlot(key);
+    if (slot < 0)
+      _other_values[key] = value;
+    else
+      setSlotValue(slot, value);
+  }
+
+  base::utf8string SlotDictionary::getValue(const base::utf8string &key) {
+    int slot = _template->variableSlot(key);
+    for (SlotDictionary *dict = this; dict != nullptr; dict = dict->_parent) {
+      if (slot >= 0) {
+        if (dict->_is_set[slot])
+          return dict->_values[slot];
+      } else {
+        dictionary_storage_iterator iter = dict->_other_values.find(key);
+        if (iter != dict->_other_values.end())
+          return iter->second;
+      }
+    }
+    return GetGlobalValue(key);
+  }
+
+  SlotDictionary *SlotDictionary::addSectionDictionaryById(std::size_t section) {
+    section_dictionary_storage &dicts = _sections[section];
+    SlotDictionary *dict = new SlotDictionary(_template, _name + _template->_sections[section] + "/", this);
+
+    if (!dicts.empty())
+      dicts.back()->setIsLast(false);
+    dict->setIsLast(true);
+    dicts.push_back(dict);
+    return dict;
+  }
+
+  DictionaryInterface *SlotDictionary::addSectionDictionary(const base::utf8string &name) {
+    int section = _template->sectionId(name);
+    if (section >= 0)
+      return addSectionDictionaryById(section);
+
+    section_dictionary_storage &dicts = _other_sections[name];
+    SlotDictionary *dict = new SlotDictionary(_template, _name + name + "/", this);
+    if (!dicts.empty())
+      dicts.back()->setIsLast(false);
+    dict->setIsLast(true);
+    dicts.push_back(dict);
+    return dict;
+  }
+
+  DictionaryInterface::section_dictionary_storage &SlotDictionary::getSectionDictionaries(
+    const base::utf8string &section) {
+    int id = _template->sectionId(section);
+    if (id >= 0)
+      return _sections[id];
+
+    section_storage::iterator iter = _other_sections.find(section);
+    return iter == _other_sections.end() ? _no_section : iter->second;
+  }
+
+  void SlotDictionary::dump(int indent) {
+    base::utf8string indent_str(indent * 2, ' ');
+    base::utf8string indent_plus_str((indent + 1) * 2, ' ');
+
+    std::cout << indent_str << "[" << _name << "] = " << std::endl << indent_str << "{" << std::endl;
+
+    for (std::size_t i = 0; i < _values.size(); ++i)
+      if (_is_set[i])
+        std::cout << indent_plus_str << "[" << _template->_variables[i] << "] = \"" << _values[i] << "\"" << std::endl;
+    for (auto item : _other_values)
+      std::cout << indent_plus_str << "[" << item.first << "] = \"" << item.second << "\"" << std::endl;
+
+    for (auto &section : _sections)
+      for (DictionaryInterface *dict : section)
+        dict->dump(indent + 1);
+    for (auto &section : _other_sections)
+      for (DictionaryInterface *dict : section.second)
+        dict->dump(indent + 1);
+
+    std::cout << indent_str << "}" << std::endl;
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  CompiledTemplate stuff
+  //-----------------------------------------------------------------------------------
+  CompiledTemplate::CompiledTemplate(const TemplateDocument &document) : _merge_barrier(0) {
+    compile(document);
+  }
+
+  //-----------------------------------------------------------------------------------
+  std::size_t CompiledTemplate::slotFor(const base::utf8string &name, std::vector<base::utf8string> &names,
+                                        std::map<base::utf8string, std::size_t> &ids) {
+    std::map<base::utf8string, std::size_t>::iterator iter = ids.find(name);
+    if (iter != ids.end())
+      return iter->second;
+
+    names.push_back(name);
+    ids[name] = names.size() - 1;
+    return names.size() - 1;
+  }
+
+  //-----------------------------------------------------------------------------------
+  void CompiledTemplate::appendLiteral(const std::string &text) {
+    //  Adjacent text and new line nodes end up in a single literal, unless the previous one belongs to a section body.
+    if (_code.size() > _merge_barrier && _code.back().op == Op_Text) {
+      _literals[_code.back().operand] += text;
+      return;
+    }
+
+    _literals.push_back(text);
+    _code.push_back({ Op_Text, _literals.size() - 1, 0, false, {} });
+  }
+
+  //-----------------------------------------------------------------------------------
+  void CompiledTemplate::compile(const TemplateDocument &document) {
+    for (const NodeStorageType &node : document) {
+      if (node->isHidden())
+        continue;
+
+      switch (node->type()) {
+        case TemplateObject_Text:
+        case TemplateObject_NewLine:
+          appendLiteral(node->text());
+          break;
+
+        case TemplateObject_Variable: {
+          NodeVariable *variable = static_cast<NodeVariable *>(node.get());
+          _code.push_back(
+            { Op_Variable, slotFor(variable->text(), _variables, _variable_slots), 0, false, variable->_modifiers });
+          break;
+        }
+
+        case TemplateObject_Section:
+        case TemplateObject_SectionSeparator: {
+          NodeSection *section = static_cast<NodeSection *>(node.get());
+          std::size_t index = _code.size();
+          _code.push_back({ Op_Section, slotFor(section->text(), _sections, _section_ids), 0, section->is_separator(),
+                            {} });
+          compile(section->_contents);
+          _code[index].end = _code.size();
+          _merge_barrier = _code.size();
+          break;
+        }
+      }
+    }
+  }
+
+  //-----------------------------------------------------------------------------------
+  int CompiledTemplate::variableSlot(const base::utf8string &name) const {
+    std::map<base::utf8string, std::size_t>::const_iterator iter = _variable_slots.find(name);
+    return iter == _variable_slots.end() ? -1 : (int)iter->second;
+  }
+
+  int CompiledTemplate::sectionId(const base::utf8string &name) const {
+    std::map<base::utf8string, std::size_t>::const_iterator iter = _section_ids.find(name);
+    return iter == _section_ids.end() ? -1 : (int)iter->second;
+  }
+
+  SlotDictionary *CompiledTemplate::createMainDictionary() const {
+    return new SlotDictionary(this, "/", nullptr);
+  }
+
+  //-----------------------------------------------------------------------------------
+  void CompiledTemplate::expand(DictionaryInterface *dict, TemplateOutput *output) const {
+    //  Modifiers are looked up once per expansion, they can be replaced between runs.
+    std::vector<std::vector<Modifier *> > modifiers(_code.size());
+    for (std::size_t pc = 0; pc < _code.size(); ++pc) {
+      for (const ModifierAndArgument &modifier : _code[pc].modifiers)
+        modifiers[pc].push_back(GetModifier(modifier._name));
+    }
+
+    run(0, _code.size(), dict, output, modifiers);
+  }
+
+  //-----------------------------------------------------------------------------------
+  void CompiledTemplate::run(std::size_t begin, std::size_t end, DictionaryInterface *dict, TemplateOutput *output,
+                             const std::vector<std::vector<Modifier *> > &modifiers) const {
+    //  Slot lookups are only valid for dictionaries created from this template.
+    SlotDictionary *slots = dynamic_cast<SlotDictionary *>(dict);
+    if (slots != nullptr && slots->_template != this)
+      slots = nullptr;
+
+    base::utf8string buffer;
+    std::size_t pc = begin;
+    while (pc < end) {
+      const Instruction &instruction = _code[pc];
+      switch (instruction.op) {
+        case Op_Text: {
+          const std::string &literal = _literals[instruction.operand];
+          output->out(literal.data(), literal.size());
+          ++pc;
+          break;
+        }
+
+        case Op_Variable: {
+          const base::utf8string *value = nullptr;
+          for (SlotDictionary *current = slots; current != nullptr && value == nullptr; current = current->_parent) {
+            if (current->_is_set[instruction.operand])
+              value = &current->_values[instruction.operand];
+          }
+
+          if (value == nullptr) {
+            const base::utf8string &name = _variables[instruction.operand];
+            buffer = (dict == nullptr || slots != nullptr) ? GetGlobalValue(name) : dict->getValue(name);
+            value = &buffer;
+          }
+
+          const std::vector<Modifier *> &mods = modifiers[pc];
+          if (mods.empty())
+            output->out(value->data(), value->bytes());
+          else {
+            base::utf8string result = *value;
+            for (std::size_t i = 0; i < mods.size(); ++i) {
+              if (mods[i] != nullptr)
+                result = mods[i]->modify(result, instruction.modifiers[i]._arg);
+            }
+            output->out(result.data(), result.bytes());
+          }
+          ++pc;
+          break;
+        }
+
+        case Op_Section: {
+          if (instruction.is_separator && dict != nullptr && !dict->isLast())
+            run(pc + 1, instruction.end, dict, output, modifiers);
+          else if (dict != nullptr) {
+            DictionaryInterface::section_dictionary_storage &section_dicts =
+              slots != nullptr ? slots->_sections[instruction.operand]
+                               : dict->getSectionDictionaries(_sections[instruction.operand]);
+            for (DictionaryInterface *item : section_dicts)
+              run(pc + 1, instruction.end, item, output, modifiers);
+          }
+          pc = instruction.end;
+          break;
+        }
+      }
+    }
+  }
+
+} //  namespace mtemplate
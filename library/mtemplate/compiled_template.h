@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "common.h"
+#include "types.h"
+#include "dictionary.h"
+#include "output.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace mtemplate {
+
+  class CompiledTemplate;
+
+  /**
+   * @brief Dictionary storing its values in the variable slots of a compiled template.
+   *
+   * Lookups done by the template that created it are plain index accesses. Keys and sections the
+   * template does not know about are still accepted and kept in maps, so this can be used
+   * everywhere a Dictionary is used. Section dictionaries are owned by their parent.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC SlotDictionary : public DictionaryInterface {
+  protected:
+    const CompiledTemplate *_template;
+    SlotDictionary *_parent;
+
+    std::vector<base::utf8string> _values;
+    std::vector<bool> _is_set;
+    std::vector<section_dictionary_storage> _sections;
+
+    dictionary_storage _other_values;
+    section_storage _other_sections;
+    section_dictionary_storage _no_section;
+
+    DictionaryInterface *getParent() {
+      return _parent;
+    }
+
+    friend class CompiledTemplate;
+
+  public:
+    SlotDictionary(const CompiledTemplate *owner, const base::utf8string &name, SlotDictionary *parent = nullptr);
+    virtual ~SlotDictionary();
+
+    void setSlotValue(std::size_t slot, const base::utf8string &value);
+    SlotDictionary *addSectionDictionaryById(std::size_t section);
+
+    //  DictionaryInterface
+    virtual void setValue(const base::utf8string &key, const base::utf8string &value);
+    virtual base::utf8string getValue(const base::utf8string &key);
+
+    virtual DictionaryInterface *addSectionDictionary(const base::utf8string &name);
+    virtual section_dictionary_storage &getSectionDictionaries(const base::utf8string &section);
+
+    virtual void dump(int indent = 0);
+  };
+
+  /**
+   * @brief A template flattened into an instruction list.
+   *
+   * Text and new line nodes are merged into literals (hidden nodes are dropped), variables refer to slots
+   * resolved once at compile time and sections jump over their body, so expansion is a simple loop
+   * instead of a walk over the node tree. Output is identical to Template::expand().
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC CompiledTemplate {
+  public:
+    CompiledTemplate(const TemplateDocument &document);
+
+    void expand(DictionaryInterface *dict, TemplateOutput *output) const;
+
+    SlotDictionary *createMainDictionary() const;
+
+    // Slot/section ids for the given name or -1 if the template doesn't use it.
+    int variableSlot(const base::utf8string &name) const;
+    int sectionId(const base::utf8string &name) const;
+
+    std::size_t variableCount() const {
+      return _variables.size();
+    }
+    std::size_t sectionCount() const {
+      return _sections.size();
+    }
+    std::size_t instructionCount() const {
+      return _code.size();
+    }
+
+  private:
+    friend class SlotDictionary;
+
+    enum OpCode { Op_Text, Op_Variable, Op_Section };
+
+    struct Instruction {
+      OpCode op;
+      std::size_t operand;  // literal index, variable slot or section id
+      std::size_t end;      // sections: index of the first instruction after the body
+      bool is_separator;    // sections: expanded in the parent dictionary unless it is the last one
+      std::vector<ModifierAndArgument> modifiers;
+    };
+
+    std::vector<Instruction> _code;
+    std::vector<std::string> _literals;
+    std::vector<base::utf8string> _variables;
+    std::vector<base::utf8string> _sections;
+    std::map<base::utf8string, std::size_t> _variable_slots;
+    std::map<base::utf8string, std::size_t> _section_ids;
+    std::size_t _merge_barrier;
+
+    void compile(const TemplateDocument &document);
+    void appendLiteral(const std::string &text);
+    std::size_t slotFor(const base::utf8string &name, std::vector<base::utf8string> &names,
+                        std::map<base::utf8string, std::size_t> &ids);
+
+    void run(std::size_t begin, std::size_t end, DictionaryInterface *dict, TemplateOutput *output,
+             const std::vector<std::vector<Modifier *> > &modifiers) const;
+  };
+
+} //  namespace mtemplate
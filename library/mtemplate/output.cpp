@@ -32,6 +32,10 @@ namespace mtemplate {
   TemplateOutput::~TemplateOutput() {
   }
 
+  void TemplateOutput::out(const char *data, std::size_t length) {
+    out(base::utf8string(std::string(data, length)));
+  }
+
   //-----------------------------------------------------------------------------------
   //  TemplateOutputString stuff
   //-----------------------------------------------------------------------------------
@@ -39,6 +43,10 @@ namespace mtemplate {
     _buffer += str;
   }
 
+  void TemplateOutputString::out(const char *data, std::size_t length) {
+    _buffer += std::string(data, length);
+  }
+
   const base::utf8string &TemplateOutputString::get() {
     return _buffer;
   }
@@ -53,4 +61,22 @@ namespace mtemplate {
     fwrite(str.data(), 1, str.bytes(), _file.file());
   }
 
+  void TemplateOutputFile::out(const char *data, std::size_t length) {
+    fwrite(data, 1, length, _file.file());
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  TemplateOutputStream stuff
+  //-----------------------------------------------------------------------------------
+  TemplateOutputStream::TemplateOutputStream(std::ostream &stream) : _stream(stream) {
+  }
+
+  void TemplateOutputStream::out(const base::utf8string &str) {
+    _stream.write(str.data(), str.bytes());
+  }
+
+  void TemplateOutputStream::out(const char *data, std::size_t length) {
+    _stream.write(data, length);
+  }
+
 } //  namespace mtemplate
@@ -27,6 +27,8 @@
 
 #include "base/utf8string.h"
 #include "base/file_utilities.h"
+
+#include <ostream>
 // class FILE;
 
 namespace mtemplate {
@@ -36,6 +38,9 @@ namespace mtemplate {
     virtual ~TemplateOutput();
 
     virtual void out(const base::utf8string &str) = 0;
+
+    //  Raw byte output, used by compiled templates to avoid building temporary strings.
+    virtual void out(const char *data, std::size_t length);
   };
 
   class MTEMPLATELIBRARY_PUBLIC_FUNC TemplateOutputString : public TemplateOutput {
@@ -43,6 +48,7 @@ namespace mtemplate {
 
   public:
     virtual void out(const base::utf8string &str);
+    virtual void out(const char *data, std::size_t length);
 
     const base::utf8string &get();
   };
@@ -53,6 +59,16 @@ namespace mtemplate {
   public:
     TemplateOutputFile(const base::utf8string &filename);
     virtual void out(const base::utf8string &str);
+    virtual void out(const char *data, std::size_t length);
+  };
+
+  class MTEMPLATELIBRARY_PUBLIC_FUNC TemplateOutputStream : public TemplateOutput {
+    std::ostream &_stream;
+
+  public:
+    TemplateOutputStream(std::ostream &stream);
+    virtual void out(const base::utf8string &str);
+    virtual void out(const char *data, std::size_t length);
   };
 
 } //  namespace mtemplate
@@ -27,6 +27,7 @@
 #include <iostream>
 #include "dictionary.h"
 #include "modifier.h"
+#include "compiled_template.h"
 
 #include <base/string_utilities.h>
 #include <base/file_utilities.h>
@@ -64,6 +65,10 @@ namespace mtemplate {
     }
   }
 
+  CompiledTemplate *Template::compile() const {
+    return new CompiledTemplate(_document);
+  }
+
   Template *GetTemplate(const base::utf8string &path, PARSE_TYPE type) {
     if (type == STRIP_WHITESPACE)
       throw std::invalid_argument("STRIP_WHITESPACE");
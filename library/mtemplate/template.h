@@ -33,6 +33,8 @@
 
 namespace mtemplate {
 
+  class CompiledTemplate;
+
   class MTEMPLATELIBRARY_PUBLIC_FUNC Template {
   protected:
     TemplateDocument _document;
@@ -43,6 +45,9 @@ namespace mtemplate {
 
     void expand(DictionaryInterface *dict, TemplateOutput *output);
     void dump(int indent = 0);
+
+    //  Caller owns the result. It does not depend on this template anymore.
+    CompiledTemplate *compile() const;
   };
 
   MTEMPLATELIBRARY_PUBLIC_FUNC Template *GetTemplate(const base::utf8string &path, PARSE_TYPE type = DO_NOT_STRIP);
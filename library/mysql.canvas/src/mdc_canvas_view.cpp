@@ -589,26 +589,168 @@ void CanvasView::update_line_crossings(Line *line) {
   if (!_line_hop_rendering)
     return;
 
-  // get the lines in the same bounding box
+  // Crossings are recomputed in one go before the next repaint, so a line laid out several times per frame
+  // (or many lines moving together) is only processed once.
+  _pending_line_crossings.insert(line);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const double LINE_GRID_CELL_SIZE = 128.0;
 
-  std::list<CanvasItem *> items = get_items_bounded_by(line->get_root_bounds(),  std::bind(&is_line, std::placeholders::_1));
+static void get_line_grid_cells(Line *line, std::vector<std::pair<int, int> > &cells) {
+  std::vector<Point> vertices(line->get_root_vertices());
+  std::set<std::pair<int, int> > seen;
 
-  std::list<CanvasItem *>::iterator iter = items.begin();
+  for (size_t i = 1; i < vertices.size(); ++i) {
+    int x1 = (int)floor(std::min(vertices[i - 1].x, vertices[i].x) / LINE_GRID_CELL_SIZE);
+    int x2 = (int)floor(std::max(vertices[i - 1].x, vertices[i].x) / LINE_GRID_CELL_SIZE);
+    int y1 = (int)floor(std::min(vertices[i - 1].y, vertices[i].y) / LINE_GRID_CELL_SIZE);
+    int y2 = (int)floor(std::max(vertices[i - 1].y, vertices[i].y) / LINE_GRID_CELL_SIZE);
 
-  // check if the line crosses with anything under it
-  for (; iter != items.end() && *iter != line; ++iter) {
-    line->mark_crossings(static_cast<Line *>(*iter));
+    for (int x = x1; x <= x2; ++x) {
+      for (int y = y1; y <= y2; ++y) {
+        if (seen.insert(std::make_pair(x, y)).second)
+          cells.push_back(std::make_pair(x, y));
+      }
+    }
   }
+}
 
-  if (iter != items.end())
-    ++iter; // skip the line itself
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::index_line_segments(Line *line) {
+  std::vector<LineGridCell> &cells = _line_grid_cells[line];
+
+  get_line_grid_cells(line, cells);
+  for (std::vector<LineGridCell>::const_iterator cell = cells.begin(); cell != cells.end(); ++cell)
+    _line_grid[*cell].insert(line);
+}
 
-  // then check if anything over it crosses the line
-  for (; iter != items.end(); ++iter) {
-    static_cast<Line *>(*iter)->mark_crossings(line);
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Removes the line from the segment grid and adds all lines which shared a cell with it to neighbours.
+ */
+void CanvasView::unindex_line_segments(Line *line, std::set<Line *> &neighbours) {
+  std::map<Line *, std::vector<LineGridCell> >::iterator entry = _line_grid_cells.find(line);
+  if (entry == _line_grid_cells.end())
+    return;
+
+  for (std::vector<LineGridCell>::const_iterator cell = entry->second.begin(); cell != entry->second.end(); ++cell) {
+    std::map<LineGridCell, std::set<Line *> >::iterator lines = _line_grid.find(*cell);
+    if (lines == _line_grid.end())
+      continue;
+
+    lines->second.erase(line);
+    neighbours.insert(lines->second.begin(), lines->second.end());
+    if (lines->second.empty())
+      _line_grid.erase(lines);
   }
+  _line_grid_cells.erase(entry);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Recomputes the crossings of all lines whose layout changed since the last call. Only lines sharing a grid cell
+ * with a changed line, before or after the change, can have gained or lost a crossing with it, so everything else
+ * is left alone.
+ */
+void CanvasView::update_pending_line_crossings() {
+  if (_pending_line_crossings.empty())
+    return;
+
+  std::set<Line *> pending;
+  pending.swap(_pending_line_crossings);
+
+  if (!_line_hop_rendering)
+    return;
+
+  std::map<Line *, std::set<Line *> > candidates;
+  for (std::set<Line *>::const_iterator line = pending.begin(); line != pending.end(); ++line) {
+    std::set<Line *> &neighbours = candidates[*line];
+
+    unindex_line_segments(*line, neighbours);
+    if (is_line(*line)) {
+      index_line_segments(*line);
+
+      const std::vector<LineGridCell> &cells = _line_grid_cells[*line];
+      for (std::vector<LineGridCell>::const_iterator cell = cells.begin(); cell != cells.end(); ++cell) {
+        const std::set<Line *> &lines = _line_grid[*cell];
+        neighbours.insert(lines.begin(), lines.end());
+      }
+    }
+    neighbours.erase(*line);
+  }
+
+  // The stacking order decides which line of a pair gets the hop. Fetch it once for the whole affected area.
+  double minx = INFINITY, miny = INFINITY, maxx = -INFINITY, maxy = -INFINITY;
+  for (std::map<Line *, std::set<Line *> >::const_iterator entry = candidates.begin(); entry != candidates.end();
+       ++entry) {
+    if (entry->second.empty())
+      continue;
+
+    std::list<Line *> lines(entry->second.begin(), entry->second.end());
+    lines.push_back(entry->first);
+    for (std::list<Line *>::const_iterator line = lines.begin(); line != lines.end(); ++line) {
+      Rect bounds = (*line)->get_root_bounds();
+      minx = std::min(minx, bounds.left());
+      miny = std::min(miny, bounds.top());
+      maxx = std::max(maxx, bounds.right());
+      maxy = std::max(maxy, bounds.bottom());
+    }
+  }
+  if (minx > maxx)
+    return;
+
+  Rect area(minx, miny, maxx - minx, maxy - miny);
+
+  std::map<Line *, size_t> stacking;
+  std::list<CanvasItem *> items = get_items_bounded_by(area, std::bind(&is_line, std::placeholders::_1));
+  for (std::list<CanvasItem *>::const_iterator item = items.begin(); item != items.end(); ++item)
+    stacking.insert(std::make_pair(static_cast<Line *>(*item), stacking.size()));
+
+  std::set<std::pair<Line *, Line *> > done;
+  for (std::map<Line *, std::set<Line *> >::const_iterator entry = candidates.begin(); entry != candidates.end();
+       ++entry) {
+    Line *line = entry->first;
+    std::map<Line *, size_t>::const_iterator line_order = stacking.find(line);
+
+    for (std::set<Line *>::const_iterator iter = entry->second.begin(); iter != entry->second.end(); ++iter) {
+      Line *other = *iter;
+      if (!done.insert(std::make_pair(std::min(line, other), std::max(line, other))).second)
+        continue;
+
+      std::map<Line *, size_t>::const_iterator other_order = stacking.find(other);
+      if (line_order == stacking.end() || other_order == stacking.end()) {
+        // one of them is hidden or doesn't hop anymore
+        line->clear_crossings(other);
+        other->clear_crossings(line);
+      } else if (line_order->second < other_order->second)
+        other->mark_crossings(line);
+      else
+        line->mark_crossings(other);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::remove_line_crossings(Line *line) {
+  _pending_line_crossings.erase(line);
+
+  std::set<Line *> neighbours;
+  unindex_line_segments(line, neighbours);
+
+  if (!_destroying) {
+    for (std::set<Line *>::const_iterator iter = neighbours.begin(); iter != neighbours.end(); ++iter)
+      (*iter)->clear_crossings(line);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void CanvasView::remove_item(mdc::CanvasItem *item) {
   if (item->get_layer())
     item->get_layer()->remove_item(item);
@@ -791,6 +933,8 @@ void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int w
   CanvasAutoLock lock(this);
   Rect clip;
 
+  update_pending_line_crossings();
+
   begin_repaint(wx, wy, ww, wh);
   if (has_gl())
     glGetError(); // Resets error flag.
@@ -1022,6 +1166,8 @@ void CanvasView::render_for_export(const Rect &bounds, CairoCtx *ctx) {
   if (ctx)
     _cairo = ctx;
 
+  update_pending_line_crossings();
+
   set_printout_mode(true);
 
   _cairo->save();
@@ -32,6 +32,10 @@
 #include "mdc_selection.h"
 #include "base/threading.h"
 
+#include <map>
+#include <set>
+#include <vector>
+
 #ifndef _MSC_VER
 #include <glib.h>
 #endif
@@ -198,6 +202,8 @@ namespace mdc {
     Selection::ContentType get_selected_items();
 
     void update_line_crossings(Line *line);
+    void update_pending_line_crossings();
+    void remove_line_crossings(Line *line);
 
     virtual bool initialize();
 
@@ -298,6 +304,16 @@ namespace mdc {
     bool _printout_mode;
     bool _line_hop_rendering;
 
+    // Lines waiting for their crossings to be recomputed, and a uniform grid over root coordinates mapping each cell
+    // to the lines having a segment in it. Crossings are only looked for between lines sharing a cell.
+    typedef std::pair<int, int> LineGridCell;
+    std::set<Line *> _pending_line_crossings;
+    std::map<LineGridCell, std::set<Line *> > _line_grid;
+    std::map<Line *, std::vector<LineGridCell> > _line_grid_cells;
+
+    void index_line_segments(Line *line);
+    void unindex_line_segments(Line *line, std::set<Line *> &neighbours);
+
     bool _destroying;
     bool _debug;
 
@@ -103,6 +103,9 @@ Line::Line(Layer *layer, LineLayouter *layouter) : Figure(layer), _layouter(0) {
 }
 
 Line::~Line() {
+  if (get_layer())
+    get_view()->remove_line_crossings(this);
+
   delete _layouter;
 }
 
@@ -722,7 +725,28 @@ void Line::draw_line_ends_gl() {
 //--------------------------------------------------------------------------------------------------
 
 void Line::set_hops_crossings(bool flag) {
+  if (_hop_crossings == flag)
+    return;
+
   _hop_crossings = flag;
+  if (flag)
+    get_view()->update_line_crossings(this);
+  else {
+    get_view()->remove_line_crossings(this);
+
+    // remove_line_crossings only clears the hops other lines make over this one, drop our own as well
+    size_t i = 0;
+    bool changed = false;
+    while (i < _segments.size())
+      if (_segments[i].hop) {
+        _segments.erase(_segments.begin() + i);
+        changed = true;
+      } else
+        i++;
+
+    if (changed)
+      set_needs_render();
+  }
 }
 
 void Line::set_end_type(LineEndType start, LineEndType end) {
@@ -765,12 +789,7 @@ void Line::mark_crossings(Line *line) {
   // can't cross with one pointed line
   // remove any hops we could have on it
   if (line->_segments.size() < 2) {
-    size_t i = 0;
-    while (i < _segments.size())
-      if (_segments[i].hop == line)
-        _segments.erase(_segments.begin() + i);
-      else
-        i++;
+    clear_crossings(line);
     return;
   }
 
@@ -826,6 +845,32 @@ void Line::mark_crossings(Line *line) {
   set_needs_render();
 }
 
+void Line::clear_crossings(Line *line) {
+  size_t i = 0;
+  bool changed = false;
+  while (i < _segments.size())
+    if (_segments[i].hop == line) {
+      _segments.erase(_segments.begin() + i);
+      changed = true;
+    } else
+      i++;
+
+  if (changed)
+    set_needs_render();
+}
+
+std::vector<Point> Line::get_root_vertices() const {
+  std::vector<Point> vertices;
+  Point offset = get_root_position();
+
+  vertices.reserve(_vertices.size());
+  for (std::vector<SegmentPoint>::const_iterator iter = _segments.begin(); iter != _segments.end(); ++iter) {
+    if (!iter->hop)
+      vertices.push_back(iter->pos + offset);
+  }
+  return vertices;
+}
+
 void Line::update_bounds() {
   if (_vertices.size() <= 1) {
     set_bounds(Rect());
@@ -134,6 +134,10 @@ namespace mdc {
     }
 
     virtual void mark_crossings(Line *line);
+    void clear_crossings(Line *line);
+
+    // The line's vertices in root coordinates, without any hops.
+    std::vector<base::Point> get_root_vertices() const;
 
     virtual void create_handles(InteractionLayer *ilayer);
     virtual void update_handles();
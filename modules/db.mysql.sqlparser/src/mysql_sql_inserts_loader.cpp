@@ -24,16 +24,299 @@
 #include <glib.h>
 #include <boost/signals2.hpp>
 #include <cctype>
+#include <cstring>
 
 #include "mysql_sql_inserts_loader.h"
 #include "mysql_sql_parser_utils.h"
+#include "grtsqlparser/statement_splitter.h"
 #include <boost/foreach.hpp>
 
 using namespace grt;
 
 #define NULL_STATE_KEEPER Null_state_keeper _nsk(this);
 
-Mysql_sql_inserts_loader::Mysql_sql_inserts_loader() {
+namespace {
+
+  /**
+   * Converts the text of a single value from an insert statement to what the recordset stores for it.
+   * String literals lose their quotes (but keep their escape sequences), everything else which is not a plain
+   * number is marked as function call.
+   */
+  std::string insert_value(std::string value) {
+    if (1 < value.size()) {
+      switch (value[0]) {
+        case '\'':
+        case '"':
+          value = value.substr(1, value.size() - 2);
+          break;
+        default:
+          static const std::string func_call_seq = "\\func ";
+          if (value[0] == '\\') {
+            if ((value.size() > func_call_seq.size()) &&
+                (value.compare(0, func_call_seq.size(), func_call_seq) == 0)) {
+              value = '\\' + value;
+            }
+          } else {
+            bool is_expression = false;
+            for (std::string::iterator i = value.begin(), i_end = value.end(); i != i_end; ++i) {
+              if (!std::isdigit(*i) && (*i != '.') && (*i != ',')) {
+                is_expression = true;
+                break;
+              }
+            }
+            if (is_expression) {
+              value = func_call_seq + value;
+            }
+          }
+          break;
+      }
+    }
+    return value;
+  }
+
+  /**
+   * A scanner for the insert statements Workbench writes for table inserts itself:
+   *
+   *   INSERT INTO `schema`.`table` (`column`, ...) VALUES (literal, ...), ...
+   *
+   * Names must be quoted with back ticks and values must be string literals, numbers or NULL. The scanner gives
+   * up on anything else, leaving such statements to the full parser. Values are returned as the text the parser
+   * would return for them.
+   */
+  class Insert_values_scanner {
+  public:
+    typedef Sql_inserts_loader::Strings Strings;
+
+    struct Row {
+      Strings values;
+      std::vector<bool> null_fields;
+    };
+
+    Insert_values_scanner(const std::string &statement)
+      : _head(statement.c_str()), _end(statement.c_str() + statement.size()) {
+    }
+
+    // Returns false if the statement is not an insert at all, which is the case for anything not starting with
+    // a plain keyword other than INSERT.
+    bool is_insert() const {
+      const char *run = _head;
+      if (run < _end && (*run == '/' || *run == '-' || *run == '#' || *run == '('))
+        return true; // Leave anything unusual to the parser.
+      return match_keyword(run, "INSERT") || !is_identifier_char(*run);
+    }
+
+    bool scan(std::string &schema_name, std::string &table_name, Strings &fields_names, std::vector<Row> &rows) {
+      if (!skip_space() || !keyword("INSERT") || !skip_space() || !keyword("INTO") || !skip_space())
+        return false;
+
+      std::string name;
+      if (!quoted_name(name))
+        return false;
+      if (_head < _end && *_head == '.') {
+        ++_head;
+        schema_name = name;
+        if (!quoted_name(name))
+          return false;
+      }
+      table_name = name;
+
+      if (!skip_space() || !next_is('('))
+        return false;
+      do {
+        if (!skip_space() || !quoted_name(name) || !skip_space())
+          return false;
+        fields_names.push_back(name);
+      } while (next_is(','));
+      if (!next_is(')') || !skip_space() || !keyword("VALUES"))
+        return false;
+
+      do {
+        if (!skip_space() || !next_is('('))
+          return false;
+
+        rows.emplace_back();
+        Row &row = rows.back();
+        row.values.reserve(fields_names.size());
+        row.null_fields.reserve(fields_names.size());
+        do {
+          bool is_null = false;
+          if (!skip_space() || !value(name, is_null) || !skip_space())
+            return false;
+          row.values.push_back(is_null ? std::string() : insert_value(name));
+          row.null_fields.push_back(is_null);
+        } while (next_is(','));
+
+        if (!next_is(')') || !skip_space())
+          return false;
+      } while (next_is(','));
+
+      return _head == _end;
+    }
+
+  private:
+    const char *_head;
+    const char *_end;
+
+    static bool is_identifier_char(char c) {
+      return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_' || c == '$' ||
+             (unsigned char)c >= 0x80;
+    }
+
+    bool match_keyword(const char *run, const char *word) const {
+      for (; *word != '\0'; ++run, ++word)
+        if (run == _end || (*run & ~0x20) != *word)
+          return false;
+      return run == _end || !is_identifier_char(*run);
+    }
+
+    bool keyword(const char *word) {
+      if (!match_keyword(_head, word))
+        return false;
+      _head += strlen(word);
+      return true;
+    }
+
+    bool next_is(char c) {
+      if (_head == _end || *_head != c)
+        return false;
+      ++_head;
+      return true;
+    }
+
+    // Skips white space and comments. Fails for unterminated comments and hidden commands.
+    bool skip_space() {
+      while (_head < _end) {
+        switch (*_head) {
+          case ' ':
+          case '\t':
+          case '\n':
+          case '\r':
+          case '\f':
+          case '\v':
+            ++_head;
+            break;
+
+          case '/':
+            if (_head + 1 == _end || _head[1] != '*')
+              return true;
+            if (_head + 2 == _end || _head[2] == '!')
+              return false;
+            _head += 2;
+            while (_head + 1 < _end && !(_head[0] == '*' && _head[1] == '/'))
+              ++_head;
+            if (_head + 1 >= _end)
+              return false;
+            _head += 2;
+            break;
+
+          case '-':
+            if (_head + 1 == _end || _head[1] != '-' ||
+                (_head + 2 < _end && _head[2] != ' ' && _head[2] != '\t' && _head[2] != '\n' && _head[2] != '\r'))
+              return true;
+            // Fall through.
+          case '#':
+            while (_head < _end && *_head != '\n' && !(*_head == '\r' && (_head + 1 == _end || _head[1] != '\n')))
+              ++_head;
+            break;
+
+          default:
+            return true;
+        }
+      }
+      return true;
+    }
+
+    bool quoted_name(std::string &name) {
+      if (!next_is('`'))
+        return false;
+
+      const char *start = _head;
+      while (_head < _end && *_head != '`' && *_head != '\0')
+        ++_head;
+      if (_head == _end || *_head != '`' || _head == start || (_head + 1 < _end && _head[1] == '`'))
+        return false; // Unterminated or empty name or one with escaped back ticks.
+
+      name.assign(start, _head++);
+      return true;
+    }
+
+    bool value(std::string &text, bool &is_null) {
+      if (_head == _end)
+        return false;
+
+      const char *start = _head;
+      switch (*_head) {
+        case '\'':
+        case '"': {
+          char quote = *_head++;
+          while (true) {
+            if (_head == _end || *_head == '\0')
+              return false;
+            if (*_head == '\\') {
+              if (++_head == _end)
+                return false;
+            } else if (*_head == quote) {
+              if (_head + 1 == _end || _head[1] != quote)
+                break;
+              ++_head;
+            }
+            ++_head;
+          }
+          ++_head;
+          break;
+        }
+
+        case 'n':
+        case 'N':
+          if (!keyword("NULL"))
+            return false;
+          is_null = true;
+          return true;
+
+        default:
+          if (*_head == '-')
+            ++_head;
+          if (!number())
+            return false;
+          break;
+      }
+
+      text.assign(start, _head);
+      return true;
+    }
+
+    // An unsigned integer or decimal number, optionally with exponent. It must not be followed by anything that
+    // would make it part of an identifier.
+    bool number() {
+      if (!digits())
+        return false;
+      if (_head < _end && *_head == '.') {
+        ++_head;
+        if (!digits())
+          return false;
+      }
+      if (_head < _end && (*_head | 0x20) == 'e') {
+        ++_head;
+        if (_head < _end && (*_head == '+' || *_head == '-'))
+          ++_head;
+        if (!digits())
+          return false;
+      }
+      return _head == _end || (!is_identifier_char(*_head) && *_head != '.');
+    }
+
+    bool digits() {
+      const char *start = _head;
+      while (_head < _end && *_head >= '0' && *_head <= '9')
+        ++_head;
+      return _head > start;
+    }
+  };
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Mysql_sql_inserts_loader::Mysql_sql_inserts_loader() : _use_values_scanner(true) {
   NULL_STATE_KEEPER
 }
 
@@ -43,9 +326,54 @@ void Mysql_sql_inserts_loader::load(const std::string &sql, const std::string &s
   _schema_name = schema_name;
   _process_sql_statement = boost::bind(&Mysql_sql_inserts_loader::process_sql_statement, this, boost::placeholders::_1);
 
-  Mysql_sql_parser_fe sql_parser_fe(bec::GRTManager::get()->get_app_option_string("SqlMode"));
+  std::string sql_mode = bec::GRTManager::get()->get_app_option_string("SqlMode");
+  Mysql_sql_parser_fe sql_parser_fe(sql_mode);
   sql_parser_fe.ignore_dml = false;
-  Mysql_sql_parser_base::parse_sql_script(sql_parser_fe, sql.c_str());
+
+  // The scanner relies on the default meaning of quotes and backslashes. The parser also stops at the first
+  // null byte, which would make results differ for scripts containing one.
+  if (!_use_values_scanner || sql_parser_fe.sql_mode.MODE_ANSI_QUOTES ||
+      sql_parser_fe.sql_mode.MODE_NO_BACKSLASH_ESCAPES || sql.find('\0') != std::string::npos) {
+    Mysql_sql_parser_base::parse_sql_script(sql_parser_fe, sql.c_str());
+    return;
+  }
+
+  // Split the script ourselves and only hand the statements to the full parser the scanner could not handle.
+  std::vector<parsers::StatementRange> ranges;
+  parsers::StatementSplitter().split(sql.c_str(), sql.size(), ranges);
+  for (auto &range : ranges) {
+    std::string statement = sql.substr(range.start, range.length);
+    if (!scan_insert_statement(statement))
+      Mysql_sql_parser_base::parse_sql_script(sql_parser_fe, statement.c_str());
+  }
+}
+
+/**
+ * Tries to load the given statement with the values scanner. Returns false if the statement must be
+ * processed by the parser instead.
+ */
+bool Mysql_sql_inserts_loader::scan_insert_statement(const std::string &statement) {
+  Insert_values_scanner scanner(statement);
+  if (!scanner.is_insert())
+    return true; // Nothing to load from this one.
+
+  // The parser rejects statements which are not valid utf-8 and unfolds version comments anywhere in a
+  // statement (even in strings), so leave such cases to it.
+  if (!g_utf8_validate(statement.c_str(), statement.size(), NULL) || statement.find("/*!") != std::string::npos)
+    return false;
+
+  std::string schema_name = _schema_name;
+  std::string table_name;
+  Strings fields_names;
+  std::vector<Insert_values_scanner::Row> rows;
+  if (!scanner.scan(schema_name, table_name, fields_names, rows))
+    return false;
+
+  const std::pair<std::string, std::string> schema_table = make_pair(schema_name, table_name);
+  for (auto &row : rows)
+    _process_insert(statement, schema_table, fields_names, row.values, row.null_fields);
+
+  return true;
 }
 
 int Mysql_sql_inserts_loader::process_sql_statement(const SqlAstNode *tree) {
@@ -68,7 +396,8 @@ Mysql_sql_inserts_loader::Parse_result Mysql_sql_inserts_loader::process_insert_
   if (insert_field_spec) {
     // schema & table name
     {
-      const SqlAstNode *table_ident = tree->subitem(sql::_insert2, sql::_insert_table, sql::_table_ident);
+      const SqlAstNode *table_ident = tree->subitem(sql::_insert2, sql::_insert_table,
+                                                    sql::_table_name_with_opt_use_partition, sql::_table_ident);
       process_obj_full_name_item(table_ident, schema_name, table_name);
     }
 
@@ -113,37 +442,8 @@ Mysql_sql_inserts_loader::Parse_result Mysql_sql_inserts_loader::process_insert_
                                       if (/*const SqlAstNode *item7=*/item6->subitem(sql::_NULL_SYM))
                                         is_field_null = true;
 
-              if (!is_field_null) {
-                value = item->restore_sql_text(_sql_statement);
-                if (1 < value.size()) {
-                  switch (value[0]) {
-                    case '\'':
-                    case '"':
-                      value = value.substr(1, value.size() - 2);
-                      break;
-                    default:
-                      static const std::string func_call_seq = "\\func ";
-                      if (value[0] == '\\') {
-                        if ((value.size() > func_call_seq.size()) &&
-                            (value.compare(0, func_call_seq.size(), func_call_seq) == 0)) {
-                          value = '\\' + value;
-                        }
-                      } else {
-                        bool is_expression = false;
-                        for (std::string::iterator i = value.begin(), i_end = value.end(); i != i_end; ++i) {
-                          if (!std::isdigit(*i) && (*i != '.') && (*i != ',')) {
-                            is_expression = true;
-                            break;
-                          }
-                        }
-                        if (is_expression) {
-                          value = func_call_seq + value;
-                        }
-                      }
-                      break;
-                  }
-                }
-              }
+              if (!is_field_null)
+                value = insert_value(item->restore_sql_text(_sql_statement));
 
               fields_values.push_back(value);
               null_fields.push_back(is_field_null);
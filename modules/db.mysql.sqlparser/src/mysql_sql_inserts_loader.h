@@ -46,15 +46,23 @@ protected:
 public:
   void load(const std::string &sql, const std::string &schema_name);
 
+  // When enabled (the default), plain INSERT ... VALUES statements are read by a dedicated scanner and only
+  // statements it cannot handle go through the full parser.
+  void use_values_scanner(bool flag) {
+    _use_values_scanner = flag;
+  }
+
 protected:
   // higher level
   int process_sql_statement(const SqlAstNode *tree);
+  bool scan_insert_statement(const std::string &statement);
 
   // parse tree core
   Parse_result process_insert_statement(const SqlAstNode *tree);
 
   // context
   std::string _schema_name;
+  bool _use_values_scanner;
 
   class Null_state_keeper : Mysql_sql_parser_base::Null_state_keeper {
   public:
@@ -221,6 +221,17 @@ def getServerMode(connection):
 
 @ModuleInfo.export(grt.classes.db_Catalog, grt.classes.db_mgmt_Connection, grt.STRING, (grt.LIST, grt.STRING), grt.DICT)
 def reverseEngineer(connection, catalog_name, schemata_list, context):
+    if context.get("useNativeReverseEngineer", True):
+        # Fetches and parses the objects over several connections in parallel.
+        options = grt.Dict()
+        for key in context.keys():
+            options[key] = context[key]
+        options["SqlDelimiter"] = grt.root.wb.options.options['SqlDelimiter']
+        catalog = grt.modules.DbMySQL.reverseEngineer(connection, catalog_name, schemata_list, options)
+        if "timings" in options:
+            context["timings"] = options["timings"]
+        return catalog
+
     catalog = grt.classes.db_mysql_Catalog()
     catalog.name = catalog_name
     catalog.simpleDatatypes.remove_all()
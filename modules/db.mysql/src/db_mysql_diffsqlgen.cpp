@@ -1414,6 +1414,50 @@ void DiffSQLGeneratorBE::process_diff_change(grt::ValueRef org_object, grt::Diff
   do_process_diff_change(org_object, diff);
 }
 
+void DiffSQLGeneratorBE::generate_create_stmts(const std::vector<GrtNamedObjectRef> &objects, grt::DictRef map) {
+  this->target_list = grt::StringListRef();
+  this->target_map = map;
+
+  for (auto &object : objects) {
+    if (db_mysql_TableRef::can_wrap(object))
+      generate_create_stmt(db_mysql_TableRef::cast_from(object));
+    else if (db_mysql_ViewRef::can_wrap(object))
+      generate_create_stmt(db_mysql_ViewRef::cast_from(object));
+    else if (db_mysql_RoutineRef::can_wrap(object))
+      generate_create_stmt(db_mysql_RoutineRef::cast_from(object));
+    else if (db_mysql_TriggerRef::can_wrap(object))
+      generate_create_stmt(db_mysql_TriggerRef::cast_from(object));
+    else if (db_UserRef::can_wrap(object))
+      generate_create_stmt(db_UserRef::cast_from(object));
+    else if (db_mysql_SchemaRef::can_wrap(object)) {
+      db_mysql_SchemaRef schema = db_mysql_SchemaRef::cast_from(object);
+      if (!_use_filtered_lists ||
+          _filtered_schemata.find(get_old_object_name_for_key(schema, _case_sensitive)) != _filtered_schemata.end())
+        callback->create_schema(schema);
+    }
+  }
+}
+
+void DiffSQLGeneratorBE::generate_drop_stmts(const std::vector<GrtNamedObjectRef> &objects, grt::DictRef map) {
+  this->target_list = grt::StringListRef();
+  this->target_map = map;
+
+  for (auto &object : objects) {
+    if (db_mysql_TableRef::can_wrap(object))
+      generate_drop_stmt(db_mysql_TableRef::cast_from(object));
+    else if (db_mysql_ViewRef::can_wrap(object))
+      generate_drop_stmt(db_mysql_ViewRef::cast_from(object));
+    else if (db_mysql_RoutineRef::can_wrap(object))
+      generate_drop_stmt(db_mysql_RoutineRef::cast_from(object));
+    else if (db_mysql_TriggerRef::can_wrap(object))
+      generate_drop_stmt(db_mysql_TriggerRef::cast_from(object));
+    else if (db_UserRef::can_wrap(object))
+      generate_drop_stmt(db_UserRef::cast_from(object));
+    else if (db_mysql_SchemaRef::can_wrap(object))
+      callback->drop_schema(db_mysql_SchemaRef::cast_from(object));
+  }
+}
+
 void DiffSQLGeneratorBE::do_process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff) {
   switch (diff->get_change_type()) {
     // case SimpleValue:
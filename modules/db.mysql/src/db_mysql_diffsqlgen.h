@@ -53,6 +53,7 @@
 #include "grts/structs.db.mysql.h"
 
 #include <set>
+#include <vector>
 
 namespace grt {
   class DiffChange;
@@ -197,6 +198,14 @@ public:
    */
   void process_diff_change(grt::ValueRef org_object, grt::DiffChange *, grt::StringListRef,
                            grt::ListRef<GrtNamedObject>);
+
+  /**
+   * Generates CREATE (or DROP) statements for the given objects into a map, without a diff. Tables include their
+   * triggers, schemata get only their own statement. This allows generating the SQL of a catalog in independent
+   * parts, e.g. on several threads with one generator (and callback) per thread.
+   */
+  void generate_create_stmts(const std::vector<GrtNamedObjectRef> &objects, grt::DictRef map);
+  void generate_drop_stmts(const std::vector<GrtNamedObjectRef> &objects, grt::DictRef map);
 };
 
 #endif // _DB_MYSQL_DIFFSQLGEN_H_
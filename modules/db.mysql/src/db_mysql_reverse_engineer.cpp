@@ -0,0 +1,567 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "base/log.h"
+#include "base/profiling.h"
+#include "base/sqlstring.h"
+#include "base/string_utilities.h"
+#include "base/util_functions.h"
+
+#include "grtpp_util.h"
+#include "grtdb/db_helpers.h"
+#include "grtsqlparser/mysql_parser_services.h"
+
+#include "cppdbc.h"
+#include "mforms/utilities.h"
+
+#include "db_mysql_reverse_engineer.h"
+
+DEFAULT_LOG_DOMAIN("DbMySQLRE")
+
+using namespace dbmysql;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// A table together with its triggers or any other single object.
+struct ParallelReverseEngineer::Unit {
+  std::vector<size_t> objects;
+};
+
+struct ParallelReverseEngineer::Worker {
+  std::unique_ptr<Source> source;
+  parsers::MySQLParserContext::Ref context;
+  db_mysql_CatalogRef catalog;
+
+  double fetch_time = 0;
+  double parse_time = 0;
+  std::vector<std::string> failures;
+
+  std::thread thread;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ParallelReverseEngineer::ParallelReverseEngineer(db_mgmt_RdbmsRef rdbms, GrtVersionRef version,
+                                                 const std::string &sql_mode, bool case_sensitive)
+  : _rdbms(rdbms), _version(version), _sql_mode(sql_mode), _case_sensitive(case_sensitive), _delimiter("$$") {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ParallelReverseEngineer::add_schema(const std::string &name) {
+  _schemata.push_back(name);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ParallelReverseEngineer::add_object(const Object &object) {
+  _objects.push_back(object);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::vector<ParallelReverseEngineer::Unit> ParallelReverseEngineer::create_units() const {
+  std::vector<Unit> units;
+  std::map<std::pair<std::string, std::string>, size_t> table_units;
+
+  for (size_t i = 0; i < _objects.size(); ++i) {
+    const Object &object = _objects[i];
+    if (object.type == TriggerObject) {
+      // Triggers must be parsed in the same catalog as their table, otherwise a stub table would be created.
+      auto iter = table_units.find({object.schema, object.table});
+      if (iter != table_units.end()) {
+        units[iter->second].objects.push_back(i);
+        continue;
+      }
+    }
+
+    if (object.type == TableObject)
+      table_units[{object.schema, object.name}] = units.size();
+    units.push_back(Unit());
+    units.back().objects.push_back(i);
+  }
+
+  // Triggers listed before their table still end up in the table's unit.
+  for (auto &unit : units) {
+    const Object &object = _objects[unit.objects.front()];
+    if (object.type != TriggerObject || unit.objects.size() > 1)
+      continue;
+
+    auto iter = table_units.find({object.schema, object.table});
+    if (iter != table_units.end()) {
+      units[iter->second].objects.push_back(unit.objects.front());
+      unit.objects.clear();
+    }
+  }
+  units.erase(std::remove_if(units.begin(), units.end(), [](const Unit &unit) { return unit.objects.empty(); }),
+              units.end());
+
+  return units;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ParallelReverseEngineer::parse_unit(Worker &worker, const Unit &unit) {
+  auto services = parsers::MySQLParserServices::get();
+
+  for (size_t index : unit.objects) {
+    const Object &object = _objects[index];
+
+    double start = base::timestamp();
+    std::string sql;
+    {
+      BASE_TRACE("reveng", "fetch");
+      sql = worker.source->fetch_ddl(object);
+    }
+    double fetched = base::timestamp();
+    worker.fetch_time += fetched - start;
+
+    if (object.type == TriggerObject || object.type == ProcedureObject || object.type == FunctionObject)
+      sql = "DELIMITER " + _delimiter + "\n" + sql + _delimiter + "\nDELIMITER ;\n";
+
+    grt::DictRef options(true);
+    options.set("schema", grt::StringRef(object.schema));
+
+    size_t errors;
+    {
+      BASE_TRACE("reveng", "parse");
+      errors = services->parseSQLIntoCatalog(worker.context, worker.catalog, sql, options);
+    }
+    worker.parse_time += base::timestamp() - fetched;
+
+    if (errors > 0)
+      worker.failures.push_back(base::strfmt("Error parsing the definition of %s.%s", object.schema.c_str(),
+                                             object.name.c_str()));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+template <class T>
+static grt::Ref<T> move_object(grt::ListRef<T> from, grt::ListRef<T> to, const std::string &name,
+                               const GrtNamedObjectRef &owner, bool case_sensitive) {
+  grt::Ref<T> object = grt::find_named_object_in_list(from, name, case_sensitive);
+  if (object.is_valid()) {
+    from.remove_value(object);
+    object->owner(owner);
+    to.insert(object);
+  }
+  return object;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ParallelReverseEngineer::merge(db_mysql_CatalogRef catalog, const std::vector<Unit> &units,
+                                    std::vector<Worker> &workers) {
+  std::map<std::string, db_mysql_SchemaRef> schemata;
+  auto target_schema = [&](const std::string &name) {
+    db_mysql_SchemaRef &schema = schemata[name];
+    if (!schema.is_valid()) {
+      schema = db_mysql_SchemaRef(grt::Initialized);
+      schema->owner(catalog);
+      schema->name(name);
+      catalog->schemata().insert(schema);
+    }
+    return schema;
+  };
+
+  for (auto &name : _schemata)
+    target_schema(name);
+
+  // Units were handed out in order, so worker w parsed units w, w + n, w + 2n...
+  std::map<std::pair<std::string, std::string>, db_mysql_TableRef> tables;
+  for (size_t u = 0; u < units.size(); ++u) {
+    Worker &worker = workers[u % workers.size()];
+    for (size_t index : units[u].objects) {
+      const Object &object = _objects[index];
+      db_mysql_SchemaRef source =
+        grt::find_named_object_in_list(worker.catalog->schemata(), object.schema, _case_sensitive);
+      if (!source.is_valid())
+        continue;
+
+      db_mysql_SchemaRef schema = target_schema(object.schema);
+      switch (object.type) {
+        case TableObject: {
+          db_mysql_TableRef table = grt::find_named_object_in_list(source->tables(), object.name, _case_sensitive);
+          if (table.is_valid() && !*table->isStub()) {
+            move_object(source->tables(), schema->tables(), object.name, schema, _case_sensitive);
+            tables[{object.schema, object.name}] = table;
+          }
+          break;
+        }
+        case ViewObject:
+          move_object(source->views(), schema->views(), object.name, schema, _case_sensitive);
+          break;
+        case ProcedureObject:
+        case FunctionObject:
+          move_object(source->routines(), schema->routines(), object.name, schema, _case_sensitive);
+          break;
+        case TriggerObject:
+          break; // Triggers move together with their table.
+      }
+    }
+  }
+
+  // Foreign keys to tables from another worker catalog point to a stub there. Redirect them to the real table or,
+  // if that table was not reverse engineered, adopt the stub (it is shared by all later references).
+  for (size_t s = 0; s < catalog->schemata().count(); ++s) {
+    db_mysql_SchemaRef schema = catalog->schemata()[s];
+    for (size_t t = 0; t < schema->tables().count(); ++t) {
+      db_mysql_TableRef table = schema->tables()[t];
+      for (size_t f = 0; f < table->foreignKeys().count(); ++f) {
+        db_ForeignKeyRef fk = table->foreignKeys()[f];
+        db_mysql_TableRef referenced = db_mysql_TableRef::cast_from(fk->referencedTable());
+        if (!referenced.is_valid())
+          continue;
+
+        db_SchemaRef referenced_schema = db_SchemaRef::cast_from(referenced->owner());
+        if (referenced_schema.is_valid() && referenced_schema->owner() == catalog)
+          continue;
+
+        std::pair<std::string, std::string> key(referenced_schema.is_valid() ? *referenced_schema->name() : "",
+                                                *referenced->name());
+        auto iter = tables.find(key);
+        if (iter == tables.end()) {
+          if (referenced_schema.is_valid())
+            referenced_schema->tables().remove_value(referenced);
+          db_mysql_SchemaRef owner = target_schema(key.first);
+          referenced->owner(owner);
+          owner->tables().insert(referenced);
+          tables[key] = referenced;
+          continue;
+        }
+
+        db_mysql_TableRef target = iter->second;
+        fk->referencedTable(target);
+        for (size_t c = 0; c < fk->referencedColumns().count(); ++c) {
+          db_ColumnRef column = fk->referencedColumns()[c];
+          db_ColumnRef replacement = grt::find_named_object_in_list(target->columns(), column->name(), false);
+          if (replacement.is_valid())
+            fk->referencedColumns().set(c, replacement);
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+db_mysql_CatalogRef ParallelReverseEngineer::run(const std::string &catalog_name, const SourceFactory &create_source,
+                                                 size_t worker_count) {
+  double start = base::timestamp();
+  std::vector<Unit> units = create_units();
+
+  worker_count = std::max<size_t>(1, std::min(worker_count, units.size()));
+  std::vector<Worker> workers(worker_count);
+  auto services = parsers::MySQLParserServices::get();
+  for (auto &worker : workers) {
+    worker.context = services->createParserContext(_rdbms->characterSets(), _version, _sql_mode, _case_sensitive);
+    worker.catalog = db_mysql_CatalogRef(grt::Initialized);
+    worker.catalog->version(_version);
+    grt::replace_contents(worker.catalog->simpleDatatypes(), _rdbms->simpleDatatypes());
+  }
+
+  std::mutex mutex;
+  std::condition_variable progress;
+  std::atomic<bool> cancelled(false);
+  std::string error;
+  size_t done = 0;
+
+  // Units are assigned round robin instead of taken from a shared queue. That keeps the merge order trivial to
+  // reconstruct and the units are small enough for the load to even out.
+  for (size_t w = 0; w < worker_count; ++w) {
+    Worker &worker = workers[w];
+    worker.thread = std::thread([&, w]() {
+      base::Tracer::set_thread_name(base::strfmt("Reverse engineering %i", (int)w));
+      try {
+        worker.source.reset(create_source());
+        for (size_t u = w; u < units.size() && !cancelled; u += worker_count) {
+          parse_unit(worker, units[u]);
+
+          std::lock_guard<std::mutex> lock(mutex);
+          ++done;
+          progress.notify_one();
+        }
+      } catch (std::exception &exc) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty())
+          error = exc.what();
+        cancelled = true;
+        progress.notify_one();
+      }
+      worker.source.reset();
+    });
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (done < units.size() && !cancelled) {
+      progress.wait_for(lock, std::chrono::milliseconds(100));
+
+      float fraction = units.empty() ? 1.0f : (float)done / units.size();
+      size_t count = done;
+      lock.unlock();
+      grt::GRT::get()->send_progress(fraction, base::strfmt("Reverse engineered %i of %i objects", (int)count,
+                                                            (int)units.size()));
+      if (grt::GRT::get()->query_status())
+        cancelled = true;
+      lock.lock();
+    }
+  }
+
+  for (auto &worker : workers)
+    worker.thread.join();
+
+  if (!error.empty())
+    throw std::runtime_error(error);
+  if (cancelled)
+    throw grt::user_cancelled("Reverse engineering cancelled");
+
+  for (auto &worker : workers) {
+    _timings.fetch += worker.fetch_time;
+    _timings.parse += worker.parse_time;
+    for (auto &failure : worker.failures)
+      grt::GRT::get()->send_warning(failure);
+  }
+
+  double merge_start = base::timestamp();
+  db_mysql_CatalogRef catalog(grt::Initialized);
+  catalog->name(catalog_name);
+  catalog->version(_version);
+  grt::replace_contents(catalog->simpleDatatypes(), _rdbms->simpleDatatypes());
+  {
+    BASE_TRACE("reveng", "merge");
+    merge(catalog, units, workers);
+  }
+  _timings.merge = base::timestamp() - merge_start;
+  _timings.total += base::timestamp() - start;
+
+  return catalog;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+  class ServerSource : public ParallelReverseEngineer::Source {
+  public:
+    ServerSource(sql::ConnectionWrapper connection) : _connection(connection) {
+    }
+
+    virtual ~ServerSource() {
+      _connection = sql::ConnectionWrapper();
+      sql::DriverManager::getDriverManager()->thread_cleanup();
+    }
+
+    virtual std::string fetch_ddl(const ParallelReverseEngineer::Object &object) override {
+      static const char *commands[] = {"SHOW CREATE TABLE !.!", "SHOW CREATE VIEW !.!", "SHOW CREATE TRIGGER !.!",
+                                       "SHOW CREATE PROCEDURE !.!", "SHOW CREATE FUNCTION !.!"};
+      static const char *kinds[] = {"table", "view", "trigger", "procedure", "function"};
+
+      std::unique_ptr<sql::Statement> statement(_connection->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(
+        statement->executeQuery(base::sqlstring(commands[object.type], 0) << object.schema << object.name));
+      if (!rs->next())
+        throw std::runtime_error(base::strfmt("Could not fetch %s information for %s.%s", kinds[object.type],
+                                              object.schema.c_str(), object.name.c_str()));
+
+      switch (object.type) {
+        case ParallelReverseEngineer::TriggerObject:
+          return rs->getString("SQL Original Statement");
+        case ParallelReverseEngineer::ProcedureObject:
+          return rs->getString("Create Procedure");
+        case ParallelReverseEngineer::FunctionObject:
+          return rs->getString("Create Function");
+        default:
+          return rs->getString(2);
+      }
+    }
+
+  private:
+    sql::ConnectionWrapper _connection;
+  };
+
+  std::vector<std::string> query_names(sql::Statement *statement, const std::string &query, int column) {
+    std::vector<std::string> names;
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(query));
+    while (rs->next())
+      names.push_back(rs->getString(column));
+    return names;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+db_mysql_CatalogRef dbmysql::reverse_engineer_server(const db_mgmt_ConnectionRef &connection,
+                                                     const std::string &catalog_name,
+                                                     const std::vector<std::string> &schemata, grt::DictRef options) {
+  double start = base::timestamp();
+  sql::DriverManager *dm = sql::DriverManager::getDriverManager();
+
+  // A password entered for this connection earlier in the session is in the password cache. Otherwise the driver
+  // manager looks it up in the keychain or asks for it, and caches it for the following connections, so those
+  // are opened one at a time.
+  std::string cached_password;
+  bool have_cached_password = mforms::Utilities::find_cached_password(
+    connection->hostIdentifier(), connection->parameterValues().get_string("userName"), cached_password);
+  std::mutex connect_mutex;
+  auto connect = [&]() {
+    std::lock_guard<std::mutex> lock(connect_mutex);
+    if (have_cached_password) {
+      sql::Authentication::Ref auth = sql::Authentication::create(connection, "");
+      auth->set_password(cached_password.c_str());
+      return dm->getConnection(connection, dm->getTunnel(connection), auth);
+    }
+    return dm->getConnection(connection);
+  };
+
+  sql::ConnectionWrapper main_connection = connect();
+  std::unique_ptr<sql::Statement> statement(main_connection->createStatement());
+
+  std::string version_string;
+  {
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery("SELECT VERSION()"));
+    if (rs->next())
+      version_string = rs->getString(1);
+  }
+  std::string sql_mode;
+  {
+    std::unique_ptr<sql::ResultSet> rs(statement->executeQuery("SELECT @@SESSION.sql_mode"));
+    if (rs->next())
+      sql_mode = rs->getString(1);
+  }
+  GrtVersionRef version = bec::parse_version(version_string);
+
+  db_mgmt_RdbmsRef rdbms = db_mgmt_RdbmsRef::cast_from(connection->driver()->owner());
+  ParallelReverseEngineer engine(rdbms, version, sql_mode, true);
+  engine.set_delimiter(options.get_string("SqlDelimiter", "$$"));
+
+  bool get_tables = options.get_int("reverseEngineerTables", 1) != 0;
+  bool get_views = options.get_int("reverseEngineerViews", 1) != 0;
+  bool get_routines = options.get_int("reverseEngineerRoutines", 1) != 0;
+  bool get_triggers = options.get_int("reverseEngineerTriggers", 1) != 0 && bec::is_supported_mysql_version_at_least(
+                                                                                version, 5, 1, 21);
+
+  grt::GRT::get()->send_progress(0, "Preparing...");
+  for (auto &schema : schemata) {
+    if (grt::GRT::get()->query_status())
+      throw grt::user_cancelled("Reverse engineering cancelled");
+
+    engine.add_schema(schema);
+
+    typedef ParallelReverseEngineer::Object Object;
+    if (get_tables || get_views) {
+      std::unique_ptr<sql::ResultSet> rs(
+        statement->executeQuery(base::sqlstring("SHOW FULL TABLES FROM !", 0) << schema));
+      while (rs->next()) {
+        bool is_view = rs->getString(2) == "VIEW";
+        if (is_view ? get_views : get_tables)
+          engine.add_object(
+            Object{is_view ? ParallelReverseEngineer::ViewObject : ParallelReverseEngineer::TableObject, schema,
+                   rs->getString(1), ""});
+      }
+    }
+
+    if (get_triggers) {
+      std::unique_ptr<sql::ResultSet> rs(statement->executeQuery(base::sqlstring("SHOW TRIGGERS FROM !", 0) << schema));
+      while (rs->next())
+        engine.add_object(
+          Object{ParallelReverseEngineer::TriggerObject, schema, rs->getString("Trigger"), rs->getString("Table")});
+    }
+
+    if (get_routines) {
+      for (auto &name :
+           query_names(statement.get(), base::sqlstring("SHOW PROCEDURE STATUS WHERE Db = ?", 0) << schema, 2))
+        engine.add_object(Object{ParallelReverseEngineer::ProcedureObject, schema, name, ""});
+      for (auto &name :
+           query_names(statement.get(), base::sqlstring("SHOW FUNCTION STATUS WHERE Db = ?", 0) << schema, 2))
+        engine.add_object(Object{ParallelReverseEngineer::FunctionObject, schema, name, ""});
+    }
+  }
+  engine.timings().list = base::timestamp() - start;
+
+  size_t worker_count = (size_t)options.get_int("reverseEngineerConnections", 4);
+  grt::GRT::get()->send_info(base::strfmt("Reverse engineering %i objects from %i schemata using %i connections",
+                                          (int)engine.object_count(), (int)schemata.size(), (int)worker_count));
+
+  // The first worker reuses the connection that was used for listing the objects.
+  std::atomic<bool> main_connection_taken(false);
+  db_mysql_CatalogRef catalog = engine.run(
+    catalog_name,
+    [&]() -> ParallelReverseEngineer::Source * {
+      if (!main_connection_taken.exchange(true))
+        return new ServerSource(main_connection);
+      return new ServerSource(connect());
+    },
+    worker_count);
+  statement.reset();
+  main_connection = sql::ConnectionWrapper();
+
+  // Tables which were only referenced by foreign keys remain stubs, like in the serial implementation.
+  std::vector<db_mysql_SchemaRef> empty_schemata;
+  for (size_t s = 0; s < catalog->schemata().count(); ++s) {
+    db_mysql_SchemaRef schema = catalog->schemata()[s];
+    bool had_stubs = false;
+    for (size_t t = schema->tables().count(); t > 0; --t) {
+      db_mysql_TableRef table = schema->tables()[t - 1];
+      if (*table->isStub()) {
+        grt::GRT::get()->send_warning(base::strfmt(
+          "Table %s was referenced from another table, but was not reverse engineered", table->name().c_str()));
+        schema->tables().remove_value(table);
+        had_stubs = true;
+      }
+    }
+    if (had_stubs && schema->tables().count() == 0 && schema->views().count() == 0 &&
+        schema->routines().count() == 0)
+      empty_schemata.push_back(schema);
+  }
+  for (auto &schema : empty_schemata)
+    catalog->schemata().remove_value(schema);
+
+  ParallelReverseEngineer::Timings &timings = engine.timings();
+  timings.total = base::timestamp() - start;
+
+  grt::DictRef timing_info(true);
+  timing_info.set("list", grt::DoubleRef(timings.list));
+  timing_info.set("fetch", grt::DoubleRef(timings.fetch));
+  timing_info.set("parse", grt::DoubleRef(timings.parse));
+  timing_info.set("merge", grt::DoubleRef(timings.merge));
+  timing_info.set("total", grt::DoubleRef(timings.total));
+  options.set("timings", timing_info);
+
+  std::string summary = base::strfmt(
+    "Reverse engineered %i objects in %.2fs (list %.2fs, fetch %.2fs, parse %.2fs, merge %.2fs)",
+    (int)engine.object_count(), timings.total, timings.list, timings.fetch, timings.parse, timings.merge);
+  logInfo("%s\n", summary.c_str());
+  grt::GRT::get()->send_progress(1.0, summary);
+
+  return catalog;
+}
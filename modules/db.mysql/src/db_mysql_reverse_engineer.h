@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "db_mysql_public_interface.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "grts/structs.db.mgmt.h"
+#include "grts/structs.db.mysql.h"
+
+namespace dbmysql {
+
+  /**
+   * Reverse engineers MySQL objects into a new catalog, using several worker threads.
+   *
+   * Each worker has its own DDL source (normally a server connection), its own parser context and parses into a
+   * private catalog, so fetching and parsing of different objects run concurrently. A table is always processed
+   * together with its triggers. When all workers are done the objects are moved into the result catalog in the
+   * order they were added, which makes the result independent of the number of workers and their scheduling.
+   * Foreign keys referencing tables that were parsed by another worker are resolved during that merge.
+   */
+  class MYSQLMODULEDBMYSQL_PUBLIC_FUNC ParallelReverseEngineer {
+  public:
+    enum ObjectType { TableObject, ViewObject, TriggerObject, ProcedureObject, FunctionObject };
+
+    struct Object {
+      ObjectType type;
+      std::string schema;
+      std::string name;
+      std::string table; // The owning table, for triggers only.
+    };
+
+    // Delivers the CREATE statement of an object. Every worker thread creates its own source.
+    class MYSQLMODULEDBMYSQL_PUBLIC_FUNC Source {
+    public:
+      virtual ~Source() {
+      }
+      virtual std::string fetch_ddl(const Object &object) = 0;
+    };
+    typedef std::function<Source *()> SourceFactory;
+
+    // Values in seconds. Fetch and parse times are summed over all workers, total is the elapsed time.
+    struct Timings {
+      double list = 0;
+      double fetch = 0;
+      double parse = 0;
+      double merge = 0;
+      double total = 0;
+    };
+
+    ParallelReverseEngineer(db_mgmt_RdbmsRef rdbms, GrtVersionRef version, const std::string &sql_mode,
+                            bool case_sensitive);
+
+    void set_delimiter(const std::string &delimiter) {
+      _delimiter = delimiter;
+    }
+
+    void add_schema(const std::string &name);
+    void add_object(const Object &object);
+    size_t object_count() const {
+      return _objects.size();
+    }
+
+    db_mysql_CatalogRef run(const std::string &catalog_name, const SourceFactory &create_source,
+                            size_t worker_count);
+
+    Timings &timings() {
+      return _timings;
+    }
+
+  private:
+    struct Unit;
+    struct Worker;
+
+    db_mgmt_RdbmsRef _rdbms;
+    GrtVersionRef _version;
+    std::string _sql_mode;
+    bool _case_sensitive;
+    std::string _delimiter;
+
+    std::vector<std::string> _schemata;
+    std::vector<Object> _objects;
+    Timings _timings;
+
+    std::vector<Unit> create_units() const;
+    void parse_unit(Worker &worker, const Unit &unit);
+    void merge(db_mysql_CatalogRef catalog, const std::vector<Unit> &units, std::vector<Worker> &workers);
+  };
+
+  /**
+   * Reverse engineers the given schemata of a live server, using up to options["reverseEngineerConnections"]
+   * connections (4 by default). Honors the reverseEngineerTables/Views/Triggers/Routines flags in the options and
+   * stores the timings of the individual phases in options["timings"].
+   */
+  MYSQLMODULEDBMYSQL_PUBLIC_FUNC db_mysql_CatalogRef reverse_engineer_server(const db_mgmt_ConnectionRef &connection,
+                                                                             const std::string &catalog_name,
+                                                                             const std::vector<std::string> &schemata,
+                                                                             grt::DictRef options);
+}
@@ -26,6 +26,10 @@
 #include <stdio.h>
 #endif
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "base/sqlstring.h"
 
 #include "grt/grt_manager.h"
@@ -39,10 +43,13 @@
 
 #include "db_mysql_diffsqlgen_grant.h"
 #include "db_mysql_catalog_report.h"
+#include "db_mysql_reverse_engineer.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
 #include "base/util_functions.h"
 #include "base/file_utilities.h"
+#include "base/file_functions.h"
+#include "base/log.h"
 
 #include "grtsqlparser/sql_specifics.h"
 #include "sqlide/recordset_table_inserts_storage.h"
@@ -57,6 +64,8 @@
 using namespace grt;
 using namespace base;
 
+DEFAULT_LOG_DOMAIN("DbMySQL")
+
 static std::string get_table_old_name(db_mysql_TableRef table) {
   return std::string("`")
     .append(table->owner()->name().c_str())
@@ -1810,10 +1819,11 @@ protected:
   grt::DictRef _decomposer_options;
   bool include_scripts;
   bool include_document_properties;
+  bool _quiet; // Set for composers running in a worker thread, which must not send messages.
   typedef std::map<std::string, std::vector<std::pair<std::string, std::string> > > alias_map_t;
   alias_map_t alias_map;
 
-  SQLComposer(const grt::DictRef options) : _case_sensitive(false) {
+  SQLComposer(const grt::DictRef options) : _case_sensitive(false), _quiet(false) {
     sql_mode = options.get_string("SQL_MODE", "ONLY_FULL_GROUP_BY,STRICT_TRANS_TABLES,NO_ZERO_IN_DATE,NO_ZERO_DATE,ERROR_FOR_DIVISION_BY_ZERO,NO_ENGINE_SUBSTITUTION");
     SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms_name("Mysql");
     Sql_specifics::Ref sql_specifics = sql_facade->sqlSpecifics();
@@ -1842,7 +1852,8 @@ protected:
   };
 
   void send_output(const std::string& msg) const {
-    grt::GRT::get()->send_output(msg);
+    if (!_quiet)
+      grt::GRT::get()->send_output(msg);
   };
 
   std::string show_warnings_sql() const {
@@ -2005,6 +2016,10 @@ static std::string generateDocumentProperties(const db_CatalogRef cat) {
 //----------------------------------------------------------------------------------------------------------------------
 
 class SQLExportComposer : public SQLComposer {
+public:
+  typedef std::function<void(const std::string&)> Output;
+
+protected:
   bool gen_create_index;
   bool gen_use;
   bool gen_drops;
@@ -2019,6 +2034,9 @@ class SQLExportComposer : public SQLComposer {
   grt::DictRef create_map;
   grt::DictRef drop_map;
 
+  // Tables whose data is written at the end of the script.
+  std::vector<db_mysql_TableRef> insert_tables;
+
 public:
   SQLExportComposer(const grt::DictRef options, grt::DictRef cmap, grt::DictRef dmap)
     : SQLComposer(options), create_map(cmap), drop_map(dmap) {
@@ -2237,39 +2255,84 @@ protected:
     return result;
   }
 
+  /**
+   * Writes the DDL of the given (already sorted) tables of a schema and collects their trigger DDL.
+   * Tables with data are remembered for the inserts section.
+   */
+  virtual void write_tables(const db_mysql_SchemaRef& schema, const std::vector<db_mysql_TableRef>& tables,
+                            const Output& out_sql, std::string& schema_triggers_sql) {
+    for (auto& table : tables) {
+      if (table->modelOnly() || table->isStub())
+        continue;
+      if (exists_in_map(table, create_map, caseSensitive)) {
+        out_sql(table_sql(table));
+        if (gen_inserts)
+          insert_tables.push_back(table);
+      } // process table
+
+      // Fill triggers_sql with triggers DDLs and append it to out_sql later
+      grt::ListRef<db_mysql_Trigger> triggers = table->triggers();
+      for (size_t c3 = triggers.count(), k = 0; k < c3; k++)
+        schema_triggers_sql.append(trigger_sql(triggers.get(k)));
+    }
+  }
+
 public:
+  void set_quiet(bool flag) {
+    _quiet = flag;
+  }
+
+  /**
+   * Renders the given tables into sql/triggers_sql and returns the tables with data in inserts.
+   * Used to compose parts of the script in worker threads (see ParallelSQLExportComposer).
+   */
+  void compose_tables(const db_mysql_SchemaRef& schema, const std::vector<db_mysql_TableRef>& tables, std::string& sql,
+                      std::string& triggers_sql, std::vector<db_mysql_TableRef>& inserts) {
+    insert_tables.clear();
+    write_tables(schema, tables, [&sql](const std::string& text) { sql.append(text); }, triggers_sql);
+    inserts.swap(insert_tables);
+  }
+
   std::string get_export_sql(const db_mysql_CatalogRef cat) {
     std::string out_sql;
-    std::string inserts_sql;  // separate from main sql script & append to it as a last step,
-                              // to separate creation of structures from data loading.
+    write_export_sql(cat, [&out_sql](const std::string& text) { out_sql.append(text); });
+    return out_sql;
+  }
+
+  /**
+   * Writes the export script piece by piece to out_sql. The inserts are generated only when they are written,
+   * so the complete script is never held in memory.
+   */
+  void write_export_sql(const db_mysql_CatalogRef cat, const Output& out_sql) {
     std::string triggers_sql; // Triggers DDLs could be prior or after INSERTs depending on settings
+    insert_tables.clear();
 
-    out_sql.append("-- MySQL Workbench Forward Engineering").append("\n");
+    out_sql("-- MySQL Workbench Forward Engineering\n");
     if (include_document_properties)
-      out_sql.append(generateDocumentProperties(db_CatalogRef::cast_from(cat)));
-    out_sql.append("\n");
+      out_sql(generateDocumentProperties(db_CatalogRef::cast_from(cat)));
+    out_sql("\n");
 
     if (include_scripts && cat->owner().is_valid()) {
       GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
         if ((*script)->forwardEngineerScriptPosition() == "top_file")
-          out_sql.append(user_script(*script));
+          out_sql(user_script(*script));
       }
     }
 
     send_output("Generating Script\n");
-    out_sql.append(set_server_vars());
+    out_sql(set_server_vars());
     TableSorterByFK sorter;
 
     if (include_scripts && cat->owner().is_valid()) {
       GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
         if ((*script)->forwardEngineerScriptPosition() == "before_ddl")
-          out_sql.append(user_script(*script));
+          out_sql(user_script(*script));
       }
     }
 
     // schemata
     grt::ListRef<db_mysql_Schema> schemata = cat->schemata();
-    out_sql.append(schemata_sql(schemata));
+    out_sql(schemata_sql(schemata));
     for (size_t c1 = schemata.count(), i = 0; i < c1; i++) {
       std::string objects_sql;
       std::string schema_triggers_sql;
@@ -2281,7 +2344,7 @@ public:
       send_output(std::string("Processing Schema ").append(schema->name()).append("\n"));
 
       if ((!_omitSchemas || gen_use) && (create_map.has_key(get_full_object_name_for_key(schema, caseSensitive))))
-        out_sql.append("USE `").append(schema->name().c_str()).append("` ;\n");
+        out_sql(std::string("USE `").append(schema->name().c_str()).append("` ;\n"));
 
       // tables
       grt::ListRef<db_mysql_Table> tables = schema->tables();
@@ -2300,25 +2363,7 @@ public:
           sorter.perform(tables.get(j), sortedTables);
       }
 
-      for (std::vector<db_mysql_TableRef>::iterator It = sortedTables.begin(); It != sortedTables.end(); ++It) {
-        db_mysql_TableRef table = *It;
-        if (table->modelOnly() || table->isStub())
-          continue;
-        if (exists_in_map(table, create_map, caseSensitive)) {
-          out_sql.append(table_sql(table));
-          if (gen_inserts) {
-            std::string tmp = table_inserts_sql(table);
-            if (!tmp.empty())
-              inserts_sql.append(tmp).append("\n");
-          }
-        } // process table
-
-        // Fill triggers_sql with triggers DDLs and append it to out_sql later
-        // tables
-        grt::ListRef<db_mysql_Trigger> triggers = table->triggers();
-        for (size_t c3 = triggers.count(), k = 0; k < c3; k++)
-          schema_triggers_sql.append(trigger_sql(triggers.get(k)));
-      }
+      write_tables(schema, sortedTables, out_sql, schema_triggers_sql);
       if (!schema_triggers_sql.empty()) {
         if (!_omitSchemas || gen_use)
           triggers_sql.append("USE `").append(schema->name().c_str()).append("`;\n");
@@ -2355,67 +2400,75 @@ public:
 
       if (!objects_sql.empty() && create_map.has_key(get_full_object_name_for_key(schema, caseSensitive))) {
         if (!_omitSchemas || gen_use)
-          out_sql.append("USE `").append(schema->name().c_str()).append("` ;\n");
-        out_sql.append(objects_sql);
+          out_sql(std::string("USE `").append(schema->name().c_str()).append("` ;\n"));
+        out_sql(objects_sql);
       }
     }
 
     if (!triggers_after_inserts)
-      out_sql.append(triggers_sql);
+      out_sql(triggers_sql);
 
     if (no_user_just_privileges) {
       std::list<std::string> grants;
       gen_grant_sql(cat, grants);
 
       for (std::list<std::string>::iterator iter = grants.begin(); iter != grants.end(); ++iter)
-        out_sql.append(*iter).append(";\n");
+        out_sql(*iter + ";\n");
     } else {
       grt::ListRef<db_User> users = cat->users();
       for (size_t c1 = users.count(), i = 0; i < c1; i++)
-        out_sql.append(user_sql(users.get(i)));
+        out_sql(user_sql(users.get(i)));
     }
 
     if (!no_FK_for_inserts)
-      out_sql.append(restore_server_vars());
+      out_sql(restore_server_vars());
+
+    // Data is kept separate from the main sql script and appended as a last step,
+    // to separate creation of structures from data loading.
+    bool have_inserts = false;
+    for (auto& table : insert_tables) {
+      std::string inserts_sql = table_inserts_sql(table);
+      if (inserts_sql.empty())
+        continue;
 
-    if (gen_inserts && !inserts_sql.empty()) {
-      if (include_scripts && cat->owner().is_valid()) {
+      if (!have_inserts && include_scripts && cat->owner().is_valid()) {
         GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
           if ((*script)->forwardEngineerScriptPosition() == "before_inserts")
-            out_sql.append(user_script(*script));
+            out_sql(user_script(*script));
         }
       }
+      have_inserts = true;
+      out_sql(inserts_sql.append("\n"));
+    }
+    insert_tables.clear();
 
-      out_sql.append(inserts_sql);
-
+    if (have_inserts) {
       if (include_scripts && cat->owner().is_valid()) {
         GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
           if ((*script)->forwardEngineerScriptPosition() == "after_inserts")
-            out_sql.append(user_script(*script));
+            out_sql(user_script(*script));
         }
       }
     }
 
     if (triggers_after_inserts)
-      out_sql.append(triggers_sql);
+      out_sql(triggers_sql);
 
     if (include_scripts && cat->owner().is_valid()) {
       GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
         if ((*script)->forwardEngineerScriptPosition() == "after_ddl")
-          out_sql.append(user_script(*script));
+          out_sql(user_script(*script));
       }
     }
     if (no_FK_for_inserts)
-      out_sql.append(restore_server_vars());
+      out_sql(restore_server_vars());
 
     if (include_scripts && cat->owner().is_valid()) {
       GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
         if ((*script)->forwardEngineerScriptPosition() == "bottom_file")
-          out_sql.append(user_script(*script));
+          out_sql(user_script(*script));
       }
     }
-
-    return out_sql;
   }
 };
 
@@ -2431,6 +2484,292 @@ ssize_t DbMySQLImpl::makeSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRe
   return 0;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Generates the DDL of tables and their triggers on several threads while the script is written.
+ * Every worker has its own generators, maps and composer and renders batches of tables. Batches are written in
+ * order as soon as they are complete and only a few of them may be buffered, which keeps memory use independent
+ * of the model size.
+ */
+class ParallelSQLExportComposer : public SQLExportComposer {
+public:
+  struct Statistics {
+    size_t tables = 0;
+    size_t bytes_written = 0;
+    size_t peak_buffered_bytes = 0;
+    double generate_time = 0; // Summed over all workers.
+  };
+
+  ParallelSQLExportComposer(const grt::DictRef options, const grt::DictRef dbsettings, grt::DictRef cmap,
+                            grt::DictRef dmap, size_t worker_count, size_t batch_size)
+    : SQLExportComposer(options, cmap, dmap), _batch_size(std::max<size_t>(1, batch_size)) {
+    // Everything touching global state (app options, the parser facade) is set up here on the calling thread.
+    bool use_oids = options.get_int("UseOIDAsResultDictKey", 0) != 0;
+    for (size_t i = 0; i < std::max<size_t>(1, worker_count); ++i) {
+      std::unique_ptr<Worker> worker(new Worker());
+      worker->create_map = grt::DictRef(true);
+      worker->drop_map = grt::DictRef(true);
+      worker->create_action.reset(
+        new ActionGenerateSQL(worker->create_map, grt::ListRef<GrtNamedObject>(), dbsettings, use_oids));
+      worker->drop_action.reset(
+        new ActionGenerateSQL(worker->drop_map, grt::ListRef<GrtNamedObject>(), dbsettings, use_oids));
+      worker->create_generator.reset(new DiffSQLGeneratorBE(options, dbsettings, worker->create_action.get()));
+      worker->drop_generator.reset(new DiffSQLGeneratorBE(options, dbsettings, worker->drop_action.get()));
+      worker->composer.reset(new SQLExportComposer(options, worker->create_map, worker->drop_map));
+      worker->composer->set_quiet(true);
+      _workers.push_back(std::move(worker));
+    }
+  }
+
+  const Statistics& statistics() const {
+    return _stats;
+  }
+
+protected:
+  struct Worker {
+    grt::DictRef create_map;
+    grt::DictRef drop_map;
+    std::unique_ptr<ActionGenerateSQL> create_action;
+    std::unique_ptr<ActionGenerateSQL> drop_action;
+    std::unique_ptr<DiffSQLGeneratorBE> create_generator;
+    std::unique_ptr<DiffSQLGeneratorBE> drop_generator;
+    std::unique_ptr<SQLExportComposer> composer;
+    double generate_time = 0;
+  };
+
+  struct Batch {
+    std::vector<db_mysql_TableRef> tables;
+    std::string sql;
+    std::string triggers_sql;
+    std::vector<db_mysql_TableRef> inserts;
+    bool done = false;
+  };
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  size_t _batch_size;
+  Statistics _stats;
+
+  void generate_batch(Worker& worker, const db_mysql_SchemaRef& schema, Batch& batch) {
+    double start = timestamp();
+
+    std::vector<GrtNamedObjectRef> objects(batch.tables.begin(), batch.tables.end());
+    worker.create_map.reset_entries();
+    worker.drop_map.reset_entries();
+    worker.create_generator->generate_create_stmts(objects, worker.create_map);
+    if (gen_drops)
+      worker.drop_generator->generate_drop_stmts(objects, worker.drop_map);
+    worker.composer->compose_tables(schema, batch.tables, batch.sql, batch.triggers_sql, batch.inserts);
+
+    worker.generate_time += timestamp() - start;
+  }
+
+  virtual void write_tables(const db_mysql_SchemaRef& schema, const std::vector<db_mysql_TableRef>& tables,
+                            const Output& out_sql, std::string& schema_triggers_sql) override {
+    std::vector<Batch> batches;
+    for (auto& table : tables) {
+      if (table->modelOnly() || table->isStub())
+        continue;
+      if (batches.empty() || batches.back().tables.size() >= _batch_size)
+        batches.push_back(Batch());
+      batches.back().tables.push_back(table);
+    }
+    if (batches.empty())
+      return;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t next = 0;
+    size_t written = 0;
+    size_t buffered = 0;
+    std::string error;
+
+    // Workers run at most this many batches ahead of the writer.
+    const size_t window = 2 * _workers.size();
+    size_t worker_count = std::min(_workers.size(), batches.size());
+
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < worker_count; ++w) {
+      threads.push_back(std::thread([&, w]() {
+        while (true) {
+          size_t index;
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return next < written + window || !error.empty(); });
+            if (!error.empty() || next >= batches.size())
+              return;
+            index = next++;
+          }
+
+          Batch& batch = batches[index];
+          try {
+            generate_batch(*_workers[w], schema, batch);
+          } catch (std::exception& exc) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error.empty())
+              error = exc.what();
+            changed.notify_all();
+            return;
+          }
+
+          std::lock_guard<std::mutex> lock(mutex);
+          batch.done = true;
+          buffered += batch.sql.size() + batch.triggers_sql.size();
+          _stats.peak_buffered_bytes = std::max(_stats.peak_buffered_bytes, buffered);
+          changed.notify_all();
+        }
+      }));
+    }
+
+    try {
+      for (auto& batch : batches) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&]() { return batch.done || !error.empty(); });
+          if (!error.empty())
+            break;
+        }
+
+        for (auto& table : batch.tables)
+          send_output(std::string("Processing Table ")
+                        .append(schema->name())
+                        .append(".")
+                        .append(table->name())
+                        .append("\n"));
+        out_sql(batch.sql);
+        schema_triggers_sql.append(batch.triggers_sql);
+        insert_tables.insert(insert_tables.end(), batch.inserts.begin(), batch.inserts.end());
+        _stats.tables += batch.tables.size();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        buffered -= batch.sql.size() + batch.triggers_sql.size();
+        batch = Batch();
+        batch.done = true;
+        ++written;
+        changed.notify_all();
+      }
+    } catch (...) {
+      // Writing failed, stop the workers before passing the error on.
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty())
+          error = "Export aborted";
+        changed.notify_all();
+      }
+      for (auto& thread : threads)
+        thread.join();
+      throw;
+    }
+
+    for (auto& thread : threads)
+      thread.join();
+
+    if (!error.empty())
+      throw std::runtime_error(error);
+  }
+
+public:
+  void write(const db_mysql_CatalogRef catalog, const Output& output) {
+    write_export_sql(catalog, [&](const std::string& text) {
+      _stats.bytes_written += text.size();
+      output(text);
+    });
+    for (auto& worker : _workers)
+      _stats.generate_time += worker->generate_time;
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ssize_t DbMySQLImpl::streamSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRef options,
+                                           const std::function<void(const std::string&)>& output) {
+  if (!db_mysql_CatalogRef::can_wrap(dbobject))
+    return 1;
+
+  double start = timestamp();
+  db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(dbobject);
+  grt::DictRef dbsettings = grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits()));
+
+  // Same defaults as for generateSQLForDifferences() + makeSQLExportScript().
+  if (!options.has_key("UseFilteredLists"))
+    options.gset("UseFilteredLists", 0);
+  if (!options.has_key("CaseSensitive"))
+    options.set("CaseSensitive", grt::IntegerRef(dbsettings.get_int("CaseSensitive", 1)));
+
+  // Statements for everything but tables are generated up front, they are few compared to tables.
+  std::vector<GrtNamedObjectRef> objects;
+  for (size_t i = 0; i < catalog->schemata().count(); ++i) {
+    db_mysql_SchemaRef schema = catalog->schemata()[i];
+    objects.push_back(schema);
+    for (size_t j = 0; j < schema->views().count(); ++j)
+      objects.push_back(schema->views()[j]);
+    for (size_t j = 0; j < schema->routines().count(); ++j)
+      objects.push_back(schema->routines()[j]);
+  }
+  for (size_t i = 0; i < catalog->users().count(); ++i)
+    objects.push_back(catalog->users()[i]);
+
+  bool use_oids = options.get_int("UseOIDAsResultDictKey", 0) != 0;
+  grt::DictRef create_map(true);
+  grt::DictRef drop_map(true);
+  {
+    ActionGenerateSQL generator(create_map, grt::ListRef<GrtNamedObject>(), dbsettings, use_oids);
+    DiffSQLGeneratorBE(options, dbsettings, &generator).generate_create_stmts(objects, create_map);
+  }
+  if (options.get_int("GenerateDrops") != 0) {
+    ActionGenerateSQL generator(drop_map, grt::ListRef<GrtNamedObject>(), dbsettings, use_oids);
+    DiffSQLGeneratorBE(options, dbsettings, &generator).generate_drop_stmts(objects, drop_map);
+  }
+
+  size_t worker_count = (size_t)options.get_int(
+    "GeneratorThreads", std::max<ssize_t>(1, std::min<ssize_t>(8, std::thread::hardware_concurrency())));
+  ParallelSQLExportComposer composer(options, dbsettings, create_map, drop_map, worker_count,
+                                     (size_t)options.get_int("GeneratorBatchSize", 32));
+  composer.write(catalog, output);
+
+  const ParallelSQLExportComposer::Statistics& stats = composer.statistics();
+  grt::DictRef info(true);
+  info.set("tables", grt::IntegerRef((ssize_t)stats.tables));
+  info.set("bytesWritten", grt::IntegerRef((ssize_t)stats.bytes_written));
+  info.set("peakBufferedBytes", grt::IntegerRef((ssize_t)stats.peak_buffered_bytes));
+  info.set("generateTime", grt::DoubleRef(stats.generate_time));
+  info.set("totalTime", grt::DoubleRef(timestamp() - start));
+  options.set("ExportStatistics", info);
+
+  logInfo("Streamed export of %i tables, %i bytes using %i threads in %.2fs (peak buffer %i bytes)\n",
+          (int)stats.tables, (int)stats.bytes_written, (int)worker_count, timestamp() - start,
+          (int)stats.peak_buffered_bytes);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ssize_t DbMySQLImpl::exportSQLScriptToFile(GrtNamedObjectRef dbobject, grt::DictRef options,
+                                           const std::string& path) {
+  FILE* file = base_fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    throw std::runtime_error("Could not open file " + path + " for writing: " + g_strerror(errno));
+
+  ssize_t result;
+  try {
+    std::string header = options.get_string("OutputScriptHeader");
+    if (!header.empty())
+      fwrite(header.data(), 1, header.size(), file);
+
+    result = streamSQLExportScript(dbobject, options, [&](const std::string& text) {
+      if (fwrite(text.data(), 1, text.size(), file) != text.size())
+        throw std::runtime_error("Error writing to file " + path + ": " + g_strerror(errno));
+    });
+  } catch (...) {
+    fclose(file);
+    throw;
+  }
+  fclose(file);
+
+  return result;
+}
+
 class SQLSyncComposer : public SQLComposer {
 public:
   SQLSyncComposer(const grt::DictRef options) : SQLComposer(options) {
@@ -2857,6 +3196,19 @@ grt::ListRef<db_UserDatatype> DbMySQLImpl::getDefaultUserDatatypes(db_mgmt_Rdbms
   return list;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+db_mysql_CatalogRef DbMySQLImpl::reverseEngineer(db_mgmt_ConnectionRef connection, const std::string& catalogName,
+                                                 grt::StringListRef schemata, grt::DictRef options) {
+  std::vector<std::string> names;
+  for (size_t i = 0; i < schemata.count(); ++i)
+    names.push_back(schemata[i]);
+
+  return dbmysql::reverse_engineer_server(connection, catalogName, names, options);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 GRT_MODULE_ENTRY_POINT(DbMySQLImpl);
 
 ;
@@ -222,6 +222,13 @@ public:
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::generateReportForDifferences),
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::makeSQLExportScript),
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::makeSQLSyncScript),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLImpl::exportSQLScriptToFile,
+                                "Writes the forward engineering script of a catalog directly to a file, generating the "
+                                "table DDL on several threads.",
+                                "catalog the catalog to export\n"
+                                "options the export options, as for makeSQLExportScript. GeneratorThreads and "
+                                "GeneratorBatchSize control the parallelism, ExportStatistics is set on return\n"
+                                "path the output file"),
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::getTraitsForServerVersion),
     DECLARE_MODULE_FUNCTION_DOC(DbMySQLImpl::makeCreateScriptForObject, "Generates a CREATE script for the object.",
                                 "object the object to be processed (Table, View, Routine etc)"),
@@ -229,7 +236,14 @@ public:
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::makeAlterScript),
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::getKnownEngines),
     DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultUserDatatypes),
-    DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultColumnValueMappings));
+    DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultColumnValueMappings),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLImpl::reverseEngineer,
+                                "Reverse engineers schemata from a server into a new catalog, using several connections.",
+                                "connection the connection to the server\n"
+                                "catalogName name of the new catalog\n"
+                                "schemata names of the schemata to reverse engineer\n"
+                                "options reverseEngineerTables/Views/Routines/Triggers flags, SqlDelimiter, "
+                                "reverseEngineerConnections. Phase timings are returned in the timings entry."));
 
   virtual std::string getTargetDBMSName() override {
     return "Mysql";
@@ -268,6 +282,16 @@ public:
   virtual ssize_t makeSQLExportScript(GrtNamedObjectRef, grt::DictRef options, const grt::DictRef& createSQL,
                                       const grt::DictRef& dropSQL) override;
 
+  /**
+   * generate the SQL export script like makeSQLExportScript, but without a prior generateSQLForDifferences() call
+   * and without ever holding the complete script in memory. Table DDL is generated on several threads and the
+   * script is passed in order, piece by piece, to output.
+   */
+  virtual ssize_t streamSQLExportScript(GrtNamedObjectRef, grt::DictRef options,
+                                        const std::function<void(const std::string&)>& output) override;
+
+  ssize_t exportSQLScriptToFile(GrtNamedObjectRef catalog, grt::DictRef options, const std::string& path);
+
   /**
    * generate CREATE SQL script for an individual object
    */
@@ -301,6 +325,9 @@ public:
     return grt::DictRef(true);
   }
 
+  db_mysql_CatalogRef reverseEngineer(db_mgmt_ConnectionRef connection, const std::string& catalogName,
+                                      grt::StringListRef schemata, grt::DictRef options);
+
   virtual grt::DictRef getDefaultTraits() const override {
     return _default_traits;
   };
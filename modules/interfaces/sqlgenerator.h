@@ -24,6 +24,8 @@
 #ifndef _SQLGENERATOR_IF_H_
 #define _SQLGENERATOR_IF_H_
 
+#include <functional>
+
 #include "grtpp_module_cpp.h"
 #include "grts/structs.h"
 #include "grts/structs.db.h"
@@ -61,6 +63,9 @@ public:
                                       const grt::DictRef& objectCreateSQL, const grt::DictRef& objectDropSQL) = 0;
   virtual ssize_t makeSQLSyncScript(db_CatalogRef cat, grt::DictRef options, const grt::StringListRef& sql_list,
                                     const grt::ListRef<GrtNamedObject>& obj_list) = 0;
+  // For internal use only, writes the export script in pieces instead of returning it.
+  virtual ssize_t streamSQLExportScript(grt::Ref<GrtNamedObject>, grt::DictRef options,
+                                        const std::function<void(const std::string&)>& output) = 0;
   virtual std::string makeCreateScriptForObject(GrtNamedObjectRef object) = 0;
   virtual grt::DictRef getDefaultTraits() const = 0;
   virtual grt::DictRef getTraitsForServerVersion(const int major, const int minor, const int revision) = 0;
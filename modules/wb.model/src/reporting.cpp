@@ -61,6 +61,7 @@
 #include "SciLexer.h"
 
 #include "mtemplate/template.h"
+#include "mtemplate/compiled_template.h"
 
 using namespace base;
 using namespace Scintilla;
@@ -1233,19 +1234,16 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
       }
       if (g_file_test(path, (GFileTest)(G_FILE_TEST_EXISTS | G_FILE_TEST_IS_REGULAR))) {
         if (g_str_has_suffix(entry, ".tpl")) {
-          // load template file
-          mtemplate::Template *template_index = mtemplate::GetTemplate(path, mtemplate::DO_NOT_STRIP);
-          if (template_index == 0) {
+          // load template file and flatten it, the same template is expanded over the whole catalog
+          std::unique_ptr<mtemplate::Template> parsed_template(mtemplate::GetTemplate(path, mtemplate::DO_NOT_STRIP));
+          if (!parsed_template) {
             grt::GRT::get()->send_error(
               "Error while loading template files. Please check the log for more information.");
             grt::GRT::get()->send_error(path);
             g_free(path);
             return 0;
           }
-
-          // expand the template based on the dictionary
-          mtemplate::TemplateOutputString string_output;
-          template_index->expand(main_dictionary, &string_output);
+          std::unique_ptr<mtemplate::CompiledTemplate> template_index(parsed_template->compile());
 
           // build output file name
           std::string output_filename;
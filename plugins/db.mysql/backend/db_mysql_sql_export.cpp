@@ -57,6 +57,7 @@ DbMySQLSQLExport::DbMySQLSQLExport(db_mysql_CatalogRef catalog) : DbMySQLValidat
   _gen_doc_props = false;
   _gen_attached_scripts = false;
   _sortTablesAlphabetically = false;
+  _stream_to_file = false;
 
   if (!_catalog.is_valid())
     _catalog = get_model_catalog(); // call own version
@@ -121,6 +122,8 @@ void DbMySQLSQLExport::set_option(const std::string &name, bool value) {
     _gen_attached_scripts = value;
   else if (name.compare("SortTablesAlphabetically") == 0)
     _sortTablesAlphabetically = value;
+  else if (name.compare("StreamToFile") == 0)
+    _stream_to_file = value;
 }
 
 void DbMySQLSQLExport::set_option(const std::string &name, const std::string &value) {
@@ -300,6 +303,21 @@ ValueRef DbMySQLSQLExport::export_task(grt::StringRef) {
       dboptions.set("CaseSensitive", grt::IntegerRef(1));
       options.set("DBSettings", dboptions);
     }
+
+    if (_stream_to_file && !_output_filename.empty()) {
+      // The script is written to the file while it is generated and not kept in memory, so there's no preview.
+      grt::BaseListRef args(true);
+      args.ginsert(_catalog);
+      args.ginsert(options);
+      args.ginsert(grt::StringRef(_output_filename));
+      grt::GRT::get()->call_module_function("DbMySQL", "exportSQLScriptToFile", args);
+      _export_sql_script.clear();
+
+      if (options.has_key("ExportStatistics"))
+        _export_statistics = grt::DictRef::cast_from(options.get("ExportStatistics"));
+      return StringRef("\nSQL Script Export Completed");
+    }
+
     // grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())),
     create_map = diffsql_module->generateSQLForDifferences(GrtNamedObjectRef(), _catalog, options);
 
@@ -54,6 +54,7 @@ class WBPLUGINDBMYSQLBE_PUBLIC_FUNC DbMySQLSQLExport : public DbMySQLValidationP
   bool _gen_doc_props;
   bool _gen_attached_scripts;
   bool _sortTablesAlphabetically;
+  bool _stream_to_file;
 
   std::shared_ptr<bec::GrtStringListModel> _users_model;
   std::shared_ptr<bec::GrtStringListModel> _users_exc_model;
@@ -122,11 +123,17 @@ public:
     return _export_sql_script;
   }
 
+  // Timings and memory use of the last streamed export (StreamToFile option).
+  grt::DictRef export_statistics() const {
+    return _export_statistics;
+  }
+
 private:
   // Validation_finished_cb _validation_finished_cb;
   // Validation_step_finished_cb _validation_step_finished_cb;
   Task_finish_cb _task_finish_cb;
   std::string _export_sql_script;
+  grt::DictRef _export_statistics;
 };
 
 grt::StringListRef convert_string_vector_to_grt_list(const std::vector<std::string> &v);
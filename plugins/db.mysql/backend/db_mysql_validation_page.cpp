@@ -56,6 +56,7 @@ void DbMySQLValidationPage::run_validation() {
   scoped_connect(task->signal_message(), std::bind(&DbMySQLSQLExport::validation_message, this, std::placeholders::_1));
   scoped_connect(task->signal_finished(),
                  std::bind(&DbMySQLSQLExport::validation_finished, this, std::placeholders::_1));
+  task->set_priority(bec::GRTTaskBase::PriorityLow);
   bec::GRTManager::get()->get_dispatcher()->add_task(task);
 }
 
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _DB_SEARCH_LIMITS_H_
+#define _DB_SEARCH_LIMITS_H_
+
+#include "base/string_utilities.h"
+#include "base/threading.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <string>
+
+// Hands out the rows the total and per table match limits leave to the search queries. Queries run in parallel, so
+// each one reserves the rows it may return before it runs and gives back what it didn't use once it is done.
+class SearchLimits {
+public:
+  enum Outcome {
+    QueryDone,    // The query ran with the rows it could reserve.
+    QueryPending, // Nothing left right now, but running queries may still give rows back. Retry later.
+    LimitReached  // Nothing left and nothing will come back. The query must not run.
+  };
+
+  typedef std::function<int(const std::string& limit_clause)> query_func_t;
+
+  SearchLimits() : _limit_per_table(0), _total_left(-1), _total_reserved(0) {
+  }
+
+  // A limit of 0 means no limit.
+  void reset(int limit_total, int limit_per_table) {
+    base::MutexLock lock(_mutex);
+    _limit_per_table = limit_per_table > 0 ? limit_per_table : 0;
+    _total_left = limit_total > 0 ? limit_total : -1;
+    _total_reserved = 0;
+    _table_left.clear();
+    _table_reserved.clear();
+  }
+
+  // True once the total limit is used up and no running query holds rows that could be given back.
+  bool exhausted() const {
+    base::MutexLock lock(_mutex);
+    return _total_left == 0 && _total_reserved == 0;
+  }
+
+  // Runs query with a LIMIT clause covering the rows reserved for it (or none, if nothing is limited). query returns
+  // the number of rows it fetched.
+  Outcome run_query(const std::string& table_key, const query_func_t& query) {
+    int reserved;
+    std::string limit_clause;
+    Outcome outcome = take_limit_clause(table_key, reserved, limit_clause);
+    if (outcome != QueryDone)
+      return outcome;
+
+    int rows;
+    try {
+      rows = query(limit_clause);
+    } catch (...) {
+      account_rows(table_key, reserved, 0);
+      throw;
+    }
+    account_rows(table_key, reserved, rows);
+    return QueryDone;
+  }
+
+private:
+  mutable base::Mutex _mutex;
+  int _limit_per_table;
+  int _total_left; // -1 if there is no total limit
+  int _total_reserved;
+  std::map<std::string, int> _table_left;
+  std::map<std::string, int> _table_reserved;
+
+  // Reserves everything both limits still allow for the table. reserved is -1 if neither limit applies.
+  Outcome take_limit_clause(const std::string& table_key, int& reserved, std::string& limit_clause) {
+    base::MutexLock lock(_mutex);
+
+    reserved = -1;
+    limit_clause.clear();
+
+    int* table_left = NULL;
+    if (_limit_per_table > 0) {
+      std::map<std::string, int>::iterator entry = _table_left.find(table_key);
+      if (entry == _table_left.end())
+        entry = _table_left.insert(std::make_pair(table_key, _limit_per_table)).first;
+      table_left = &entry->second;
+      if (*table_left == 0)
+        return _table_reserved[table_key] > 0 ? QueryPending : LimitReached;
+      reserved = *table_left;
+    }
+
+    if (_total_left >= 0 && (reserved < 0 || _total_left < reserved)) {
+      // The total limit cuts this query short. While other queries may still give rows back it has to wait for
+      // them, or the search could end with fewer rows than the limit although there were more matches.
+      if (_total_reserved > 0)
+        return QueryPending;
+      if (_total_left == 0)
+        return LimitReached;
+      reserved = _total_left;
+    }
+
+    if (reserved < 0)
+      return QueryDone;
+
+    if (_total_left > 0)
+      _total_left -= reserved;
+    if (table_left != NULL)
+      *table_left -= reserved;
+    _total_reserved += reserved;
+    _table_reserved[table_key] += reserved;
+    limit_clause = base::strfmt("LIMIT %i", reserved);
+    return QueryDone;
+  }
+
+  void account_rows(const std::string& table_key, int reserved, int rows) {
+    if (reserved < 0)
+      return;
+
+    base::MutexLock lock(_mutex);
+    int unused = std::max(0, reserved - rows);
+    if (_total_left >= 0)
+      _total_left += unused;
+    if (_limit_per_table > 0)
+      _table_left[table_key] += unused;
+    _total_reserved -= reserved;
+    _table_reserved[table_key] -= reserved;
+  }
+};
+
+#endif //#ifndef _DB_SEARCH_LIMITS_H_
@@ -22,6 +22,7 @@
  */
 
 #include "DbSearchPanel.h"
+#include "DbSearchLimits.h"
 #include <sstream>
 #include "grtui/grt_wizard_form.h"
 #include "grtui/connection_page.h"
@@ -30,6 +31,10 @@
 #include "grt/grt_manager.h"
 #include "base/log.h"
 
+#include <chrono>
+#include <deque>
+#include <thread>
+
 DEFAULT_LOG_DOMAIN("db.search");
 
 grt::ValueRef call_search(std::function<void()> search, std::function<void()> fail_cb) {
@@ -73,6 +78,12 @@ bool is_datetime_type(const std::string& type) {
   return chartypes.find(searchtype) != chartypes.end();
 };
 
+static bool is_integer_type(const std::string& type) {
+  static const std::set<std::string> inttypes = {"tinyint", "smallint", "mediumint", "int", "integer", "bigint"};
+  std::string searchtype = type.substr(0, type.find_first_of("( "));
+  return inttypes.find(searchtype) != inttypes.end();
+};
+
 class DBSearch {
 public:
   typedef std::vector<std::vector<std::pair<std::string, std::string> > > column_data_t;
@@ -85,6 +96,22 @@ public:
   };
 
 private:
+  // A unit of work for the search workers. A table is first looked at with resolved == false, which fetches its
+  // columns and either searches it directly or, if it is big, queues one resolved task per PK range.
+  struct TableTask {
+    std::string schema;
+    std::string table;
+    std::vector<std::string> column_patterns;
+    bool resolved;
+    std::list<std::string> pk_columns;
+    std::list<std::string> select_columns;
+    bool match_PK;
+    std::string range;
+
+    TableTask() : resolved(false), match_PK(false) {
+    }
+  };
+
   sql::ConnectionWrapper _db_conn;
   grt::StringListRef _filter_list;
   std::string _search_keyword;
@@ -93,7 +120,6 @@ private:
   SearchMode _search_mode;
   int _limit_total;
   int _limt_per_table;
-  int _limit_counter;
   std::vector<SearchResultEntry> _search_result;
   volatile bool _working;
   volatile bool _stop;
@@ -104,20 +130,33 @@ private:
   int _matched_rows;
   std::string _cast_to;
   int _search_data_type;
+  SearchExecution _execution;
   base::Mutex _search_result_mutex;
   base::Mutex _pause_mutex;
 
+  // Work queue shared by the workers, guarded by _task_mutex.
+  base::Mutex _task_mutex;
+  std::deque<TableTask> _tasks;
+  std::map<std::string, long long> _table_rows;
+  SearchLimits _limits;
+  int _busy_workers;
+  size_t _total_tasks;
+  size_t _done_tasks;
+
 protected:
-  typedef std::function<void(const std::string&, const std::string&, const std::list<std::string>&,
-                             const std::list<std::string>&, const std::string&, const bool match_PK)>
+  typedef std::function<int(sql::Connection*, const std::string&, const std::string&, const std::list<std::string>&,
+                             const std::list<std::string>&, const std::string&, const std::string&, const bool match_PK)>
     select_func_t;
   void run(select_func_t select_func);
-  void select_data(const std::string& schema_name, const std::string& table_name,
+  void run_worker(sql::Connection* connection, select_func_t select_func);
+  void resolve_table(sql::Connection* connection, TableTask& task);
+  bool split_table(sql::Connection* connection, const TableTask& task, const std::string& pk_type);
+  int select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                    const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                   const std::string& limit_clause, const bool match_PK);
-  void count_data(const std::string& schema_name, const std::string& table_name,
+                   const std::string& range, const std::string& limit_clause, const bool match_PK);
+  int count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
                   const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                  const std::string& limit_clause, const bool match_PK);
+                  const std::string& range, const std::string& limit_clause, const bool match_PK);
 
 public:
   /*
@@ -129,7 +168,7 @@ public:
     */
   DBSearch(sql::ConnectionWrapper connection, const std::string& search_keyword, const grt::StringListRef& filter_list,
            const SearchMode search_mode, const int limit_total, const int limt_per_table, const bool invert,
-           const int search_data_type, const std::string cast_to)
+           const int search_data_type, const std::string cast_to, const SearchExecution& execution)
     : _db_conn(connection),
       _filter_list(filter_list),
       _search_keyword(search_keyword),
@@ -138,7 +177,6 @@ public:
       _search_mode(search_mode),
       _limit_total(limit_total),
       _limt_per_table(limt_per_table),
-      _limit_counter(0),
       _working(false),
       _stop(false),
       _starting(false),
@@ -147,7 +185,11 @@ public:
       _searched_tables(0),
       _matched_rows(0),
       _cast_to(cast_to),
-      _search_data_type(search_data_type) {
+      _search_data_type(search_data_type),
+      _execution(execution),
+      _busy_workers(0),
+      _total_tasks(0),
+      _done_tasks(0) {
   }
 
   ~DBSearch() {
@@ -204,10 +246,10 @@ public:
   std::string build_where(const std::string& col, const std::string& data) const;
   std::string build_select_query(const std::string& schema, const std::string& table,
                                  const std::list<std::string>& columns, const std::string& limit,
-                                 const bool match_PK) const;
+                                 const bool match_PK, const std::string& range = "") const;
   std::string build_count_query(const std::string& schema, const std::string& table,
                                 const std::list<std::string>& columns, const std::string& limit,
-                                const bool match_PK) const;
+                                const bool match_PK, const std::string& range = "") const;
   void search();
   void count();
 };
@@ -248,10 +290,13 @@ std::string DBSearch::build_where(const std::string& col, const std::string& dat
 
 std::string DBSearch::build_count_query(const std::string& schema, const std::string& table,
                                         const std::list<std::string>& columns, const std::string& limit,
-                                        const bool match_PK) const {
+                                        const bool match_PK, const std::string& range) const {
   if (columns.empty())
     return std::string();
-  std::string result("SELECT COUNT(*) ");
+  std::string result("SELECT ");
+  if (_execution.query_timeout > 0)
+    result.append(base::strfmt("/*+ MAX_EXECUTION_TIME(%i) */ ", _execution.query_timeout * 1000));
+  result.append("COUNT(*) ");
   std::string or_clause;
   std::string where_condition;
   for (std::list<std::string>::const_iterator It = columns.begin(); It != columns.end(); ++It) {
@@ -261,17 +306,21 @@ std::string DBSearch::build_count_query(const std::string& schema, const std::st
   }
 
   result.append(base::sqlstring(" FROM !.! WHERE ", 0) << schema << table);
+  if (!range.empty())
+    where_condition = "(" + where_condition + ") AND " + range + " ";
   result.append(where_condition).append(limit);
   return result;
 }
 
 std::string DBSearch::build_select_query(const std::string& schema, const std::string& table,
                                          const std::list<std::string>& columns, const std::string& limit,
-                                         const bool match_PK) const {
+                                         const bool match_PK, const std::string& range) const {
   if (columns.empty())
     return std::string();
 
   std::string result("SELECT ");
+  if (_execution.query_timeout > 0)
+    result.append(base::strfmt("/*+ MAX_EXECUTION_TIME(%i) */ ", _execution.query_timeout * 1000));
   bool pk_col = true;
   std::string or_clause;
   std::string where_condition;
@@ -298,47 +347,51 @@ std::string DBSearch::build_select_query(const std::string& schema, const std::s
     return std::string();
   }
   result.append(base::sqlstring("FROM !.! WHERE ", base::QuoteOnlyIfNeeded) << schema << table);
+  if (!range.empty())
+    where_condition = "(" + where_condition + ") AND " + range + " ";
   result.append(where_condition).append(limit);
   return result;
 }
 
-void DBSearch::count_data(const std::string& schema_name, const std::string& table_name,
-                          const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                          const std::string& limit_clause, const bool match_PK) {
-  std::string query = build_count_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+// Both return the number of rows fetched, which is what counts against the search limits.
+int DBSearch::count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                         const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                         const std::string& range, const std::string& limit_clause, const bool match_PK) {
+  std::string query = build_count_query(schema_name, table_name, select_columns, limit_clause, match_PK, range);
   if (query.empty())
-    return;
+    return 0;
 
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
+  int rows = (int)rs->rowsCount();
   SearchResultEntry result;
   result.schema = schema_name;
   result.table = table_name;
   result.keys = pk_columns;
   result.query = query;
+  int matched = 0;
   while (rs->next()) {
     std::vector<std::pair<std::string, std::string> > data;
     data.reserve(select_columns.size());
     data.push_back(std::pair<std::string, std::string>("COUNT", rs->getString(1)));
-    _matched_rows += rs->getInt(1);
+    matched += rs->getInt(1);
     result.data.push_back(data);
   }
   base::MutexLock lock(_search_result_mutex);
+  _matched_rows += matched;
   _search_result.push_back(result);
+  return rows;
 };
 
-void DBSearch::select_data(const std::string& schema_name, const std::string& table_name,
-                           const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
-                           const std::string& limit_clause, const bool match_PK) {
-  std::string query = build_select_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+int DBSearch::select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                          const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                          const std::string& range, const std::string& limit_clause, const bool match_PK) {
+  std::string query = build_select_query(schema_name, table_name, select_columns, limit_clause, match_PK, range);
   if (query.empty())
-    return;
-  std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
+    return 0;
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
   std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
-  if (_limit_counter > 0)
-    _limit_counter -= (int)rs->rowsCount();
+  int rows = (int)rs->rowsCount();
   SearchResultEntry result;
   result.schema = schema_name;
   result.table = table_name;
@@ -353,23 +406,217 @@ void DBSearch::select_data(const std::string& schema_name, const std::string& ta
     if (!data.empty())
       result.data.push_back(data);
   }
+  base::MutexLock lock(_search_result_mutex);
   _matched_rows += (int)result.data.size();
-  if (!result.data.empty()) {
-    base::MutexLock lock(_search_result_mutex);
+  if (!result.data.empty())
     _search_result.push_back(result);
-  }
+  return rows;
 };
 
 void DBSearch::search() {
   run(std::bind(&DBSearch::select_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7,
+                std::placeholders::_8));
 };
 
 void DBSearch::count() {
   run(std::bind(&DBSearch::count_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
-                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6));
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7,
+                std::placeholders::_8));
 };
 
+// Fetches the columns to search and the primary key of the task's table.
+void DBSearch::resolve_table(sql::Connection* connection, TableTask& task) {
+  const std::string& schema_name = task.schema;
+  const std::string& table_name = task.table;
+  std::string like_clause;
+  static const std::string like_pattern = "Field LIKE ? OR ";
+  for (std::vector<std::string>::const_iterator It_cols = task.column_patterns.begin();
+       It_cols != task.column_patterns.end(); ++It_cols)
+    like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
+  like_clause.append("FALSE");
+
+  std::string pk_type;
+  std::list<std::string>& pk_columns = task.pk_columns;
+  std::list<std::string>& select_columns = task.select_columns;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(
+      stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
+                                     << schema_name << table_name)
+                           .append(like_clause)));
+    while (rs->next()) {
+      std::string column = rs->getString(1);
+      std::string column_type = rs->getString(2);
+      if ((_search_data_type == search_all_types) ||
+          ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
+          ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
+          ((_search_data_type & text_type) && is_string_type(column_type))) {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
+          pk_type = column_type;
+          task.match_PK = true; // PK should be searched, not just displayed
+        }
+        select_columns.push_back(column);
+      } else {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
+          pk_type = column_type;
+        }
+      }
+    }
+  } catch (std::exception& exc) {
+    logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
+  }
+  // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
+  if (pk_columns.empty() && !select_columns.empty()) {
+    try {
+      std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
+                    << schema_name << table_name)));
+      while (rs->next()) {
+        select_columns.push_back(rs->getString(1));
+        pk_columns.push_back(rs->getString(1));
+        pk_type = rs->getString(2);
+      }
+      // set PK col to be the first, or push empty string to indicate that there is no PK at all
+      if (pk_columns.empty())
+        select_columns.push_front("");
+    } catch (std::exception& exc) {
+      logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
+    }
+  }
+  task.resolved = true;
+
+  if (pk_columns.size() == 1 && is_integer_type(pk_type) && split_table(connection, task, pk_type))
+    task.select_columns.clear(); // the ranges queued by split_table do the actual search
+}
+
+// Queues one task per PK range if the table is estimated to be bigger than the chunk size, so that a huge table
+// can be searched by several workers at once and doesn't hold up the rest of the search.
+bool DBSearch::split_table(sql::Connection* connection, const TableTask& task, const std::string& pk_type) {
+  if (_execution.chunk_rows <= 0 || _execution.max_connections <= 1 || task.select_columns.empty())
+    return false;
+
+  long long rows;
+  {
+    base::MutexLock lock(_task_mutex);
+    std::map<std::string, long long>::const_iterator estimate = _table_rows.find(task.schema + "." + task.table);
+    if (estimate == _table_rows.end() || estimate->second <= _execution.chunk_rows)
+      return false;
+    rows = estimate->second;
+  }
+
+  long long min_key, max_key;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(
+      stmt->executeQuery(std::string(base::sqlstring("SELECT MIN(!), MAX(!) FROM !.!", 0)
+                                     << task.pk_columns.front() << task.pk_columns.front() << task.schema
+                                     << task.table)));
+    if (!rs->next() || rs->isNull(1))
+      return false;
+    min_key = std::stoll(rs->getString(1));
+    max_key = std::stoll(rs->getString(2));
+  } catch (std::exception& exc) {
+    logWarning("Could not get key range of %s.%s, searching it in one go: %s\n", task.schema.c_str(),
+               task.table.c_str(), exc.what());
+    return false;
+  }
+
+  // The key span of a signed BIGINT can exceed what a long long holds, so ranges are computed as unsigned offsets
+  // from min_key. rows > chunk_rows, hence there are at least 2 chunks and step can't overflow.
+  unsigned long long chunks = (rows + _execution.chunk_rows - 1) / _execution.chunk_rows;
+  unsigned long long span = (unsigned long long)max_key - (unsigned long long)min_key;
+  unsigned long long step = span / chunks + 1;
+  std::string key = base::sqlstring("!", 0) << task.pk_columns.front();
+
+  base::MutexLock lock(_task_mutex);
+  for (unsigned long long offset = 0;; offset += step) {
+    TableTask chunk(task);
+    bool last = span - offset < step;
+    long long start = (long long)((unsigned long long)min_key + offset);
+    long long end = last ? max_key : (long long)((unsigned long long)min_key + offset + step - 1);
+    chunk.range = base::strfmt("%s BETWEEN %lli AND %lli", key.c_str(), start, end);
+    _tasks.push_front(chunk);
+    ++_total_tasks;
+    if (last)
+      break;
+  }
+  logDebug2("Split %s.%s (%s, ~%lli rows) into %lli ranges\n", task.schema.c_str(), task.table.c_str(),
+            pk_type.c_str(), rows, (long long)chunks);
+  return true;
+}
+
+void DBSearch::run_worker(sql::Connection* connection, select_func_t select_func) {
+  while (true) {
+    wait_if_paused();
+    if (_stop)
+      return;
+
+    TableTask task;
+    {
+      base::MutexLock lock(_task_mutex);
+      if (_limits.exhausted())
+        return;
+      if (_tasks.empty()) {
+        // Another worker might still be splitting a big table into ranges.
+        if (_busy_workers == 0)
+          return;
+      } else {
+        task = _tasks.front();
+        _tasks.pop_front();
+        ++_busy_workers;
+      }
+    }
+    if (task.schema.empty()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      continue;
+    }
+
+    bool postponed = false;
+    try {
+      if (!task.resolved) {
+        {
+          base::MutexLock lock(_search_result_mutex);
+          _state = std::string("SELECT data from ") + task.schema + "." + task.table;
+          _searched_tables++;
+        }
+        resolve_table(connection, task);
+      }
+
+      if (!task.select_columns.empty()) {
+        // If the rows left to the limits are held by running queries, the task waits for them to give back what
+        // they didn't need, otherwise the search could stop short of the limits.
+        postponed = _limits.run_query(task.schema + "." + task.table, [&](const std::string& limit_clause) {
+          return select_func(connection, task.schema, task.table, task.pk_columns, task.select_columns, task.range,
+                             limit_clause, task.match_PK);
+        }) == SearchLimits::QueryPending;
+      }
+    } catch (std::exception& exc) {
+      // A timed out or otherwise failing table must not end the search of all the others.
+      logWarning("Error searching %s.%s%s%s: %s\n", task.schema.c_str(), task.table.c_str(),
+                 task.range.empty() ? "" : " where ", task.range.c_str(), exc.what());
+    }
+
+    {
+      base::MutexLock lock(_task_mutex);
+      --_busy_workers;
+      if (postponed)
+        _tasks.push_back(task);
+      else {
+        ++_done_tasks;
+        _progress = (_done_tasks * 1.f) / _total_tasks;
+      }
+    }
+    if (postponed)
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+}
+
 void DBSearch::run(select_func_t select_func) {
   struct working_state_guard {
     volatile bool& _state;
@@ -385,7 +632,7 @@ void DBSearch::run(select_func_t select_func) {
   _starting = false;
   _working = true;
   _stop = false;
-  _limit_counter = _limit_total ? _limit_total : -1;
+  _limits.reset(_limit_total, _limt_per_table);
   _state = "Fetch schema list";
   _searched_tables = 0;
   _matched_rows = 0;
@@ -454,108 +701,63 @@ void DBSearch::run(select_func_t select_func) {
           schemas_tables[schema_name + '.' + table].push_back(column_pattern);
         }
       }
+
+      // Row estimates decide which tables are worth splitting into key ranges.
+      if (_execution.chunk_rows > 0 && _execution.max_connections > 1) {
+        try {
+          std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+            base::sqlstring("SELECT TABLE_NAME, TABLE_ROWS FROM information_schema.TABLES WHERE TABLE_SCHEMA = ?", 0)
+            << schema_name)));
+          while (rs->next())
+            _table_rows[schema_name + '.' + rs->getString(1)] = rs->getInt64(2);
+        } catch (std::exception& exc) {
+          logWarning("Could not get table sizes of %s: %s\n", schema_name.c_str(), exc.what());
+        }
+      }
     }
   }
-  int cntr = 0;
+
+  _tasks.clear();
+  _busy_workers = 0;
+  _done_tasks = 0;
   for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas_tables.begin();
        It != schemas_tables.end(); ++It) {
-    // Pick columns
-    std::string table_name = It->first;
-    size_t dotpos = table_name.find('.');
-    std::string schema_name = table_name.substr(0, dotpos);
-    _state = std::string("SELECT data from ") + schema_name + "." + table_name;
-    table_name = table_name.substr(++dotpos);
-    std::vector<std::string> columns = It->second;
-    std::string like_clause;
-    static const std::string like_pattern = "Field LIKE ? OR ";
-    for (std::vector<std::string>::const_iterator It_cols = columns.begin(); It_cols != columns.end(); ++It_cols)
-      like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
-    like_clause.append("FALSE");
-
-    wait_if_paused();
-    if (_stop) {
-      _working = false;
-      return;
-    }
-
-    std::list<std::string> pk_columns;
-    bool match_PK = false;
-    std::list<std::string> select_columns;
+    TableTask task;
+    size_t dotpos = It->first.find('.');
+    task.schema = It->first.substr(0, dotpos);
+    task.table = It->first.substr(dotpos + 1);
+    task.column_patterns = It->second;
+    _tasks.push_back(task);
+  }
+  _total_tasks = _tasks.size();
+
+  // The first worker uses the connection given to us, the others get their own. Those are opened here, one after
+  // the other, and if that fails the search just continues with fewer workers.
+  std::vector<sql::ConnectionWrapper> connections;
+  int worker_count = std::min(_execution.open_connection ? _execution.max_connections : 1, (int)_tasks.size());
+  for (int i = 1; i < worker_count && !_stop; ++i) {
+    _state = base::strfmt("Opening connection %i of %i", i + 1, worker_count);
     try {
-      std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-      std::unique_ptr<sql::ResultSet> rs(
-        stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
-                                       << schema_name << table_name)
-                             .append(like_clause)));
-      while (rs->next()) {
-        std::string column = rs->getString(1);
-        std::string column_type = rs->getString(2);
-        if ((_search_data_type == search_all_types) ||
-            ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
-            ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
-            ((_search_data_type & text_type) && is_string_type(column_type))) {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-            match_PK = true; // PK should be searched, not just displayed
-          }
-          select_columns.push_back(column);
-        } else {
-          if (rs->getString(4) == "PRI") {
-            select_columns.push_front(column);
-            pk_columns.push_back(column);
-          }
-        }
-      }
+      connections.push_back(_execution.open_connection());
     } catch (std::exception& exc) {
-      logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
-    }
-    // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
-    if (pk_columns.empty() && !select_columns.empty()) {
-      try {
-        std::unique_ptr<sql::Statement> stmt(_db_conn->createStatement());
-        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
-          std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
-                      << schema_name << table_name)));
-        while (rs->next()) {
-          select_columns.push_back(rs->getString(1));
-          pk_columns.push_back(rs->getString(1));
-        }
-        // set PK col to be the first, or push empty string to indicate that there is no PK at all
-        if (pk_columns.empty())
-          select_columns.push_front("");
-      } catch (std::exception& exc) {
-        logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
-      }
+      logWarning("Could not open an additional connection for searching: %s\n", exc.what());
+      break;
     }
+  }
 
-    { // Build select from columns fetched on previous step and use it to collect data
-      wait_if_paused();
-      if (_stop) {
-        _working = false;
-        return;
-      }
-      ++cntr;
-      std::string limit_clause("");
-      if (_limit_counter > 0) {
-        size_t limit = std::min(_limit_counter, _limt_per_table);
-        std::stringstream sout;
-        sout << "LIMIT " << limit;
-        limit_clause = sout.str();
-      } else if (_limt_per_table) {
-        std::stringstream sout;
-        sout << "LIMIT " << _limt_per_table;
-        limit_clause = sout.str();
-      }
-
-      _progress = (cntr * 1.f) / (schemas_tables.size());
-      select_func(schema_name, table_name, pk_columns, select_columns, limit_clause, match_PK);
-      _searched_tables++;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < connections.size(); ++i)
+    workers.push_back(std::thread(&DBSearch::run_worker, this, connections[i].get(), select_func));
+  run_worker(_db_conn.get(), select_func);
+  for (std::thread& worker : workers)
+    worker.join();
 
-      if ((_limit_total > 0) && (_limit_counter <= 0))
-        break;
-    }
+  if (_stop) {
+    _working = false;
+    return;
   }
+
+  base::MutexLock lock(_search_result_mutex);
   if (_searched_tables == 0)
     _state = "No tables were searched";
   else
@@ -770,7 +972,6 @@ void DBSearchPanel::prepare_menu() {
 }
 
 void DBSearchPanel::load_model(mforms::TreeNodeRef tnode) {
-  _key_columns.clear();
   for (size_t c = _searcher->search_results().size(), i = tnode->count(); i < c; i++) {
     const DBSearch::column_data_t& rows = _searcher->search_results()[i].data;
     mforms::TreeNodeRef table_node = tnode->add_child();
@@ -805,7 +1006,8 @@ void DBSearchPanel::load_model(mforms::TreeNodeRef tnode) {
 void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string& search_keyword,
                            const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
                            const int limt_per_table, const bool invert, const int search_data_type,
-                           const std::string cast_to, std::function<void(grt::ValueRef)> finished_callback,
+                           const std::string cast_to, const SearchExecution& execution,
+                           std::function<void(grt::ValueRef)> finished_callback,
                            std::function<void()> failed_callback) {
   if (_searcher)
     return;
@@ -813,13 +1015,14 @@ void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string&
   _progress_box.show(true);
 
   _results_tree.clear();
+  _key_columns.clear();
 
   stop_search_if_working();
   _search_finished = false;
   if (_update_timer)
     bec::GRTManager::get()->cancel_timer(_update_timer);
   _searcher = std::shared_ptr<DBSearch>(new DBSearch(connection, search_keyword, filter_list, search_mode, limit_total,
-                                                     limt_per_table, invert, search_data_type, cast_to));
+                                                     limt_per_table, invert, search_data_type, cast_to, execution));
   load_model(_results_tree.root_node());
   std::function<void()> fsearch = (std::bind(&DBSearch::search, _searcher.get()));
   // fsearch = (std::bind(&DBSearch::count, _searcher.get()));//COUNT test
@@ -828,7 +1031,7 @@ void DBSearchPanel::search(sql::ConnectionWrapper connection, const std::string&
                                            finished_callback);
   while (_searcher->is_starting())
     ;
-  _update_timer = bec::GRTManager::get()->run_every(std::bind(&DBSearchPanel::update, this), 1);
+  _update_timer = bec::GRTManager::get()->run_every(std::bind(&DBSearchPanel::update, this), 0.5);
 }
 
 bool DBSearchPanel::update() {
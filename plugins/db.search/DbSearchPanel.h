@@ -34,6 +34,15 @@ enum SearchMode { Contains, ExactMatch, Like, Regexp };
 
 enum SearchDataType { numeric_type = 1, datetime_type = 1 << 1, text_type = 1 << 2, search_all_types = -1 };
 
+// How a search is spread over the server. Tables are searched by up to max_connections workers, each with its own
+// connection, and big tables with a single integer primary key are split into PK ranges searched independently.
+struct SearchExecution {
+  std::function<sql::ConnectionWrapper()> open_connection; // Opens an additional connection for a worker.
+  int max_connections = 1;
+  int chunk_rows = 0;    // Tables estimated to have more rows are chunked. 0 disables chunking.
+  int query_timeout = 0; // Maximum execution time of a single search query in seconds. 0 means no limit.
+};
+
 class DBSearchPanel : public mforms::Box {
 protected:
   mforms::Box _progress_box;
@@ -58,7 +67,8 @@ public:
   void search(sql::ConnectionWrapper connection, const std::string& search_keyword,
               const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
               const int limt_per_table, const bool invert, const int search_data_type, const std::string cast_to,
-              std::function<void(grt::ValueRef)> finished_callback, std::function<void()> failed_callback);
+              const SearchExecution& execution, std::function<void(grt::ValueRef)> finished_callback,
+              std::function<void()> failed_callback);
   void toggle_pause();
   bool stop_search_if_working();
   bool update();
@@ -176,10 +176,20 @@ private:
     _filter_panel.set_searching(true);
     _search_panel.show(true);
 
+    SearchExecution execution;
+    db_mgmt_ConnectionRef connection(_editor->connection());
+    execution.open_connection = [connection]() {
+      return sql::DriverManager::getDriverManager()->getConnection(connection);
+    };
+    execution.max_connections =
+      (int)std::max(1L, bec::GRTManager::get()->get_app_option_int("db.search:SearchConnections", 4));
+    execution.chunk_rows = (int)bec::GRTManager::get()->get_app_option_int("db.search:SearchChunkRows", 1000000);
+    execution.query_timeout = (int)bec::GRTManager::get()->get_app_option_int("db.search:SearchQueryTimeout", 0);
+
     _search_panel.search(
       wrapper, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
       _filter_panel.search_all_types() ? search_all_types : text_type, _filter_panel.search_all_types() ? "CHAR" : "",
-      std::bind(&DBSearchView::finished_search, this), std::bind(&DBSearchView::failed_search, this));
+      execution, std::bind(&DBSearchView::finished_search, this), std::bind(&DBSearchView::failed_search, this));
   }
 
 public:
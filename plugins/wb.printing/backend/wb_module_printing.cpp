@@ -30,6 +30,7 @@
 #include "wbcanvas/model_diagram_impl.h"
 
 #include "wb_module_printing.h"
+#include "wb_printing.h"
 
 #include "mdc_canvas_view_printing.h"
 #include "base/string_utilities.h"
@@ -136,7 +137,7 @@ grt::ListRef<app_Plugin> WbPrintingImpl::getPluginInfo() {
 }
 
 int WbPrintingImpl::printToPDFFile(model_DiagramRef view, const std::string &path) {
-  mdc::CanvasViewExtras extras(view->get_data()->get_canvas_view());
+  mdc::CanvasViewExtras extras(wbprint::getCanvasView(view));
 
   app_PageSettingsRef page(workbench_DocumentRef::cast_from(grt::GRT::get()->get("/wb/doc"))->pageSettings());
 
@@ -152,13 +153,19 @@ int WbPrintingImpl::printToPDFFile(model_DiagramRef view, const std::string &pat
 
 int WbPrintingImpl::printDiagramsToFile(grt::ListRef<model_Diagram> views, const std::string &path,
                                         const std::string &format, grt::DictRef options) {
+  // Realize all diagrams up front, so a diagram that cannot be printed fails before the file is created.
+  std::vector<mdc::CanvasView *> canvases;
+  GRTLIST_FOREACH(model_Diagram, views, view)
+    canvases.push_back(wbprint::getCanvasView(*view));
+
   int pages = 0;
   base::FileHandle fh(path.c_str(), "wb");
   app_PageSettingsRef page(workbench_DocumentRef::cast_from(grt::GRT::get()->get("/wb/doc"))->pageSettings());
   int total_pages = 0;
 
+  size_t index = 0;
   GRTLIST_FOREACH(model_Diagram, views, view) {
-    mdc::CanvasViewExtras extras((*view)->get_data()->get_canvas_view());
+    mdc::CanvasViewExtras extras(canvases[index++]);
 
     extras.set_page_margins(page->marginTop(), page->marginLeft(), page->marginBottom(), page->marginRight());
     extras.set_paper_size(page->paperType()->width(), page->paperType()->height());
@@ -173,8 +180,9 @@ int WbPrintingImpl::printDiagramsToFile(grt::ListRef<model_Diagram> views, const
   {
     std::unique_ptr<mdc::Surface> surf;
 
+    index = 0;
     GRTLIST_FOREACH(model_Diagram, views, view) {
-      mdc::CanvasViewExtras extras((*view)->get_data()->get_canvas_view());
+      mdc::CanvasViewExtras extras(canvases[index++]);
 
       extras.set_page_margins(page->marginTop(), page->marginLeft(), page->marginBottom(), page->marginRight());
       extras.set_paper_size(page->paperType()->width(), page->paperType()->height());
@@ -203,7 +211,7 @@ int WbPrintingImpl::printDiagramsToFile(grt::ListRef<model_Diagram> views, const
 }
 
 int WbPrintingImpl::printToPSFile(model_DiagramRef view, const std::string &path) {
-  mdc::CanvasViewExtras extras(view->get_data()->get_canvas_view());
+  mdc::CanvasViewExtras extras(wbprint::getCanvasView(view));
 
   app_PageSettingsRef page(workbench_DocumentRef::cast_from(grt::GRT::get()->get("/wb/doc"))->pageSettings());
 
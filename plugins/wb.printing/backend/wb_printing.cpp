@@ -28,12 +28,25 @@
 #include "wbcanvas/model_diagram_impl.h"
 
 #include "grts/structs.workbench.h"
+#include "base/string_utilities.h"
+
+//--------------------------------------------------------------------------------------------------
+
+mdc::CanvasView *wbprint::getCanvasView(model_DiagramRef view) {
+  // Closed diagrams have no canvas view yet. Printing can run on the GRT thread, where get_canvas_view() would
+  // only schedule the realization and return NULL.
+  mdc::CanvasView *canvas = view->get_data()->get_realized_canvas_view();
+  if (canvas == NULL)
+    throw std::runtime_error(base::strfmt("Cannot print diagram \"%s\", its canvas could not be created.",
+                                          view->name().c_str()));
+  return canvas;
+}
 
 //--------------------------------------------------------------------------------------------------
 
 int wbprint::getPageCount(model_DiagramRef view) {
   mdc::Count xc, yc;
-  view->get_data()->get_canvas_view()->get_page_layout(xc, yc);
+  getCanvasView(view)->get_page_layout(xc, yc);
 
   return xc * yc;
 }
@@ -43,7 +56,7 @@ int wbprint::getPageCount(model_DiagramRef view) {
 void wbprint::getPageLayout(model_DiagramRef view, int &xpages, int &ypages) {
   mdc::Count xc, yc;
 
-  view->get_data()->get_canvas_view()->get_page_layout(xc, yc);
+  getCanvasView(view)->get_page_layout(xc, yc);
   xpages = xc;
   ypages = yc;
 }
@@ -59,7 +72,7 @@ app_PageSettingsRef wbprint::getPageSettings(model_DiagramRef diagram) {
 #ifdef _MSC_VER
 
 int wbprint::printPageHDC(model_DiagramRef view, int pagenum, HDC hdc, int width, int height) {
-  mdc::CanvasViewExtras extras(view->get_data()->get_canvas_view());
+  mdc::CanvasViewExtras extras(getCanvasView(view));
 
   app_PageSettingsRef page(workbench_DocumentRef::cast_from(grt::GRT::get()->get("/wb/doc"))->pageSettings());
 
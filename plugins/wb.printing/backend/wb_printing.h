@@ -39,6 +39,10 @@
 #define WBPRINTINGBE_PUBLIC_FUNC
 #endif
 
+namespace mdc {
+  class CanvasView;
+};
+
 namespace wbprint {
 
 #ifdef _MSC_VER
@@ -47,6 +51,10 @@ namespace wbprint {
 
 #endif
 
+  // Returns the canvas view of the diagram, realizing it on the main thread if it was never opened.
+  // Throws std::runtime_error if the diagram cannot be realized.
+  mdc::CanvasView WBPRINTINGBE_PUBLIC_FUNC *getCanvasView(model_DiagramRef view);
+
   int WBPRINTINGBE_PUBLIC_FUNC getPageCount(model_DiagramRef view);
   void WBPRINTINGBE_PUBLIC_FUNC getPageLayout(model_DiagramRef view, int &xpages, int &ypages);
 
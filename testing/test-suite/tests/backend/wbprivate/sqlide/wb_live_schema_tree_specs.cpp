@@ -23,6 +23,7 @@
 
 #include "stub/stub_mforms.h"
 #include "sqlide/wb_live_schema_tree.h"
+#include "sqlide/wb_object_search_index.h"
 #include "grt.h"
 
 #include "casmine.h"
@@ -2057,6 +2058,59 @@ $describe("Live Schema Tree") {
     node_filtered->remove_children();
   });
 
+  $it("Update node children with large collections", [this]() {
+    mforms::TreeNodeRef node = data->pModelView->root_node();
+    node->remove_children();
+
+    // Names arrive unsorted, the workers sort them before they are handed over to the tree.
+    base::StringListPtr names(new std::list<std::string>());
+    for (int i = 4999; i >= 0; --i)
+      names->push_back("schema_" + std::to_string(100000 + i));
+    LiveSchemaTree::sort_object_names(names, false);
+    $expect(names->front()).toEqual("schema_100000");
+    $expect(names->back()).toEqual("schema_104999");
+
+    $expect(data->treeTestHelper.update_node_children(node, names, LiveSchemaTree::Schema, true)).toBeTrue();
+    $expect(node->count()).toEqual(5000);
+    $expect(node->get_child(0)->get_string(0)).toEqual("schema_100000");
+    $expect(node->get_child(4999)->get_string(0)).toEqual("schema_104999");
+
+    // A refresh dropping every even entry and adding a few new ones.
+    base::StringListPtr refreshed(new std::list<std::string>());
+    for (int i = 0; i < 5000; i += 2)
+      refreshed->push_back("schema_" + std::to_string(100001 + i));
+    refreshed->push_back("schema_200000");
+    refreshed->push_back("schema_000000");
+    $expect(data->treeTestHelper.update_node_children(node, refreshed, LiveSchemaTree::Schema, true)).toBeTrue();
+    $expect(node->count()).toEqual(2502);
+    $expect(node->get_child(0)->get_string(0)).toEqual("schema_000000");
+    $expect(node->get_child(1)->get_string(0)).toEqual("schema_100001");
+    $expect(node->get_child(2501)->get_string(0)).toEqual("schema_200000");
+    $expect(data->treeTestHelper.get_child_node(node, "schema_100002").is_valid()).toBeFalse();
+
+    // Duplicated names only match a single existing node.
+    base::StringListPtr duplicates(new std::list<std::string>());
+    duplicates->push_back("schema_000000");
+    duplicates->push_back("schema_000000");
+    std::vector<mforms::TreeNodeRef> to_remove;
+    data->treeTestHelper.update_change_data(node, duplicates, LiveSchemaTree::Schema, to_remove);
+    $expect(duplicates->size()).toEqual(1U);
+    $expect(to_remove.size()).toEqual(2501U);
+
+    // Filtering adds all matches in one go, keeping their order.
+    data->treeTestHelperFiltered.set_base(&data->treeTestHelper);
+    data->treeTestHelperFiltered.set_filter("schema_1000*");
+    data->treeTestHelperFiltered.filter_data();
+
+    mforms::TreeNodeRef node_filtered = data->pModelViewFiltered->root_node();
+    $expect(node_filtered->count()).toEqual(5);
+    $expect(node_filtered->get_child(0)->get_string(0)).toEqual("schema_100001");
+    $expect(node_filtered->get_child(4)->get_string(0)).toEqual("schema_100009");
+
+    node->remove_children();
+    node_filtered->remove_children();
+  });
+
   $it("Activating a schema", [this]() {
     mforms::TreeNodeRef node = data->pModelView->root_node();
     mforms::TreeNodeRef schema;
@@ -4124,6 +4178,66 @@ $describe("Live Schema Tree") {
     root_node_f->remove_children();
   });
 
+  $it("Filtering through the object index", [this]() {
+    mforms::TreeNodeRef root_node = data->pModelView->root_node();
+    mforms::TreeNodeRef root_node_f = data->pModelViewFiltered->root_node();
+
+    data->fillComplexSchema("TF035CHK001");
+
+    // Indexes the loaded tree, like the fetch workers do with the lists they hand over to the tree.
+    ObjectSearchIndex index;
+    std::vector<std::string> schema_names;
+    for (int schema_index = 0; schema_index < root_node->count(); schema_index++)
+      schema_names.push_back(root_node->get_child(schema_index)->get_string(0));
+    index.set_schemas(schema_names);
+
+    for (int schema_index = 0; schema_index < root_node->count(); schema_index++) {
+      mforms::TreeNodeRef schema_node = root_node->get_child(schema_index);
+      std::vector<base::StringListPtr> lists;
+      for (int collection : { LiveSchemaTree::TABLES_NODE_INDEX, LiveSchemaTree::VIEWS_NODE_INDEX,
+                              LiveSchemaTree::PROCEDURES_NODE_INDEX, LiveSchemaTree::FUNCTIONS_NODE_INDEX }) {
+        mforms::TreeNodeRef collection_node = schema_node->get_child(collection);
+        base::StringListPtr names(new std::list<std::string>());
+        for (int object_index = 0; object_index < collection_node->count(); object_index++)
+          names->push_back(collection_node->get_child(object_index)->get_string(0));
+        lists.push_back(names);
+      }
+      index.set_schema_contents(schema_node->get_string(0), lists[0], lists[1], lists[2], lists[3]);
+    }
+
+    data->treeTestHelperFiltered.set_base(&data->treeTestHelper);
+    data->treeTestHelperFiltered.set_object_index(&index);
+
+    // Same results as filtering by walking all the nodes.
+    std::vector<std::string> schemas = { "basic_schema", "basic_training" };
+    std::vector<std::string> tables = { "customer", "store" };
+    std::vector<std::string> views = { "first_view", "second_view", "secure_view" };
+    std::vector<std::string> procedures = { "get_debths", "get_payments" };
+    std::vector<std::string> functions = { "calc_debth_list" };
+    data->treeTestHelperFiltered.set_filter("?asic_*.*s*");
+    data->treeTestHelperFiltered.filter_data();
+    data->verifyFilterResult("TF035CHK002", root_node_f, schemas, tables, views, procedures, functions);
+
+    data->treeTestHelperFiltered.set_filter("BASIC*.sec*");
+    data->treeTestHelperFiltered.filter_data();
+    data->verifyFilterResult("TF035CHK003", root_node_f, schemas, {}, { "second_view", "secure_view" }, {}, {});
+
+    // An index entry without a node means index and tree are out of sync, the nodes are checked instead.
+    index.update_object(LiveSchemaTree::View, "basic_schema", "", "second_viewer");
+    data->treeTestHelperFiltered.filter_data();
+    data->verifyFilterResult("TF035CHK004", root_node_f, schemas, {}, { "second_view", "secure_view" }, {}, {});
+
+    // Schemas the index doesn't know about yet are not hidden.
+    index.set_schemas({ "basic_schema" });
+    data->treeTestHelperFiltered.set_filter("basic*");
+    data->treeTestHelperFiltered.filter_data();
+    $expect(root_node_f->count()).toEqual(2);
+
+    data->treeTestHelperFiltered.set_object_index(nullptr);
+    root_node->remove_children();
+    root_node_f->remove_children();
+  });
+
   $it("Filter patterns", [this]() {
     data->treeTestHelperFiltered.clean_filter();
 
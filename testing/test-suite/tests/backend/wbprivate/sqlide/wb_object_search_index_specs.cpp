@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "sqlide/wb_object_search_index.h"
+
+#include "base/string_utilities.h"
+
+#include "casmine.h"
+
+using namespace wb;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  ObjectSearchIndex index;
+
+  base::StringListPtr makeList(std::initializer_list<std::string> names) {
+    return std::make_shared<base::StringList>(names);
+  }
+
+  std::string joined(base::StringListPtr names) {
+    return base::join(*names, ",");
+  }
+
+  void fill() {
+    index.set_schemas({ "sakila", "world", "test" });
+    index.set_schema_contents("sakila", makeList({ "actor", "address", "film", "film_actor", "payment" }),
+                              makeList({ "actor_info", "film_list" }), makeList({ "film_in_stock" }),
+                              makeList({ "get_customer_balance" }));
+    index.set_schema_contents("world", makeList({ "city", "country", "countrylanguage" }), makeList({}),
+                              makeList({}), makeList({}));
+    index.set_schema_contents("test", makeList({}), makeList({}), makeList({}), makeList({}));
+  }
+};
+
+$describe("Object search index") {
+  $beforeEach([this]() {
+    data->index.clear();
+  });
+
+  $it("Converting remote filters", []() {
+    $expect(ObjectSearchIndex::like_to_wildcard("fil%")).toEqual("fil*");
+    $expect(ObjectSearchIndex::like_to_wildcard("f_lm%")).toEqual("f?lm*");
+    $expect(ObjectSearchIndex::like_to_wildcard("film\\_actor%")).toEqual("film_actor*");
+    $expect(ObjectSearchIndex::like_to_wildcard("100\\%")).toEqual("100%");
+  });
+
+  $it("Incomplete indexes defer only the unindexed schemas to the server", [this]() {
+    std::vector<ObjectSearchIndex::SchemaMatches> matches;
+    std::vector<std::string> unindexed;
+    $expect(data->index.search("*", "*", matches, unindexed)).toBeFalse();
+
+    data->index.set_schemas({ "sakila", "world" });
+    data->index.set_schema_contents("sakila", data->makeList({ "actor" }), data->makeList({}), data->makeList({}),
+                                    data->makeList({}));
+    $expect(data->index.is_indexed("sakila")).toBeTrue();
+    $expect(data->index.is_indexed("world")).toBeFalse();
+
+    // world is not loaded yet, so it is left for the server while sakila is answered locally.
+    $expect(data->index.search("*", "act*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].schema).toEqual("sakila");
+    $expect(unindexed.size()).toEqual(1U);
+    if (unindexed.size() == 1)
+      $expect(unindexed[0]).toEqual("world");
+
+    $expect(data->index.search("sak*", "act*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(unindexed.empty()).toBeTrue();
+
+    // Schemas dropped from the server list lose their contents.
+    data->index.set_schemas({ "world" });
+    $expect(data->index.is_indexed("sakila")).toBeFalse();
+    $expect(data->index.object_count()).toEqual(0U);
+  });
+
+  $it("Searching objects", [this]() {
+    data->fill();
+    $expect(data->index.object_count()).toEqual(12U);
+
+    std::vector<ObjectSearchIndex::SchemaMatches> matches;
+    std::vector<std::string> unindexed;
+
+    // Prefix search, case insensitive, grouped by object type.
+    $expect(data->index.search("*", "FILM*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].schema).toEqual("sakila");
+    $expect(data->joined(matches[0].tables)).toEqual("film,film_actor");
+    $expect(data->joined(matches[0].views)).toEqual("film_list");
+    $expect(data->joined(matches[0].procedures)).toEqual("film_in_stock");
+    $expect(matches[0].functions->empty()).toBeTrue();
+
+    // Substring search.
+    $expect(data->index.search("*", "*actor*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(data->joined(matches[0].tables)).toEqual("actor,film_actor");
+    $expect(data->joined(matches[0].views)).toEqual("actor_info");
+
+    // General wildcards and schema filters.
+    $expect(data->index.search("*", "c?ty*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].schema).toEqual("world");
+    $expect(data->joined(matches[0].tables)).toEqual("city");
+
+    $expect(data->index.search("world", "*", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].tables->size()).toEqual(3U);
+
+    $expect(data->index.search("*", "none*", matches, unindexed)).toBeTrue();
+    $expect(matches.empty()).toBeTrue();
+  });
+
+  $it("Tracking object changes", [this]() {
+    data->fill();
+    std::vector<ObjectSearchIndex::SchemaMatches> matches;
+    std::vector<std::string> unindexed;
+
+    data->index.update_object(LiveSchemaTree::Table, "test", "", "t1");
+    data->index.update_object(LiveSchemaTree::Table, "sakila", "payment", "payments");
+    data->index.update_object(LiveSchemaTree::View, "sakila", "film_list", "");
+    data->index.update_object(LiveSchemaTree::Schema, "", "", "new_schema");
+
+    $expect(data->index.search("*", "t1", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].schema).toEqual("test");
+
+    $expect(data->index.search("sakila", "pay*", matches, unindexed)).toBeTrue();
+    $expect(data->joined(matches[0].tables)).toEqual("payments");
+
+    $expect(data->index.search("sakila", "film*", matches, unindexed)).toBeTrue();
+    $expect(matches[0].views->empty()).toBeTrue();
+
+    $expect(data->index.is_indexed("new_schema")).toBeTrue();
+    data->index.update_object(LiveSchemaTree::Schema, "", "new_schema", "");
+    $expect(data->index.is_indexed("new_schema")).toBeFalse();
+  });
+
+  $it("Searching many schemas finds exactly the matching objects", [this]() {
+    std::vector<std::string> schemas;
+    for (size_t i = 0; i < 20; ++i)
+      schemas.push_back("schema_" + std::to_string(i));
+    data->index.set_schemas(schemas);
+
+    for (auto &schema : schemas) {
+      base::StringListPtr tables = data->makeList({});
+      for (size_t i = 0; i < 100; ++i)
+        tables->push_back("table_" + std::to_string(i) + "_" + schema);
+      data->index.set_schema_contents(schema, tables, data->makeList({}), data->makeList({}), data->makeList({}));
+    }
+
+    std::vector<ObjectSearchIndex::SchemaMatches> matches;
+    std::vector<std::string> unindexed;
+    for (auto pattern : { "table_42*", "*_42_*" }) {
+      $expect(data->index.search("*", pattern, matches, unindexed)).toBeTrue();
+      $expect(matches.size()).toEqual(schemas.size());
+      for (auto &match : matches) {
+        $expect(match.tables->size()).toEqual(1U);
+        if (match.tables->size() == 1)
+          $expect(match.tables->front()).toEqual("table_42_" + match.schema);
+      }
+    }
+
+    $expect(data->index.search("schema_7", "*_schema_7", matches, unindexed)).toBeTrue();
+    $expect(matches.size()).toEqual(1U);
+    $expect(matches[0].tables->size()).toEqual(100U);
+  });
+}
+
+}
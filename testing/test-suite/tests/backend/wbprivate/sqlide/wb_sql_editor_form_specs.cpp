@@ -21,6 +21,8 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <thread>
+
 #include "casmine.h"
 #include "wb_test_helpers.h"
 
@@ -37,6 +39,8 @@
 
 #include "cppconn/driver.h"
 #include "cppconn/sqlstring.h"
+#include "cppconn/statement.h"
+#include "cppconn/resultset.h"
 
 #include "sqlide/wb_sql_editor_form.h"
 
@@ -674,6 +678,40 @@ $describe("SQL Editor Form") {
     $expect(pchildData->delete_rule).toEqual(4U, "TF006CHK005 : Unexpected foreign key delete rule");
     $expect(pchildData->referenced_table).toBe("language", "TF006CHK005 : Unexpected foreign key delete rule");
   });
+
+  $it("Hands out pooled aux connections.", [&]() {
+    sql::Dbc_connection_handler::Ref mainConn;
+    base::RecMutexLock mainLock(data->form->ensure_valid_aux_connection(mainConn));
+
+    // Nested use on the same thread must not open another connection.
+    {
+      sql::Dbc_connection_handler::Ref nestedConn;
+      base::RecMutexLock nestedLock(data->form->ensure_valid_aux_connection(nestedConn));
+      $expect(nestedConn.get() == mainConn.get()).toBeTrue("TF007CHK001 : Nested aux connection differs");
+    }
+
+    // Another task must not wait for the busy connection.
+    sql::Dbc_connection_handler *workerConn = nullptr;
+    bool queryDone = false;
+    std::thread worker([&]() {
+      sql::Dbc_connection_handler::Ref conn;
+      base::RecMutexLock lock(data->form->ensure_valid_aux_connection(conn));
+      workerConn = conn.get();
+
+      std::unique_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery("SELECT 1"));
+      queryDone = rs->next();
+    });
+    worker.join();
+
+    $expect(workerConn != nullptr && workerConn != mainConn.get())
+      .toBeTrue("TF007CHK002 : Worker got the busy aux connection");
+    $expect(queryDone).toBeTrue("TF007CHK003 : Query on pooled aux connection failed");
+
+    SqlEditorForm::AuxConnectionPoolStats stats = data->form->aux_connection_pool_stats();
+    $expect(stats.open).toBeGreaterThanOrEqual(2U, "TF007CHK004 : Unexpected number of open aux connections");
+    $expect(stats.peak_in_use).toBeGreaterThanOrEqual(2U, "TF007CHK005 : Unexpected pool utilization");
+  });
 }
 
 }
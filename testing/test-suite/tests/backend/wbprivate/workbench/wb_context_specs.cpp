@@ -173,6 +173,45 @@ $describe("Workbench model document integration tests") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Closed diagrams are realized on first activation", [this]() {
+    data->tester->wb->new_document();
+    data->tester->addView();
+    data->tester->addTableFigure("table1", 10, 10);
+    data->tester->addView();
+    data->tester->addTableFigure("table2", 10, 10);
+
+    workbench_physical_ModelRef model(data->tester->getPmodel());
+    $expect(model->diagrams().count()).toBe(2U);
+
+    model->diagrams()[0]->closed(1);
+    model->currentDiagram(model->diagrams()[1]);
+    data->tester->syncView();
+    $expect(data->tester->wb->save_as(data->outputDir + "/lazy_diagrams.mwb")).toBeTrue();
+
+    $expect(data->tester->closeDocument()).toBeTrue();
+    data->tester->wb->close_document_finish();
+
+    $expect(data->tester->wb->open_document(data->outputDir + "/lazy_diagrams.mwb")).toBeTrue();
+    data->tester->flushUntil(1);
+
+    model = data->tester->getPmodel();
+    model_DiagramRef closedDiagram(model->diagrams()[0]);
+    $expect(model->diagrams()[1]->get_data()->is_canvas_view_valid()).toBeTrue();
+
+    // Catalog objects and figures are loaded, only the canvas is deferred.
+    $expect(closedDiagram->get_data()->is_canvas_view_valid()).toBeFalse();
+    $expect(closedDiagram->figures().count()).toBe(1U);
+    $expect(model->catalog()->schemata()[0]->tables().count()).toBe(2U);
+
+    data->tester->wb->get_model_context()->switch_diagram(closedDiagram);
+    $expect(closedDiagram->get_data()->is_canvas_view_valid()).toBeTrue();
+
+    $expect(data->tester->closeDocument()).toBeTrue();
+    data->tester->wb->close_document_finish();
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Bug: opening a model with selection will cause a crash", [this]() {
     data->tester->wb->new_document();
 
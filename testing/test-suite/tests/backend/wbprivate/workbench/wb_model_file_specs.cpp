@@ -139,6 +139,79 @@ $describe("Tests for WB model file") {
     data->testModelSavingAndLoading(data->tmpDataDir + data->UnicodeBaseModelFile);
   });
 
+  $it("Autosave journal is replayed on the last snapshot", [this]() {
+    data->tester->wb->new_document();
+    data->tester->addView();
+    db_mysql_TableRef table = data->tester->addTableFigure("table1", 10, 10);
+    workbench_DocumentRef doc(data->tester->wb->get_document());
+
+    grt::GRT::get()->begin_undoable_action();
+    db_mysql_ColumnRef existing(grt::Initialized);
+    existing->owner(table);
+    existing->name("existing_col");
+    table->columns().insert(existing);
+    grt::GRT::get()->end_undoable_action("Add column");
+
+    ModelFile mf(data->outputDir);
+    mf.create();
+
+    // The first autosave writes a full snapshot.
+    std::string snapshotPath = mf.get_path_for(MAIN_DOCUMENT_AUTOSAVE_NAME);
+    std::string journalPath = mf.get_path_for(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME);
+    mf.store_document_autosave(doc);
+    $expect(base::file_exists(snapshotPath)).toBeTrue();
+    $expect(base::file_exists(journalPath)).toBeFalse();
+    std::string snapshot = mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_NAME);
+
+    grt::GRT::get()->begin_undoable_action();
+    table->name("renamed");
+    table->comment("journaled");
+    db_mysql_ColumnRef column(grt::Initialized);
+    column->owner(table);
+    column->name("id");
+    table->columns().insert(column);
+    grt::GRT::get()->end_undoable_action("Edit table");
+
+    // Later ones only append the changed members, and only the inserted column of the column list.
+    mf.store_document_autosave(doc);
+    $expect(base::file_exists(journalPath)).toBeTrue();
+    $expect(mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_NAME)).toBe(snapshot);
+    std::string journal = mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME);
+    $expect(journal).toContain("insert=\"1\"");
+    $expect(journal).Not.toContain("existing_col");
+
+    grt::GRT::get()->begin_undoable_action();
+    table->comment("second batch");
+    table->columns().remove(0);
+    grt::GRT::get()->end_undoable_action("Edit table");
+    mf.store_document_autosave(doc);
+    $expect(mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_NAME)).toBe(snapshot);
+    $expect(mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_JOURNAL_NAME)).toContain("remove=\"0\"");
+
+    std::string recoveredPath = data->outputDir + "/recovered_autosave.mwb.xml";
+    ModelFile::copy_file(snapshotPath, recoveredPath);
+    ModelFile::apply_autosave_journal(recoveredPath, journalPath);
+
+    workbench_DocumentRef recovered = workbench_DocumentRef::cast_from(grt::GRT::get()->unserialize(recoveredPath));
+    db_mysql_TableRef recoveredTable = db_mysql_TableRef::cast_from(
+      recovered->physicalModels()[0]->catalog()->schemata()[0]->tables()[0]);
+    $expect(recoveredTable->id()).toBe(table->id());
+    $expect(*recoveredTable->name()).toBe("renamed");
+    $expect(*recoveredTable->comment()).toBe("second batch");
+    $expect(recoveredTable->columns().count()).toBe(1U);
+    $expect(recoveredTable->columns()[0]->id()).toBe(column->id());
+    $expect(*recoveredTable->columns()[0]->name()).toBe("id");
+
+    // A change made without undo tracking is not journaled, so the next autosave writes a snapshot.
+    table->comment("untracked");
+    mf.store_document_autosave(doc);
+    $expect(base::file_exists(journalPath)).toBeFalse();
+    $expect(mf.get_file_contents(MAIN_DOCUMENT_AUTOSAVE_NAME)).toContain("untracked");
+
+    $expect(data->tester->closeDocument()).toBeTrue();
+    data->tester->wb->close_document_finish();
+  });
+
 }
 
 }
@@ -404,6 +404,61 @@ $describe("General Undo/Redo") {
 
   //--------------------------------------------------------------------------------------------------------------------
 
+  $it("Repeated member changes in a group are coalesced", []() {
+    UndoManager um;
+    db_mysql_TableRef table(grt::Initialized);
+    table->name("original");
+
+    um.begin_undo_group();
+    for (int i = 0; i < 10; ++i) {
+      um.add_undo(new UndoObjectChangeAction(table, "name"));
+      table->name(base::strfmt("name%i", i));
+      um.add_undo(new UndoObjectChangeAction(table, "comment"));
+      table->comment(base::strfmt("comment%i", i));
+    }
+    um.end_undo_group("rename");
+
+    UndoGroup *group = dynamic_cast<UndoGroup *>(um.get_undo_stack().back());
+    $expect(group).Not.toBeNull();
+    $expect(group->get_actions().size()).toEqual(2U);
+
+    um.undo();
+    $expect(*table->name()).toEqual("original");
+    $expect(*table->comment()).toEqual("");
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  $it("Undo stack is trimmed to the memory limit", []() {
+    UndoManager um;
+    db_mysql_TableRef table(grt::Initialized);
+    std::string big(100000, 'x');
+
+    // Each entry keeps a 100KB old comment alive.
+    for (int i = 0; i < 20; ++i) {
+      table->comment(big + std::to_string(i));
+      um.begin_undo_group();
+      um.add_undo(new UndoObjectChangeAction(table, "comment"));
+      table->comment("");
+      um.end_undo_group("change comment");
+    }
+    $expect(um.get_undo_stack().size()).toEqual(20U);
+    $expect(um.get_undo_memory_size()).toBeGreaterThan(20U * 100000U);
+
+    um.set_memory_limit(500000);
+    $expect(um.get_undo_stack().size()).toEqual(4U);
+    $expect(um.get_undo_memory_size()).toBeLessThan(500001U);
+
+    // The latest entry is kept even if it alone exceeds the limit.
+    um.set_memory_limit(1000);
+    $expect(um.get_undo_stack().size()).toEqual(1U);
+
+    um.undo();
+    $expect(*table->comment()).toEqual(big + "19");
+  });
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   $it("Configuration: general settings", []() {
     $pending("not implemented");
   });
@@ -21,6 +21,9 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <atomic>
+
+#include "base/util_functions.h"
 #include "grt/grt_dispatcher.h"
 #include "grt/grt_manager.h"
 #include "wb_test_helpers.h"
@@ -90,6 +93,132 @@ $describe("GRT request dispatcher") {
     $expect(finish_called).toBeTrue();
   });
 
+  $it("Multiple workers respect task affinity", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false, 4);
+    dispatcher->start();
+    $expect(dispatcher->worker_count()).toBe(4U);
+
+    // Two independent tasks that can only both finish in time if they run side by side.
+    std::atomic<int> arrived(0);
+    std::atomic<bool> concurrent(true);
+    std::vector<GRTTask::Ref> tasks;
+    for (size_t i = 0; i < 2; ++i) {
+      GRTTask::Ref task = GRTTask::create_task("independent " + std::to_string(i), dispatcher, [&]() {
+        ++arrived;
+        double start = base::timestamp();
+        while (arrived < 2) {
+          if (base::timestamp() - start > 5) {
+            concurrent = false;
+            break;
+          }
+          g_usleep(1000);
+        }
+        return grt::ValueRef();
+      });
+      tasks.push_back(task);
+      dispatcher->add_task(task);
+    }
+    for (auto &task : tasks)
+      dispatcher->wait_task(task);
+    $expect(concurrent.load()).toBeTrue("Independent tasks should be spread over the workers");
+
+    std::atomic<int> runningSerial(0), finishedSerial(0);
+    std::atomic<bool> overlapped(false);
+    for (size_t i = 0; i < 20; ++i) {
+      dispatcher->execute_async_function("serial " + std::to_string(i), [&]() {
+        if (++runningSerial > 1)
+          overlapped = true;
+        g_usleep(1000);
+        --runningSerial;
+        ++finishedSerial;
+        return grt::ValueRef();
+      }, GRTTaskBase::PriorityNormal, "serial");
+    }
+    while (finishedSerial < 20)
+      g_usleep(1000);
+    $expect(overlapped.load()).toBeFalse("Tasks with the same affinity key must not run concurrently");
+
+    dispatcher->shutdown();
+  });
+
+  $it("Collects queue statistics", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false);
+    dispatcher->start();
+
+    std::vector<GRTTask::Ref> tasks;
+    for (size_t i = 0; i < 40; ++i) {
+      GRTTask::Ref task = GRTTask::create_task("task " + std::to_string(i), dispatcher, []() {
+        g_usleep(500);
+        return grt::IntegerRef(1);
+      });
+      tasks.push_back(task);
+      dispatcher->add_task(task);
+    }
+
+    for (auto &task : tasks)
+      dispatcher->wait_task(task);
+
+    // Finished callbacks run before the worker is done with a task, so wait until it is idle.
+    while (dispatcher->get_busy())
+      g_usleep(1000);
+
+    GRTDispatcher::Statistics statistics = dispatcher->get_statistics();
+    $expect(statistics.tasks_executed).toBe(40U);
+    $expect(statistics.running).toBe(0U);
+    $expect(statistics.queue_depth).toBe(0U);
+    $expect(statistics.max_queue_depth).toBeGreaterThan(0U);
+    $expect(statistics.max_wait_time >= statistics.average_wait_time()).toBeTrue();
+
+    dispatcher->shutdown();
+  });
+
+  $it("Queued tasks run by priority", [this]() {
+    GRTDispatcher::Ref dispatcher = GRTDispatcher::create_dispatcher(true, false);
+    dispatcher->start();
+
+    // Keep the worker busy until all other tasks are queued.
+    std::atomic<bool> started(false), release(false);
+    GRTTask::Ref blocker = GRTTask::create_task("blocker", dispatcher, [&]() {
+      started = true;
+      while (!release)
+        g_usleep(1000);
+      return grt::ValueRef();
+    });
+    dispatcher->add_task(blocker);
+    while (!started)
+      g_usleep(1000);
+
+    std::vector<std::string> order;
+    std::vector<GRTTask::Ref> tasks;
+    auto queue = [&](const std::string &name, GRTTaskBase::Priority priority) {
+      GRTTask::Ref task = GRTTask::create_task(name, dispatcher, [&order, name]() {
+        order.push_back(name);
+        return grt::ValueRef();
+      });
+      task->set_priority(priority);
+      tasks.push_back(task);
+      dispatcher->add_task(task);
+    };
+    queue("low", GRTTaskBase::PriorityLow);
+    queue("normal 1", GRTTaskBase::PriorityNormal);
+    queue("high", GRTTaskBase::PriorityHigh);
+    queue("normal 2", GRTTaskBase::PriorityNormal);
+
+    GRTDispatcher::Statistics statistics = dispatcher->get_statistics();
+    $expect(statistics.queued_by_priority[GRTTaskBase::PriorityLow]).toBe(1U);
+    $expect(statistics.queued_by_priority[GRTTaskBase::PriorityNormal]).toBe(2U);
+    $expect(statistics.queued_by_priority[GRTTaskBase::PriorityHigh]).toBe(1U);
+
+    release = true;
+    dispatcher->wait_task(blocker);
+    for (auto &task : tasks)
+      dispatcher->wait_task(task);
+
+    $expect(order).toEqual({ "high", "normal 1", "normal 2", "low" });
+
+    dispatcher->shutdown();
+  });
+
 }
 
 }
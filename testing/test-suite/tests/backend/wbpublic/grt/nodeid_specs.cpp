@@ -37,6 +37,30 @@ using namespace std;
 
 namespace {
 
+// A flat list standing in for a result grid, serving a computed value for every cell.
+class ScrollGridModel : public bec::ListModel {
+public:
+  ScrollGridModel(size_t rows, size_t columns) : _rows(rows), _columns(columns) {
+  }
+
+  virtual size_t count() override {
+    return _rows;
+  }
+
+  virtual void refresh() override {
+  }
+
+  using bec::ListModel::get_field;
+  virtual bool get_field(const bec::NodeId &node, ColumnId column, ssize_t &value) override {
+    value = (ssize_t)(node[0] * _columns + column);
+    return true;
+  }
+
+private:
+  size_t _rows;
+  size_t _columns;
+};
+
 $ModuleEnvironment() {};
 
 $TestData {
@@ -194,6 +218,60 @@ $describe("TreeModel") {
     }
   });
 
+  $it("Node paths up to depth 4 are stored inline", []() {
+    bec::NodeId node(1);
+    $expect(node.index.is_inline()).toBeTrue();
+
+    node.append(2).append(3).append(4);
+    $expect(node.index.is_inline()).toBeTrue();
+
+    node.append(5);
+    $expect(node.index.is_inline()).toBeFalse();
+    $expect(node.toString()).toBe("1.2.3.4.5");
+
+    node.prepend(0);
+    $expect(node.toString()).toBe("0.1.2.3.4.5");
+    $expect(node.parent().toString()).toBe("0.1.2.3.4");
+
+    bec::NodeId copy(node);
+    $expect(copy == node).toBeTrue();
+
+    bec::NodeId moved(std::move(copy));
+    $expect(moved == node).toBeTrue();
+    $expect(copy.is_valid()).toBeFalse();
+
+    moved = bec::NodeId("7.8");
+    $expect(moved.index.is_inline()).toBeTrue();
+    $expect(moved.toString()).toBe("7.8");
+  });
+
+  $it("Walking a grid with inline node ids visits every cell", []() {
+    // Walks the grid the way the GTK list model wrapper does while scrolling: step to the next row, then get
+    // a node for each cell from the row iterator and fetch the value.
+    const size_t rows = 500;
+    const size_t columns = 40;
+    ScrollGridModel model(rows, columns);
+
+    size_t checksum = 0;
+    size_t visitedRows = 0;
+    for (bec::NodeId row = model.get_node(0);; row = model.get_next(row)) {
+      $expect(row.index.is_inline()).toBeTrue();
+      $expect(row[0]).toEqual(visitedRows);
+      for (size_t column = 0; column < columns; ++column) {
+        bec::NodeId cell(row);
+        ssize_t value = 0;
+        model.get_field(cell, column, value);
+        checksum += (size_t)value;
+      }
+      ++visitedRows;
+      if (!model.has_next(row))
+        break;
+    }
+
+    $expect(visitedRows).toEqual(rows);
+    $expect(checksum).toEqual(rows * columns * (rows * columns - 1) / 2);
+  });
+
   $it("Sorting nodes test", []() {
     std::vector<bec::NodeId> test;
     for (std::size_t i = 1; i < 20; i++)
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <random>
+
+#include "grt/spatial_handler.h"
+#include "mdc.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+class TestLayer : public spatial::Layer {
+public:
+  TestLayer() : spatial::Layer(spatial::new_layer_id(), base::Color(0.5, 0.5, 0.5)) {
+    _show = true;
+  }
+
+  spatial::Feature *feature(size_t index) {
+    return _features[index];
+  }
+};
+
+// A roughly round polygon with the given number of corners.
+static std::string polygonWkt(double lon, double lat, double radius, int corners) {
+  std::string wkt = "POLYGON((";
+  for (int i = 0; i <= corners; ++i) {
+    double angle = 2 * M_PI * (i % corners) / corners;
+    if (i > 0)
+      wkt += ",";
+    wkt += std::to_string(lon + radius * cos(angle)) + " " + std::to_string(lat + radius * sin(angle));
+  }
+  return wkt + "))";
+}
+
+static bool intersects(const base::Rect &a, const base::Rect &b) {
+  return a.pos.x <= b.pos.x + b.size.width && a.pos.x + a.size.width >= b.pos.x &&
+         a.pos.y <= b.pos.y + b.size.height && a.pos.y + a.size.height >= b.pos.y;
+}
+
+$describe("Spatial handler") {
+
+  $it("Envelope tree finds the same rectangles as a linear scan", []() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> position(0, 1000), extent(0, 25);
+
+    for (size_t count : { 0, 1, 16, 17, 500, 10000 }) {
+      std::vector<base::Rect> rects;
+      for (size_t i = 0; i < count; ++i)
+        rects.push_back(base::Rect(position(random), position(random), extent(random), extent(random)));
+
+      spatial::EnvelopeTree tree;
+      tree.build(rects);
+      $expect(tree.empty()).toBe(count == 0);
+
+      for (int i = 0; i < 100; ++i) {
+        base::Rect area(position(random), position(random), 4 * extent(random), 4 * extent(random));
+        std::vector<size_t> found, expected;
+        tree.query(area, found);
+        for (size_t j = 0; j < rects.size(); ++j) {
+          if (intersects(rects[j], area))
+            expected.push_back(j);
+        }
+        $expect(found == expected).toBeTrue();
+      }
+    }
+  });
+
+  $it("Simplification keeps the shape within the tolerance", []() {
+    std::vector<base::Point> line = { { 0, 0 }, { 1, 0.1 }, { 2, -0.1 }, { 3, 5 }, { 4, 2.5 }, { 5, 0 } };
+    std::vector<base::Point> result;
+    spatial::simplify_points(line, 0.5, false, result);
+    $expect(result.size()).toBe(4U);
+    $expect(result.front() == line.front()).toBeTrue();
+    $expect(result[1] == line[2]).toBeTrue();
+    $expect(result[2] == line[3]).toBeTrue();
+    $expect(result.back() == line.back()).toBeTrue();
+
+    std::vector<base::Point> ring;
+    for (int i = 0; i <= 200; ++i) {
+      double angle = 2 * M_PI * (i % 200) / 200;
+      ring.push_back(base::Point(100 + 50 * cos(angle), 100 + 50 * sin(angle)));
+    }
+    spatial::simplify_points(ring, 0.5, true, result);
+    $expect(result.size()).toBeLessThan(ring.size() / 2);
+    $expect(result.front() == ring.front()).toBeTrue();
+    $expect(result.back() == ring.back()).toBeTrue();
+
+    // A ring smaller than the tolerance still keeps a visible extent.
+    spatial::simplify_points(ring, 1000, true, result);
+    $expect(result.size()).toBe(3U);
+  });
+
+  $it("Parallel projection and indexed picking match the serial results", []() {
+    if (!spatial::Projection::get_instance().check_libproj_availability()) {
+      $pending("libproj is not available");
+      return;
+    }
+
+    // Enough features to be projected by several workers, the small layer is projected on this thread.
+    TestLayer layer, smallLayer;
+    const int rows = 40, columns = 100;
+    for (int row = 0; row < rows; ++row) {
+      for (int column = 0; column < columns; ++column) {
+        double lon = -179 + column * 358.0 / columns, lat = -89 + row * 178.0 / rows;
+        layer.add_feature(row * columns + column, polygonWkt(lon, lat, 0.6, 16), true);
+        if (row == rows / 2)
+          smallLayer.add_feature(column, polygonWkt(lon, lat, 0.6, 16), true);
+      }
+    }
+
+    spatial::ProjectionView view = { 1600, 800, 179, 89, -179, -89 };
+    spatial::Converter converter(view, spatial::Projection::get_instance().get_projection(spatial::ProjGeodetic),
+                                 spatial::Projection::get_instance().get_projection(spatial::ProjRobinson));
+    layer.render(&converter);
+    $expect(layer.query_render_progress()).toBeGreaterThan(0.99f);
+
+    smallLayer.render(&converter);
+    for (int column = 0; column < columns; ++column) {
+      base::Rect expected, actual;
+      $expect(smallLayer.feature(column)->screen_bounds(expected)).toBeTrue();
+      $expect(layer.feature((rows / 2) * columns + column)->screen_bounds(actual)).toBeTrue();
+      $expect(actual == expected).toBeTrue();
+    }
+
+    // A clipped repaint only draws the features the index returns for the clip area.
+    mdc::ImageSurface surface(view.width, view.height, CAIRO_FORMAT_ARGB32);
+    mdc::CairoCtx cr(surface);
+    layer.repaint(cr, 1, base::Rect());
+    layer.repaint(cr, 4, base::Rect(0, 0, view.width / 4.0, view.height / 4.0));
+
+    // Picking through the index must find the same feature as checking every feature.
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> x(0, view.width), y(0, view.height);
+    for (int i = 0; i < 200; ++i) {
+      base::Point p(x(random), y(random));
+      spatial::Feature *expected = nullptr;
+      double best = -1;
+      for (size_t j = 0; j < layer.size(); ++j) {
+        double distance = layer.feature(j)->distance(p);
+        if (distance < 4.0 && distance != -1 && (distance < best || best == -1)) {
+          best = distance;
+          expected = layer.feature(j);
+        }
+      }
+      $expect(layer.feature_closest(p) == expected).toBeTrue();
+    }
+  });
+
+}
+
+}
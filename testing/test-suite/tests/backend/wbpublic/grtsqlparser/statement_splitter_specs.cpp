@@ -0,0 +1,704 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <fstream>
+#include <random>
+
+#include "base/string_utilities.h"
+#include "grtsqlparser/statement_splitter.h"
+#include "sqlide/sql_script_file_reader.h"
+
+#include "casmine.h"
+
+using namespace parsers;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The two byte-at-a-time splitters the shared StatementSplitter replaced, the one from the parser module
+// (with line numbers) and the one from the sql facade. They serve as reference for the parity checks.
+
+static const unsigned char *skipLeadingWhitespace(const unsigned char *head, const unsigned char *tail) {
+  while (head < tail && *head <= ' ')
+    head++;
+  return head;
+}
+
+static bool isLineBreak(const unsigned char *head, const unsigned char *line_break) {
+  if (*line_break == '\0')
+    return false;
+
+  while (*head != '\0' && *line_break != '\0' && *head == *line_break) {
+    head++;
+    line_break++;
+  }
+  return *line_break == '\0';
+}
+
+static void legacyDetermineStatementRanges(const char *sql, size_t length, const std::string &initialDelimiter,
+                                           std::vector<StatementRange> &ranges, const std::string &lineBreak) {
+
+  static const unsigned char keyword[] = "delimiter";
+
+  std::string delimiter = initialDelimiter.empty() ? ";" : initialDelimiter;
+  const unsigned char *delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+  const unsigned char *start = reinterpret_cast<const unsigned char *>(sql);
+  const unsigned char *head = start;
+  const unsigned char *tail = head;
+  const unsigned char *end = head + length;
+  const unsigned char *newLine = reinterpret_cast<const unsigned char *>(lineBreak.c_str());
+
+  size_t currentLine = 0;
+  size_t statementStart = 0;
+  bool haveContent = false; // Set when anything else but comments were found for the current statement.
+
+  while (tail < end) {
+    switch (*tail) {
+      case '/': { // Possible multi line comment or hidden (conditional) command.
+        if (*(tail + 1) == '*') {
+          tail += 2;
+          bool isHiddenCommand = (*tail == '!');
+          while (true) {
+            while (tail < end && *tail != '*') {
+              if (isLineBreak(tail, newLine))
+                ++currentLine;
+              tail++;
+            }
+
+            if (tail == end) // Unfinished comment.
+              break;
+            else {
+              if (*++tail == '/') {
+                tail++; // Skip the slash too.
+                break;
+              }
+            }
+          }
+
+          if (isHiddenCommand)
+            haveContent = true;
+          if (!haveContent) {
+            head = tail; // Skip over the comment.
+            statementStart = currentLine;
+          }
+
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '-': { // Possible single line comment.
+        const unsigned char *end_char = tail + 2;
+        if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || isLineBreak(end_char, newLine))) {
+          // Skip everything until the end of the line.
+          tail += 2;
+          while (tail < end && !isLineBreak(tail, newLine))
+            tail++;
+
+          if (!haveContent) {
+            head = tail;
+            statementStart = currentLine;
+          }
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '#': { // MySQL single line comment.
+        while (tail < end && !isLineBreak(tail, newLine))
+          tail++;
+
+        if (!haveContent) {
+          head = tail;
+          statementStart = currentLine;
+        }
+
+        break;
+      }
+
+      case '"':
+      case '\'':
+      case '`': { // Quoted string/id. Skip this in a local loop.
+        haveContent = true;
+        unsigned char quote = *tail++;
+        while (tail < end && *tail != quote) {
+          // Skip any escaped character too.
+          if (*tail == '\\')
+            tail++;
+          tail++;
+        }
+        if (*tail == quote)
+          tail++; // Skip trailing quote char if one was there.
+
+        break;
+      }
+
+      case 'd':
+      case 'D': {
+        haveContent = true;
+
+        // Possible start of the keyword DELIMITER. Must be at the start of the text or a character,
+        // which is not part of a regular MySQL identifier (0-9, A-Z, a-z, _, $, \u0080-\uffff).
+        unsigned char previous = tail > start ? *(tail - 1) : 0;
+        bool is_identifier_char = previous >= 0x80 || (previous >= '0' && previous <= '9') ||
+                                  ((previous | 0x20) >= 'a' && (previous | 0x20) <= 'z') || previous == '$' ||
+                                  previous == '_';
+        if (tail == start || !is_identifier_char) {
+          const unsigned char *run = tail + 1;
+          const unsigned char *kw = keyword + 1;
+          int count = 9;
+          while (count-- > 1 && (*run++ | 0x20) == *kw++)
+            ;
+          if (count == 0 && *run == ' ') {
+            // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+            tail = run++;
+            while (run < end && !isLineBreak(run, newLine))
+              ++run;
+            delimiter = base::trim(std::string(reinterpret_cast<const char *>(tail), run - tail));
+            delimiterHead = reinterpret_cast<const unsigned char *>(delimiter.c_str());
+
+            // Skip over the delimiter statement and any following line breaks.
+            while (isLineBreak(run, newLine)) {
+              ++currentLine;
+              ++run;
+            }
+            tail = run;
+            head = tail;
+            statementStart = currentLine;
+          } else
+            ++tail;
+        } else
+          ++tail;
+
+        break;
+      }
+
+      default:
+        if (isLineBreak(tail, newLine)) {
+          ++currentLine;
+          if (!haveContent)
+            ++statementStart;
+        }
+
+        if (*tail > ' ')
+          haveContent = true;
+        tail++;
+        break;
+    }
+
+    if (*tail == *delimiterHead) {
+      // Found possible start of the delimiter. Check if it really is.
+      size_t count = delimiter.size();
+      if (count == 1) {
+        // Most common case. Trim the statement and check if it is not empty before adding the range.
+        head = skipLeadingWhitespace(head, tail);
+        if (head < tail)
+          ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+        head = ++tail;
+        statementStart = currentLine;
+        haveContent = false;
+      } else {
+        const unsigned char *run = tail + 1;
+        const unsigned char *del = delimiterHead + 1;
+        while (count-- > 1 && (*run++ == *del++))
+          ;
+
+        if (count == 0) {
+          // Multi char delimiter is complete. Tail still points to the start of the delimiter.
+          // Run points to the first character after the delimiter.
+          head = skipLeadingWhitespace(head, tail);
+          if (head < tail)
+            ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+          tail = run;
+          head = run;
+          statementStart = currentLine;
+          haveContent = false;
+        }
+      }
+    }
+  }
+
+  // Add remaining text to the range list.
+  head = skipLeadingWhitespace(head, tail);
+  if (head < tail)
+    ranges.push_back({ statementStart, static_cast<size_t>(head - start), static_cast<size_t>(tail - head) });
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void legacySplitSqlScript(const char *sql, std::size_t length, const std::string &initial_delimiter,
+                                 std::vector<std::pair<std::size_t, std::size_t> > &ranges,
+                                 const std::string &line_break) {
+  std::string delimiter = initial_delimiter.empty() ? ";" : initial_delimiter;
+  const unsigned char *delimiter_head = (unsigned char *)delimiter.c_str();
+
+  const unsigned char keyword[] = "delimiter";
+
+  const unsigned char *head = (unsigned char *)sql;
+  const unsigned char *tail = head;
+  const unsigned char *end = head + length;
+  const unsigned char *new_line = (unsigned char *)line_break.c_str();
+  bool have_content = false; // Set when anything else but comments were found for the current statement.
+
+  while (tail < end) {
+    switch (*tail) {
+      case '/': // Possible multi line comment or hidden (conditional) command.
+        if (*(tail + 1) == '*') {
+          tail += 2;
+          bool is_hidden_command = (*tail == '!');
+          while (true) {
+            while (tail < end && *tail != '*')
+              tail++;
+            if (tail == end) // Unfinished comment.
+              break;
+            else {
+              if (*++tail == '/') {
+                tail++; // Skip the slash too.
+                break;
+              }
+            }
+          }
+
+          if (!is_hidden_command && !have_content)
+            head = tail; // Skip over the comment.
+        } else
+          tail++;
+
+        break;
+
+      case '-': // Possible single line comment.
+      {
+        const unsigned char *end_char = tail + 2;
+        if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || isLineBreak(end_char, new_line))) {
+          // Skip everything until the end of the line.
+          tail += 2;
+          while (tail < end && !isLineBreak(tail, new_line))
+            tail++;
+          if (!have_content)
+            head = tail;
+        } else
+          tail++;
+
+        break;
+      }
+
+      case '#': // MySQL single line comment.
+        while (tail < end && !isLineBreak(tail, new_line))
+          tail++;
+        if (!have_content)
+          head = tail;
+        break;
+
+      case '"':
+      case '\'':
+      case '`': // Quoted string/id. Skip this in a local loop.
+      {
+        have_content = true;
+        char quote = *tail++;
+        while (tail < end && *tail != quote) {
+          // Skip any escaped character too.
+          if (*tail == '\\')
+            tail++;
+          tail++;
+        }
+        if (*tail == quote)
+          tail++; // Skip trailing quote char to if one was there.
+
+        break;
+      }
+
+      case 'd':
+      case 'D': {
+        have_content = true;
+
+        // Possible start of the keyword DELIMITER. Must be at the start of the text or a character,
+        // which is not part of a regular MySQL identifier (0-9, A-Z, a-z, _, $, \u0080-\uffff).
+        unsigned char previous = tail > (unsigned char *)sql ? *(tail - 1) : 0;
+        bool is_identifier_char = previous >= 0x80 || (previous >= '0' && previous <= '9') ||
+                                  ((previous | 0x20) >= 'a' && (previous | 0x20) <= 'z') || previous == '$' ||
+                                  previous == '_';
+        if (tail == (unsigned char *)sql || !is_identifier_char) {
+          const unsigned char *run = tail + 1;
+          const unsigned char *kw = keyword + 1;
+          int count = 9;
+          while (count-- > 1 && (*run++ | 0x20) == *kw++)
+            ;
+          if (count == 0 && *run == ' ') {
+            // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+            tail = run++;
+            while (run < end && !isLineBreak(run, new_line))
+              run++;
+            delimiter = base::trim(std::string((char *)tail, run - tail));
+            delimiter_head = (unsigned char *)delimiter.c_str();
+
+            // Skip over the delimiter statement and any following line breaks.
+            while (isLineBreak(run, new_line))
+              run++;
+            tail = run;
+            head = tail;
+          } else
+            tail++;
+        } else
+          tail++;
+
+        break;
+      }
+
+      default:
+        if (*tail > ' ')
+          have_content = true;
+        tail++;
+        break;
+    }
+
+    if (*tail == *delimiter_head) {
+      // Found possible start of the delimiter. Check if it really is.
+      size_t count = delimiter.size();
+      if (count == 1) {
+        // Most common case. Trim the statement and check if it is not empty before adding the range.
+        head = skipLeadingWhitespace(head, tail);
+        if (head < tail)
+          ranges.push_back(std::make_pair<size_t, size_t>(head - (unsigned char *)sql, tail - head));
+        head = ++tail;
+        have_content = false;
+      } else {
+        const unsigned char *run = tail + 1;
+        const unsigned char *del = delimiter_head + 1;
+        while (count-- > 1 && (*run++ == *del++))
+          ;
+
+        if (count == 0) {
+          // Multi char delimiter is complete. Tail still points to the start of the delimiter.
+          // Run points to the first character after the delimiter.
+          head = skipLeadingWhitespace(head, tail);
+          if (head < tail)
+            ranges.push_back(std::make_pair<size_t, size_t>(head - (unsigned char *)sql, tail - head));
+          tail = run;
+          head = run;
+          have_content = false;
+        }
+      }
+    }
+  }
+
+  // Add remaining text to the range list.
+  head = skipLeadingWhitespace(head, tail);
+  if (head < tail)
+    ranges.push_back(std::make_pair<size_t, size_t>(head - (unsigned char *)sql, tail - head));
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Compares the results of the shared splitter in both flavors with those of the old splitters. The text is padded
+// with zeros, as all of them may look a few bytes past the end.
+static void expectParity(const std::string &sql, const std::string &delimiter, const std::string &lineBreak) {
+  std::string buffer = sql + std::string(16, '\0');
+
+  std::vector<StatementRange> expected;
+  legacyDetermineStatementRanges(buffer.c_str(), sql.size(), delimiter, expected, lineBreak);
+  std::vector<StatementRange> actual;
+  StatementSplitter(delimiter, lineBreak).split(buffer.c_str(), sql.size(), actual);
+
+  $expect(actual.size()).toBe(expected.size(), "Statement count differs for: " + sql.substr(0, 200));
+  for (size_t i = 0; i < std::min(actual.size(), expected.size()); ++i) {
+    if (actual[i].start != expected[i].start || actual[i].length != expected[i].length ||
+        actual[i].line != expected[i].line) {
+      $fail(base::strfmt("Statement %zu differs (%zu/%zu/%zu instead of %zu/%zu/%zu) for: ", i, actual[i].line,
+                         actual[i].start, actual[i].length, expected[i].line, expected[i].start, expected[i].length) +
+            sql.substr(0, 200));
+      break;
+    }
+  }
+
+  std::vector<std::pair<size_t, size_t> > expectedPairs;
+  legacySplitSqlScript(buffer.c_str(), sql.size(), delimiter, expectedPairs, lineBreak);
+  StatementSplitter facadeSplitter(delimiter, lineBreak);
+  facadeSplitter.setHiddenCommandsAreContent(false);
+  actual.clear();
+  facadeSplitter.split(buffer.c_str(), sql.size(), actual);
+
+  $expect(actual.size()).toBe(expectedPairs.size(), "Facade statement count differs for: " + sql.substr(0, 200));
+  for (size_t i = 0; i < std::min(actual.size(), expectedPairs.size()); ++i) {
+    if (actual[i].start != expectedPairs[i].first || actual[i].length != expectedPairs[i].second) {
+      $fail(base::strfmt("Facade statement %zu differs for: ", i) + sql.substr(0, 200));
+      break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+typedef std::vector<std::pair<std::string, size_t>> Statements; // Text and line of each statement.
+
+static Statements splitWhole(const std::string &sql, const std::string &delimiter) {
+  std::string buffer = sql + std::string(16, '\0');
+  std::vector<StatementRange> ranges;
+  StatementSplitter(delimiter).split(buffer.c_str(), sql.size(), ranges);
+
+  Statements result;
+  for (auto &range : ranges)
+    result.push_back({ sql.substr(range.start, range.length), range.line });
+  return result;
+}
+
+// Passes the text to splitPart() in pieces of the given size, like a file read block by block.
+static Statements splitInPieces(const std::string &sql, const std::string &delimiter, size_t pieceSize) {
+  StatementSplitter splitter(delimiter);
+  Statements result;
+  std::string pending;
+  size_t position = 0;
+  while (true) {
+    size_t count = std::min(pieceSize, sql.size() - position);
+    pending += sql.substr(position, count);
+    position += count;
+    bool atEnd = position == sql.size();
+
+    std::string buffer = pending + std::string(16, '\0');
+    std::vector<StatementRange> ranges;
+    size_t consumed = splitter.splitPart(buffer.c_str(), pending.size(), atEnd, ranges);
+    for (auto &range : ranges)
+      result.push_back({ pending.substr(range.start, range.length), range.line });
+    pending.erase(0, consumed);
+
+    if (atEnd)
+      break;
+  }
+  return result;
+}
+
+static void expectSameInPieces(const std::string &sql, const std::string &delimiter, size_t pieceSize) {
+  Statements expected = splitWhole(sql, delimiter);
+  Statements actual = splitInPieces(sql, delimiter, pieceSize);
+  if (actual != expected)
+    $fail(base::strfmt("Split in pieces of %zu differs for: ", pieceSize) + sql.substr(0, 200));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Something that looks like mysqldump output: table definitions, long extended inserts with escaped strings,
+// conditional comments and a trigger with its own delimiter.
+static std::string generateDump(size_t size) {
+  std::mt19937 random(4711);
+  std::uniform_int_distribution<int> letter('a', 'z');
+
+  std::string dump = "-- MySQL dump 10.13\n--\n-- Host: localhost    Database: bench\n"
+                     "/*!40101 SET @OLD_CHARACTER_SET_CLIENT=@@CHARACTER_SET_CLIENT */;\n"
+                     "/*!40014 SET @OLD_FOREIGN_KEY_CHECKS=@@FOREIGN_KEY_CHECKS, FOREIGN_KEY_CHECKS=0 */;\n\n";
+  for (int table = 0; dump.size() < size; ++table) {
+    dump += base::strfmt("--\n-- Table structure for table `t%i`\n--\n\nDROP TABLE IF EXISTS `t%i`;\n", table, table);
+    dump += base::strfmt("CREATE TABLE `t%i` (\n  `id` int NOT NULL,\n  `name` varchar(100) DEFAULT NULL,\n"
+                         "  `data` text,\n  PRIMARY KEY (`id`)\n) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;\n\n",
+                         table);
+    dump += base::strfmt("LOCK TABLES `t%i` WRITE;\n/*!40000 ALTER TABLE `t%i` DISABLE KEYS */;\n", table, table);
+    for (int insert = 0; insert < 20; ++insert) {
+      dump += base::strfmt("INSERT INTO `t%i` VALUES ", table);
+      for (int row = 0; row < 200; ++row) {
+        std::string text;
+        for (int i = 0; i < 120; ++i)
+          text += (i % 37 == 36) ? "\\'" : std::string(1, (char)letter(random));
+        dump += base::strfmt("%s(%i,'name %i','%s')", row > 0 ? "," : "", row, row, text.c_str());
+      }
+      dump += ";\n";
+    }
+    dump += base::strfmt("/*!40000 ALTER TABLE `t%i` ENABLE KEYS */;\nUNLOCK TABLES;\n\n", table);
+    dump += base::strfmt("DELIMITER ;;\nCREATE TRIGGER `t%i_bi` BEFORE INSERT ON `t%i` FOR EACH ROW BEGIN\n"
+                         "  SET NEW.name = 'x'; -- keep it short\nEND ;;\nDELIMITER ;\n\n", table, table);
+  }
+  return dump;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+$TestData {
+  std::string dataDir = casmine::CasmineContext::get()->tmpDataDir();
+};
+
+$describe("Statement splitter") {
+
+  $it("Splits the test scripts exactly like the old splitters", [this]() {
+    struct {
+      std::string name;
+      std::string lineBreak;
+      std::string delimiter;
+    } files[] = {
+      { "/db/statements.txt", "\n", "$$" },
+      { "/db/nasty_tables.sql", "\r\n", ";" },
+      { "/db/sakila-db/sakila-data.sql", "\n", ";" },
+      { "/db/sakila-db/sakila-schema.sql", "\n", ";" },
+    };
+
+    for (auto &file : files) {
+      std::ifstream stream(data->dataDir + file.name, std::ios::binary);
+      $expect(stream.good()).toBeTrue("Error loading " + file.name);
+      std::string sql((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+      expectParity(sql, file.delimiter, file.lineBreak);
+    }
+  });
+
+  $it("Handles edge cases exactly like the old splitters", []() {
+    static const std::vector<std::string> scripts = {
+      "",
+      ";",
+      ";;;",
+      "select 1",
+      "  select 1;  ",
+      "a;;b;",
+      ";select 1;select 2",
+      "select 'a;b'; select \"c;d\"; select `e;f`;",
+      "select 'it\\'s'; select 2",
+      "select 'unterminated; select 2",
+      "select 'trailing backslash\\",
+      "select 1 /* comment; */; select 2",
+      "/* leading */ select 1; /* unterminated",
+      "/*!40101 SET x = 1 */ -- comment\n; select 2;",
+      "/*!40101 SET x = 1 */ /* comment */; select 2;",
+      "-- comment\nselect 1;\n--not a comment;\nselect 2",
+      "# comment;\nselect 1; #trailing",
+      "--\tx\nselect 1;--",
+      "DELIMITER $$\ncreate procedure p() begin select 1; end$$\nDELIMITER ;\nselect 2;",
+      "delimiter //\n\n\nselect 1//select 2/ /select 3//",
+      "DELIMITER \nselect 1;",
+      "xdelimiter $$\nselect 1;",
+      "select 1 delimiter $$\n;",
+      "DELIMITER",
+      "d",
+      "\n\n  \n\tselect\n1\n;\n\nselect 2;\n",
+      "select '\n\n'; select\n2",
+      "select \xc3\xa4d; select 2;",
+    };
+
+    for (auto &script : scripts) {
+      expectParity(script, ";", "\n");
+      expectParity(script, "$$", "\n");
+      expectParity(script, ";", "\r\n");
+      expectParity(script, ";;", "");
+    }
+  });
+
+  $it("Splits random text exactly like the old splitters", []() {
+    static const std::string alphabet[] = { ";", "$", "'", "\"", "`", "\\", "/", "*", "!", "-", "#", " ", "\t",
+                                            "\n", "\r", "d", "D", "e", "x", "1", "delimiter ", "DELIMITER $$\n",
+                                            "\xc3\xa4", "/*!", "*/", "-- ", "select ", "abcdefghijklmnopqrstuvwxyz" };
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<size_t> piece(0, sizeof(alphabet) / sizeof(alphabet[0]) - 1);
+    std::uniform_int_distribution<size_t> length(0, 80);
+
+    for (int i = 0; i < 3000; ++i) {
+      std::string script;
+      for (size_t count = length(random); count > 0; --count)
+        script += alphabet[piece(random)];
+
+      expectParity(script, ";", "\n");
+      expectParity(script, "$$", "\r\n");
+    }
+  });
+
+  $it("Splits text arriving in pieces like the whole text", [this]() {
+    for (auto name : { "/db/sakila-db/sakila-schema.sql", "/db/sakila-db/sakila-data.sql", "/db/nasty_tables.sql" }) {
+      std::ifstream stream(data->dataDir + name, std::ios::binary);
+      std::string sql((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+      expectSameInPieces(sql, ";", 64 * 1024);
+    }
+    expectSameInPieces(generateDump(4 * 1024 * 1024), ";", 100000);
+
+    // Pieces cutting through comments, quotes, delimiters and DELIMITER commands.
+    static const std::string alphabet[] = { ";", "$$", "'", "\"", "`", "\\", "/*", "*/", "/*!", "-- ", "#", " ", "\n",
+                                            "d", "e", "delimiter ", "DELIMITER $$\n", "DELIMITER ;\n", "select " };
+    std::mt19937 random(4321);
+    std::uniform_int_distribution<size_t> piece(0, sizeof(alphabet) / sizeof(alphabet[0]) - 1);
+    std::uniform_int_distribution<size_t> length(0, 60);
+    std::uniform_int_distribution<size_t> pieceSize(1, 24);
+
+    for (int i = 0; i < 3000; ++i) {
+      std::string script;
+      for (size_t count = length(random); count > 0; --count)
+        script += alphabet[piece(random)];
+
+      expectSameInPieces(script, ";", pieceSize(random));
+      expectSameInPieces(script, "$$", pieceSize(random));
+    }
+  });
+
+  $it("Reads script files in blocks with bounded read-ahead", [this]() {
+    std::string path = data->dataDir + "/db/sakila-db/sakila-data.sql";
+    std::ifstream stream(path, std::ios::binary);
+    std::string sql((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    Statements expected = splitWhole(sql, ";");
+
+    Sql_script_file_reader reader(path, ";", 64 * 1024, 1);
+    reader.start();
+    $expect((size_t)reader.file_size()).toBe(sql.size());
+
+    Statements actual;
+    Sql_script_file_reader::Statement statement;
+    std::uint64_t lastOffset = 0;
+    while (reader.next(statement)) {
+      actual.push_back({ statement.sql, statement.line });
+      $expect(statement.end_offset > lastOffset).toBeTrue();
+      lastOffset = statement.end_offset;
+    }
+    $expect(actual == expected).toBeTrue("Statements read from the file differ");
+    $expect((size_t)reader.bytes_read()).toBe(sql.size());
+
+    Sql_script_file_reader cancelled(path, ";", 64 * 1024, 1);
+    cancelled.start();
+    $expect(cancelled.next(statement)).toBeTrue();
+    cancelled.cancel();
+    $expect(cancelled.next(statement)).toBeFalse();
+
+    Sql_script_file_reader missing(data->dataDir + "/db/no-such-file.sql");
+    $expect([&]() { missing.start(); }).toThrow();
+  });
+
+  $it("Stops when asked to", []() {
+    std::string sql = "select 1; select 2; select 3;";
+    bool stop = true;
+
+    std::vector<StatementRange> ranges;
+    StatementSplitter splitter;
+    splitter.setStopFlag(&stop);
+    splitter.split(sql.c_str(), sql.size(), ranges);
+    $expect(ranges.empty()).toBeTrue();
+
+    stop = false;
+    splitter.split(sql.c_str(), sql.size(), ranges);
+    $expect(ranges.size()).toBe(3U);
+  });
+
+  $it("Splits a generated dump exactly like the old splitter", []() {
+    std::string dump = generateDump(4 * 1024 * 1024);
+    expectParity(dump, ";", "\n");
+    expectParity(dump, ";", "\r\n");
+  });
+}
+
+}
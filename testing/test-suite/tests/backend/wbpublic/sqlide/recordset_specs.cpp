@@ -22,7 +22,12 @@
  */
 
 #include "sqlide/recordset_cdbc_storage.h"
+#include "sqlide/recordset_text_storage.h"
+#include "sqlide/recordset_stream_export.h"
 #include "sqlide/recordset_be.h"
+#include "sqlide/recordset_search_index.h"
+#include "sqlide/recordset_sorter.h"
+#include "base/file_utilities.h"
 #include "cppdbc.h"
 
 #include "casmine.h"
@@ -41,6 +46,38 @@ $TestData {
 static void dummy() {
 }
 
+static Recordset::Ref createRecordset(sql::Dbc_connection_handler::Ref connection, base::RecMutex &connLock,
+                                      const std::string &query) {
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create());
+  data_storage->setUserConnectionGetter(
+    [&connLock, connection](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+      base::RecMutexLock lock(connLock, false);
+      conn = connection;
+      return lock;
+    }
+  );
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+
+  std::shared_ptr<sql::Statement> dbc_statement(connection->ref->createStatement());
+  dbc_statement->execute(query);
+
+  std::shared_ptr<sql::ResultSet> rset(dbc_statement->getResultSet());
+  data_storage->dbc_resultset(rset);
+  rs->reset(true);
+  return rs;
+}
+
+static const std::string searchQuery =
+  "select 1 as id, 'Alpha Centauri' as `name`, 'star' as `kind` union all select 2, 'Betelgeuse', 'Star' "
+  "union all select 3, 'Andromeda', 'galaxy' union all select 4, NULL, 'nebula' "
+  "union all select 5, 'alphabet soup', 'food' union all select 6, 'Proxima 4.25', 'star'";
+
+static const std::string exportQuery =
+  "select 1 as id, 'plain' as `name`, 'a, \\\"quoted\\\" value' as `with quotes`, NULL as `empty`, 2.5 as `a;b` "
+  "union all select 2, 'tab\\there', 'line\\nbreak', 'x', NULL";
+
 $describe("Recordset") {
 
   $beforeAll([this]() {
@@ -86,6 +123,185 @@ $describe("Recordset") {
     $expect(rs->is_field_null(0, 1)).toBeTrue("NULL blob is NULL");
   });
 
+  $it("Native export matches the template output", [this]() {
+    base::RecMutex connLock;
+    Recordset::Ref rs = createRecordset(data->connection, connLock, exportQuery);
+    std::string outputDir = casmine::CasmineContext::get()->outputDir();
+
+    for (auto format : { "CSV", "CSV_semicolon", "tab" }) {
+      std::string templatePath = outputDir + "/export_template." + format;
+      std::string nativePath = outputDir + "/export_native." + format;
+
+      Recordset_text_storage::Ref storage = Recordset_text_storage::create();
+      storage->data_format(format);
+      storage->file_path(templatePath);
+      storage->use_native_export(false);
+      storage->serialize(rs);
+
+      storage->file_path(nativePath);
+      storage->use_native_export(true);
+      storage->serialize(rs);
+
+      std::string templateOutput = base::getTextFileContent(templatePath);
+      $expect(templateOutput.empty()).toBeFalse(format);
+      $expect(base::getTextFileContent(nativePath)).toEqual(templateOutput, format);
+    }
+  });
+
+  $it("Search index candidates", []() {
+    Recordset_search_index index(2, 1024 * 1024);
+    auto add = [&](std::uint32_t rowid, size_t column, const std::string &text) {
+      $expect(index.add_cell(rowid, column, text.data(), text.size())).toBeTrue();
+    };
+    add(1, 0, "Alpha Centauri");
+    add(2, 0, "Betelgeuse");
+    add(3, 0, "alphabet");
+    add(1, 1, "star");
+    add(2, 1, "STAR");
+    add(3, 1, "food");
+
+    Recordset_search_index::Row_ids rowids;
+    $expect(index.column_candidates(0, "%alpha%", rowids)).toBeFalse("not ready before finish()");
+    index.finish();
+    $expect(index.is_ready()).toBeTrue();
+    $expect(index.row_count()).toBe(3U);
+
+    $expect(index.column_candidates(0, "%ALPHA%", rowids)).toBeTrue();
+    $expect(rowids == Recordset_search_index::Row_ids({ 1, 3 })).toBeTrue("ASCII case folding");
+    $expect(index.column_candidates(0, "alp%cen_auri", rowids)).toBeTrue();
+    $expect(rowids == Recordset_search_index::Row_ids({ 1 })).toBeTrue("literal runs around wildcards");
+    $expect(index.column_candidates(0, "%al%", rowids)).toBeFalse("too short to narrow");
+    $expect(index.column_candidates(1, "%food%", rowids)).toBeTrue();
+    $expect(rowids == Recordset_search_index::Row_ids({ 3 })).toBeTrue();
+
+    $expect(index.any_column_candidates("%star%", rowids)).toBeTrue();
+    $expect(rowids == Recordset_search_index::Row_ids({ 1, 2 })).toBeTrue();
+    $expect(index.any_column_candidates("%comet%", rowids)).toBeTrue();
+    $expect(rowids.empty()).toBeTrue();
+
+    index.touch(2);
+    $expect(index.any_column_candidates("%comet%", rowids)).toBeTrue();
+    $expect(rowids == Recordset_search_index::Row_ids({ 2 })).toBeTrue("edited rows are always candidates");
+  });
+
+  $it("Search index doesn't change filter results", [this]() {
+    grt::DictRef options = grt::DictRef::cast_from(grt::GRT::get()->get("/wb/options/options"));
+    options.gset("Recordset:SearchIndexMinRows", 0);
+
+    base::RecMutex connLock;
+    options.gset("Recordset:SearchIndexMaxMemory", 0);
+    Recordset::Ref plain = createRecordset(data->connection, connLock, searchQuery);
+    $expect(plain->search_index() == nullptr).toBeTrue();
+
+    options.gset("Recordset:SearchIndexMaxMemory", 16);
+    Recordset::Ref indexed = createRecordset(data->connection, connLock, searchQuery);
+    $expect(indexed->search_index() != nullptr).toBeTrue();
+    indexed->search_index()->wait();
+    $expect(indexed->search_index()->is_ready()).toBeTrue();
+    $expect(indexed->search_index()->row_count()).toBe(6U);
+
+    for (auto search : { "alpha", "STAR", "4.2", "a", "xyz", "_ta" }) {
+      plain->set_data_search_string(search);
+      indexed->set_data_search_string(search);
+      $expect(indexed->row_count()).toBe(plain->row_count(), search);
+    }
+    plain->reset_data_search_string();
+    indexed->reset_data_search_string();
+
+    plain->set_column_filter(2, "star");
+    indexed->set_column_filter(2, "star");
+    $expect(indexed->row_count()).toBe(plain->row_count());
+    $expect(indexed->row_count()).toBe(3U);
+
+    plain->set_data_search_string("centauri");
+    indexed->set_data_search_string("centauri");
+    $expect(indexed->row_count()).toBe(1U);
+
+    options.gset("Recordset:SearchIndexMinRows", 50000);
+    options.gset("Recordset:SearchIndexMaxMemory", 256);
+  });
+
+  $it("In-memory sort order", []() {
+    typedef std::vector<sqlite::variant_t> Values;
+    Recordset_sorter sorter({ { true, 1 } }, 1024 * 1024);
+    sorter.add_row(1, Values({ std::string("beta") }));
+    sorter.add_row(2, Values({ sqlite::null_t() }));
+    sorter.add_row(3, Values({ std::string("Alpha") }));
+    sorter.add_row(4, Values({ 5 }));
+    sorter.add_row(5, Values({ (long double)4.5 }));
+    sorter.add_row(6, Values({ std::string("alpha") }));
+    sorter.add_row(7, Values({ (long long)5 }));
+    sorter.sort();
+    $expect(sorter.sorted_rowids() == std::vector<std::int64_t>({ 2, 5, 4, 7, 3, 6, 1 })).toBeTrue();
+
+    Recordset_sorter small({ { false, 1 } }, 64);
+    bool fits = true;
+    for (int i = 0; i < 10 && fits; ++i)
+      fits = small.add_row(i, Values({ std::string("exceeds the budget") }));
+    $expect(fits).toBeFalse();
+
+    // The parallel sort must produce exactly the same order as the single threaded one.
+    Recordset_sorter parallel({ { false, 1 }, { false, -1 } }, 256 * 1024 * 1024);
+    Recordset_sorter serial({ { false, 1 }, { false, -1 } }, 256 * 1024 * 1024);
+    for (int i = 0; i < 200000; ++i) {
+      Values values({ (i * 7919) % 101, (long double)((i * 104729) % 1009) / 7 });
+      parallel.add_row(i, values);
+      serial.add_row(i, values);
+    }
+    parallel.sort(4);
+    serial.sort(1);
+    $expect(parallel.sorted_rowids() == serial.sorted_rowids()).toBeTrue();
+  });
+
+  $it("In-memory sort matches the SQLite order", [this]() {
+    grt::DictRef options = grt::DictRef::cast_from(grt::GRT::get()->get("/wb/options/options"));
+    base::RecMutex connLock;
+    Recordset::Ref rs = createRecordset(data->connection, connLock, searchQuery);
+
+    auto sorted_ids = [&](size_t budget, Recordset::ColumnId column, int direction) {
+      options.gset("Recordset:SortMemoryBudget", (ssize_t)budget);
+      rs->sort_by(column, direction, false);
+      std::vector<ssize_t> ids;
+      for (size_t row = 0; row < rs->row_count(); ++row) {
+        ssize_t id = 0;
+        rs->get_field(bec::NodeId(row), 0, id);
+        ids.push_back(id);
+      }
+      rs->sort_by(column, 0, false);
+      return ids;
+    };
+
+    for (Recordset::ColumnId column = 0; column < 3; ++column) {
+      for (int direction : { 1, -1 }) {
+        std::vector<ssize_t> sqlite_order = sorted_ids(0, column, direction);
+        $expect(sqlite_order.size()).toBe(6U);
+        $expect(sorted_ids(16, column, direction) == sqlite_order).toBeTrue(std::to_string(column));
+      }
+    }
+    options.gset("Recordset:SortMemoryBudget", 256);
+  });
+
+  $it("Streaming export from a server result set", [this]() {
+    std::string path = casmine::CasmineContext::get()->outputDir() + "/export_stream.jsonl";
+    std::unique_ptr<sql::Statement> stmt(data->connection->ref->createStatement());
+    std::unique_ptr<sql::ResultSet> rset(stmt->executeQuery(exportQuery));
+
+    size_t progressCalls = 0;
+    Recordset_stream_exporter exporter(Recordset_stream_exporter::JSONLines, path);
+    exporter.progress_callback([&](size_t, double) {
+      ++progressCalls;
+      return true;
+    }, 1);
+    $expect(exporter.export_result_set(rset.get())).toBe(2U);
+    $expect(progressCalls).toBe(3U);
+
+    std::vector<std::string> lines = base::split(base::getTextFileContent(path), "\n");
+    $expect(lines[0]).toEqual("{\"id\": 1, \"name\": \"plain\", \"with quotes\": \"a, \\\"quoted\\\" value\", "
+                              "\"empty\": null, \"a;b\": 2.5}");
+    $expect(lines[1]).toEqual("{\"id\": 2, \"name\": \"tab\\there\", \"with quotes\": \"line\\nbreak\", "
+                              "\"empty\": \"x\", \"a;b\": null}");
+  });
+
 }
 
 }
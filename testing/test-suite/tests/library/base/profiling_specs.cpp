@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "base/profiling.h"
+#include "base/string_utilities.h"
+
+#include "casmine.h"
+
+#include <thread>
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$describe("profiling") {
+  $beforeAll([&]() {
+    base::Tracer::enable(false);
+    base::Tracer::clear();
+  });
+
+  $afterAll([&]() {
+    base::Tracer::enable(false);
+    base::Tracer::clear();
+  });
+
+  $it("Trace spans are only recorded while tracing is enabled", [&]() {
+    { BASE_TRACE("test", "disabled"); }
+    $expect(base::Tracer::event_count()).toBe(0U);
+
+    base::Tracer::enable(true);
+    { BASE_TRACE("test", "enabled"); }
+    base::Tracer::enable(false);
+    { BASE_TRACE("test", "disabled"); }
+    $expect(base::Tracer::event_count()).toBe(1U);
+
+    base::Tracer::clear();
+    $expect(base::Tracer::event_count()).toBe(0U);
+  });
+
+  $it("Each thread records into its own buffer", [&]() {
+    base::Tracer::enable(true);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i)
+      threads.emplace_back([]() {
+        for (size_t j = 0; j < 10000; ++j) {
+          BASE_TRACE("test", "worker");
+        }
+      });
+    for (auto &thread : threads)
+      thread.join();
+
+    base::Tracer::enable(false);
+    $expect(base::Tracer::event_count()).toBe(40000U);
+    $expect(base::Tracer::dropped_count()).toBe(0U);
+
+    base::Tracer::clear();
+  });
+
+  $it("Trace data is exported in the Chrome trace-event format", [&]() {
+    base::Tracer::enable(true);
+    base::Tracer::set_thread_name("Tester");
+    {
+      BASE_TRACE("test", "outer");
+      BASE_TRACE("test", "inner");
+    }
+    base::Tracer::enable(false);
+
+    std::string json = base::Tracer::to_chrome_json();
+    $expect(json.find("\"traceEvents\"")).Not.toBe(std::string::npos);
+    $expect(json.find("{\"name\":\"thread_name\",\"ph\":\"M\"")).Not.toBe(std::string::npos);
+    $expect(json.find("\"args\":{\"name\":\"Tester\"}")).Not.toBe(std::string::npos);
+    $expect(json.find("{\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"X\"")).Not.toBe(std::string::npos);
+    $expect(json.find("{\"name\":\"inner\",\"cat\":\"test\",\"ph\":\"X\"")).Not.toBe(std::string::npos);
+
+    std::string path = casmine::CasmineContext::get()->outputDir() + "/trace.json";
+    $expect(base::Tracer::write_chrome_trace(path)).toBeTrue();
+    $expect(base::getTextFileContent(path)).toBe(json);
+
+    base::Tracer::clear();
+  });
+}
+
+}
@@ -374,6 +374,86 @@ $describe("DBC: statement tests") {
       throw;
     }
   });
+
+  $it("Only statements without result sets are batched", []() {
+    $expect(sql::SqlBatchExec::is_batchable("INSERT INTO t VALUES (1)")).toBeTrue();
+    $expect(sql::SqlBatchExec::is_batchable("  -- comment\n  create table t (a int)")).toBeTrue();
+    $expect(sql::SqlBatchExec::is_batchable("/*!40101 SET @OLD_SQL_MODE=@@SQL_MODE */")).toBeTrue();
+    $expect(sql::SqlBatchExec::is_batchable("/* drop it */ DROP TABLE t")).toBeTrue();
+
+    $expect(sql::SqlBatchExec::is_batchable("SELECT 1")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("/*!50001 SELECT 1 */")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("SHOW TABLES")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("CALL proc()")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("LOAD DATA LOCAL INFILE 'x' INTO TABLE t")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("CREATE PROCEDURE p() BEGIN SELECT 1; END")).toBeFalse();
+    $expect(sql::SqlBatchExec::is_batchable("")).toBeFalse();
+  });
+
+  $it("Batched script execution maps errors to the original statements", [this]() {
+    db_mgmt_ConnectionRef connectionProperties(grt::Initialized);
+    setupConnectionEnvironment(connectionProperties);
+
+    sql::DriverManager *dm = sql::DriverManager::getDriverManager();
+    sql::ConnectionWrapper wrapper = dm->getConnection(connectionProperties);
+    std::unique_ptr<sql::Statement> stmt(wrapper->createStatement());
+
+    std::list<std::string> statements = {
+      "DROP DATABASE IF EXISTS dbc_statement_test_batch",
+      "CREATE DATABASE dbc_statement_test_batch",
+      "CREATE TABLE dbc_statement_test_batch.t1 (id int PRIMARY KEY)",
+      "INSERT INTO dbc_statement_test_batch.t1 VALUES (1)",
+      "INSERT INTO dbc_statement_test_batch.t1 VALUES (1)", // Duplicate key.
+      "INSERT INTO dbc_statement_test_batch.t1 VALUES (2)",
+      "SELECT * FROM dbc_statement_test_batch.t1",
+      "INSERT INTO dbc_statement_test_batch.t1 VALUES (3)",
+      "INSERT INTO dbc_statement_test_batch.t1 VALUES (4)"
+    };
+
+    std::vector<std::string> failed;
+    sql::SqlBatchExec batchExec;
+    batchExec.max_packet_size(1024 * 1024);
+    batchExec.stop_on_error(false);
+    batchExec.error_cb([&](long long, const std::string &, const std::string &statement) {
+      failed.push_back(statement);
+      return 0;
+    });
+
+    $expect(batchExec(stmt.get(), statements)).toEqual(1);
+    $expect(batchExec.failed_statements().size()).toEqual(1U);
+    $expect(batchExec.failed_statements()[0]).toEqual(4U);
+    $expect(failed.size()).toEqual(1U);
+    $expect(failed[0]).toEqual("INSERT INTO dbc_statement_test_batch.t1 VALUES (1)");
+
+    // One packet up to the failed insert, then single statements around the SELECT and one packet after it.
+    $expect(batchExec.packet_count()).toEqual(2);
+    $expect(batchExec.sql_log().size()).toEqual(statements.size());
+
+    // Everything except the failed statement went through.
+    std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery("SELECT count(*) FROM dbc_statement_test_batch.t1"));
+    $expect(rs->next()).toBeTrue();
+    $expect(rs->getInt(1)).toEqual(4);
+
+    // Stopping on errors leaves the rest of the packet and script alone.
+    statements = {
+      "CREATE TABLE dbc_statement_test_batch.t2 (id int PRIMARY KEY)",
+      "INSERT INTO dbc_statement_test_batch.t2 VALUES (1)",
+      "INSERT INTO dbc_statement_test_batch.t2 VALUES (1)",
+      "INSERT INTO dbc_statement_test_batch.t2 VALUES (2)"
+    };
+    failed.clear();
+    batchExec.stop_on_error(true);
+    $expect(batchExec(stmt.get(), statements)).toEqual(1);
+    $expect(batchExec.failed_statements()[0]).toEqual(2U);
+    $expect(batchExec.packet_count()).toEqual(1);
+
+    rs.reset(stmt->executeQuery("SELECT count(*) FROM dbc_statement_test_batch.t2"));
+    $expect(rs->next()).toBeTrue();
+    $expect(rs->getInt(1)).toEqual(1);
+    rs.reset();
+
+    stmt->execute("DROP DATABASE IF EXISTS dbc_statement_test_batch");
+  });
 }
 
 }
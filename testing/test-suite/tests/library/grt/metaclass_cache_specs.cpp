@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "base/file_utilities.h"
+
+#include "structs.test.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string structsDir;
+  std::string cacheFile;
+
+  void loadFromXML() {
+    WorkbenchTester::reinitGRT();
+    register_structs_test_xml();
+    grt::GRT::get()->scan_metaclasses_in(structsDir);
+    grt::GRT::get()->end_loading_metaclasses();
+  }
+};
+
+$describe("GRT: metaclass cache") {
+  $beforeAll([this]() {
+    data->structsDir = casmine::CasmineContext::get()->outputDir() + "/metaclass_cache";
+    data->cacheFile = data->structsDir + "/structs.cache";
+    base::remove_recursive(data->structsDir);
+    g_mkdir_with_parents(data->structsDir.c_str(), 0700);
+    base::copyFile(casmine::CasmineContext::get()->tmpDataDir() + "/structs.test.xml",
+                   data->structsDir + "/structs.test.xml");
+  });
+
+  $afterAll([this]() {
+    base::remove_recursive(data->structsDir);
+    WorkbenchTester::reinitGRT();
+  });
+
+  $it("Cached metaclasses match the ones loaded from XML", [this]() {
+    data->loadFromXML();
+
+    std::map<std::string, unsigned int> checksums;
+    for (auto metaclass : grt::GRT::get()->get_metaclasses())
+      checksums[metaclass->name()] = metaclass->crc32();
+    $expect(checksums.size()).toBeGreaterThan(0U);
+
+    $expect(grt::GRT::get()->save_metaclass_cache(data->cacheFile, { data->structsDir })).toBeTrue();
+
+    WorkbenchTester::reinitGRT();
+    register_structs_test_xml();
+    $expect(grt::GRT::get()->load_metaclass_cache(data->cacheFile, { data->structsDir })).toBe((int)checksums.size());
+    grt::GRT::get()->end_loading_metaclasses();
+
+    $expect(grt::GRT::get()->get_metaclasses().size()).toBe(checksums.size());
+    for (auto metaclass : grt::GRT::get()->get_metaclasses())
+      $expect(metaclass->crc32()).toBe(checksums[metaclass->name()], "Checksum of " + metaclass->name());
+
+    grt::MetaClass *book = grt::GRT::get()->get_metaclass("test.Book");
+    $expect(book).Not.toBeNull();
+    $expect(book->parent()->name()).toBe("test.Publication");
+    $expect(book->get_attribute("caption")).toBe("Book");
+    $expect(book->get_member_attribute("authors", "desc")).toBe("the list of authors");
+    $expect((int)book->get_member_type("authors").base.type).toBe(grt::ListType);
+
+    // Objects of cached classes are bound to their implementation like the ones loaded from XML.
+    test_BookRef bookObject(grt::Initialized);
+    bookObject->pages(42);
+    $expect(*grt::IntegerRef::cast_from(book->get_member_value(&bookObject.content(), "pages"))).toBe(42);
+  });
+
+  $it("Outdated or damaged caches are rejected", [this]() {
+    data->loadFromXML();
+    $expect(grt::GRT::get()->save_metaclass_cache(data->cacheFile, { data->structsDir })).toBeTrue();
+
+    WorkbenchTester::reinitGRT();
+    register_structs_test_xml();
+
+    // A struct file added since the cache was written invalidates it.
+    base::copyFile(casmine::CasmineContext::get()->tmpDataDir() + "/structs.foo.xml",
+                   data->structsDir + "/structs.foo.xml");
+    $expect(grt::GRT::get()->load_metaclass_cache(data->cacheFile, { data->structsDir })).toBe(-1);
+    base::tryRemove(data->structsDir + "/structs.foo.xml");
+
+    // So does a truncated one.
+    gchar *contents = nullptr;
+    gsize length = 0;
+    $expect(g_file_get_contents(data->cacheFile.c_str(), &contents, &length, nullptr) != 0).toBeTrue();
+    g_file_set_contents(data->cacheFile.c_str(), contents, (gssize)length / 2, nullptr);
+    g_free(contents);
+    $expect(grt::GRT::get()->load_metaclass_cache(data->cacheFile, { data->structsDir })).toBe(-1);
+
+    // Nothing was registered by the failed attempts.
+    $expect(grt::GRT::get()->get_metaclass("test.Book")).toBeNull();
+  });
+}
+
+}
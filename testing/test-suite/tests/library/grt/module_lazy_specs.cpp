@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "base/file_utilities.h"
+
+#include "grtpp_module_lazy.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+// Stands in for a module file, with a single function returning 42.
+class FakeModule : public grt::Module {
+public:
+  FakeModule(grt::ModuleLoader *loader, const std::string &name, const std::string &path) : grt::Module(loader) {
+    _name = name;
+    _path = path;
+    _meta_version = "1.0";
+    _meta_author = "Oracle";
+    _interfaces.push_back("FakeInterface");
+
+    grt::Module::Function function;
+    function.name = "getAnswer";
+    function.description = "Returns the answer";
+    function.ret_type.base.type = grt::IntegerType;
+    grt::ArgSpec arg;
+    arg.name = "question";
+    arg.type.base.type = grt::StringType;
+    function.arg_types.push_back(arg);
+    function.call = [](const grt::BaseListRef &) { return grt::IntegerRef(42); };
+    add_function(function);
+  }
+};
+
+class FakeLoader : public grt::ModuleLoader {
+public:
+  size_t loadCount = 0;
+  bool failing = false;
+  std::string moduleName = "FakeModule";
+
+  virtual std::string get_loader_name() override {
+    return "fake";
+  }
+
+  virtual grt::Module *init_module(const std::string &path) override {
+    ++loadCount;
+    if (failing)
+      return nullptr;
+    return new FakeModule(this, moduleName, path);
+  }
+
+  virtual void refresh() override {
+  }
+  virtual bool load_library(const std::string &) override {
+    return false;
+  }
+  virtual bool run_script_file(const std::string &) override {
+    return false;
+  }
+  virtual bool run_script(const std::string &) override {
+    return false;
+  }
+  virtual bool check_file_extension(const std::string &) override {
+    return false;
+  }
+};
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string moduleDir;
+  std::string modulePath;
+  std::string manifestFile;
+  FakeLoader *loader = nullptr;
+
+  // Builds a manifest for the fake module file and returns the lazy module created from it.
+  std::unique_ptr<grt::LazyModule> createLazyModule() {
+    FakeModule module(loader, "FakeModule", modulePath);
+    grt::ModuleManifest manifest({ "db_fake_*" });
+    manifest.update({ &module });
+    return std::unique_ptr<grt::LazyModule>(dynamic_cast<grt::LazyModule *>(manifest.create_deferred_module(modulePath)));
+  }
+};
+
+$describe("GRT: deferred modules") {
+  $beforeAll([this]() {
+    data->moduleDir = casmine::CasmineContext::get()->outputDir() + "/lazy_modules";
+    data->modulePath = data->moduleDir + "/db_fake_grt.so";
+    data->manifestFile = data->moduleDir + "/modules.cache";
+    base::remove_recursive(data->moduleDir);
+    g_mkdir_with_parents(data->moduleDir.c_str(), 0700);
+    g_file_set_contents(data->modulePath.c_str(), "module", -1, nullptr);
+
+    WorkbenchTester::reinitGRT();
+    data->loader = new FakeLoader(); // Owned by the GRT.
+    grt::GRT::get()->add_module_loader(data->loader);
+  });
+
+  $afterAll([this]() {
+    base::remove_recursive(data->moduleDir);
+    WorkbenchTester::reinitGRT();
+  });
+
+  $beforeEach([this]() {
+    data->loader->loadCount = 0;
+    data->loader->failing = false;
+    data->loader->moduleName = "FakeModule";
+  });
+
+  $it("Manifest round-trip", [this]() {
+    FakeModule module(data->loader, "FakeModule", data->modulePath);
+    grt::ModuleManifest manifest({ "db_fake_*" });
+    $expect(manifest.update({ &module })).toBeTrue();
+    $expect(manifest.update({ &module })).toBeFalse("Unchanged modules must not change the manifest");
+    $expect(manifest.save(data->manifestFile)).toBeTrue();
+
+    grt::ModuleManifest loaded({ "db_fake_*" });
+    $expect(loaded.load(data->manifestFile)).toBeTrue();
+    std::unique_ptr<grt::Module> lazy(loaded.create_deferred_module(data->modulePath));
+    $expect(lazy.get()).Not.toBeNull();
+    $expect(loaded.deferred_count()).toBe(1U);
+
+    $expect(lazy->name()).toBe("FakeModule");
+    $expect(lazy->version()).toBe("1.0");
+    $expect(lazy->author()).toBe("Oracle");
+    $expect(lazy->path()).toBe(data->modulePath);
+    $expect(lazy->get_interfaces().size()).toBe(1U);
+    $expect(lazy->get_interfaces()[0]).toBe("FakeInterface");
+
+    const grt::Module::Function *function = lazy->get_function("getAnswer");
+    $expect(function).Not.toBeNull();
+    $expect(function->description).toBe("Returns the answer");
+    $expect((int)function->ret_type.base.type).toBe(grt::IntegerType);
+    $expect(function->arg_types.size()).toBe(1U);
+    $expect(function->arg_types[0].name).toBe("question");
+    $expect((int)function->arg_types[0].type.base.type).toBe(grt::StringType);
+
+    $expect(data->loader->loadCount).toBe(0U, "Creating the lazy module must not load the module file");
+
+    // Files not matching the patterns are never deferred.
+    grt::ModuleManifest other({ "db_other_*" });
+    $expect(other.load(data->manifestFile)).toBeTrue();
+    $expect(other.create_deferred_module(data->modulePath)).toBeNull();
+
+    // Neither is a damaged manifest used.
+    gchar *contents = nullptr;
+    gsize length = 0;
+    $expect(g_file_get_contents(data->manifestFile.c_str(), &contents, &length, nullptr) != 0).toBeTrue();
+    g_file_set_contents(data->manifestFile.c_str(), contents, (gssize)length / 2, nullptr);
+    g_free(contents);
+    grt::ModuleManifest damaged({ "db_fake_*" });
+    $expect(damaged.load(data->manifestFile)).toBeFalse();
+    $expect(damaged.create_deferred_module(data->modulePath)).toBeNull();
+  });
+
+  $it("First call loads the real module", [this]() {
+    std::unique_ptr<grt::LazyModule> lazy = data->createLazyModule();
+    $expect(lazy.get()).Not.toBeNull();
+    $expect(lazy->is_loaded()).toBeFalse();
+
+    grt::BaseListRef args(true);
+    args.ginsert(grt::StringRef("life"));
+    grt::ValueRef result = lazy->call_function("getAnswer", args);
+    $expect(lazy->is_loaded()).toBeTrue();
+    $expect(data->loader->loadCount).toBe(1U);
+    $expect(*grt::IntegerRef::cast_from(result)).toBe(42);
+
+    // Later calls, also through the function slot, go to the already loaded module.
+    result = lazy->get_function("getAnswer")->call(args);
+    $expect(*grt::IntegerRef::cast_from(result)).toBe(42);
+    $expect(data->loader->loadCount).toBe(1U);
+
+    $expect([&]() { lazy->call_function("noSuchFunction", args); }).toThrow();
+  });
+
+  $it("Failing load reports an error", [this]() {
+    std::unique_ptr<grt::LazyModule> lazy = data->createLazyModule();
+    $expect(lazy.get()).Not.toBeNull();
+
+    grt::BaseListRef args(true);
+    data->loader->failing = true;
+    $expect([&]() { lazy->call_function("getAnswer", args); }).toThrow();
+    $expect(lazy->is_loaded()).toBeFalse();
+
+    // The module file now contains a different module.
+    data->loader->failing = false;
+    data->loader->moduleName = "OtherModule";
+    $expect([&]() { lazy->call_function("getAnswer", args); }).toThrow();
+    $expect(lazy->is_loaded()).toBeFalse();
+    $expect(data->loader->loadCount).toBe(2U);
+
+    // Once the file is right again, the module can still be loaded.
+    data->loader->moduleName = "FakeModule";
+    args.ginsert(grt::StringRef("life"));
+    $expect(*grt::IntegerRef::cast_from(lazy->call_function("getAnswer", args))).toBe(42);
+  });
+}
+
+}
@@ -23,8 +23,10 @@
 
 #include "base/utf8string.h"
 #include "mtemplate/template.h"
+#include "mtemplate/compiled_template.h"
 #include "base/string_utilities.h"
 #include <fstream>
+#include <sstream>
 
 #include "casmine.h"
 
@@ -81,6 +83,41 @@ struct SQLQuoteModifier : public mtemplate::Modifier {
   }
 };
 
+// Cut down version of the table listing in the HTML model report templates.
+static const char *reportTemplate =
+  "<html><head><title>{{TITLE}}</title></head>\n"
+  "<body>\n"
+  "{{#SCHEMATA}}<h1>Schema {{SCHEMA_NAME}}</h1>\n"
+  "{{#TABLES}}<div id=\"{{TABLE_ID}}\"><h2>{{TABLE_NAME}}</h2>\n"
+  "  <p>{{TABLE_COMMENT}}</p>\n"
+  "  <table>\n"
+  "  {{#COLUMNS_LISTING}}{{#COLUMNS}}<tr><td>{{COLUMN_NAME}}</td><td>{{COLUMN_DATATYPE}}</td>"
+  "<td>{{COLUMN_NOTNULL}}</td><td>{{SCHEMA_NAME}}.{{TABLE_NAME}}</td></tr>{{#COLUMNS_separator}}\n  {{/COLUMNS_separator}}"
+  "{{/COLUMNS}}{{/COLUMNS_LISTING}}\n"
+  "  </table>\n"
+  "</div>\n"
+  "{{/TABLES}}{{/SCHEMATA}}"
+  "</body></html>\n";
+
+static void fillReportDictionary(mtemplate::DictionaryInterface *main, size_t tableCount, size_t columnCount) {
+  main->setValue("TITLE", "Model Report");
+  mtemplate::DictionaryInterface *schema = main->addSectionDictionary("SCHEMATA");
+  schema->setValue("SCHEMA_NAME", "sakila");
+  for (size_t i = 0; i < tableCount; ++i) {
+    mtemplate::DictionaryInterface *table = schema->addSectionDictionary("TABLES");
+    table->setIntValue("TABLE_ID", (long)i);
+    table->setValue("TABLE_NAME", "table_" + std::to_string(i));
+    table->setValue("TABLE_COMMENT", "Comment <" + std::to_string(i) + ">");
+    mtemplate::DictionaryInterface *listing = table->addSectionDictionary("COLUMNS_LISTING");
+    for (size_t j = 0; j < columnCount; ++j) {
+      mtemplate::DictionaryInterface *column = listing->addSectionDictionary("COLUMNS");
+      column->setValue("COLUMN_NAME", "column_" + std::to_string(j));
+      column->setValue("COLUMN_DATATYPE", j % 2 == 0 ? "INT" : "VARCHAR(45)");
+      column->setValue("COLUMN_NOTNULL", j == 0 ? "Yes" : "No");
+    }
+  }
+}
+
 $TestData {
   std::string outputDir = CasmineContext::get()->outputDir();
   std::string dataDir = CasmineContext::get()->tmpDataDir();
@@ -260,6 +297,53 @@ $describe("mtemplate") {
     $expect(compare_file_contents(data->dataDir + "/mtemplate/test_result.html", data->outputDir + "/test_result.html")).toBeTrue();
   });
 
+
+  $it("Compiled templates produce the same output", [this]() {
+    for (auto name : { "CSV_semicolon", "JSON", "SQL_inserts", "HTML" }) {
+      std::unique_ptr<mtemplate::Template> tpl(mtemplate::GetTemplate(data->dataDir + "/mtemplate/" + name + ".tpl"));
+      std::unique_ptr<mtemplate::CompiledTemplate> compiled(tpl->compile());
+
+      std::unique_ptr<mtemplate::DictionaryInterface> dictionary(mtemplate::CreateMainDictionary());
+      std::unique_ptr<mtemplate::DictionaryInterface> slotDictionary(compiled->createMainDictionary());
+      for (auto dict : { dictionary.get(), slotDictionary.get() }) {
+        for (auto item : data->language_details_map) {
+          mtemplate::DictionaryInterface *row = dict->addSectionDictionary("ROW");
+          row->setValueAndShowSection("FIELD_VALUE", item.first, "FIELD");
+          row->setValueAndShowSection("FIELD_VALUE", item.second, "FIELD");
+        }
+      }
+
+      mtemplate::TemplateOutputString expected, generic, slots;
+      tpl->expand(dictionary.get(), &expected);
+      compiled->expand(dictionary.get(), &generic);
+      compiled->expand(slotDictionary.get(), &slots);
+
+      $expect(generic.get()).toEqual(expected.get(), name);
+      $expect(slots.get()).toEqual(expected.get(), name);
+    }
+  });
+
+  $it("Compiled templates render nested sections like the interpreter", [this]() {
+    mtemplate::Template tpl(mtemplate::parseTemplate(reportTemplate, mtemplate::STRIP_BLANK_LINES));
+    std::unique_ptr<mtemplate::CompiledTemplate> compiled(tpl.compile());
+
+    std::unique_ptr<mtemplate::DictionaryInterface> dictionary(mtemplate::CreateMainDictionary());
+    fillReportDictionary(dictionary.get(), 20, 5);
+    std::stringstream expected;
+    mtemplate::TemplateOutputStream expectedOutput(expected);
+    tpl.expand(dictionary.get(), &expectedOutput);
+
+    std::unique_ptr<mtemplate::SlotDictionary> slotDictionary(compiled->createMainDictionary());
+    fillReportDictionary(slotDictionary.get(), 20, 5);
+    std::stringstream actual;
+    mtemplate::TemplateOutputStream actualOutput(actual);
+    compiled->expand(slotDictionary.get(), &actualOutput);
+
+    $expect(actual.str()).toEqual(expected.str());
+    $expect(actual.str()).toContain("<h2>table_19</h2>");
+    $expect(actual.str()).toContain("<td>column_4</td><td>INT</td><td>No</td><td>sakila.table_19</td>");
+  });
+
 }
 
 }
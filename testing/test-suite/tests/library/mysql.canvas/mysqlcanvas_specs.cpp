@@ -21,6 +21,8 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <random>
+
 #include "mdc.h"
 #include "mdc_canvas_view_image.h"
 
@@ -85,6 +87,94 @@ struct CairoSurface {
   }
 };
 
+// Places a line on fixed points. Changing the points lays the line out again, like a connection
+// whose figures were moved.
+class FixedLineLayouter : public mdc::LineLayouter {
+public:
+  std::vector<base::Point> points;
+
+  FixedLineLayouter(const std::vector<base::Point> &points) : points(points) {
+  }
+
+  virtual mdc::Connector *get_start_connector() const override {
+    return nullptr;
+  }
+  virtual mdc::Connector *get_end_connector() const override {
+    return nullptr;
+  }
+
+  virtual std::vector<base::Point> get_points() override {
+    return points;
+  }
+  virtual base::Point get_start_point() override {
+    return points.front();
+  }
+  virtual base::Point get_end_point() override {
+    return points.back();
+  }
+
+  virtual void update() override {
+    _changed();
+  }
+
+  void move(const std::vector<base::Point> &newPoints) {
+    points = newPoints;
+    update();
+  }
+};
+
+class HopLine : public mdc::Line {
+public:
+  FixedLineLayouter *layouter;
+  int offset;
+
+  HopLine(mdc::Layer *layer, FixedLineLayouter *layouter, int offset)
+    : mdc::Line(layer, layouter), layouter(layouter), offset(offset) {
+  }
+
+  size_t hopsOn(const mdc::Line *other) const {
+    size_t count = 0;
+    for (auto &segment : _segments)
+      if (segment.hop == other)
+        ++count;
+    return count;
+  }
+};
+
+// Crossings between two lines, checking every pair of segments.
+static size_t bruteForceCrossings(const mdc::Line *line1, const mdc::Line *line2) {
+  if (!line1->get_hops_crossings() || !line2->get_hops_crossings())
+    return 0;
+
+  std::vector<base::Point> vertices1(line1->get_root_vertices()), vertices2(line2->get_root_vertices());
+  size_t count = 0;
+  base::Point intersection;
+  for (size_t i = 1; i < vertices1.size(); ++i) {
+    for (size_t j = 1; j < vertices2.size(); ++j) {
+      if (mdc::intersect_hv_lines(vertices1[i - 1], vertices1[i], vertices2[j - 1], vertices2[j], intersection))
+        ++count;
+    }
+  }
+  return count;
+}
+
+// An orthogonal polyline spanning several grid cells. All coordinates of a line share an offset no other line
+// uses, so lines never touch at their ends or overlap.
+static std::vector<base::Point> randomOrthogonalPoints(std::mt19937 &random, int offset) {
+  std::uniform_int_distribution<int> coordinate(0, 40);
+  std::vector<base::Point> points;
+  double x = coordinate(random) * 20 + offset, y = coordinate(random) * 20 + offset;
+  points.push_back(base::Point(x, y));
+  for (int i = 0; i < 3; ++i) {
+    if (i % 2 == 0)
+      x = coordinate(random) * 20 + offset;
+    else
+      y = coordinate(random) * 20 + offset;
+    points.push_back(base::Point(x, y));
+  }
+  return points;
+}
+
 $ModuleEnvironment() {};
 
 class Thing : public mdc::Box {
@@ -172,9 +262,9 @@ $TestData {
   std::string dataDir = CasmineContext::get()->tmpDataDir();
 };
 
-$xdescribe("mdc canvas") {
+$describe("mdc canvas") {
 
-  $it("View creation + zoom", []() {
+  $xit("View creation + zoom", []() {
     mdc::ImageCanvasView view(500, 400);
 
     view.set_page_size(base::Size(500, 400));
@@ -190,7 +280,7 @@ $xdescribe("mdc canvas") {
     $expect(view.get_viewport().str()).toBe(base::Rect(0, 0, 500, 400).str());
   });
 
-  $it("View hierarchy creation", [this]() {
+  $xit("View hierarchy creation", [this]() {
     data->view = std::make_unique<mdc::ImageCanvasView>(1000, 1000);
     data->view->initialize();
 
@@ -230,7 +320,7 @@ $xdescribe("mdc canvas") {
     $expect(data->group != nullptr).toBeTrue();
   });
 
-  $it("Test get_common_ancestor", [this]() {
+  $xit("Test get_common_ancestor", [this]() {
     mdc::CanvasItem *ancestor;
 
     ancestor = data->item1->get_common_ancestor(data->item2.get());
@@ -242,7 +332,7 @@ $xdescribe("mdc canvas") {
     $expect(ancestor).Not.toBe(nullptr);
   });
 
-  $it("Coordinate conversion", [this]() {
+  $xit("Coordinate conversion", [this]() {
     base::Point p;
 
     $expect(data->item0->get_position().x).toBe(100);
@@ -259,7 +349,7 @@ $xdescribe("mdc canvas") {
     $expect(p.y).toBe(205);
   });
 
-  $it("Non-homogeneous box layout", []() {
+  $xit("Non-homogeneous box layout", []() {
     mdc::ImageCanvasView view(1000, 1000);
     view.initialize();
     mdc::Layer *layer = view.get_current_layer();
@@ -298,7 +388,7 @@ $xdescribe("mdc canvas") {
     $expect(r4.get_size().height).toBe(20);
   });
 
-  $it("Rectangle rendering", [this]() {
+  $xit("Rectangle rendering", [this]() {
     mdc::ImageCanvasView imageView(500, 400);
     mdc::Layer *layer;
 
@@ -436,6 +526,75 @@ $xdescribe("mdc canvas") {
     $expect(targetSurface == sourceSurface).toBe(true);
   });
 
+
+  $it("Line crossings match a brute-force check after moving, adding and deleting lines", []() {
+    mdc::ImageCanvasView view(1000, 1000);
+    view.initialize();
+    mdc::Layer *layer = view.get_current_layer();
+
+    std::mt19937 random(17);
+    std::vector<HopLine *> lines;
+    int nextOffset = 1;
+    auto addLine = [&]() {
+      HopLine *line = new HopLine(layer, new FixedLineLayouter(randomOrthogonalPoints(random, nextOffset)), nextOffset);
+      ++nextOffset;
+      layer->add_item(line);
+      lines.push_back(line);
+    };
+
+    size_t totalCrossings = 0;
+    auto checkCrossings = [&]() {
+      view.update_pending_line_crossings();
+      for (size_t i = 0; i < lines.size(); ++i) {
+        for (size_t j = i + 1; j < lines.size(); ++j) {
+          size_t expected = bruteForceCrossings(lines[i], lines[j]);
+          size_t hops1 = lines[i]->hopsOn(lines[j]), hops2 = lines[j]->hopsOn(lines[i]);
+
+          // Each crossing is drawn as a hop on exactly one of the two lines.
+          $expect(hops1 + hops2).toBe(expected);
+          $expect(hops1 == 0 || hops2 == 0).toBeTrue();
+          totalCrossings += expected;
+        }
+      }
+    };
+
+    for (int i = 0; i < 12; ++i)
+      addLine();
+    checkCrossings();
+
+    std::uniform_int_distribution<size_t> pick(0, 11);
+    for (int round = 0; round < 20; ++round) {
+      for (int i = 0; i < 3; ++i) {
+        HopLine *line = lines[pick(random) % lines.size()];
+        line->layouter->move(randomOrthogonalPoints(random, line->offset));
+      }
+      checkCrossings();
+    }
+
+    // A deleted line leaves no hops behind on the lines it crossed.
+    for (int i = 0; i < 3; ++i) {
+      size_t index = pick(random) % lines.size();
+      HopLine *line = lines[index];
+      lines.erase(lines.begin() + index);
+      delete line;
+      for (auto other : lines)
+        $expect(other->hopsOn(line)).toBe(0U);
+      checkCrossings();
+    }
+
+    addLine();
+    lines.front()->set_hops_crossings(false);
+    checkCrossings();
+    lines.front()->set_hops_crossings(true);
+    checkCrossings();
+
+    // Make sure the lines actually crossed, otherwise nothing was checked.
+    $expect(totalCrossings).toBeGreaterThan(0U);
+
+    for (auto line : lines)
+      delete line;
+  });
+
 }
 
 }
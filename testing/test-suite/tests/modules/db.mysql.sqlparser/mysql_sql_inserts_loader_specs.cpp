@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <random>
+
+#include "base/string_utilities.h"
+#include "mysql_sql_inserts_loader.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+struct LoadedInsert {
+  std::string schema;
+  std::string table;
+  Sql_inserts_loader::Strings names;
+  Sql_inserts_loader::Strings values;
+  std::vector<bool> nullFields;
+
+  bool operator == (const LoadedInsert &other) const {
+    return schema == other.schema && table == other.table && names == other.names && values == other.values &&
+           nullFields == other.nullFields;
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static std::vector<LoadedInsert> loadInserts(const std::string &sql, bool useValuesScanner) {
+  std::vector<LoadedInsert> result;
+
+  Mysql_sql_inserts_loader::Ref loader = Mysql_sql_inserts_loader::create();
+  loader->use_values_scanner(useValuesScanner);
+  loader->process_insert_cb([&](const std::string &, const std::pair<std::string, std::string> &schemaTable,
+                                const Sql_inserts_loader::Strings &names, const Sql_inserts_loader::Strings &values,
+                                const std::vector<bool> &nullFields) {
+    result.push_back({ schemaTable.first, schemaTable.second, names, values, nullFields });
+  });
+  loader->load(sql, "default_schema");
+
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static void expectParity(const std::string &sql) {
+  std::vector<LoadedInsert> expected = loadInserts(sql, false);
+  std::vector<LoadedInsert> actual = loadInserts(sql, true);
+
+  $expect(actual.size()).toBe(expected.size(), "Row count differs for: " + sql);
+  for (size_t i = 0; i < std::min(actual.size(), expected.size()); ++i) {
+    if (!(actual[i] == expected[i])) {
+      $fail(base::strfmt("Row %zu differs for: ", i) + sql);
+      break;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+};
+
+$describe("MySQL inserts loader") {
+
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->createNewDocument();
+  });
+
+  $it("Reads names and values of generated inserts", []() {
+    std::vector<LoadedInsert> rows = loadInserts(
+      "INSERT INTO `sakila`.`actor` (`actor_id`, `first_name`, `last_update`) VALUES (1, 'PENELOPE', NULL);\n"
+      "INSERT INTO `actor` (`actor_id`, `first_name`, `last_update`) VALUES (2, 'it\\'s', now()), (-3, '', 1e5);",
+      true);
+
+    $expect(rows.size()).toBe(3U);
+    if (rows.size() != 3)
+      return;
+
+    $expect(rows[0].schema).toBe("sakila");
+    $expect(rows[0].table).toBe("actor");
+    $expect(rows[0].names).toEqual(Sql_inserts_loader::Strings({ "actor_id", "first_name", "last_update" }));
+    $expect(rows[0].values).toEqual(Sql_inserts_loader::Strings({ "1", "PENELOPE", "" }));
+    $expect(rows[0].nullFields).toEqual(std::vector<bool>({ false, false, true }));
+
+    $expect(rows[1].schema).toBe("default_schema");
+    $expect(rows[1].table).toBe("actor");
+    $expect(rows[1].values).toEqual(Sql_inserts_loader::Strings({ "2", "it\\'s", "\\func now()" }));
+    $expect(rows[2].values).toEqual(Sql_inserts_loader::Strings({ "\\func -3", "", "\\func 1e5" }));
+  });
+
+  $it("Loads inserts exactly like the parser", []() {
+    static const std::vector<std::string> scripts = {
+      "INSERT INTO `s`.`t` (`a`, `b`) VALUES (1, 'x')",
+      "insert into `t` (`a`) values ('it\\'s'), (\"q\"\"q\"), ('a''b'), (NULL), (null), (-1), (1.5), (1e5), (007), ('')",
+      "INSERT INTO `t` (`a`, `b`, `c`) VALUES ('a\\\\', 'b\\n', 'c\\0')",
+      "INSERT /* c */ INTO `t` -- x\n (`a`) # y\n VALUES (1) -- z\n;",
+      "INSERT INTO `t` (`a b`, `c.d`) VALUES ('\xc3\xa4', 2)",
+      "INSERT INTO `t` (`a`, `b`) VALUES (1)",
+      "INSERT INTO `t` (`a`) VALUES (1abc); INSERT INTO `t` (`a`) VALUES (x'0A'); INSERT INTO `t` (`a`) VALUES ('a' 'b')",
+      "INSERT INTO t (a) VALUES (1); INSERT t (a) VALUES (2); INSERT INTO `t` VALUES (3)",
+      "INSERT INTO `t` (`a`) VALUES (1) ON DUPLICATE KEY UPDATE `a` = 2",
+      "INSERT INTO `t` (`a`) VALUES ('/*!40101 x */')",
+      "/*!40000 ALTER TABLE `t` DISABLE KEYS */; INSERT INTO `t` (`a`) VALUES (1); SET @a = 1; select 1;",
+      "DELIMITER $$\nINSERT INTO `t` (`a`) VALUES ('a;b')$$\nDELIMITER ;\nINSERT INTO `t` (`a`) VALUES (2);",
+      "INSERT INTO `t` (`a`) VALUES ('\xff\xfe')",
+    };
+
+    for (auto &script : scripts)
+      expectParity(script);
+  });
+
+  $it("Loads random variations of inserts exactly like the parser", []() {
+    static const std::vector<std::string> values = {
+      "'x'", "'it\\'s'", "'a''b'", "\"q\"", "''", "'\\\\'", "NULL", "null", "1", "-1", "1.5", "2e3", "-0.5E+2", "1abc"
+    };
+    static const std::vector<std::string> noise = {
+      " ", "\n", "(", ")", ",", "'", "`", "\\", ".", "x", "1.", ".5", "- 1", "+1", "DEFAULT", "/* c */", "-- c\n",
+      "# c\n", "--", "`a``b`", "\xc3\xa4", "\r\n"
+    };
+
+    std::mt19937 random(42);
+    for (int i = 0; i < 1000; ++i) {
+      std::string sql = std::string("INSERT INTO ") + (random() % 2 ? "`t`" : "`s`.`t`") + " (`a`, `b`) VALUES ";
+      for (size_t row = 0, count = 1 + random() % 3; row < count; ++row) {
+        sql += row > 0 ? ", (" : "(";
+        sql += values[random() % values.size()] + (random() % 2 ? ", " : ",") + values[random() % values.size()];
+        sql += ")";
+      }
+
+      for (size_t changes = random() % 4; changes > 0; --changes) {
+        size_t position = random() % (sql.size() + 1);
+        if (random() % 2)
+          sql.insert(position, noise[random() % noise.size()]);
+        else if (position < sql.size())
+          sql.erase(position, 1 + random() % 3);
+      }
+
+      expectParity(sql);
+    }
+  });
+
+  $it("Loads a table dump exactly like the parser", []() {
+    std::string sql;
+    for (int i = 0; i < 2000; ++i)
+      sql += base::strfmt("INSERT INTO `sakila`.`actor` (`actor_id`, `first_name`, `last_name`, `last_update`) "
+                          "VALUES (%i, 'First \\'%i', 'Last name %i', '2006-02-15 04:34:33');\n", i, i, i);
+
+    std::vector<LoadedInsert> expected = loadInserts(sql, false);
+    std::vector<LoadedInsert> actual = loadInserts(sql, true);
+
+    $expect(expected.size()).toBe(2000U);
+    $expect(actual.size()).toBe(expected.size());
+    for (size_t i = 0; i < std::min(actual.size(), expected.size()); ++i) {
+      if (!(actual[i] == expected[i])) {
+        $fail(base::strfmt("Row %zu differs", i));
+        break;
+      }
+    }
+    if (!actual.empty())
+      $expect(actual.back().values[1]).toBe("First \\'1999");
+  });
+}
+
+}
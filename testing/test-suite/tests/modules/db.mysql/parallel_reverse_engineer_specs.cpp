@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include "grtdb/db_helpers.h"
+#include "db_mysql_reverse_engineer.h"
+
+using namespace dbmysql;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Serves fixed CREATE statements instead of querying a server.
+class MemorySource : public ParallelReverseEngineer::Source {
+public:
+  MemorySource(const std::map<std::string, std::string> &ddl) : _ddl(ddl) {
+  }
+
+  virtual std::string fetch_ddl(const ParallelReverseEngineer::Object &object) override {
+    auto iter = _ddl.find(object.schema + "." + object.name);
+    if (iter == _ddl.end())
+      throw std::runtime_error("Unknown object " + object.name);
+    return iter->second;
+  }
+
+private:
+  const std::map<std::string, std::string> &_ddl;
+};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  std::map<std::string, std::string> ddl;
+
+  db_mysql_CatalogRef reverseEngineer(size_t workers) {
+    ParallelReverseEngineer engine(tester->getRdbms(), bec::parse_version("8.0.16"), "", true);
+    engine.add_schema("shop");
+
+    typedef ParallelReverseEngineer::Object Object;
+    engine.add_object(Object{ ParallelReverseEngineer::TableObject, "shop", "orders", "" });
+    engine.add_object(Object{ ParallelReverseEngineer::TableObject, "shop", "customers", "" });
+    engine.add_object(Object{ ParallelReverseEngineer::TableObject, "shop", "items", "" });
+    engine.add_object(Object{ ParallelReverseEngineer::ViewObject, "shop", "big_orders", "" });
+    engine.add_object(Object{ ParallelReverseEngineer::TriggerObject, "shop", "orders_bi", "orders" });
+    engine.add_object(Object{ ParallelReverseEngineer::ProcedureObject, "shop", "cleanup", "" });
+
+    return engine.run("def", [this]() { return new MemorySource(ddl); }, workers);
+  }
+};
+
+$describe("Parallel reverse engineering") {
+
+  $beforeAll([this] () {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    data->ddl["shop.orders"] = "CREATE TABLE `orders` (`id` int NOT NULL, `customer_id` int, PRIMARY KEY (`id`), "
+      "CONSTRAINT `fk_customer` FOREIGN KEY (`customer_id`) REFERENCES `customers` (`id`))";
+    data->ddl["shop.customers"] = "CREATE TABLE `customers` (`id` int NOT NULL, `name` varchar(45), PRIMARY KEY (`id`))";
+    data->ddl["shop.items"] = "CREATE TABLE `items` (`id` int NOT NULL, `order_id` int, PRIMARY KEY (`id`), "
+      "CONSTRAINT `fk_order` FOREIGN KEY (`order_id`) REFERENCES `orders` (`id`), "
+      "CONSTRAINT `fk_other` FOREIGN KEY (`order_id`) REFERENCES `archive` (`id`))";
+    data->ddl["shop.big_orders"] = "CREATE VIEW `big_orders` AS SELECT * FROM `orders` WHERE `id` > 100";
+    data->ddl["shop.orders_bi"] = "CREATE TRIGGER `orders_bi` BEFORE INSERT ON `orders` FOR EACH ROW SET NEW.id = NEW.id";
+    data->ddl["shop.cleanup"] = "CREATE PROCEDURE `cleanup`() BEGIN DELETE FROM `orders`; END";
+  });
+
+  $it("Creates the same catalog independent of the number of workers", [this]() {
+    db_mysql_CatalogRef serial = data->reverseEngineer(1);
+    db_mysql_CatalogRef parallel = data->reverseEngineer(4);
+
+    for (auto catalog : { serial, parallel }) {
+      $expect(catalog->schemata().count()).toBe(1U);
+      db_mysql_SchemaRef schema = catalog->schemata()[0];
+      $expect(*schema->name()).toBe("shop");
+
+      // Tables in listing order, followed by the stub for the table which was not reverse engineered.
+      $expect(schema->tables().count()).toBe(4U);
+      $expect(*schema->tables()[0]->name()).toBe("orders");
+      $expect(*schema->tables()[1]->name()).toBe("customers");
+      $expect(*schema->tables()[2]->name()).toBe("items");
+      $expect(*schema->tables()[3]->name()).toBe("archive");
+      $expect(*schema->tables()[3]->isStub() != 0).toBeTrue();
+
+      $expect(schema->views().count()).toBe(1U);
+      $expect(schema->routines().count()).toBe(1U);
+      $expect(schema->tables()[0]->triggers().count()).toBe(1U);
+    }
+  });
+
+  $it("Resolves foreign keys into the merged catalog", [this]() {
+    db_mysql_CatalogRef catalog = data->reverseEngineer(4);
+    db_mysql_SchemaRef schema = catalog->schemata()[0];
+
+    db_mysql_TableRef orders = schema->tables()[0];
+    db_mysql_TableRef customers = schema->tables()[1];
+    db_mysql_TableRef items = schema->tables()[2];
+
+    $expect(orders->foreignKeys().count()).toBe(1U);
+    db_ForeignKeyRef fk = orders->foreignKeys()[0];
+    $expect(fk->referencedTable() == customers).toBeTrue();
+    $expect(fk->referencedColumns()[0] == customers->columns()[0]).toBeTrue();
+    $expect(*customers->isStub() == 0).toBeTrue();
+
+    $expect(items->foreignKeys().count()).toBe(2U);
+    $expect(items->foreignKeys()[0]->referencedTable() == orders).toBeTrue();
+    $expect(items->foreignKeys()[1]->referencedTable() == schema->tables()[3]).toBeTrue();
+  });
+
+  $it("Reports the timings of the phases", [this]() {
+    ParallelReverseEngineer engine(data->tester->getRdbms(), bec::parse_version("8.0.16"), "", true);
+    engine.add_schema("shop");
+    engine.add_object(ParallelReverseEngineer::Object{ ParallelReverseEngineer::TableObject, "shop", "customers", "" });
+    engine.run("def", [this]() { return new MemorySource(data->ddl); }, 2);
+
+    $expect(engine.timings().total >= engine.timings().merge).toBeTrue();
+    $expect(engine.timings().parse > 0).toBeTrue();
+  });
+
+  $it("Propagates fetch errors", [this]() {
+    ParallelReverseEngineer engine(data->tester->getRdbms(), bec::parse_version("8.0.16"), "", true);
+    engine.add_schema("shop");
+    engine.add_object(ParallelReverseEngineer::Object{ ParallelReverseEngineer::TableObject, "shop", "missing", "" });
+    $expect([&]() { engine.run("def", [this]() { return new MemorySource(data->ddl); }, 2); }).toThrow();
+  });
+}
+
+}
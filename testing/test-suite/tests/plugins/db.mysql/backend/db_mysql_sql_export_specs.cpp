@@ -22,6 +22,7 @@
  */
 
 #include "base/file_utilities.h"
+#include "base/string_utilities.h"
 
 #include "grtsqlparser/sql_facade.h"
 
@@ -44,7 +45,9 @@ $TestData {
 
   std::string dataDir;
 
-  void doForwardEngineering(std::string &modelfile, std::string &expectedFileName, std::map<std::string, bool> &fwd_opts) {
+  // With a streamFile the script is generated in parallel and written directly to that file.
+  void doForwardEngineering(std::string &modelfile, std::string &expectedFileName, std::map<std::string, bool> &fwd_opts,
+                            const std::string &streamFile = "") {
     $expect(base::file_exists(modelfile)).toBeTrue("Model file not found");
 
     tester->wb->open_document(modelfile);
@@ -77,9 +80,23 @@ $TestData {
     for (it = fwd_opts.begin(); it != fwd_opts.end(); ++it)
       exp.set_option(it->first, it->second);
 
+    if (!streamFile.empty()) {
+      exp.set_option("OutputFileName", streamFile);
+      exp.set_option("StreamToFile", true);
+    }
+
     exp.start_export(true);
 
     std::string output = exp.export_sql_script();
+    if (!streamFile.empty()) {
+      $expect(output.empty()).toBeTrue();
+      output = base::getTextFileContent(streamFile);
+
+      grt::DictRef statistics = exp.export_statistics();
+      $expect(statistics.is_valid()).toBeTrue();
+      $expect(statistics.get_int("tables") > 0).toBeTrue();
+      $expect((size_t)statistics.get_int("bytesWritten")).toBe(output.size());
+    }
     $expect(output).toEqualContentOfFile(expectedFileName);
 
     tester->wb->close_document();
@@ -123,6 +140,36 @@ $describe("Forward Engineer") {
     data->doForwardEngineering(modelfile, expectedFileName, opts);
   });
 
+  $it("Streamed parallel forward engineering of sakila database", [this]() {
+    std::map<std::string, bool> opts;
+    std::string modelfile = data->dataDir + "/forward_engineer/sakila.mwb";
+    std::string expectedFileName = data->dataDir + "/forward_engineer/sakila.expected.sql";
+
+    opts["GenerateDrops"] = true;
+    opts["GenerateSchemaDrops"] = true;
+    opts["SkipForeignKeys"] = true;
+    opts["SkipFKIndexes"] = true;
+    opts["GenerateWarnings"] = true;
+    opts["GenerateCreateIndex"] = true;
+    opts["NoUsersJustPrivileges"] = false;
+    opts["NoViewPlaceholders"] = false;
+    opts["GenerateInserts"] = false;
+    opts["NoFKForInserts"] = false;
+    opts["TriggersAfterInserts"] = true;
+    opts["OmitSchemata"] = false;
+    opts["GenerateUse"] = true;
+
+    opts["TablesAreSelected"] = true;
+    opts["TriggersAreSelected"] = true;
+    opts["RoutinesAreSelected"] = true;
+    opts["ViewsAreSelected"] = true;
+    opts["UsersAreSelected"] = true;
+    opts["GenerateDocumentProperties"] = false;
+
+    std::string outputFile = casmine::CasmineContext::get()->outputDir() + "/sakila.streamed.sql";
+    data->doForwardEngineering(modelfile, expectedFileName, opts, outputFile);
+  });
+
   $it("Forward engineering of routines with ommitSchemata enabled", [this]() {
     std::map<std::string, bool> opts;
     std::string modelfile = data->dataDir + "/forward_engineer/omit_schema_routine.mwb";
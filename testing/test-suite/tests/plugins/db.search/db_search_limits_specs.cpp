@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "DbSearchLimits.h"
+
+#include "casmine.h"
+
+namespace {
+
+// A PK range of a table and the number of rows in it matching the search.
+struct FakeRange {
+  std::string table;
+  int matches;
+};
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::mutex mutex;
+  std::map<std::string, int> fetched;
+  std::vector<std::string> clauses;
+
+  // Stands in for the select function of the search: returns what the LIMIT clause allows of the matching rows.
+  int fakeSelect(const FakeRange &range, const std::string &limitClause) {
+    int rows = range.matches;
+    if (!limitClause.empty())
+      rows = std::min(rows, std::stoi(limitClause.substr(limitClause.find(' ') + 1)));
+
+    // Give the other workers a chance to reserve rows while this query "runs".
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fetched[range.table] += rows;
+    clauses.push_back(limitClause);
+    return rows;
+  }
+
+  // Searches the ranges with several workers, the way DBSearch::run_worker does.
+  void search(SearchLimits &limits, const std::vector<FakeRange> &ranges, size_t workerCount) {
+    std::deque<FakeRange> queue(ranges.begin(), ranges.end());
+    std::mutex queueMutex;
+
+    auto worker = [&]() {
+      while (true) {
+        FakeRange range;
+        {
+          std::lock_guard<std::mutex> lock(queueMutex);
+          if (queue.empty() || limits.exhausted())
+            return;
+          range = queue.front();
+          queue.pop_front();
+        }
+
+        SearchLimits::Outcome outcome = limits.run_query(
+          range.table, [&](const std::string &limitClause) { return fakeSelect(range, limitClause); });
+        if (outcome == SearchLimits::QueryPending) {
+          {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(range);
+          }
+          std::this_thread::yield();
+        }
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workerCount; ++i)
+      workers.push_back(std::thread(worker));
+    for (auto &thread : workers)
+      thread.join();
+  }
+
+  int totalFetched() {
+    int total = 0;
+    for (auto &entry : fetched)
+      total += entry.second;
+    return total;
+  }
+};
+
+$describe("DB search limits") {
+  $beforeEach([this]() {
+    data->fetched.clear();
+    data->clauses.clear();
+  });
+
+  // 3 tables split into ranges with different numbers of matches, 60 + 25 + 5 matches in total.
+  static const std::vector<FakeRange> ranges = {
+    { "s.big", 10 }, { "s.big", 0 }, { "s.big", 30 }, { "s.big", 20 }, { "s.medium", 5 }, { "s.medium", 20 },
+    { "s.small", 2 }, { "s.small", 3 }, { "s.small", 0 }
+  };
+
+  $it("Queries without any limit get no LIMIT clause", [this]() {
+    SearchLimits limits;
+    limits.reset(0, 0);
+    data->search(limits, ranges, 4);
+
+    $expect(data->totalFetched()).toBe(90);
+    for (auto &clause : data->clauses)
+      $expect(clause).toBe("");
+  });
+
+  $it("Parallel ranges fetch exactly up to the per table limit", [this]() {
+    SearchLimits limits;
+    limits.reset(0, 15);
+    data->search(limits, ranges, 4);
+
+    // Rows other ranges of a table didn't need are given back, so a table with enough matches reaches its limit.
+    $expect(data->fetched["s.big"]).toBe(15);
+    $expect(data->fetched["s.medium"]).toBe(15);
+    $expect(data->fetched["s.small"]).toBe(5);
+    for (auto &clause : data->clauses)
+      $expect(clause).Not.toBe("LIMIT 0");
+  });
+
+  $it("Parallel ranges fetch exactly up to the total limit", [this]() {
+    SearchLimits limits;
+    limits.reset(42, 0);
+    data->search(limits, ranges, 4);
+
+    $expect(data->totalFetched()).toBe(42);
+    $expect(limits.exhausted()).toBeTrue();
+  });
+
+  $it("The total and per table limits apply together", [this]() {
+    SearchLimits limits;
+    limits.reset(27, 12);
+    data->search(limits, ranges, 3);
+
+    $expect(data->totalFetched()).toBe(27);
+    for (auto &entry : data->fetched)
+      $expect(entry.second).toBeLessThanOrEqual(12);
+
+    // Nothing is left, so no further query may run, not even an unlimited one.
+    bool ran = false;
+    $expect(limits.run_query("s.other", [&](const std::string &) {
+      ran = true;
+      return 0;
+    })).toBe(SearchLimits::LimitReached);
+    $expect(ran).toBeFalse();
+  });
+
+  $it("A failing query gives back the rows it reserved", [this]() {
+    SearchLimits limits;
+    limits.reset(10, 5);
+
+    $expect([&]() {
+      limits.run_query("s.big", [](const std::string &) -> int { throw std::runtime_error("timeout"); });
+    }).toThrow();
+
+    std::string clause;
+    limits.run_query("s.big", [&](const std::string &limitClause) {
+      clause = limitClause;
+      return 0;
+    });
+    $expect(clause).toBe("LIMIT 5");
+
+    data->search(limits, ranges, 2);
+    $expect(data->totalFetched()).toBe(10);
+    for (auto &entry : data->fetched)
+      $expect(entry.second).toBeLessThanOrEqual(5);
+  });
+}
+
+}